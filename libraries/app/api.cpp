@@ -44,6 +44,7 @@
 template class fc::api<graphene::app::block_api>;
 template class fc::api<graphene::app::network_broadcast_api>;
 template class fc::api<graphene::app::network_node_api>;
+template class fc::api<graphene::app::admin_api>;
 template class fc::api<graphene::app::history_api>;
 template class fc::api<graphene::app::crypto_api>;
 template class fc::api<graphene::app::asset_api>;
@@ -90,7 +91,9 @@ namespace graphene { namespace app {
     {
        if( api_name == "database_api" )
        {
-          _database_api = std::make_shared< database_api >( std::ref( *_app.chain_database() ), &( _app.get_options() ) );
+          _database_api = std::make_shared< database_api >( std::ref( *_app.chain_database() ), &( _app.get_options() ),
+                                                            &_app.get_api_worker_pool(),
+                                                            &_app.get_api_response_cache() );
        }
        else if( api_name == "block_api" )
        {
@@ -108,6 +111,10 @@ namespace graphene { namespace app {
        {
           _network_node_api = std::make_shared< network_node_api >( std::ref(_app) );
        }
+       else if( api_name == "admin_api" )
+       {
+          _admin_api = std::make_shared< admin_api >( std::ref(_app) );
+       }
        else if( api_name == "crypto_api" )
        {
           _crypto_api = std::make_shared< crypto_api >();
@@ -180,7 +187,10 @@ namespace graphene { namespace app {
     void network_broadcast_api::broadcast_transaction(const precomputable_transaction& trx)
     {
        _app.chain_database()->precompute_parallel( trx ).wait();
-       _app.chain_database()->push_transaction(trx);
+       {
+          api_worker_pool::write_guard guard( _app.get_api_worker_pool() );
+          _app.chain_database()->push_transaction(trx);
+       }
        if( _app.p2p_node() != nullptr )
           _app.p2p_node()->broadcast_transaction(trx);
     }
@@ -198,7 +208,10 @@ namespace graphene { namespace app {
     void network_broadcast_api::broadcast_block( const signed_block& b )
     {
        _app.chain_database()->precompute_parallel( b ).wait();
-       _app.chain_database()->push_block(b);
+       {
+          api_worker_pool::write_guard guard( _app.get_api_worker_pool() );
+          _app.chain_database()->push_block(b);
+       }
        if( _app.p2p_node() != nullptr )
           _app.p2p_node()->broadcast( net::block_message( b ));
     }
@@ -207,7 +220,10 @@ namespace graphene { namespace app {
     {
        _app.chain_database()->precompute_parallel( trx ).wait();
        _callbacks[trx.id()] = cb;
-       _app.chain_database()->push_transaction(trx);
+       {
+          api_worker_pool::write_guard guard( _app.get_api_worker_pool() );
+          _app.chain_database()->push_transaction(trx);
+       }
        if( _app.p2p_node() != nullptr )
           _app.p2p_node()->broadcast_transaction(trx);
     }
@@ -238,6 +254,46 @@ namespace graphene { namespace app {
        return _app.p2p_node()->get_potential_peers();
     }
 
+    graphene::chain::transaction_admission_statistics network_node_api::get_mempool_statistics() const
+    {
+       return _app.chain_database()->admission_controller().get_statistics();
+    }
+
+    api_worker_pool_statistics network_node_api::get_api_worker_statistics() const
+    {
+       return _app.get_api_worker_pool().get_statistics();
+    }
+
+    admin_api::admin_api( application& a ) : _app( a )
+    {
+    }
+
+    api_call_statistics admin_api::get_api_call_statistics() const
+    {
+       return _app.get_api_call_accounting().get_statistics();
+    }
+
+    vector<api_slow_call> admin_api::get_slow_api_calls() const
+    {
+       return _app.get_api_call_accounting().get_slow_calls();
+    }
+
+    string admin_api::get_prometheus_metrics() const
+    {
+       return _app.get_api_call_accounting().get_prometheus_metrics()
+              + _app.get_api_response_cache().get_prometheus_metrics();
+    }
+
+    api_response_cache_statistics admin_api::get_api_response_cache_statistics() const
+    {
+       return _app.get_api_response_cache().get_statistics();
+    }
+
+    void admin_api::reset_api_call_statistics()
+    {
+       _app.get_api_call_accounting().reset();
+    }
+
     fc::variant_object network_node_api::get_advanced_node_parameters() const
     {
        return _app.p2p_node()->get_advanced_node_parameters();
@@ -308,6 +364,12 @@ namespace graphene { namespace app {
        return *_custom_operations_api;
     }
 
+    fc::api<admin_api> login_api::admin() const
+    {
+       FC_ASSERT(_admin_api);
+       return *_admin_api;
+    }
+
     vector<order_history_object> history_api::get_fill_order_history( std::string asset_a, std::string asset_b,
                                                                       uint32_t limit )const
     {
@@ -343,51 +405,57 @@ namespace graphene { namespace app {
                                                                        unsigned limit,
                                                                        operation_history_id_type start ) const
     {
-       FC_ASSERT( _app.chain_database() );
-       const auto& db = *_app.chain_database();
-
-       const auto configured_limit = _app.get_options().api_limit_get_account_history;
-       FC_ASSERT( limit <= configured_limit,
-                  "limit can not be greater than ${configured_limit}",
-                  ("configured_limit", configured_limit) );
-
-       vector<operation_history_object> result;
-       account_id_type account;
-       try {
-          account = database_api.get_account_id_from_string(account_id_or_name);
-          const account_transaction_history_object& node = account(db).statistics(db).most_recent_op(db);
-          if(start == operation_history_id_type() || start.instance.value > node.operation_id.instance.value)
-             start = node.operation_id;
-       } catch(...) { return result; }
-
-       if(_app.is_plugin_enabled("elasticsearch")) {
-          auto es = _app.get_plugin<elasticsearch::elasticsearch_plugin>("elasticsearch");
-          if(es.get()->get_running_mode() != elasticsearch::mode::only_save) {
-             if(!_app.elasticsearch_thread)
-                _app.elasticsearch_thread= std::make_shared<fc::thread>("elasticsearch");
-
-             return _app.elasticsearch_thread->async([&es, &account, &stop, &limit, &start]() {
-                return es->get_account_history(account, stop, limit, start);
-             }, "thread invoke for method " BOOST_PP_STRINGIZE(method_name)).wait();
+       // create the thread before the call might be executed concurrently by several workers
+       if( _app.is_plugin_enabled("elasticsearch") && !_app.elasticsearch_thread )
+          _app.elasticsearch_thread = std::make_shared<fc::thread>("elasticsearch");
+
+       return _app.get_api_worker_pool().run_read_only( "history_api", "get_account_history", [&]() {
+          FC_ASSERT( _app.chain_database() );
+          const auto& db = *_app.chain_database();
+
+          const auto configured_limit = _app.get_options().api_limit_get_account_history;
+          FC_ASSERT( limit <= configured_limit,
+                     "limit can not be greater than ${configured_limit}",
+                     ("configured_limit", configured_limit) );
+
+          vector<operation_history_object> result;
+          account_id_type account;
+          try {
+             account = database_api.get_account_id_from_string(account_id_or_name);
+             const account_transaction_history_object& node = account(db).statistics(db).most_recent_op(db);
+             if(start == operation_history_id_type() || start.instance.value > node.operation_id.instance.value)
+                start = node.operation_id;
+          } catch(...) { return result; }
+
+          if(_app.is_plugin_enabled("elasticsearch")) {
+             auto es = _app.get_plugin<elasticsearch::elasticsearch_plugin>("elasticsearch");
+             if(es.get()->get_running_mode() != elasticsearch::mode::only_save) {
+                if(!_app.elasticsearch_thread)
+                   _app.elasticsearch_thread= std::make_shared<fc::thread>("elasticsearch");
+
+                return _app.elasticsearch_thread->async([&es, &account, &stop, &limit, &start]() {
+                   return es->get_account_history(account, stop, limit, start);
+                }, "thread invoke for method " BOOST_PP_STRINGIZE(method_name)).wait();
+             }
           }
-       }
 
-       const auto& hist_idx = db.get_index_type<account_transaction_history_index>();
-       const auto& by_op_idx = hist_idx.indices().get<by_op>();
-       auto index_start = by_op_idx.begin();
-       auto itr = by_op_idx.lower_bound(boost::make_tuple(account, start));
+          const auto& hist_idx = db.get_index_type<account_transaction_history_index>();
+          const auto& by_op_idx = hist_idx.indices().get<by_op>();
+          auto index_start = by_op_idx.begin();
+          auto itr = by_op_idx.lower_bound(boost::make_tuple(account, start));
 
-       while(itr != index_start && itr->account == account && itr->operation_id.instance.value > stop.instance.value && result.size() < limit)
-       {
-          if(itr->operation_id.instance.value <= start.instance.value)
-             result.push_back(itr->operation_id(db));
-          --itr;
-       }
-       if(stop.instance.value == 0 && result.size() < limit && itr->account == account) {
-         result.push_back(itr->operation_id(db));
-       }
+          while(itr != index_start && itr->account == account && itr->operation_id.instance.value > stop.instance.value && result.size() < limit)
+          {
+             if(itr->operation_id.instance.value <= start.instance.value)
+                result.push_back(itr->operation_id(db));
+             --itr;
+          }
+          if(stop.instance.value == 0 && result.size() < limit && itr->account == account) {
+            result.push_back(itr->operation_id(db));
+          }
 
-       return result;
+          return result;
+       } );
     }
 
     vector<operation_history_object> history_api::get_account_history_operations( const std::string account_id_or_name,
@@ -396,42 +464,44 @@ namespace graphene { namespace app {
                                                                        operation_history_id_type stop,
                                                                        unsigned limit ) const
     {
-       FC_ASSERT( _app.chain_database() );
-       const auto& db = *_app.chain_database();
-
-       const auto configured_limit = _app.get_options().api_limit_get_account_history_operations;
-       FC_ASSERT( limit <= configured_limit,
-                  "limit can not be greater than ${configured_limit}",
-                  ("configured_limit", configured_limit) );
-
-       vector<operation_history_object> result;
-       account_id_type account;
-       try {
-          account = database_api.get_account_id_from_string(account_id_or_name);
-       } catch(...) { return result; }
-       const auto& stats = account(db).statistics(db);
-       if( stats.most_recent_op == account_transaction_history_id_type() ) return result;
-       const account_transaction_history_object* node = &stats.most_recent_op(db);
-       if( start == operation_history_id_type() )
-          start = node->operation_id;
-
-       while(node && node->operation_id.instance.value > stop.instance.value && result.size() < limit)
-       {
-          if( node->operation_id.instance.value <= start.instance.value ) {
+       return _app.get_api_worker_pool().run_read_only( "history_api", "get_account_history_operations", [&]() {
+          FC_ASSERT( _app.chain_database() );
+          const auto& db = *_app.chain_database();
+
+          const auto configured_limit = _app.get_options().api_limit_get_account_history_operations;
+          FC_ASSERT( limit <= configured_limit,
+                     "limit can not be greater than ${configured_limit}",
+                     ("configured_limit", configured_limit) );
+
+          vector<operation_history_object> result;
+          account_id_type account;
+          try {
+             account = database_api.get_account_id_from_string(account_id_or_name);
+          } catch(...) { return result; }
+          const auto& stats = account(db).statistics(db);
+          if( stats.most_recent_op == account_transaction_history_id_type() ) return result;
+          const account_transaction_history_object* node = &stats.most_recent_op(db);
+          if( start == operation_history_id_type() )
+             start = node->operation_id;
+
+          while(node && node->operation_id.instance.value > stop.instance.value && result.size() < limit)
+          {
+             if( node->operation_id.instance.value <= start.instance.value ) {
 
-             if(node->operation_id(db).op.which() == operation_type)
-               result.push_back( node->operation_id(db) );
+                if(node->operation_id(db).op.which() == operation_type)
+                  result.push_back( node->operation_id(db) );
+             }
+             if( node->next == account_transaction_history_id_type() )
+                node = nullptr;
+             else node = &node->next(db);
           }
-          if( node->next == account_transaction_history_id_type() )
-             node = nullptr;
-          else node = &node->next(db);
-       }
-       if( stop.instance.value == 0 && result.size() < limit ) {
-          auto head = db.find(account_transaction_history_id_type());
-          if (head != nullptr && head->account == account && head->operation_id(db).op.which() == operation_type)
-            result.push_back(head->operation_id(db));
-       }
-       return result;
+          if( stop.instance.value == 0 && result.size() < limit ) {
+             auto head = db.find(account_transaction_history_id_type());
+             if (head != nullptr && head->account == account && head->operation_id(db).op.which() == operation_type)
+               result.push_back(head->operation_id(db));
+          }
+          return result;
+       } );
     }
 
 
@@ -440,41 +510,43 @@ namespace graphene { namespace app {
                                                                                 unsigned limit,
                                                                                 uint64_t start ) const
     {
-       FC_ASSERT( _app.chain_database() );
-       const auto& db = *_app.chain_database();
-
-       const auto configured_limit = _app.get_options().api_limit_get_relative_account_history;
-       FC_ASSERT( limit <= configured_limit,
-                  "limit can not be greater than ${configured_limit}",
-                  ("configured_limit", configured_limit) );
-
-       vector<operation_history_object> result;
-       account_id_type account;
-       try {
-          account = database_api.get_account_id_from_string(account_id_or_name);
-       } catch(...) { return result; }
-       const auto& stats = account(db).statistics(db);
-       if( start == 0 )
-          start = stats.total_ops;
-       else
-          start = std::min( stats.total_ops, start );
-
-       if( start >= stop && start > stats.removed_ops && limit > 0 )
-       {
-          const auto& hist_idx = db.get_index_type<account_transaction_history_index>();
-          const auto& by_seq_idx = hist_idx.indices().get<by_seq>();
+       return _app.get_api_worker_pool().run_read_only( "history_api", "get_relative_account_history", [&]() {
+          FC_ASSERT( _app.chain_database() );
+          const auto& db = *_app.chain_database();
+
+          const auto configured_limit = _app.get_options().api_limit_get_relative_account_history;
+          FC_ASSERT( limit <= configured_limit,
+                     "limit can not be greater than ${configured_limit}",
+                     ("configured_limit", configured_limit) );
+
+          vector<operation_history_object> result;
+          account_id_type account;
+          try {
+             account = database_api.get_account_id_from_string(account_id_or_name);
+          } catch(...) { return result; }
+          const auto& stats = account(db).statistics(db);
+          if( start == 0 )
+             start = stats.total_ops;
+          else
+             start = std::min( stats.total_ops, start );
+
+          if( start >= stop && start > stats.removed_ops && limit > 0 )
+          {
+             const auto& hist_idx = db.get_index_type<account_transaction_history_index>();
+             const auto& by_seq_idx = hist_idx.indices().get<by_seq>();
 
-          auto itr = by_seq_idx.upper_bound( boost::make_tuple( account, start ) );
-          auto itr_stop = by_seq_idx.lower_bound( boost::make_tuple( account, stop ) );
+             auto itr = by_seq_idx.upper_bound( boost::make_tuple( account, start ) );
+             auto itr_stop = by_seq_idx.lower_bound( boost::make_tuple( account, stop ) );
 
-          do
-          {
-             --itr;
-             result.push_back( itr->operation_id(db) );
+             do
+             {
+                --itr;
+                result.push_back( itr->operation_id(db) );
+             }
+             while ( itr != itr_stop && result.size() < limit );
           }
-          while ( itr != itr_stop && result.size() < limit );
-       }
-       return result;
+          return result;
+       } );
     }
 
     flat_set<uint32_t> history_api::get_market_history_buckets()const
@@ -522,28 +594,9 @@ namespace graphene { namespace app {
        FC_ASSERT( market_hist_plugin, "Market history plugin is not enabled" );
        FC_ASSERT(_app.chain_database());
 
-       const auto& db = *_app.chain_database();
        asset_id_type a = database_api.get_asset_id_from_string( asset_a );
        asset_id_type b = database_api.get_asset_id_from_string( asset_b );
-       vector<bucket_object> result;
-       result.reserve(200);
-
-       if( a > b ) std::swap(a,b);
-
-       const auto& bidx = db.get_index_type<bucket_index>();
-       const auto& by_key_idx = bidx.indices().get<by_key>();
-
-       auto itr = by_key_idx.lower_bound( bucket_key( a, b, bucket_seconds, start ) );
-       while( itr != by_key_idx.end() && itr->key.open <= end && result.size() < 200 )
-       {
-          if( !(itr->key.base == a && itr->key.quote == b && itr->key.seconds == bucket_seconds) )
-          {
-            return result;
-          }
-          result.push_back(*itr);
-          ++itr;
-       }
-       return result;
+       return market_hist_plugin->get_market_history( a, b, bucket_seconds, start, end, 200 );
     } FC_CAPTURE_AND_RETHROW( (asset_a)(asset_b)(bucket_seconds)(start)(end) ) }
 
     crypto_api::crypto_api(){};
@@ -704,20 +757,63 @@ namespace graphene { namespace app {
 
       auto plugin = _app.get_plugin<graphene::grouped_orders::grouped_orders_plugin>( "grouped_orders" );
       FC_ASSERT( plugin );
-      const auto& limit_groups = plugin->limit_order_groups();
-      vector< limit_order_group > result;
 
       asset_id_type base_asset_id = database_api.get_asset_id_from_string( base_asset );
       asset_id_type quote_asset_id = database_api.get_asset_id_from_string( quote_asset );
 
+      return collect_limit_order_groups( *plugin, base_asset_id, quote_asset_id, group, start, limit );
+   }
+
+   map< uint16_t, vector< limit_order_group > > orders_api::get_grouped_limit_orders_by_groups(
+         std::string base_asset,
+         std::string quote_asset,
+         flat_set<uint16_t> groups,
+         optional<price> start,
+         uint32_t limit )const
+   {
+      const auto configured_limit = _app.get_options().api_limit_get_grouped_limit_orders;
+      FC_ASSERT( limit <= configured_limit,
+                 "limit can not be greater than ${configured_limit}",
+                 ("configured_limit", configured_limit) );
+
+      auto plugin = _app.get_plugin<graphene::grouped_orders::grouped_orders_plugin>( "grouped_orders" );
+      FC_ASSERT( plugin );
+
+      const auto& tracked_groups = plugin->tracked_groups();
+      for( uint16_t group : groups )
+         FC_ASSERT( tracked_groups.find( group ) != tracked_groups.end(),
+                    "group ${g} is not tracked by this node", ("g", group) );
+
+      asset_id_type base_asset_id = database_api.get_asset_id_from_string( base_asset );
+      asset_id_type quote_asset_id = database_api.get_asset_id_from_string( quote_asset );
+
+      map< uint16_t, vector< limit_order_group > > result;
+      for( uint16_t group : groups )
+         result[group] = collect_limit_order_groups( *plugin, base_asset_id, quote_asset_id, group, start, limit );
+      return result;
+   }
+
+   vector< limit_order_group > orders_api::collect_limit_order_groups( grouped_orders_plugin& plugin,
+                                                                       asset_id_type base_asset_id,
+                                                                       asset_id_type quote_asset_id,
+                                                                       uint16_t group,
+                                                                       const optional<price>& start,
+                                                                       uint32_t limit )const
+   {
+      vector< limit_order_group > result;
+      const auto* book = plugin.find_limit_order_group_book( group, base_asset_id, quote_asset_id );
+      if( book == nullptr )
+         return result;
+
       price max_price = price::max( base_asset_id, quote_asset_id );
       price min_price = price::min( base_asset_id, quote_asset_id );
       if( start.valid() && !start->is_null() )
          max_price = std::max( std::min( max_price, *start ), min_price );
 
-      auto itr = limit_groups.lower_bound( limit_order_group_key( group, max_price ) );
+      auto itr = book->lower_bound( limit_order_group_key( group, max_price ) );
       // use an end iterator to try to avoid expensive price comparison
-      auto end = limit_groups.upper_bound( limit_order_group_key( group, min_price ) );
+      auto end = book->upper_bound( limit_order_group_key( group, min_price ) );
+      result.reserve( std::min<size_t>( limit, book->size() ) );
       while( itr != end && result.size() < limit )
       {
          result.emplace_back( *itr );
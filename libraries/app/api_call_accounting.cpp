@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <graphene/app/api_call_accounting.hpp>
+
+#include <fc/log/logger.hpp>
+#include <fc/rpc/websocket_api.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+namespace graphene { namespace app {
+
+const std::vector<uint64_t>& api_latency_histogram::bucket_upper_bounds()
+{
+   static const std::vector<uint64_t> bounds = { 1000, 2000, 5000, 10000, 20000, 50000, 100000, 200000,
+                                                 500000, 1000000, 2000000, 5000000 };
+   return bounds;
+}
+
+void api_latency_histogram::record( uint64_t microseconds )
+{
+   const auto& bounds = bucket_upper_bounds();
+   if( counts.empty() )
+      counts.resize( bounds.size() + 1 );
+   const size_t bucket = std::lower_bound( bounds.begin(), bounds.end(), microseconds ) - bounds.begin();
+   ++counts[bucket];
+   ++total_calls;
+   total_microseconds += microseconds;
+   max_microseconds = std::max( max_microseconds, microseconds );
+}
+
+void api_call_accounting::set_history_size( uint32_t size )
+{
+   _history_size = size;
+   while( _slow_calls.size() > _history_size )
+      _slow_calls.pop_back();
+   while( _closed_connections.size() > _history_size )
+      _closed_connections.pop_back();
+}
+
+uint64_t api_call_accounting::open_connection( const std::string& remote_endpoint )
+{
+   const uint64_t id = _next_connection_id++;
+   api_connection_statistics& conn = _connections[id];
+   conn.connection_id = id;
+   conn.remote_endpoint = remote_endpoint;
+   conn.connected_since = fc::time_point::now();
+   return id;
+}
+
+void api_call_accounting::set_connection_username( uint64_t connection_id, const std::string& username )
+{
+   auto itr = _connections.find( connection_id );
+   if( itr != _connections.end() )
+      itr->second.username = username;
+}
+
+void api_call_accounting::close_connection( uint64_t connection_id )
+{
+   auto itr = _connections.find( connection_id );
+   if( itr == _connections.end() )
+      return;
+   if( _history_size > 0 )
+   {
+      _closed_connections.push_front( std::move( itr->second ) );
+      if( _closed_connections.size() > _history_size )
+         _closed_connections.pop_back();
+   }
+   _connections.erase( itr );
+}
+
+void api_call_accounting::record_call( uint64_t connection_id, const std::string& method, uint64_t request_bytes,
+                                       uint64_t response_bytes, const fc::microseconds& duration, bool failed )
+{
+   const uint64_t microseconds = std::max<int64_t>( duration.count(), 0 );
+
+   api_method_statistics& stats = _methods[method];
+   stats.latency.record( microseconds );
+   stats.total_request_bytes += request_bytes;
+   stats.total_response_bytes += response_bytes;
+   if( failed )
+      ++stats.failed_calls;
+
+   std::string remote_endpoint;
+   auto itr = _connections.find( connection_id );
+   if( itr != _connections.end() )
+   {
+      api_connection_statistics& conn = itr->second;
+      ++conn.calls;
+      if( failed )
+         ++conn.failed_calls;
+      conn.total_microseconds += microseconds;
+      conn.total_request_bytes += request_bytes;
+      conn.total_response_bytes += response_bytes;
+      remote_endpoint = conn.remote_endpoint;
+   }
+
+   if( _slow_call_threshold.count() <= 0 || duration < _slow_call_threshold )
+      return;
+
+   wlog( "Slow API call ${m} from ${r} took ${t} us, request ${q} bytes, response ${s} bytes",
+         ("m",method)("r",remote_endpoint)("t",microseconds)("q",request_bytes)("s",response_bytes) );
+   if( _history_size == 0 )
+      return;
+   api_slow_call call;
+   call.time = fc::time_point::now();
+   call.connection_id = connection_id;
+   call.remote_endpoint = std::move( remote_endpoint );
+   call.method = method;
+   call.request_bytes = request_bytes;
+   call.response_bytes = response_bytes;
+   call.microseconds = microseconds;
+   call.failed = failed;
+   _slow_calls.push_front( std::move( call ) );
+   if( _slow_calls.size() > _history_size )
+      _slow_calls.pop_back();
+}
+
+api_call_statistics api_call_accounting::get_statistics()const
+{
+   api_call_statistics result;
+   result.latency_bucket_upper_bounds_us = api_latency_histogram::bucket_upper_bounds();
+   result.methods = _methods;
+   result.connections.reserve( _connections.size() );
+   for( const auto& conn : _connections )
+      result.connections.push_back( conn.second );
+   result.closed_connections.assign( _closed_connections.begin(), _closed_connections.end() );
+   return result;
+}
+
+std::vector< api_slow_call > api_call_accounting::get_slow_calls()const
+{
+   return std::vector< api_slow_call >( _slow_calls.begin(), _slow_calls.end() );
+}
+
+namespace {
+   /// Escape a Prometheus label value
+   std::string escape_label( const std::string& value )
+   {
+      std::string result;
+      result.reserve( value.size() );
+      for( char c : value )
+      {
+         if( c == '\\' || c == '"' )
+            result += '\\';
+         if( c == '\n' )
+         {
+            result += "\\n";
+            continue;
+         }
+         result += c;
+      }
+      return result;
+   }
+
+   std::string format_seconds( uint64_t microseconds )
+   {
+      std::ostringstream out;
+      out << microseconds / 1000000 << '.';
+      const std::string fraction = std::to_string( microseconds % 1000000 );
+      out << std::string( 6 - fraction.size(), '0' ) << fraction;
+      return out.str();
+   }
+}
+
+std::string api_call_accounting::get_prometheus_metrics()const
+{
+   const auto& bounds = api_latency_histogram::bucket_upper_bounds();
+   std::ostringstream out;
+
+   out << "# HELP graphene_api_call_duration_seconds Time spent executing API calls\n"
+       << "# TYPE graphene_api_call_duration_seconds histogram\n";
+   for( const auto& method : _methods )
+   {
+      const std::string label = "method=\"" + escape_label( method.first ) + "\"";
+      const api_latency_histogram& latency = method.second.latency;
+      uint64_t cumulative = 0;
+      for( size_t i = 0; i < bounds.size(); ++i )
+      {
+         if( i < latency.counts.size() )
+            cumulative += latency.counts[i];
+         out << "graphene_api_call_duration_seconds_bucket{" << label << ",le=\"" << format_seconds( bounds[i] )
+             << "\"} " << cumulative << "\n";
+      }
+      out << "graphene_api_call_duration_seconds_bucket{" << label << ",le=\"+Inf\"} " << latency.total_calls << "\n"
+          << "graphene_api_call_duration_seconds_sum{" << label << "} "
+          << format_seconds( latency.total_microseconds ) << "\n"
+          << "graphene_api_call_duration_seconds_count{" << label << "} " << latency.total_calls << "\n";
+   }
+
+   out << "# HELP graphene_api_call_failures_total API calls which returned an error\n"
+       << "# TYPE graphene_api_call_failures_total counter\n";
+   for( const auto& method : _methods )
+      out << "graphene_api_call_failures_total{method=\"" << escape_label( method.first ) << "\"} "
+          << method.second.failed_calls << "\n";
+
+   out << "# HELP graphene_api_call_request_bytes_total Estimated size of API call requests\n"
+       << "# TYPE graphene_api_call_request_bytes_total counter\n";
+   for( const auto& method : _methods )
+      out << "graphene_api_call_request_bytes_total{method=\"" << escape_label( method.first ) << "\"} "
+          << method.second.total_request_bytes << "\n";
+
+   out << "# HELP graphene_api_call_response_bytes_total Estimated size of API call responses\n"
+       << "# TYPE graphene_api_call_response_bytes_total counter\n";
+   for( const auto& method : _methods )
+      out << "graphene_api_call_response_bytes_total{method=\"" << escape_label( method.first ) << "\"} "
+          << method.second.total_response_bytes << "\n";
+
+   out << "# HELP graphene_api_connections Open API connections\n"
+       << "# TYPE graphene_api_connections gauge\n"
+       << "graphene_api_connections " << _connections.size() << "\n";
+
+   out << "# HELP graphene_api_connection_calls_total API calls per open connection\n"
+       << "# TYPE graphene_api_connection_calls_total counter\n";
+   for( const auto& conn : _connections )
+      out << "graphene_api_connection_calls_total{connection=\"" << conn.first << "\",remote=\""
+          << escape_label( conn.second.remote_endpoint ) << "\",user=\"" << escape_label( conn.second.username )
+          << "\"} " << conn.second.calls << "\n";
+
+   out << "# HELP graphene_api_connection_duration_seconds_total Time spent executing API calls per open connection\n"
+       << "# TYPE graphene_api_connection_duration_seconds_total counter\n";
+   for( const auto& conn : _connections )
+      out << "graphene_api_connection_duration_seconds_total{connection=\"" << conn.first << "\"} "
+          << format_seconds( conn.second.total_microseconds ) << "\n";
+
+   out << "# HELP graphene_api_connection_response_bytes_total Estimated size of API responses per open connection\n"
+       << "# TYPE graphene_api_connection_response_bytes_total counter\n";
+   for( const auto& conn : _connections )
+      out << "graphene_api_connection_response_bytes_total{connection=\"" << conn.first << "\"} "
+          << conn.second.total_response_bytes << "\n";
+
+   return out.str();
+}
+
+void api_call_accounting::reset()
+{
+   _methods.clear();
+   _slow_calls.clear();
+   _closed_connections.clear();
+   for( auto& conn : _connections )
+   {
+      conn.second.calls = 0;
+      conn.second.failed_calls = 0;
+      conn.second.total_microseconds = 0;
+      conn.second.total_request_bytes = 0;
+      conn.second.total_response_bytes = 0;
+   }
+}
+
+uint64_t api_call_accounting::estimate_json_size( const fc::variant& v )
+{
+   switch( v.get_type() )
+   {
+      case fc::variant::null_type:
+         return 4;
+      case fc::variant::bool_type:
+         return v.as_bool() ? 4 : 5;
+      case fc::variant::int64_type:
+      case fc::variant::uint64_type:
+      case fc::variant::double_type:
+         return 12;
+      case fc::variant::string_type:
+         return v.get_string().size() + 2;
+      case fc::variant::blob_type:
+         return v.get_blob().data.size() * 4 / 3 + 4;
+      case fc::variant::array_type:
+      {
+         uint64_t size = 2;
+         for( const auto& item : v.get_array() )
+            size += estimate_json_size( item ) + 1;
+         return size;
+      }
+      case fc::variant::object_type:
+      {
+         uint64_t size = 2;
+         for( const auto& entry : v.get_object() )
+            size += entry.key().size() + 4 + estimate_json_size( entry.value() );
+         return size;
+      }
+      default:
+         return 0;
+   }
+}
+
+namespace detail {
+
+   /**
+    * A websocket API connection which times every call it dispatches.
+    *
+    * fc resolves the method of a "call" request and of any other request in handlers which are registered on the
+    * RPC state by the base class. They are replaced here by handlers which do the same dispatching through
+    * @ref receive_call and account for it.
+    */
+   class accounting_websocket_api_connection : public fc::rpc::websocket_api_connection
+   {
+   public:
+      accounting_websocket_api_connection( const fc::http::websocket_connection_ptr& c, uint32_t max_depth,
+                                           api_call_accounting& accounting )
+         : fc::rpc::websocket_api_connection( c, max_depth ), _accounting( accounting )
+      {
+         _connection_id = _accounting.open_connection( c->get_remote_endpoint_string() );
+         _api_names[0] = "database_api";
+         _api_names[1] = "login_api";
+
+         _rpc_state.remove_method( "call" );
+         _rpc_state.add_method( "call", [this]( const fc::variants& args ) -> fc::variant
+         {
+            FC_ASSERT( args.size() == 3 && args[2].is_array() );
+            fc::api_id_type api_id;
+            if( args[0].is_string() )
+               api_id = accounted_call( 1, args[0].as_string(), fc::variants() ).as_uint64();
+            else
+               api_id = args[0].as_uint64();
+            return accounted_call( api_id, args[1].as_string(), args[2].get_array() );
+         } );
+         _rpc_state.on_unhandled( [this]( const std::string& method_name, const fc::variants& args )
+         {
+            return accounted_call( 0, method_name, args );
+         } );
+      }
+
+      ~accounting_websocket_api_connection()
+      {
+         _accounting.close_connection( _connection_id );
+      }
+
+      uint64_t connection_id()const { return _connection_id; }
+
+   private:
+      fc::variant accounted_call( fc::api_id_type api_id, const std::string& method_name, const fc::variants& args )
+      {
+         const std::string method = api_name( api_id ) + "." + method_name;
+         const uint64_t request_bytes = estimate_json_size_of( args ) + method_name.size();
+         const fc::time_point start = fc::time_point::now();
+         fc::variant result;
+         try
+         {
+            result = receive_call( api_id, method_name, args );
+         }
+         catch( ... )
+         {
+            _accounting.record_call( _connection_id, method, request_bytes, 0, fc::time_point::now() - start, true );
+            throw;
+         }
+         _accounting.record_call( _connection_id, method, request_bytes,
+                                  api_call_accounting::estimate_json_size( result ),
+                                  fc::time_point::now() - start, false );
+
+         if( api_id == 1 )
+         {
+            // Methods of the login API which return an API return the id under which it has been registered
+            if( method_name == "login" )
+            {
+               if( result.is_bool() && result.as_bool() && !args.empty() && args[0].is_string() )
+                  _accounting.set_connection_username( _connection_id, args[0].as_string() );
+            }
+            else if( result.is_uint64() || result.is_int64() )
+               _api_names[ result.as_uint64() ] = method_name + "_api";
+         }
+         return result;
+      }
+
+      std::string api_name( fc::api_id_type api_id )const
+      {
+         auto itr = _api_names.find( api_id );
+         if( itr != _api_names.end() )
+            return itr->second;
+         return "api_" + std::to_string( api_id );
+      }
+
+      static uint64_t estimate_json_size_of( const fc::variants& args )
+      {
+         uint64_t size = 2;
+         for( const auto& arg : args )
+            size += api_call_accounting::estimate_json_size( arg ) + 1;
+         return size;
+      }
+
+      api_call_accounting&                     _accounting;
+      uint64_t                                 _connection_id = 0;
+      std::map< fc::api_id_type, std::string > _api_names;
+   };
+
+} // detail
+
+std::shared_ptr<fc::rpc::websocket_api_connection> create_accounting_websocket_api_connection(
+      const std::shared_ptr<fc::http::websocket_connection>& connection, uint32_t max_conversion_depth,
+      api_call_accounting& accounting )
+{
+   return std::make_shared<detail::accounting_websocket_api_connection>( connection, max_conversion_depth,
+                                                                         accounting );
+}
+
+void record_api_connection_username( const std::shared_ptr<fc::rpc::websocket_api_connection>& connection,
+                                     api_call_accounting& accounting, const std::string& username )
+{
+   auto conn = std::dynamic_pointer_cast<detail::accounting_websocket_api_connection>( connection );
+   if( conn )
+      accounting.set_connection_username( conn->connection_id(), username );
+}
+
+} } // graphene::app
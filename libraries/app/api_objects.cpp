@@ -106,4 +106,38 @@ market_ticker::market_ticker(const fc::time_point_sec& now,
    quote_volume = "0";
 }
 
+liquidity_pool_ticker::liquidity_pool_ticker( const liquidity_pool_ticker_object& lpto,
+                                              const fc::time_point_sec& now )
+{
+   pool = lpto.pool;
+   time = now;
+   exchange_count = lpto._24h_exchange_count;
+   deposit_count = lpto._24h_deposit_count;
+   withdrawal_count = lpto._24h_withdrawal_count;
+   volume_a = lpto._24h_volume_a;
+   volume_b = lpto._24h_volume_b;
+   fee_a = lpto._24h_fee_a;
+   fee_b = lpto._24h_fee_b;
+   total_exchange_count = lpto.total_exchange_count;
+   for( const auto& stats : lpto.hourly_stats )
+   {
+      if( stats.exchange_count == 0 || stats.open.base.amount == 0 )
+         continue;
+      if( !open.valid() )
+      {
+         open = stats.open;
+         high = stats.high;
+         low = stats.low;
+      }
+      else
+      {
+         if( stats.high > *high )
+            high = stats.high;
+         if( stats.low < *low )
+            low = stats.low;
+      }
+      close = stats.close;
+   }
+}
+
 } } // graphene::app
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <graphene/app/api_response_cache.hpp>
+
+#include <sstream>
+
+namespace graphene { namespace app {
+
+void api_response_cache::set_capacity( uint64_t capacity_bytes )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _capacity_bytes = capacity_bytes;
+   _stats.capacity_bytes = capacity_bytes;
+   while( !_entries.empty() && _stats.used_bytes > _capacity_bytes )
+   {
+      erase_entry( std::prev( _entries.end() ) );
+      ++_stats.evictions;
+   }
+}
+
+std::shared_ptr<const void> api_response_cache::find_erased( const std::string& key )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   if( _capacity_bytes == 0 )
+      return nullptr;
+   auto itr = _index.find( key );
+   if( itr == _index.end() )
+   {
+      ++_stats.misses;
+      return nullptr;
+   }
+   ++_stats.hits;
+   _entries.splice( _entries.begin(), _entries, itr->second );
+   return itr->second->value;
+}
+
+void api_response_cache::insert_erased( const std::string& key, std::shared_ptr<const void> value, uint64_t bytes )
+{
+   bytes += key.size();
+   std::lock_guard<std::mutex> lock( _mutex );
+   // an entry which does not fit would only flush the cache
+   if( bytes > _capacity_bytes )
+      return;
+   auto itr = _index.find( key );
+   if( itr != _index.end() )
+      erase_entry( itr->second );
+   while( !_entries.empty() && _stats.used_bytes + bytes > _capacity_bytes )
+   {
+      erase_entry( std::prev( _entries.end() ) );
+      ++_stats.evictions;
+   }
+   _entries.push_front( entry{ key, std::move( value ), bytes } );
+   _index[key] = _entries.begin();
+   _stats.used_bytes += bytes;
+   ++_stats.insertions;
+}
+
+void api_response_cache::erase( const std::string& key )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   auto itr = _index.find( key );
+   if( itr != _index.end() )
+      erase_entry( itr->second );
+}
+
+void api_response_cache::erase_entry( lru_list::iterator itr )
+{
+   _stats.used_bytes -= itr->bytes;
+   _index.erase( itr->key );
+   _entries.erase( itr );
+}
+
+void api_response_cache::clear()
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _entries.clear();
+   _index.clear();
+   _stats.used_bytes = 0;
+}
+
+api_response_cache_statistics api_response_cache::get_statistics()const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   api_response_cache_statistics result = _stats;
+   result.entries = _entries.size();
+   return result;
+}
+
+std::string api_response_cache::get_prometheus_metrics()const
+{
+   const api_response_cache_statistics stats = get_statistics();
+   std::ostringstream out;
+   out << "# HELP graphene_api_response_cache_hits_total API results served from the response cache\n"
+       << "# TYPE graphene_api_response_cache_hits_total counter\n"
+       << "graphene_api_response_cache_hits_total " << stats.hits << "\n"
+       << "# HELP graphene_api_response_cache_misses_total Response cache lookups which found nothing\n"
+       << "# TYPE graphene_api_response_cache_misses_total counter\n"
+       << "graphene_api_response_cache_misses_total " << stats.misses << "\n"
+       << "# HELP graphene_api_response_cache_evictions_total Entries evicted from the response cache\n"
+       << "# TYPE graphene_api_response_cache_evictions_total counter\n"
+       << "graphene_api_response_cache_evictions_total " << stats.evictions << "\n"
+       << "# HELP graphene_api_response_cache_entries Entries in the response cache\n"
+       << "# TYPE graphene_api_response_cache_entries gauge\n"
+       << "graphene_api_response_cache_entries " << stats.entries << "\n"
+       << "# HELP graphene_api_response_cache_bytes Approximate size of the entries in the response cache\n"
+       << "# TYPE graphene_api_response_cache_bytes gauge\n"
+       << "graphene_api_response_cache_bytes " << stats.used_bytes << "\n";
+   return out.str();
+}
+
+} } // graphene::app
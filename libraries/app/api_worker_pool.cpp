@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <graphene/app/api_worker_pool.hpp>
+
+#include <fc/exception/exception.hpp>
+#include <fc/log/logger.hpp>
+
+#include <algorithm>
+#include <limits>
+
+namespace graphene { namespace app {
+
+static const fc::microseconds lock_retry_interval( 100 );
+
+api_worker_pool::write_guard::write_guard( api_worker_pool& pool ) : _pool( pool )
+{
+   if( !_pool.is_enabled() )
+      return;
+   if( _pool._write_depth == 0 )
+   {
+      // The main thread also serves p2p and websocket I/O, so it must not block on the lock. New calls are held
+      // back while a writer waits, see call_scope, so the calls in flight drain and the lock becomes available.
+      ++_pool._writers_waiting;
+      try
+      {
+         // another task of the main thread can take the lock meanwhile, then this guard is nested in its one
+         while( _pool._write_depth == 0 && !_pool._chain_state_mutex.try_lock() )
+            fc::usleep( lock_retry_interval );
+      }
+      catch( ... )
+      {
+         --_pool._writers_waiting;
+         throw;
+      }
+      --_pool._writers_waiting;
+   }
+   ++_pool._write_depth;
+   _locked = true;
+}
+
+api_worker_pool::write_guard::~write_guard()
+{
+   if( !_locked )
+      return;
+   if( --_pool._write_depth == 0 )
+      _pool._chain_state_mutex.unlock();
+}
+
+api_worker_pool::read_guard::read_guard( api_worker_pool& pool, worker& w ) : _pool( pool ), _worker( w )
+{
+   // A call which waits for another thread, e.g. a query to elasticsearch, lets the worker start another call.
+   // That one must not take the lock again, it could block the worker while a writer is queued.
+   if( _worker.read_depth == 0 )
+      _pool._chain_state_mutex.lock_shared();
+   ++_worker.read_depth;
+}
+
+api_worker_pool::read_guard::~read_guard()
+{
+   if( --_worker.read_depth == 0 )
+      _pool._chain_state_mutex.unlock_shared();
+}
+
+api_worker_pool::call_scope::call_scope( api_worker_pool& pool, const std::string& api_name,
+                                         const std::string& method_name )
+   : _pool( pool ), _api( pool._apis[api_name] ), _method_key( api_name + "." + method_name ),
+     _start( fc::time_point::now() )
+{
+   // let a waiting writer go first, otherwise a steady stream of calls could keep it out forever
+   while( _pool._writers_waiting > 0 )
+      fc::usleep( lock_retry_interval );
+
+   if( _api.limit == 0 )
+   {
+      auto itr = _pool._api_limits.find( api_name );
+      _api.limit = ( itr != _pool._api_limits.end() ? itr->second : _pool._default_api_limit );
+   }
+
+   if( _api.running < _api.limit )
+      ++_api.running;
+   else
+   {
+      // the slot of a finishing call is handed over to us, see release_slot()
+      fc::promise<void>::ptr slot_available = fc::promise<void>::create( "api worker slot" );
+      _api.waiting.push_back( slot_available );
+      try
+      {
+         slot_available->wait();
+      }
+      catch( ... )
+      {
+         auto itr = std::find( _api.waiting.begin(), _api.waiting.end(), slot_available );
+         if( itr != _api.waiting.end() )
+            _api.waiting.erase( itr );
+         else
+            _pool.release_slot( _api );
+         throw;
+      }
+   }
+
+   _worker = std::min_element( _pool._workers.begin(), _pool._workers.end(),
+                               []( const std::unique_ptr<worker>& a, const std::unique_ptr<worker>& b ) {
+                                  return a->in_flight < b->in_flight;
+                               } )->get();
+   ++_worker->in_flight;
+}
+
+api_worker_pool::call_scope::~call_scope()
+{
+   --_worker->in_flight;
+   _pool.release_slot( _api );
+   _pool._methods[_method_key].record( ( fc::time_point::now() - _start ).count() );
+}
+
+void api_worker_pool::release_slot( api_state& api )
+{
+   if( api.waiting.empty() )
+   {
+      --api.running;
+      return;
+   }
+   fc::promise<void>::ptr next = api.waiting.front();
+   api.waiting.pop_front();
+   next->set_value();
+}
+
+api_worker_pool::api_worker_pool() {}
+
+api_worker_pool::~api_worker_pool()
+{
+   stop();
+}
+
+void api_worker_pool::start( uint32_t num_threads, uint32_t default_api_limit,
+                             const std::map< std::string, uint32_t >& api_limits )
+{
+   FC_ASSERT( !is_enabled(), "The API worker pool has already been started" );
+   _default_api_limit = ( default_api_limit > 0 ? default_api_limit : num_threads );
+   _api_limits = api_limits;
+   for( auto& limit : _api_limits )
+   {
+      if( limit.second == 0 )
+         limit.second = std::numeric_limits<uint32_t>::max();
+   }
+   _workers.reserve( num_threads );
+   for( uint32_t i = 0; i < num_threads; ++i )
+   {
+      _workers.emplace_back( new worker );
+      _workers.back()->thread = std::make_shared<fc::thread>( "api worker " + std::to_string( i ) );
+   }
+   if( num_threads > 0 )
+      ilog( "Started ${n} API worker threads", ("n",num_threads) );
+}
+
+void api_worker_pool::stop()
+{
+   for( auto& w : _workers )
+      w->thread->quit();
+   _workers.clear();
+}
+
+api_worker_pool_statistics api_worker_pool::get_statistics()const
+{
+   api_worker_pool_statistics result;
+   result.worker_threads = _workers.size();
+   result.latency_bucket_upper_bounds_us = api_latency_histogram::bucket_upper_bounds();
+   for( const auto& api : _apis )
+   {
+      api_concurrency_statistics& stats = result.apis[api.first];
+      stats.limit = ( api.second.limit == std::numeric_limits<uint32_t>::max() ? 0 : api.second.limit );
+      stats.running = api.second.running;
+      stats.waiting = api.second.waiting.size();
+   }
+   result.methods = _methods;
+   return result;
+}
+
+} } // graphene::app
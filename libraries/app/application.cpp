@@ -44,6 +44,7 @@
 #include <fc/rpc/api_connection.hpp>
 #include <fc/rpc/websocket_api.hpp>
 #include <fc/crypto/base64.hpp>
+#include <fc/string.hpp>
 
 #include <boost/filesystem/path.hpp>
 #include <boost/signals2.hpp>
@@ -121,6 +122,13 @@ void application_impl::reset_p2p_node(const fc::path& data_dir)
    _p2p_network->load_configuration(data_dir / "p2p");
    _p2p_network->set_node_delegate(this);
 
+   if( _options->count("p2p-max-trx-per-second-per-peer") )
+   {
+      fc::mutable_variant_object params;
+      params["maximum_transactions_per_second_per_peer"] = _options->at("p2p-max-trx-per-second-per-peer").as<uint32_t>();
+      _p2p_network->set_advanced_node_parameters( params );
+   }
+
    if( _options->count("seed-node") )
    {
       auto seeds = _options->at("seed-node").as<vector<string>>();
@@ -157,7 +165,9 @@ void application_impl::reset_p2p_node(const fc::path& data_dir)
 
 void application_impl::new_connection( const fc::http::websocket_connection_ptr& c )
 {
-   auto wsc = std::make_shared<fc::rpc::websocket_api_connection>(c, GRAPHENE_NET_MAX_NESTED_OBJECTS);
+   auto wsc = _api_call_accounting_enabled
+              ? create_accounting_websocket_api_connection( c, GRAPHENE_NET_MAX_NESTED_OBJECTS, _api_call_accounting )
+              : std::make_shared<fc::rpc::websocket_api_connection>(c, GRAPHENE_NET_MAX_NESTED_OBJECTS);
    auto login = std::make_shared<graphene::app::login_api>( std::ref(*_self) );
    login->enable_api("database_api");
 
@@ -184,7 +194,8 @@ void application_impl::new_connection( const fc::http::websocket_connection_ptr&
       password = parts[1];
    }
 
-   login->login(username, password);
+   if( login->login(username, password) && username != "*" )
+      record_api_connection_username( wsc, _api_call_accounting, username );
 }
 
 void application_impl::reset_websocket_server()
@@ -260,6 +271,10 @@ void application_impl::set_api_limit() {
    if(_options->count("api-limit-get-key-references")){
        _app_options.api_limit_get_key_references = _options->at("api-limit-get-key-references").as<uint64_t>();
    }
+   if(_options->count("api-limit-get-account-references")){
+       _app_options.api_limit_get_account_references =
+             _options->at("api-limit-get-account-references").as<uint64_t>();
+   }
    if(_options->count("api-limit-get-htlc-by")) {
       _app_options.api_limit_get_htlc_by = _options->at("api-limit-get-htlc-by").as<uint64_t>();
    }
@@ -269,6 +284,19 @@ void application_impl::set_api_limit() {
    if(_options->count("api-limit-get-full-accounts-lists")) {
       _app_options.api_limit_get_full_accounts_lists = _options->at("api-limit-get-full-accounts-lists").as<uint64_t>();
    }
+   if(_options->count("api-limit-get-full-accounts-batch")) {
+      _app_options.api_limit_get_full_accounts_batch = _options->at("api-limit-get-full-accounts-batch").as<uint64_t>();
+   }
+   if(_options->count("api-limit-get-full-accounts-batch-items")) {
+      _app_options.api_limit_get_full_accounts_batch_items =
+            _options->at("api-limit-get-full-accounts-batch-items").as<uint64_t>();
+   }
+   if(_options->count("api-limit-scan-objects")) {
+      _app_options.api_limit_scan_objects = _options->at("api-limit-scan-objects").as<uint64_t>();
+   }
+   if(_options->count("api-scan-cursor-lifetime")) {
+      _app_options.api_scan_cursor_lifetime = _options->at("api-scan-cursor-lifetime").as<uint32_t>();
+   }
    if(_options->count("api-limit-get-top-voters")) {
       _app_options.api_limit_get_top_voters = _options->at("api-limit-get-top-voters").as<uint64_t>();
    }
@@ -403,6 +431,21 @@ void application_impl::startup()
    }
    _chain_db->add_checkpoints( loaded_checkpoints );
 
+   if( _options->count("state-hash") && _options->at("state-hash").as<bool>() )
+   {
+      _chain_db->enable_state_hash( true );
+      if( _options->count("state-hash-checkpoint") )
+      {
+         flat_map<uint32_t,fc::sha256> state_hash_checkpoints;
+         for( const auto& cp : _options->at("state-hash-checkpoint").as<vector<string>>() )
+         {
+            auto item = fc::json::from_string(cp).as<std::pair<uint32_t,fc::sha256> >( 2 );
+            state_hash_checkpoints[item.first] = item.second;
+         }
+         _chain_db->add_state_hash_checkpoints( state_hash_checkpoints );
+      }
+   }
+
    if( _options->count("enable-standby-votes-tracking") )
    {
       _chain_db->enable_standby_votes_tracking( _options->at("enable-standby-votes-tracking").as<bool>() );
@@ -449,6 +492,62 @@ void application_impl::startup()
       _force_validate = true;
    }
 
+   graphene::chain::transaction_admission_parameters admission_params;
+   if( _options->count("mempool-max-transactions") )
+      admission_params.max_pending_transactions = _options->at("mempool-max-transactions").as<uint32_t>();
+   if( _options->count("mempool-priority-reserved") )
+      admission_params.priority_lane_reserved = _options->at("mempool-priority-reserved").as<uint32_t>();
+   if( _options->count("mempool-account-trx-per-second") )
+      admission_params.account_trx_per_second = _options->at("mempool-account-trx-per-second").as<uint32_t>();
+   if( _options->count("mempool-account-trx-burst") )
+      admission_params.account_trx_burst = _options->at("mempool-account-trx-burst").as<uint32_t>();
+   _chain_db->admission_controller().set_parameters( admission_params );
+
+   if( _options->count("rpc-worker-threads") && _options->at("rpc-worker-threads").as<uint32_t>() > 0 )
+   {
+      std::map< string, uint32_t > api_limits;
+      if( _options->count("rpc-worker-api-limit") )
+      {
+         for( const string& api_limit : _options->at("rpc-worker-api-limit").as<vector<string>>() )
+         {
+            const auto pos = api_limit.find( '=' );
+            FC_ASSERT( pos != string::npos && pos > 0 && pos + 1 < api_limit.size(),
+                       "Invalid rpc-worker-api-limit ${l}, expected API_NAME=LIMIT", ("l",api_limit) );
+            api_limits[ api_limit.substr( 0, pos ) ] = fc::to_uint64( api_limit.substr( pos + 1 ) );
+         }
+      }
+      _api_worker_pool.start( _options->at("rpc-worker-threads").as<uint32_t>(),
+                              _options->at("rpc-worker-api-concurrency").as<uint32_t>(),
+                              api_limits );
+   }
+
+   if( _options->count("api-call-accounting") )
+      _api_call_accounting_enabled = _options->at("api-call-accounting").as<bool>();
+   if( _options->count("api-slow-call-threshold-ms") )
+      _api_call_accounting.set_slow_call_threshold(
+            fc::milliseconds( _options->at("api-slow-call-threshold-ms").as<uint32_t>() ) );
+   if( _options->count("api-slow-call-log-size") )
+      _api_call_accounting.set_history_size( _options->at("api-slow-call-log-size").as<uint32_t>() );
+
+   if( _options->count("recent-transaction-cache-size") )
+      _chain_db->recent_transactions().set_capacity( _options->at("recent-transaction-cache-size").as<uint32_t>() );
+
+   if( _options->count("api-response-cache-size-mb") )
+      _api_response_cache.set_capacity( _options->at("api-response-cache-size-mb").as<uint64_t>() * 1024 * 1024 );
+   if( _api_response_cache.is_enabled() )
+   {
+      // Operation history objects are cached by database_api::get_objects, but they can be pruned
+      _api_response_cache_removed_connection = _chain_db->removed_objects.connect(
+            [this]( const vector<chain::object_id_type>& ids, const vector<const graphene::db::object*>&,
+                    const flat_set<chain::account_id_type>& ) {
+         for( const chain::object_id_type& id : ids )
+         {
+            if( id.is<chain::operation_history_id_type>() )
+               _api_response_cache.erase( "get_objects:" + std::string( id ) );
+         }
+      } );
+   }
+
    if ( _options->count("enable-subscribe-to-all") )
       _app_options.enable_subscribe_to_all = _options->at( "enable-subscribe-to-all" ).as<bool>();
 
@@ -566,6 +665,7 @@ bool application_impl::handle_block(const graphene::net::block_message& blk_msg,
          // you can help the network code out by throwing a block_older_than_undo_history exception.
          // when the net code sees that, it will stop trying to push blocks from that chain, but
          // leave that peer connected so that they can get sync blocks from us
+         api_worker_pool::write_guard guard( _api_worker_pool );
          return _chain_db->push_block( blk_msg.block, skip );
       });
 
@@ -618,6 +718,7 @@ void application_impl::handle_transaction(const graphene::net::trx_message& tran
    }
 
    _chain_db->precompute_parallel( transaction_message.trx ).wait();
+   api_worker_pool::write_guard guard( _api_worker_pool );
    _chain_db->push_transaction( transaction_message.trx );
 } FC_CAPTURE_AND_RETHROW( (transaction_message) ) }
 
@@ -961,6 +1062,7 @@ application::application()
 
 application::~application()
 {
+   my->_api_worker_pool.stop();
    if( my->_p2p_network )
    {
       my->_p2p_network->close();
@@ -1001,6 +1103,43 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("enable-standby-votes-tracking", bpo::value<bool>()->implicit_value(true),
           "Whether to enable tracking of votes of standby witnesses and committee members. "
           "Set it to true to provide accurate data to API clients, set to false for slightly better performance.")
+         ("state-hash", bpo::value<bool>()->implicit_value(true),
+          "Whether to maintain a hash of the whole chain state, which is logged after every maintenance interval. "
+          "Costs some performance, useful to compare the state of two nodes or replay modes.")
+         ("state-hash-checkpoint", bpo::value<vector<string>>()->composing(),
+          "Pairs of [BLOCK_NUM,STATE_HASH] of maintenance blocks, a different state hash is reported as error. "
+          "Requires state-hash.")
+         ("mempool-max-transactions", bpo::value<uint32_t>()->default_value(0),
+          "Maximum number of pending transactions, the ones paying the lowest fee per byte are evicted first. "
+          "0 means unlimited")
+         ("mempool-priority-reserved", bpo::value<uint32_t>()->default_value(0),
+          "Number of pending transaction slots reserved for transactions which only publish price feeds "
+          "or cancel limit orders")
+         ("mempool-account-trx-per-second", bpo::value<uint32_t>()->default_value(0),
+          "Maximum number of transactions per second accepted from one fee-paying account, 0 means unlimited")
+         ("mempool-account-trx-burst", bpo::value<uint32_t>()->default_value(0),
+          "Maximum number of transactions accepted at once from an idle fee-paying account")
+         ("p2p-max-trx-per-second-per-peer", bpo::value<uint32_t>(),
+          "Maximum number of transactions per second accepted from one p2p peer, 0 means unlimited")
+         ("rpc-worker-threads", bpo::value<uint32_t>()->default_value(0),
+          "Number of threads executing read-only database_api and history_api calls, "
+          "0 executes all API calls on the main thread")
+         ("rpc-worker-api-concurrency", bpo::value<uint32_t>()->default_value(0),
+          "Maximum number of calls of one API executed by the worker threads at the same time, "
+          "0 means the number of worker threads")
+         ("rpc-worker-api-limit", bpo::value<vector<string>>()->composing(),
+          "Concurrency limit for an individual API as API_NAME=LIMIT, e.g. history_api=2 (may specify multiple times)")
+         ("api-call-accounting", bpo::value<bool>()->implicit_value(true)->default_value(true),
+          "Whether to account the time and the bandwidth used by websocket API calls per method and per connection")
+         ("api-slow-call-threshold-ms", bpo::value<uint32_t>()->default_value(0),
+          "API calls taking longer than this are logged and kept in the slow call log of admin_api, 0 disables it")
+         ("api-slow-call-log-size", bpo::value<uint32_t>()->default_value(100),
+          "Number of slow API calls and of closed API connections kept for admin_api")
+         ("recent-transaction-cache-size", bpo::value<uint32_t>()->default_value(10000),
+          "Number of transactions recently pushed to this node kept in memory for peers and get_recent_transaction_by_id")
+         ("api-response-cache-size-mb", bpo::value<uint64_t>()->default_value(64),
+          "Size of the cache of API results derived from irreversible blocks, e.g. blocks and operation history, "
+          "0 disables it")
          ("api-limit-get-account-history-operations",boost::program_options::value<uint64_t>()->default_value(100),
           "For history_api::get_account_history_operations to set max limit value")
          ("api-limit-get-account-history",boost::program_options::value<uint64_t>()->default_value(100),
@@ -1015,12 +1154,24 @@ void application::set_program_options(boost::program_options::options_descriptio
           "For asset_api::get_asset_holders to set max limit value")
          ("api-limit-get-key-references",boost::program_options::value<uint64_t>()->default_value(100),
           "For database_api_impl::get_key_references to set max limit value")
+         ("api-limit-get-account-references",boost::program_options::value<uint64_t>()->default_value(1000),
+          "For database_api_impl::get_key_references and get_account_references to set max number of "
+          "referencing accounts returned per key or account")
          ("api-limit-get-htlc-by",boost::program_options::value<uint64_t>()->default_value(100),
           "For database_api_impl::get_htlc_by_from and get_htlc_by_to to set max limit value")
          ("api-limit-get-full-accounts",boost::program_options::value<uint64_t>()->default_value(50),
           "For database_api_impl::get_full_accounts to set max accounts to query at once")
          ("api-limit-get-full-accounts-lists",boost::program_options::value<uint64_t>()->default_value(500),
           "For database_api_impl::get_full_accounts to set max items to return in the lists")
+         ("api-limit-get-full-accounts-batch",boost::program_options::value<uint64_t>()->default_value(1000),
+          "For database_api_impl::get_full_accounts_batch to set max accounts to query at once")
+         ("api-limit-get-full-accounts-batch-items",boost::program_options::value<uint64_t>()->default_value(10000),
+          "For database_api_impl::get_full_accounts_batch to set max items to return in the lists of all accounts "
+          "together")
+         ("api-limit-scan-objects",boost::program_options::value<uint64_t>()->default_value(1000),
+          "For database_api_impl::scan_objects to set max limit value")
+         ("api-scan-cursor-lifetime",boost::program_options::value<uint32_t>()->default_value(600),
+          "Number of seconds a cursor returned by database_api_impl::scan_objects stays valid")
          ("api-limit-get-top-voters",boost::program_options::value<uint64_t>()->default_value(200),
           "For database_api_impl::get_top_voters to set max limit value")
          ("api-limit-get-call-orders",boost::program_options::value<uint64_t>()->default_value(300),
@@ -1130,6 +1281,21 @@ std::shared_ptr<chain::database> application::chain_database() const
    return my->_chain_db;
 }
 
+api_worker_pool& application::get_api_worker_pool()
+{
+   return my->_api_worker_pool;
+}
+
+api_call_accounting& application::get_api_call_accounting()
+{
+   return my->_api_call_accounting;
+}
+
+api_response_cache& application::get_api_response_cache()
+{
+   return my->_api_response_cache;
+}
+
 void application::set_block_production(bool producing_blocks)
 {
    my->_is_block_producer = producing_blocks;
@@ -1170,6 +1336,7 @@ void application::shutdown_plugins()
 }
 void application::shutdown()
 {
+   my->_api_worker_pool.stop();
    if( my->_p2p_network )
       my->_p2p_network->close();
    if( my->_chain_db )
@@ -187,6 +187,11 @@ class application_impl : public net::node_delegate
       api_access _apiaccess;
 
       std::shared_ptr<graphene::chain::database>            _chain_db;
+      api_worker_pool                                       _api_worker_pool;
+      api_call_accounting                                   _api_call_accounting;
+      api_response_cache                                    _api_response_cache;
+      boost::signals2::scoped_connection                    _api_response_cache_removed_connection;
+      bool                                                  _api_call_accounting_enabled = true;
       std::shared_ptr<graphene::net::node>                  _p2p_network;
       std::shared_ptr<fc::http::websocket_server>      _websocket_server;
       std::shared_ptr<fc::http::websocket_tls_server>  _websocket_tls_server;
@@ -24,13 +24,18 @@
 
 #include "database_api_impl.hxx"
 
+#include <graphene/app/api_call_accounting.hpp>
 #include <graphene/app/util.hpp>
 #include <graphene/chain/get_config.hpp>
 #include <graphene/chain/hardfork.hpp>
 #include <graphene/protocol/pts_address.hpp>
 #include <graphene/protocol/restriction_predicate.hpp>
 
+#include <fc/crypto/base64.hpp>
 #include <fc/crypto/hex.hpp>
+#include <fc/crypto/hmac.hpp>
+#include <fc/crypto/rand.hpp>
+#include <fc/io/json.hpp>
 #include <fc/rpc/api_connection.hpp>
 
 #include <boost/range/iterator_range.hpp>
@@ -47,13 +52,15 @@ namespace graphene { namespace app {
 //                                                                  //
 //////////////////////////////////////////////////////////////////////
 
-database_api::database_api( graphene::chain::database& db, const application_options* app_options )
-   : my( new database_api_impl( db, app_options ) ) {}
+database_api::database_api( graphene::chain::database& db, const application_options* app_options,
+                            api_worker_pool* worker_pool, api_response_cache* response_cache )
+   : my( new database_api_impl( db, app_options, worker_pool, response_cache ) ) {}
 
 database_api::~database_api() {}
 
-database_api_impl::database_api_impl( graphene::chain::database& db, const application_options* app_options )
-:_db(db), _app_options(app_options)
+database_api_impl::database_api_impl( graphene::chain::database& db, const application_options* app_options,
+                                      api_worker_pool* worker_pool, api_response_cache* response_cache )
+:_db(db), _app_options(app_options), _worker_pool(worker_pool), _response_cache(response_cache)
 {
    dlog("creating database api ${x}", ("x",int64_t(this)) );
    _new_connection = _db.new_objects.connect([this](const vector<object_id_type>& ids,
@@ -111,11 +118,24 @@ fc::variants database_api_impl::get_objects( const vector<object_id_type>& ids,
 
    std::transform(ids.begin(), ids.end(), std::back_inserter(result),
                   [this,to_subscribe](object_id_type id) -> fc::variant {
+      // Operation history objects are never modified, only removed, see application_impl::startup()
+      const bool is_history = id.is<operation_history_id_type>();
+      const std::string cache_key = ( is_history && _response_cache != nullptr ) ? "get_objects:" + std::string( id )
+                                                                                 : std::string();
+      if( !cache_key.empty() )
+      {
+         if( auto cached = _response_cache->find<fc::variant>( cache_key ) )
+            return *cached;
+      }
       if(auto obj = _db.find_object(id))
       {
-         if( to_subscribe && !id.is<operation_history_id_type>() && !id.is<account_transaction_history_id_type>() )
+         if( to_subscribe && !is_history && !id.is<account_transaction_history_id_type>() )
             this->subscribe_to_item( id );
-         return obj->to_variant();
+         fc::variant v = obj->to_variant();
+         if( !cache_key.empty()
+               && is_cacheable( static_cast<const operation_history_object*>( obj )->block_num ) )
+            _response_cache->insert( cache_key, v, api_call_accounting::estimate_json_size( v ) );
+         return v;
       }
       return {};
    });
@@ -210,10 +230,19 @@ optional<block_header> database_api::get_block_header(uint32_t block_num)const
 
 optional<block_header> database_api_impl::get_block_header(uint32_t block_num) const
 {
-   auto result = _db.fetch_block_by_number(block_num);
-   if(result)
-      return *result;
-   return {};
+   const std::string cache_key = "get_block_header:" + std::to_string( block_num );
+   if( is_cacheable( block_num ) )
+   {
+      if( auto cached = _response_cache->find<block_header>( cache_key ) )
+         return *cached;
+   }
+   auto result = get_block(block_num);
+   if( !result )
+      return {};
+   block_header header = *result;
+   if( is_cacheable( block_num ) )
+      _response_cache->insert( cache_key, header, fc::raw::pack_size( header ) );
+   return header;
 }
 map<uint32_t, optional<block_header>> database_api::get_block_header_batch(const vector<uint32_t> block_nums)const
 {
@@ -238,7 +267,16 @@ optional<signed_block> database_api::get_block(uint32_t block_num)const
 
 optional<signed_block> database_api_impl::get_block(uint32_t block_num)const
 {
-   return _db.fetch_block_by_number(block_num);
+   if( !is_cacheable( block_num ) )
+      return _db.fetch_block_by_number(block_num);
+
+   const std::string cache_key = "get_block:" + std::to_string( block_num );
+   if( auto cached = _response_cache->find<signed_block>( cache_key ) )
+      return *cached;
+   auto result = _db.fetch_block_by_number(block_num);
+   if( result )
+      _response_cache->insert( cache_key, *result, fc::raw::pack_size( *result ) );
+   return result;
 }
 
 processed_transaction database_api::get_transaction( uint32_t block_num, uint32_t trx_in_block )const
@@ -257,7 +295,7 @@ optional<signed_transaction> database_api::get_recent_transaction_by_id( const t
 
 processed_transaction database_api_impl::get_transaction(uint32_t block_num, uint32_t trx_num)const
 {
-   auto opt_block = _db.fetch_block_by_number(block_num);
+   auto opt_block = get_block(block_num);
    FC_ASSERT( opt_block );
    FC_ASSERT( opt_block->transactions.size() > trx_num );
    return opt_block->transactions[trx_num];
@@ -325,15 +363,19 @@ dynamic_global_property_object database_api_impl::get_dynamic_global_properties(
 //                                                                  //
 //////////////////////////////////////////////////////////////////////
 
-vector<flat_set<account_id_type>> database_api::get_key_references( vector<public_key_type> key )const
+vector<flat_set<account_id_type>> database_api::get_key_references( vector<public_key_type> key,
+                                                                   optional<uint32_t> limit,
+                                                                   optional<account_id_type> start_id )const
 {
-   return my->get_key_references( key );
+   return my->get_key_references( key, limit, start_id );
 }
 
 /**
  *  @return all accounts that referr to the key or account id in their owner or active authorities.
  */
-vector<flat_set<account_id_type>> database_api_impl::get_key_references( vector<public_key_type> keys )const
+vector<flat_set<account_id_type>> database_api_impl::get_key_references( vector<public_key_type> keys,
+                                                                        optional<uint32_t> olimit,
+                                                                        optional<account_id_type> ostart_id )const
 {
    // api_helper_indexes plugin is required for accessing the secondary index
    FC_ASSERT( _app_options && _app_options->has_api_helper_indexes_plugin,
@@ -344,6 +386,13 @@ vector<flat_set<account_id_type>> database_api_impl::get_key_references( vector<
               "Number of querying keys can not be greater than ${configured_limit}",
               ("configured_limit", configured_limit) );
 
+   const auto configured_accounts_limit = _app_options->api_limit_get_account_references;
+   const uint64_t limit = olimit.valid() ? *olimit : configured_accounts_limit;
+   FC_ASSERT( limit <= configured_accounts_limit,
+              "limit can not be greater than ${configured_limit}",
+              ("configured_limit", configured_accounts_limit) );
+   const account_id_type start_id = ostart_id.valid() ? *ostart_id : account_id_type();
+
    const auto& idx = _db.get_index_type<account_index>();
    const auto& aidx = dynamic_cast<const base_primary_index&>(idx);
    const auto& refs = aidx.get_secondary_index<graphene::chain::account_member_index>();
@@ -351,6 +400,10 @@ vector<flat_set<account_id_type>> database_api_impl::get_key_references( vector<
    vector< flat_set<account_id_type> > final_result;
    final_result.reserve(keys.size());
 
+   typedef flat_set<account_id_type>::const_iterator posting_iterator;
+   vector< std::pair<posting_iterator, posting_iterator> > cursors;
+   cursors.reserve(6);
+
    for( auto& key : keys )
    {
       address a1( pts_address(key, false, 56) );
@@ -359,26 +412,35 @@ vector<flat_set<account_id_type>> database_api_impl::get_key_references( vector<
       address a4( pts_address(key, true, 0)  );
       address a5( key );
 
-      flat_set<account_id_type> result;
-
+      // the posting lists are sorted, so merge them starting from the requested ID
+      cursors.clear();
       for( auto& a : {a1,a2,a3,a4,a5} )
       {
-          auto itr = refs.account_to_address_memberships.find(a);
-          if( itr != refs.account_to_address_memberships.end() )
-          {
-             result.reserve( result.size() + itr->second.size() );
-             for( auto item : itr->second )
-             {
-                result.insert(item);
-             }
-          }
+         auto itr = refs.account_to_address_memberships.find(a);
+         if( itr != refs.account_to_address_memberships.end() )
+            cursors.emplace_back( itr->second.lower_bound(start_id), itr->second.end() );
       }
-
       auto itr = refs.account_to_key_memberships.find(key);
       if( itr != refs.account_to_key_memberships.end() )
+         cursors.emplace_back( itr->second.lower_bound(start_id), itr->second.end() );
+
+      flat_set<account_id_type> result;
+      while( result.size() < limit )
       {
-         result.reserve( result.size() + itr->second.size() );
-         for( auto item : itr->second ) result.insert(item);
+         optional<account_id_type> next;
+         for( const auto& c : cursors )
+         {
+            if( c.first != c.second && ( !next.valid() || *c.first < *next ) )
+               next = *c.first;
+         }
+         if( !next.valid() )
+            break;
+         result.insert( result.end(), *next );
+         for( auto& c : cursors )
+         {
+            if( c.first != c.second && *c.first == *next )
+               ++c.first;
+         }
       }
       final_result.emplace_back( std::move(result) );
    }
@@ -458,12 +520,30 @@ vector<optional<account_object>> database_api_impl::get_accounts( const vector<s
 std::map<string,full_account> database_api::get_full_accounts( const vector<string>& names_or_ids,
                                                                optional<bool> subscribe )
 {
-   return my->get_full_accounts( names_or_ids, subscribe );
+   // subscribing changes the state of this connection, that has to happen on the main thread
+   if( my->get_whether_to_subscribe( subscribe ) )
+      return my->get_full_accounts( names_or_ids, subscribe );
+   auto impl = my;
+   return my->run_read_only( "get_full_accounts", [impl,&names_or_ids]() {
+      return impl->get_full_accounts( names_or_ids, false );
+   } );
+}
+
+std::map<string,full_account> database_api::get_full_accounts_batch( const vector<string>& names_or_ids,
+                                                                     const flat_set<string>& fields )const
+{
+   auto impl = my;
+   return my->run_read_only( "get_full_accounts_batch", [impl,&names_or_ids,&fields]() {
+      return impl->get_full_accounts_batch( names_or_ids, fields );
+   } );
 }
 
 vector<account_statistics_object> database_api::get_top_voters(uint32_t limit)const
 {
-   return my->get_top_voters( limit );
+   auto impl = my;
+   return my->run_read_only( "get_top_voters", [impl,limit]() {
+      return impl->get_top_voters( limit );
+   } );
 }
 
 std::map<std::string, full_account> database_api_impl::get_full_accounts( const vector<std::string>& names_or_ids,
@@ -645,6 +725,197 @@ std::map<std::string, full_account> database_api_impl::get_full_accounts( const
    return results;
 }
 
+namespace detail {
+
+   struct same_object
+   {
+      template<typename T>
+      const T& operator()( const T& o )const { return o; }
+   };
+
+   /**
+    * Append the objects of @p idx owned by each of the @p accounts to a list of the account.
+    * @p idx must be ordered by account first, it is walked once from the lowest to the highest queried account,
+    * seeking over the parts which belong to accounts that are not queried.
+    * Each list gets at most @p limit items, and all lists of the call together at most @p budget items.
+    */
+   template<typename Index, typename GetAccount, typename Project, typename Item>
+   void collect_by_account( const Index& idx, GetAccount get_account, Project project,
+                            std::map<account_id_type, full_account>& accounts,
+                            vector<Item> full_account::* list, bool more_data::* more, size_t limit,
+                            size_t& budget )
+   {
+      auto itr = idx.begin();
+      for( auto& entry : accounts )
+      {
+         const account_id_type id = entry.first;
+         if( itr != idx.end() && get_account( *itr ) < id )
+            itr = idx.lower_bound( id );
+         vector<Item>& items = entry.second.*list;
+         for( ; itr != idx.end() && get_account( *itr ) == id; ++itr )
+         {
+            if( items.size() >= limit || budget == 0 )
+            {
+               entry.second.more_data_available.*more = true;
+               break;
+            }
+            items.emplace_back( project( *itr ) );
+            --budget;
+         }
+      }
+   }
+
+} // detail
+
+std::map<std::string, full_account> database_api_impl::get_full_accounts_batch(
+      const vector<std::string>& names_or_ids, const flat_set<std::string>& fields )const
+{
+   FC_ASSERT( _app_options, "Internal error" );
+   const auto configured_limit = _app_options->api_limit_get_full_accounts_batch;
+   FC_ASSERT( names_or_ids.size() <= configured_limit,
+              "Number of querying accounts can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   static const flat_set<std::string> known_fields = {
+      "account", "statistics", "registrar_name", "referrer_name", "lifetime_referrer_name", "votes",
+      "cashback_balance", "balances", "vesting_balances", "limit_orders", "call_orders", "settle_orders",
+      "proposals", "assets", "withdraws_from", "withdraws_to", "htlcs_from", "htlcs_to" };
+   for( const auto& field : fields )
+      FC_ASSERT( known_fields.find( field ) != known_fields.end(), "Unknown field: ${f}", ("f",field) );
+   auto wanted = [&fields]( const std::string& field ) {
+      return fields.empty() || fields.find( field ) != fields.end();
+   };
+
+   // Sorted by ID, so that every index below can be walked once
+   std::map<account_id_type, full_account> accounts;
+   vector< std::pair<std::string, account_id_type> > found;
+   found.reserve( names_or_ids.size() );
+   for( const std::string& account_name_or_id : names_or_ids )
+   {
+      const account_object* account = get_account_from_string( account_name_or_id, false );
+      if( account == nullptr )
+         continue;
+      found.emplace_back( account_name_or_id, account->id );
+      accounts[account->id].account = *account;
+   }
+
+   const size_t list_limit = static_cast<size_t>( _app_options->api_limit_get_full_accounts_lists );
+   // the lists of all accounts together, a list which is cut short has its more_data_available flag set
+   size_t item_budget = static_cast<size_t>( _app_options->api_limit_get_full_accounts_batch_items );
+
+   const auto& balance_index = _db.get_index_type< primary_index< account_balance_index > >().
+         get_secondary_index< balances_by_account_index >();
+   const graphene::chain::required_approval_index* proposals_by_account = nullptr;
+   if( wanted( "proposals" ) && _app_options->has_api_helper_indexes_plugin )
+      proposals_by_account = &_db.get_index_type< primary_index< proposal_index > >().
+            get_secondary_index< graphene::chain::required_approval_index >();
+
+   for( auto& entry : accounts )
+   {
+      full_account& acnt = entry.second;
+      const account_object& account = acnt.account;
+      if( wanted( "statistics" ) )
+         acnt.statistics = account.statistics(_db);
+      if( wanted( "registrar_name" ) )
+         acnt.registrar_name = account.registrar(_db).name;
+      if( wanted( "referrer_name" ) )
+         acnt.referrer_name = account.referrer(_db).name;
+      if( wanted( "lifetime_referrer_name" ) )
+         acnt.lifetime_referrer_name = account.lifetime_referrer(_db).name;
+      if( wanted( "votes" ) )
+         acnt.votes = lookup_vote_ids( vector<vote_id_type>( account.options.votes.begin(),
+                                                             account.options.votes.end() ) );
+      if( wanted( "cashback_balance" ) && account.cashback_vb )
+         acnt.cashback_balance = account.cashback_balance(_db);
+
+      if( proposals_by_account != nullptr )
+      {
+         auto required_approvals_itr = proposals_by_account->_account_to_proposals.find( account.id );
+         if( required_approvals_itr != proposals_by_account->_account_to_proposals.end() )
+         {
+            acnt.proposals.reserve( std::min( required_approvals_itr->second.size(), list_limit ) );
+            for( auto proposal_id : required_approvals_itr->second )
+            {
+               if( acnt.proposals.size() >= list_limit || item_budget == 0 ) {
+                  acnt.more_data_available.proposals = true;
+                  break;
+               }
+               acnt.proposals.push_back( proposal_id(_db) );
+               --item_budget;
+            }
+         }
+      }
+
+      if( wanted( "balances" ) )
+      {
+         for( const auto& balance : balance_index.get_account_balances( account.id ) )
+         {
+            if( acnt.balances.size() >= list_limit || item_budget == 0 ) {
+               acnt.more_data_available.balances = true;
+               break;
+            }
+            acnt.balances.emplace_back( *balance.second );
+            --item_budget;
+         }
+      }
+   }
+
+   const detail::same_object same;
+   if( wanted( "vesting_balances" ) )
+      detail::collect_by_account( _db.get_index_type<vesting_balance_index>().indices().get<by_account>(),
+                                  []( const vesting_balance_object& o ) { return o.owner; }, same, accounts,
+                                  &full_account::vesting_balances, &more_data::vesting_balances, list_limit,
+                                  item_budget );
+   if( wanted( "limit_orders" ) )
+      detail::collect_by_account( _db.get_index_type<limit_order_index>().indices().get<by_account>(),
+                                  []( const limit_order_object& o ) { return o.seller; }, same, accounts,
+                                  &full_account::limit_orders, &more_data::limit_orders, list_limit,
+                                  item_budget );
+   if( wanted( "call_orders" ) )
+      detail::collect_by_account( _db.get_index_type<call_order_index>().indices().get<by_account>(),
+                                  []( const call_order_object& o ) { return o.borrower; }, same, accounts,
+                                  &full_account::call_orders, &more_data::call_orders, list_limit,
+                                  item_budget );
+   if( wanted( "settle_orders" ) )
+      detail::collect_by_account( _db.get_index_type<force_settlement_index>().indices().get<by_account>(),
+                                  []( const force_settlement_object& o ) { return o.owner; }, same, accounts,
+                                  &full_account::settle_orders, &more_data::settle_orders, list_limit,
+                                  item_budget );
+   if( wanted( "assets" ) )
+      detail::collect_by_account( _db.get_index_type<asset_index>().indices().get<by_issuer>(),
+                                  []( const asset_object& o ) { return o.issuer; },
+                                  []( const asset_object& o ) { return o.get_id(); }, accounts,
+                                  &full_account::assets, &more_data::assets, list_limit,
+                                  item_budget );
+   const auto& withdraw_indices = _db.get_index_type<withdraw_permission_index>().indices();
+   if( wanted( "withdraws_from" ) )
+      detail::collect_by_account( withdraw_indices.get<by_from>(),
+                                  []( const withdraw_permission_object& o ) { return o.withdraw_from_account; },
+                                  same, accounts,
+                                  &full_account::withdraws_from, &more_data::withdraws_from, list_limit,
+                                  item_budget );
+   if( wanted( "withdraws_to" ) )
+      detail::collect_by_account( withdraw_indices.get<by_authorized>(),
+                                  []( const withdraw_permission_object& o ) { return o.authorized_account; },
+                                  same, accounts,
+                                  &full_account::withdraws_to, &more_data::withdraws_to, list_limit,
+                                  item_budget );
+   const auto& htlc_indices = _db.get_index_type<htlc_index>().indices();
+   if( wanted( "htlcs_from" ) )
+      detail::collect_by_account( htlc_indices.get<by_from_id>(), htlc_object::from_extractor(), same, accounts,
+                                  &full_account::htlcs_from, &more_data::htlcs_from, list_limit,
+                                  item_budget );
+   if( wanted( "htlcs_to" ) )
+      detail::collect_by_account( htlc_indices.get<by_to_id>(), htlc_object::to_extractor(), same, accounts,
+                                  &full_account::htlcs_to, &more_data::htlcs_to, list_limit,
+                                  item_budget );
+
+   std::map<std::string, full_account> results;
+   for( const auto& item : found )
+      results[item.first] = accounts[item.second];
+   return results;
+}
+
 vector<account_statistics_object> database_api_impl::get_top_voters(uint32_t limit)const
 {
    FC_ASSERT( _app_options, "Internal error" );
@@ -680,17 +951,28 @@ optional<account_object> database_api_impl::get_account_by_name( string name )co
    return optional<account_object>();
 }
 
-vector<account_id_type> database_api::get_account_references( const std::string account_id_or_name )const
+vector<account_id_type> database_api::get_account_references( const std::string account_id_or_name,
+                                                              optional<uint32_t> limit,
+                                                              optional<account_id_type> start_id )const
 {
-   return my->get_account_references( account_id_or_name );
+   return my->get_account_references( account_id_or_name, limit, start_id );
 }
 
-vector<account_id_type> database_api_impl::get_account_references( const std::string account_id_or_name )const
+vector<account_id_type> database_api_impl::get_account_references( const std::string account_id_or_name,
+                                                                   optional<uint32_t> olimit,
+                                                                   optional<account_id_type> ostart_id )const
 {
    // api_helper_indexes plugin is required for accessing the secondary index
    FC_ASSERT( _app_options && _app_options->has_api_helper_indexes_plugin,
               "api_helper_indexes plugin is not enabled on this server." );
 
+   const auto configured_limit = _app_options->api_limit_get_account_references;
+   const uint64_t limit = olimit.valid() ? *olimit : configured_limit;
+   FC_ASSERT( limit <= configured_limit,
+              "limit can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+   const account_id_type start_id = ostart_id.valid() ? *ostart_id : account_id_type();
+
    const auto& idx = _db.get_index_type<account_index>();
    const auto& aidx = dynamic_cast<const base_primary_index&>(idx);
    const auto& refs = aidx.get_secondary_index<graphene::chain::account_member_index>();
@@ -700,8 +982,10 @@ vector<account_id_type> database_api_impl::get_account_references( const std::st
 
    if( itr != refs.account_to_account_memberships.end() )
    {
-      result.reserve( itr->second.size() );
-      for( auto item : itr->second ) result.push_back(item);
+      auto start = itr->second.lower_bound( start_id );
+      const size_t count = std::min<uint64_t>( limit, itr->second.end() - start );
+      result.reserve( count );
+      result.insert( result.end(), start, start + count );
    }
    return result;
 }
@@ -921,7 +1205,10 @@ vector<optional<extended_asset_object>> database_api_impl::get_assets(
 
 vector<extended_asset_object> database_api::list_assets(const string& lower_bound_symbol, uint32_t limit)const
 {
-   return my->list_assets( lower_bound_symbol, limit );
+   auto impl = my;
+   return my->run_read_only( "list_assets", [impl,&lower_bound_symbol,limit]() {
+      return impl->list_assets( lower_bound_symbol, limit );
+   } );
 }
 
 vector<extended_asset_object> database_api_impl::list_assets(const string& lower_bound_symbol, uint32_t limit)const
@@ -1434,7 +1721,10 @@ market_volume database_api_impl::get_24_volume( const string& base, const string
 
 order_book database_api::get_order_book( const string& base, const string& quote, unsigned limit )const
 {
-   return my->get_order_book( base, quote, limit);
+   auto impl = my;
+   return my->run_read_only( "get_order_book", [impl,&base,&quote,limit]() {
+      return impl->get_order_book( base, quote, limit );
+   } );
 }
 
 order_book database_api_impl::get_order_book( const string& base, const string& quote, unsigned limit )const
@@ -1871,6 +2161,71 @@ vector<optional<liquidity_pool_object>> database_api_impl::get_liquidity_pools_b
    return result;
 }
 
+vector<liquidity_pool_ticker> database_api::get_liquidity_pool_tickers_by_volume(
+            std::string asset_symbol_or_id,
+            optional<uint32_t> limit,
+            optional<liquidity_pool_id_type> start_id )const
+{
+   return my->get_liquidity_pool_tickers_by_volume( asset_symbol_or_id, limit, start_id );
+}
+
+vector<liquidity_pool_ticker> database_api_impl::get_liquidity_pool_tickers_by_volume(
+            std::string asset_symbol_or_id,
+            optional<uint32_t> olimit,
+            optional<liquidity_pool_id_type> ostart_id )const
+{
+   FC_ASSERT( _app_options && _app_options->has_market_history_plugin, "Market history plugin is not enabled." );
+
+   uint32_t limit = olimit.valid() ? *olimit : 101;
+
+   const auto configured_limit = _app_options->api_limit_get_liquidity_pools;
+   FC_ASSERT( limit <= configured_limit,
+              "limit can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+
+   const asset_id_type asset_id = get_asset_from_string( asset_symbol_or_id )->id;
+
+   // Volumes of different assets can not be compared, so the pools holding the asset as asset A and the ones
+   // holding it as asset B are merged, each ordered by descending volume of the asset
+   const auto& ticker_idx = _db.get_index_type<liquidity_pool_ticker_index>().indices();
+   const auto& idx_a = ticker_idx.get<by_volume_a>();
+   const auto& idx_b = ticker_idx.get<by_volume_b>();
+   auto itr_a = idx_a.lower_bound( asset_id );
+   auto itr_b = idx_b.lower_bound( asset_id );
+   const auto end_a = idx_a.upper_bound( asset_id );
+   const auto end_b = idx_b.upper_bound( asset_id );
+   if( ostart_id.valid() )
+   {
+      const auto& pool_idx = ticker_idx.get<by_pool>();
+      auto start_itr = pool_idx.find( *ostart_id );
+      FC_ASSERT( start_itr != pool_idx.end(), "No statistics of liquidity pool ${p}", ("p", *ostart_id) );
+      FC_ASSERT( start_itr->asset_a == asset_id || start_itr->asset_b == asset_id,
+                 "Liquidity pool ${p} does not hold asset ${a}", ("p", *ostart_id)("a", asset_symbol_or_id) );
+      const fc::uint128_t start_volume = ( start_itr->asset_a == asset_id ) ? start_itr->_24h_volume_a
+                                                                            : start_itr->_24h_volume_b;
+      itr_a = idx_a.lower_bound( std::make_tuple( asset_id, start_volume, *ostart_id ) );
+      itr_b = idx_b.lower_bound( std::make_tuple( asset_id, start_volume, *ostart_id ) );
+   }
+
+   vector<liquidity_pool_ticker> results;
+   results.reserve( limit );
+   const fc::time_point_sec now = _db.head_block_time();
+   while( results.size() < limit && ( itr_a != end_a || itr_b != end_b ) )
+   {
+      const bool take_a = ( itr_b == end_b )
+                          || ( itr_a != end_a
+                               && ( itr_a->_24h_volume_a > itr_b->_24h_volume_b
+                                    || ( itr_a->_24h_volume_a == itr_b->_24h_volume_b
+                                         && itr_a->pool < itr_b->pool ) ) );
+      if( take_a )
+         results.emplace_back( *(itr_a++), now );
+      else
+         results.emplace_back( *(itr_b++), now );
+   }
+
+   return results;
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Witnesses                                                        //
@@ -2373,6 +2728,12 @@ processed_transaction database_api::validate_transaction( const signed_transacti
 
 processed_transaction database_api_impl::validate_transaction( const signed_transaction& trx )const
 {
+   // applies the transaction to the chain state and undoes it afterwards, workers must not read meanwhile
+   if( _worker_pool )
+   {
+      api_worker_pool::write_guard guard( *_worker_pool );
+      return _db.validate_transaction(trx);
+   }
    return _db.validate_transaction(trx);
 }
 
@@ -2461,6 +2822,43 @@ vector< fc::variant > database_api_impl::get_required_fees( const vector<operati
    return result;
 }
 
+vector< asset > database_api::get_operation_fees( const vector<operation>& ops )const
+{
+   return my->get_operation_fees( ops );
+}
+
+struct fee_asset_visitor
+{
+   typedef asset_id_type result_type;
+   template<typename OpType>
+   asset_id_type operator()( const OpType& op )const { return op.fee.asset_id; }
+};
+
+vector< asset > database_api_impl::get_operation_fees( const vector<operation>& ops )const
+{
+   // group the operations by fee asset, so that every group is handled in one batch
+   std::map< asset_id_type, vector<size_t> > positions;
+   for( size_t i = 0; i < ops.size(); ++i )
+      positions[ ops[i].visit( fee_asset_visitor() ) ].push_back( i );
+
+   vector< asset > result( ops.size() );
+   const fee_schedule& current_fee_schedule = _db.current_fee_schedule();
+   for( const auto& group : positions )
+   {
+      const asset_object* a = _db.find( group.first );
+      FC_ASSERT( a != nullptr, "Asset ${a} does not exist", ("a",group.first) );
+      // we copy the ops because we need to mutate an operation to reliably determine its fee, see #435
+      vector< operation > group_ops;
+      group_ops.reserve( group.second.size() );
+      for( size_t i : group.second )
+         group_ops.push_back( ops[i] );
+      const vector< asset > fees = current_fee_schedule.set_fees( group_ops, a->options.core_exchange_rate );
+      for( size_t j = 0; j < fees.size(); ++j )
+         result[ group.second[j] ] = fees[j];
+   }
+   return result;
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Proposed transactions                                            //
@@ -2701,6 +3099,218 @@ vector<htlc_object> database_api_impl::list_htlcs(const htlc_id_type start, uint
    return result;
 }
 
+//////////////////////////////////////////////////////////////////////
+//                                                                  //
+// Scans                                                            //
+//                                                                  //
+//////////////////////////////////////////////////////////////////////
+
+scan_page database_api::scan_objects( const string& collection,
+                                      const vector<string>& scope,
+                                      const optional<string>& cursor,
+                                      const optional<uint32_t>& limit )const
+{
+   auto impl = my;
+   return my->run_read_only( "scan_objects", [impl,&collection,&scope,&cursor,&limit]() {
+      return impl->scan_objects( collection, scope, cursor, limit );
+   } );
+}
+
+namespace detail {
+
+   /// A key which is generated once per process, so that nobody else can issue or alter scan cursors
+   const fc::sha256& scan_cursor_secret()
+   {
+      static const fc::sha256 secret = []() {
+         fc::sha256 key;
+         fc::rand_bytes( key.data(), key.data_size() );
+         return key;
+      }();
+      return secret;
+   }
+
+   fc::sha256 scan_cursor_signature( const string& payload )
+   {
+      fc::hmac<fc::sha256> mac;
+      const fc::sha256& key = scan_cursor_secret();
+      return mac.digest( key.data(), key.data_size(), payload.data(), payload.size() );
+   }
+
+   struct always_in_scan_range
+   {
+      template<typename T>
+      bool operator()( const T& )const { return true; }
+   };
+
+   /**
+    * Append the objects from @p itr on to @p objects while they are in range, up to @p limit objects.
+    * @return the sort key of the last appended object if there are more objects, otherwise null
+    */
+   template<typename Iterator, typename InRange, typename KeyOf>
+   optional<fc::variant> fill_scan_page( Iterator itr, const Iterator& end, InRange in_range, KeyOf key_of,
+                                         uint64_t limit, vector<variant>& objects )
+   {
+      for( ; itr != end && in_range( *itr ); ++itr )
+      {
+         if( objects.size() >= limit )
+            return key_of( *std::prev( itr ) );
+         objects.emplace_back( *itr, GRAPHENE_MAX_NESTED_OBJECTS );
+      }
+      return optional<fc::variant>();
+   }
+
+} // detail
+
+scan_page database_api_impl::scan_objects( const string& collection,
+                                           const vector<string>& scope,
+                                           const optional<string>& ocursor,
+                                           const optional<uint32_t>& olimit )const
+{
+   FC_ASSERT( _app_options, "Internal error" );
+   const auto configured_limit = _app_options->api_limit_scan_objects;
+   const uint64_t limit = olimit.valid() ? *olimit : configured_limit;
+   FC_ASSERT( limit <= configured_limit,
+              "limit can not be greater than ${configured_limit}",
+              ("configured_limit", configured_limit) );
+   FC_ASSERT( limit > 0, "limit must be positive" );
+
+   const fc::time_point_sec now( fc::time_point::now() );
+
+   scan_cursor cursor;
+   const bool resume = ocursor.valid();
+   if( resume )
+   {
+      // the cursor is the encoded position, followed by its signature
+      bool valid = false;
+      const size_t separator = ocursor->rfind( '.' );
+      if( separator != string::npos )
+      {
+         try
+         {
+            const string payload = fc::base64_decode( ocursor->substr( 0, separator ) );
+            if( fc::sha256( ocursor->substr( separator + 1 ) ) == detail::scan_cursor_signature( payload ) )
+            {
+               cursor = fc::json::from_string( payload ).as<scan_cursor>( GRAPHENE_MAX_NESTED_OBJECTS );
+               valid = true;
+            }
+         }
+         catch( const fc::exception& )
+         {
+         }
+      }
+      FC_ASSERT( valid, "Invalid cursor" );
+      FC_ASSERT( cursor.collection == collection && cursor.scope == scope,
+                 "The cursor does not belong to this scan" );
+      FC_ASSERT( cursor.expiration >= now, "The cursor has expired" );
+   }
+   else
+   {
+      cursor.collection = collection;
+      cursor.scope = scope;
+      cursor.start_block_num = _db.head_block_num();
+   }
+
+   scan_page page;
+   page.start_block_num = cursor.start_block_num;
+   page.head_block_num = _db.head_block_num();
+   page.head_block_id = _db.head_block_id();
+
+   optional<fc::variant> last_key;
+   if( collection == "accounts" )
+   {
+      FC_ASSERT( scope.empty(), "Scope must be empty" );
+      const auto& idx = _db.get_index_type<account_index>().indices().get<by_name>();
+      auto itr = resume ? idx.upper_bound( cursor.last_key.as_string() ) : idx.begin();
+      last_key = detail::fill_scan_page( itr, idx.end(), detail::always_in_scan_range(),
+                                         []( const account_object& o ) { return fc::variant( o.name ); },
+                                         limit, page.objects );
+   }
+   else if( collection == "assets" )
+   {
+      FC_ASSERT( scope.empty(), "Scope must be empty" );
+      const auto& idx = _db.get_index_type<asset_index>().indices().get<by_symbol>();
+      auto itr = resume ? idx.upper_bound( cursor.last_key.as_string() ) : idx.begin();
+      last_key = detail::fill_scan_page( itr, idx.end(), detail::always_in_scan_range(),
+                                         []( const asset_object& o ) { return fc::variant( o.symbol ); },
+                                         limit, page.objects );
+   }
+   else if( collection == "htlcs" )
+   {
+      FC_ASSERT( scope.empty(), "Scope must be empty" );
+      const auto& idx = _db.get_index_type<htlc_index>().indices().get<by_id>();
+      auto itr = resume ? idx.upper_bound( cursor.last_key.as<object_id_type>( 1 ) ) : idx.begin();
+      last_key = detail::fill_scan_page( itr, idx.end(), detail::always_in_scan_range(),
+                                         []( const htlc_object& o ) { return fc::variant( o.id, 1 ); },
+                                         limit, page.objects );
+   }
+   else if( collection == "call_orders" )
+   {
+      FC_ASSERT( scope.size() == 1, "Scope must be the market-issued asset" );
+      const asset_object* mia = get_asset_from_string( scope.front() );
+      FC_ASSERT( mia->is_market_issued(), "${s} is not a market-issued asset", ("s",scope.front()) );
+      const auto& idx = _db.get_index_type<call_order_index>().indices().get<by_collateral>();
+      const price index_price = price::min( mia->bitasset_data(_db).options.short_backing_asset, mia->get_id() );
+      auto itr = idx.lower_bound( index_price );
+      if( resume )
+      {
+         const fc::variants& key = cursor.last_key.get_array();
+         FC_ASSERT( key.size() == 2, "Invalid cursor" );
+         itr = idx.upper_bound( std::make_tuple( key[0].as<price>( GRAPHENE_MAX_NESTED_OBJECTS ),
+                                                 key[1].as<object_id_type>( 1 ) ) );
+      }
+      last_key = detail::fill_scan_page( itr, idx.upper_bound( index_price.max() ),
+                                         detail::always_in_scan_range(),
+                                         []( const call_order_object& o ) {
+                                            return fc::variant( fc::variants{
+                                                  fc::variant( price( o.get_collateral(), o.get_debt() ),
+                                                               GRAPHENE_MAX_NESTED_OBJECTS ),
+                                                  fc::variant( o.id, 1 ) } );
+                                         },
+                                         limit, page.objects );
+   }
+   else if( collection == "trades" )
+   {
+      FC_ASSERT( _app_options->has_market_history_plugin, "Market history plugin is not enabled." );
+      FC_ASSERT( scope.size() == 2, "Scope must be the two assets of the market" );
+      auto assets = lookup_asset_symbols( scope );
+      FC_ASSERT( assets[0], "Invalid base asset symbol: ${s}", ("s",scope[0]) );
+      FC_ASSERT( assets[1], "Invalid quote asset symbol: ${s}", ("s",scope[1]) );
+      auto base_id = assets[0]->id;
+      auto quote_id = assets[1]->id;
+      if( base_id > quote_id ) std::swap( base_id, quote_id );
+
+      const auto& idx = _db.get_index_type<market_history::history_index>().indices().get<by_market_time>();
+      auto itr = idx.lower_bound( std::make_tuple( base_id, quote_id ) );
+      if( resume )
+      {
+         const fc::variants& key = cursor.last_key.get_array();
+         FC_ASSERT( key.size() == 2, "Invalid cursor" );
+         itr = idx.upper_bound( std::make_tuple( base_id, quote_id, key[0].as<fc::time_point_sec>( 1 ),
+                                                 key[1].as<int64_t>( 1 ) ) );
+      }
+      last_key = detail::fill_scan_page( itr, idx.end(),
+                                         [base_id,quote_id]( const market_history::order_history_object& o ) {
+                                            return o.key.base == base_id && o.key.quote == quote_id;
+                                         },
+                                         []( const market_history::order_history_object& o ) {
+                                            return fc::variant( fc::variants{ fc::variant( o.time, 1 ),
+                                                                              fc::variant( o.key.sequence ) } );
+                                         },
+                                         limit, page.objects );
+   }
+   else
+      FC_ASSERT( false, "Unknown collection: ${c}", ("c",collection) );
+
+   if( last_key.valid() )
+   {
+      cursor.last_key = *last_key;
+      cursor.expiration = now + _app_options->api_scan_cursor_lifetime;
+      const string payload = fc::json::to_string( fc::variant( cursor, GRAPHENE_MAX_NESTED_OBJECTS ) );
+      page.next_cursor = fc::base64_encode( payload ) + "." + detail::scan_cursor_signature( payload ).str();
+   }
+   return page;
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Private methods                                                  //
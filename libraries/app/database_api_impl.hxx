@@ -23,6 +23,8 @@
  */
 
 #include <graphene/app/database_api.hpp>
+#include <graphene/app/api_response_cache.hpp>
+#include <graphene/app/api_worker_pool.hpp>
 
 #include <fc/bloom_filter.hpp>
 
@@ -33,10 +35,23 @@ namespace graphene { namespace app {
 typedef std::map< std::pair<graphene::chain::asset_id_type, graphene::chain::asset_id_type>,
                   std::vector<fc::variant> > market_queue_type;
 
+/// The position of a scan, handed to the client as an opaque token
+struct scan_cursor
+{
+   string             collection;
+   vector<string>     scope;
+   /// Sort key of the last returned object
+   fc::variant        last_key;
+   uint32_t           start_block_num = 0;
+   fc::time_point_sec expiration;
+};
+
 class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 {
    public:
-      explicit database_api_impl( graphene::chain::database& db, const application_options* app_options );
+      explicit database_api_impl( graphene::chain::database& db, const application_options* app_options,
+                                  api_worker_pool* worker_pool = nullptr,
+                                  api_response_cache* response_cache = nullptr );
       virtual ~database_api_impl();
 
       // Objects
@@ -63,7 +78,9 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       dynamic_global_property_object get_dynamic_global_properties()const;
 
       // Keys
-      vector<flat_set<account_id_type>> get_key_references( vector<public_key_type> key )const;
+      vector<flat_set<account_id_type>> get_key_references( vector<public_key_type> key,
+                                                            optional<uint32_t> limit,
+                                                            optional<account_id_type> start_id )const;
       bool is_public_key_registered(string public_key) const;
 
       // Accounts
@@ -72,9 +89,13 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
                                                      optional<bool> subscribe )const;
       std::map<string,full_account> get_full_accounts( const vector<string>& names_or_ids,
                                                        optional<bool> subscribe );
+      std::map<string,full_account> get_full_accounts_batch( const vector<string>& names_or_ids,
+                                                             const flat_set<string>& fields )const;
       vector<account_statistics_object> get_top_voters(uint32_t limit)const;
       optional<account_object> get_account_by_name( string name )const;
-      vector<account_id_type> get_account_references( const std::string account_id_or_name )const;
+      vector<account_id_type> get_account_references( const std::string account_id_or_name,
+                                                      optional<uint32_t> limit,
+                                                      optional<account_id_type> start_id )const;
       vector<optional<account_object>> lookup_account_names(const vector<string>& account_names)const;
       map<string,account_id_type> lookup_accounts( const string& lower_bound_name,
                                                    uint32_t limit,
@@ -155,6 +176,10 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<optional<liquidity_pool_object>> get_liquidity_pools_by_share_asset(
             const vector<std::string>& asset_symbols_or_ids,
             optional<bool> subscribe = optional<bool>() )const;
+      vector<liquidity_pool_ticker> get_liquidity_pool_tickers_by_volume(
+            std::string asset_symbol_or_id,
+            optional<uint32_t> limit = 101,
+            optional<liquidity_pool_id_type> start_id = optional<liquidity_pool_id_type>() )const;
 
       // Witnesses
       vector<optional<witness_object>> get_witnesses(const vector<witness_id_type>& witness_ids)const;
@@ -193,6 +218,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       processed_transaction validate_transaction( const signed_transaction& trx )const;
       vector< fc::variant > get_required_fees( const vector<operation>& ops,
                                                const std::string& asset_id_or_symbol )const;
+      vector< asset > get_operation_fees( const vector<operation>& ops )const;
 
       // Proposed transactions
       vector<proposal_object> get_proposed_transactions( const std::string account_id_or_name )const;
@@ -216,6 +242,12 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
                                           htlc_id_type start, uint32_t limit) const;
       vector<htlc_object> list_htlcs(const htlc_id_type lower_bound_id, uint32_t limit) const;
 
+      // Scans
+      scan_page scan_objects( const string& collection,
+                              const vector<string>& scope,
+                              const optional<string>& cursor,
+                              const optional<uint32_t>& limit )const;
+
    //private:
 
       ////////////////////////////////////////////////
@@ -300,6 +332,31 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       // Subscription
       ////////////////////////////////////////////////
 
+      ////////////////////////////////////////////////
+      // Worker threads
+      ////////////////////////////////////////////////
+
+      // Executes a read-only call on the API worker pool if there is one.
+      // The call must not subscribe to anything, subscriptions are not thread safe.
+      template<typename Functor>
+      auto run_read_only( const std::string& method_name, Functor&& call )const -> decltype( call() )
+      {
+         if( _worker_pool == nullptr )
+            return call();
+         return _worker_pool->run_read_only( "database_api", method_name, std::forward<Functor>( call ) );
+      }
+
+      ////////////////////////////////////////////////
+      // Response cache
+      ////////////////////////////////////////////////
+
+      // Whether results derived from the given block can be cached
+      bool is_cacheable( uint32_t block_num )const
+      {
+         return _response_cache != nullptr && _response_cache->is_enabled()
+                && block_num <= _db.get_dynamic_global_properties().last_irreversible_block_num;
+      }
+
       // Decides whether to subscribe using member variables and given parameter
       bool get_whether_to_subscribe( optional<bool> subscribe )const
       {
@@ -420,8 +477,12 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 
       graphene::chain::database& _db;
       const application_options* _app_options = nullptr;
+      api_worker_pool* _worker_pool = nullptr;
+      api_response_cache* _response_cache = nullptr;
 
       const graphene::api_helper_indexes::amount_in_collateral_index* amount_in_collateral_index;
 };
 
 } } // graphene::app
+
+FC_REFLECT( graphene::app::scan_cursor, (collection)(scope)(last_key)(start_block_num)(expiration) )
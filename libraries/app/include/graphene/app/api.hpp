@@ -102,10 +102,10 @@ namespace graphene { namespace app {
     */
    struct limit_order_group
    {
-      limit_order_group( const std::pair<limit_order_group_key,limit_order_group_data>& p )
-         :  min_price( p.first.min_price ),
-            max_price( p.second.max_price ),
-            total_for_sale( p.second.total_for_sale )
+      limit_order_group( const limit_order_group_entry& e )
+         :  min_price( e.key.min_price ),
+            max_price( e.data.max_price ),
+            total_for_sale( e.data.total_for_sale )
             {}
       limit_order_group() {}
 
@@ -205,7 +205,8 @@ namespace graphene { namespace app {
           * @param a Asset symbol or ID in a trading pair
           * @param b The other asset symbol or ID in the trading pair
           * @param bucket_seconds Length of each time bucket in seconds.
-          * Note: it need to be within result of get_market_history_buckets() API, otherwise no data will be returned
+          * Note: it need to be a multiple of the greatest common divisor of the result of
+          * get_market_history_buckets() API, otherwise no data will be returned
           * @param start The start of a time range, E.G. "2018-01-01T00:00:00"
           * @param end The end of the time range
           * @return A list of OHLCV data, in "least recent first" order.
@@ -352,6 +353,55 @@ namespace graphene { namespace app {
           */
          std::vector<net::potential_peer_record> get_potential_peers() const;
 
+         /**
+          * @brief Get the depth of the pending transaction pool and the admission control counters
+          */
+         graphene::chain::transaction_admission_statistics get_mempool_statistics() const;
+
+         /**
+          * @brief Get the load and the latency histograms of the API calls executed by the RPC worker threads
+          */
+         api_worker_pool_statistics get_api_worker_statistics() const;
+
+      private:
+         application& _app;
+   };
+
+   /**
+    * @brief The admin_api class exposes the accounting of the API calls served by this node.
+    */
+   class admin_api
+   {
+      public:
+         admin_api(application& a);
+
+         /**
+          * @brief Get the latency histogram, the call count and the bandwidth of every API method, and the totals
+          *        of the open and the most recently closed API connections
+          */
+         api_call_statistics get_api_call_statistics() const;
+
+         /**
+          * @brief Get the most recent API calls which took longer than the configured slow call threshold,
+          *        newest first
+          */
+         vector<api_slow_call> get_slow_api_calls() const;
+
+         /**
+          * @brief Get the API call statistics in the Prometheus text exposition format
+          */
+         string get_prometheus_metrics() const;
+
+         /**
+          * @brief Reset the API call statistics and the slow call log
+          */
+         void reset_api_call_statistics();
+
+         /**
+          * @brief Get the size and the hit and miss counters of the cache of immutable API results
+          */
+         api_response_cache_statistics get_api_response_cache_statistics() const;
+
       private:
          application& _app;
    };
@@ -516,7 +566,31 @@ namespace graphene { namespace app {
                                                                optional<price> start,
                                                                uint32_t limit )const;
 
+         /**
+          * @brief Get grouped limit orders in given market for several group widths at once.
+          *
+          * @param base_asset ID or symbol of asset being sold
+          * @param quote_asset ID or symbol of asset being purchased
+          * @param groups Maximum price diffs within each order group, each has to be one of configured values
+          * @param start Optional price to indicate the first order group to retrieve for every group width
+          * @param limit Maximum number of order groups to retrieve per group width (must not exceed 101)
+          * @return The grouped limit orders of every requested group width, each ordered from best offered price
+          *         to worst
+          */
+         map< uint16_t, vector< limit_order_group > > get_grouped_limit_orders_by_groups( std::string base_asset,
+                                                                                         std::string quote_asset,
+                                                                                         flat_set<uint16_t> groups,
+                                                                                         optional<price> start,
+                                                                                         uint32_t limit )const;
+
       private:
+         vector< limit_order_group > collect_limit_order_groups( grouped_orders_plugin& plugin,
+                                                                 asset_id_type base_asset_id,
+                                                                 asset_id_type quote_asset_id,
+                                                                 uint16_t group,
+                                                                 const optional<price>& start,
+                                                                 uint32_t limit )const;
+
          application& _app;
          graphene::app::database_api database_api;
    };
@@ -550,6 +624,7 @@ namespace graphene { namespace app {
 extern template class fc::api<graphene::app::block_api>;
 extern template class fc::api<graphene::app::network_broadcast_api>;
 extern template class fc::api<graphene::app::network_node_api>;
+extern template class fc::api<graphene::app::admin_api>;
 extern template class fc::api<graphene::app::history_api>;
 extern template class fc::api<graphene::app::crypto_api>;
 extern template class fc::api<graphene::app::asset_api>;
@@ -599,6 +674,8 @@ namespace graphene { namespace app {
          fc::api<graphene::debug_witness::debug_api> debug()const;
          /// @brief Retrieve the custom operations API
          fc::api<custom_operations_api> custom_operations()const;
+         /// @brief Retrieve the admin API
+         fc::api<admin_api> admin()const;
 
          /// @brief Called to enable an API, not reflected.
          void enable_api( const string& api_name );
@@ -615,6 +692,7 @@ namespace graphene { namespace app {
          optional< fc::api<orders_api> > _orders_api;
          optional< fc::api<graphene::debug_witness::debug_api> > _debug_api;
          optional< fc::api<custom_operations_api> > _custom_operations_api;
+         optional< fc::api<admin_api> > _admin_api;
    };
 
 }}  // graphene::app
@@ -662,6 +740,15 @@ FC_API(graphene::app::network_node_api,
        (get_potential_peers)
        (get_advanced_node_parameters)
        (set_advanced_node_parameters)
+       (get_mempool_statistics)
+       (get_api_worker_statistics)
+     )
+FC_API(graphene::app::admin_api,
+       (get_api_call_statistics)
+       (get_slow_api_calls)
+       (get_prometheus_metrics)
+       (reset_api_call_statistics)
+       (get_api_response_cache_statistics)
      )
 FC_API(graphene::app::crypto_api,
        (blind)
@@ -680,6 +767,7 @@ FC_API(graphene::app::asset_api,
 FC_API(graphene::app::orders_api,
        (get_tracked_groups)
        (get_grouped_limit_orders)
+       (get_grouped_limit_orders_by_groups)
      )
 FC_API(graphene::app::custom_operations_api,
        (get_storage_info)
@@ -696,4 +784,5 @@ FC_API(graphene::app::login_api,
        (orders)
        (debug)
        (custom_operations)
+       (admin)
      )
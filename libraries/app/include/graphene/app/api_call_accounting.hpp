@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+#include <fc/variant.hpp>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fc {
+   namespace http { class websocket_connection; }
+   namespace rpc { class websocket_api_connection; }
+}
+
+namespace graphene { namespace app {
+
+   /// Latency distribution of the calls of one API method
+   struct api_latency_histogram
+   {
+      /// upper bounds of the buckets in microseconds, the last bucket counts all slower calls
+      static const std::vector<uint64_t>& bucket_upper_bounds();
+
+      /// number of calls per bucket
+      std::vector<uint64_t> counts;
+      uint64_t              total_calls = 0;
+      uint64_t              total_microseconds = 0;
+      uint64_t              max_microseconds = 0;
+
+      void record( uint64_t microseconds );
+   };
+
+   struct api_method_statistics
+   {
+      api_latency_histogram latency;
+      uint64_t              total_request_bytes = 0;
+      uint64_t              total_response_bytes = 0;
+      uint64_t              failed_calls = 0;
+   };
+
+   struct api_connection_statistics
+   {
+      uint64_t           connection_id = 0;
+      std::string        remote_endpoint;
+      std::string        username;
+      fc::time_point_sec connected_since;
+      uint64_t           calls = 0;
+      uint64_t           failed_calls = 0;
+      uint64_t           total_microseconds = 0;
+      uint64_t           total_request_bytes = 0;
+      uint64_t           total_response_bytes = 0;
+   };
+
+   struct api_slow_call
+   {
+      fc::time_point_sec time;
+      uint64_t           connection_id = 0;
+      std::string        remote_endpoint;
+      std::string        method;
+      uint64_t           request_bytes = 0;
+      uint64_t           response_bytes = 0;
+      uint64_t           microseconds = 0;
+      bool               failed = false;
+   };
+
+   struct api_call_statistics
+   {
+      std::vector<uint64_t>                           latency_bucket_upper_bounds_us;
+      /// keyed by "api_name.method_name"
+      std::map< std::string, api_method_statistics >  methods;
+      /// open connections
+      std::vector< api_connection_statistics >        connections;
+      /// the most recently closed connections, newest first
+      std::vector< api_connection_statistics >        closed_connections;
+   };
+
+   /**
+    * @brief Accounts for the time and the bandwidth used by every API call received over websocket connections
+    *
+    * Request and response sizes are estimates of the size of their JSON encoding. Calls taking longer than the
+    * slow call threshold are logged and kept in a bounded list.
+    *
+    * All methods must be called from the thread which dispatches API calls.
+    */
+   class api_call_accounting
+   {
+   public:
+      /// @param threshold calls which take longer are recorded as slow calls, 0 disables the slow call log
+      void set_slow_call_threshold( const fc::microseconds& threshold ) { _slow_call_threshold = threshold; }
+      /// @param size number of slow calls and of closed connections to keep
+      void set_history_size( uint32_t size );
+
+      uint64_t open_connection( const std::string& remote_endpoint );
+      void set_connection_username( uint64_t connection_id, const std::string& username );
+      void close_connection( uint64_t connection_id );
+
+      void record_call( uint64_t connection_id, const std::string& method, uint64_t request_bytes,
+                        uint64_t response_bytes, const fc::microseconds& duration, bool failed );
+
+      api_call_statistics get_statistics()const;
+      /// @return the slow calls, newest first
+      std::vector< api_slow_call > get_slow_calls()const;
+      /// @return all counters in the Prometheus text exposition format
+      std::string get_prometheus_metrics()const;
+      /// forget all method statistics, connection totals and slow calls; open connections stay tracked
+      void reset();
+
+      /// @return an estimate of the size of the JSON encoding of @p v, without encoding it
+      static uint64_t estimate_json_size( const fc::variant& v );
+
+   private:
+      std::map< std::string, api_method_statistics >     _methods;
+      std::map< uint64_t, api_connection_statistics >    _connections;
+      std::deque< api_connection_statistics >            _closed_connections;
+      std::deque< api_slow_call >                        _slow_calls;
+      fc::microseconds                                   _slow_call_threshold;
+      uint32_t                                           _history_size = 100;
+      uint64_t                                           _next_connection_id = 1;
+   };
+
+   /**
+    * Create a websocket API connection which reports every call it dispatches, including calls of APIs obtained
+    * through the login API, to @p accounting.
+    */
+   std::shared_ptr<fc::rpc::websocket_api_connection> create_accounting_websocket_api_connection(
+         const std::shared_ptr<fc::http::websocket_connection>& connection, uint32_t max_conversion_depth,
+         api_call_accounting& accounting );
+
+   /// Record the user logged in on a connection created by @ref create_accounting_websocket_api_connection
+   void record_api_connection_username( const std::shared_ptr<fc::rpc::websocket_api_connection>& connection,
+                                        api_call_accounting& accounting, const std::string& username );
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::api_latency_histogram, (counts)(total_calls)(total_microseconds)(max_microseconds) )
+FC_REFLECT( graphene::app::api_method_statistics,
+            (latency)(total_request_bytes)(total_response_bytes)(failed_calls) )
+FC_REFLECT( graphene::app::api_connection_statistics,
+            (connection_id)(remote_endpoint)(username)(connected_since)
+            (calls)(failed_calls)(total_microseconds)(total_request_bytes)(total_response_bytes) )
+FC_REFLECT( graphene::app::api_slow_call,
+            (time)(connection_id)(remote_endpoint)(method)(request_bytes)(response_bytes)(microseconds)(failed) )
+FC_REFLECT( graphene::app::api_call_statistics,
+            (latency_bucket_upper_bounds_us)(methods)(connections)(closed_connections) )
@@ -121,6 +121,29 @@ namespace graphene { namespace app {
                     const asset_object& asset_quote);
    };
 
+   /// Statistics of a liquidity pool in the last 24 hours, measured in whole hours
+   struct liquidity_pool_ticker
+   {
+      liquidity_pool_id_type     pool;
+      time_point_sec             time;
+      uint32_t                   exchange_count = 0;
+      uint32_t                   deposit_count = 0;
+      uint32_t                   withdrawal_count = 0;
+      fc::uint128_t              volume_a;
+      fc::uint128_t              volume_b;
+      fc::uint128_t              fee_a;
+      fc::uint128_t              fee_b;
+      /// exchange prices, the base asset is asset A
+      optional<price>            open;
+      optional<price>            high;
+      optional<price>            low;
+      optional<price>            close;
+      uint64_t                   total_exchange_count = 0;
+
+      liquidity_pool_ticker() {}
+      liquidity_pool_ticker( const liquidity_pool_ticker_object& lpto, const fc::time_point_sec& now );
+   };
+
    struct market_volume
    {
       time_point_sec             time;
@@ -142,6 +165,23 @@ namespace graphene { namespace app {
       account_id_type            side2_account_id = GRAPHENE_NULL_ACCOUNT;
    };
 
+   /**
+    * @brief A page of objects returned by @ref database_api::scan_objects
+    *
+    * The head block fields tell the client whether the chain state has changed while it was scanning.
+    */
+   struct scan_page
+   {
+      vector<variant>            objects;
+      /// Pass this to the next call to read the next page, not set if there are no more objects
+      optional<string>           next_cursor;
+      /// Head block number when the first page of the scan was read
+      uint32_t                   start_block_num = 0;
+      /// Head block when this page was read
+      uint32_t                   head_block_num = 0;
+      block_id_type              head_block_id;
+   };
+
    struct extended_asset_object : asset_object
    {
       extended_asset_object() {}
@@ -186,10 +226,16 @@ FC_REFLECT( graphene::app::order_book, (base)(quote)(bids)(asks) );
 FC_REFLECT( graphene::app::market_ticker,
             (time)(base)(quote)(latest)(lowest_ask)(lowest_ask_base_size)(lowest_ask_quote_size)
             (highest_bid)(highest_bid_base_size)(highest_bid_quote_size)(percent_change)(base_volume)(quote_volume)(mto_id) );
+FC_REFLECT( graphene::app::liquidity_pool_ticker,
+            (pool)(time)(exchange_count)(deposit_count)(withdrawal_count)
+            (volume_a)(volume_b)(fee_a)(fee_b)(open)(high)(low)(close)(total_exchange_count) );
 FC_REFLECT( graphene::app::market_volume, (time)(base)(quote)(base_volume)(quote_volume) );
 FC_REFLECT( graphene::app::market_trade, (sequence)(date)(price)(amount)(value)(type)
             (side1_account_id)(side2_account_id));
 
+FC_REFLECT( graphene::app::scan_page,
+            (objects)(next_cursor)(start_block_num)(head_block_num)(head_block_id) );
+
 FC_REFLECT_DERIVED( graphene::app::extended_asset_object, (graphene::chain::asset_object),
                     (total_in_collateral)(total_backing_collateral) );
 
@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <fc/reflect/reflect.hpp>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace graphene { namespace app {
+
+   struct api_response_cache_statistics
+   {
+      uint64_t capacity_bytes = 0;
+      uint64_t used_bytes = 0;
+      uint64_t entries = 0;
+      uint64_t hits = 0;
+      uint64_t misses = 0;
+      uint64_t insertions = 0;
+      uint64_t evictions = 0;
+   };
+
+   /**
+    * @brief A size-bounded LRU cache of API results which can not change any more
+    *
+    * Only results which are derived from irreversible blocks must be stored, e.g. blocks, block headers and
+    * operation history objects at or below the last irreversible block. Entries are keyed by the API method and its
+    * arguments and hold the ready-made result, so a hit skips reading the block database and, for results which
+    * are variants, converting the object again.
+    *
+    * The cache is shared by all API connections and is thread safe.
+    */
+   class api_response_cache
+   {
+   public:
+      /// @param capacity_bytes approximate upper bound of the size of all entries, 0 disables the cache
+      void set_capacity( uint64_t capacity_bytes );
+      bool is_enabled()const { return _capacity_bytes > 0; }
+
+      /// @return the cached result of type @p T stored under @p key, or nullptr
+      template<typename T>
+      std::shared_ptr<const T> find( const std::string& key )
+      {
+         return std::static_pointer_cast<const T>( find_erased( key ) );
+      }
+
+      /// Store a result of approximately @p bytes bytes under @p key, evicting the least recently used entries
+      template<typename T>
+      void insert( const std::string& key, T value, uint64_t bytes )
+      {
+         if( is_enabled() )
+            insert_erased( key, std::make_shared<const T>( std::move( value ) ), bytes );
+      }
+
+      /// Drop the entry stored under @p key, if any
+      void erase( const std::string& key );
+
+      /// Drop all entries
+      void clear();
+
+      api_response_cache_statistics get_statistics()const;
+      /// @return the statistics in the Prometheus text exposition format
+      std::string get_prometheus_metrics()const;
+
+   private:
+      struct entry
+      {
+         std::string                 key;
+         std::shared_ptr<const void> value;
+         uint64_t                    bytes = 0;
+      };
+      typedef std::list<entry> lru_list;
+
+      std::shared_ptr<const void> find_erased( const std::string& key );
+      void insert_erased( const std::string& key, std::shared_ptr<const void> value, uint64_t bytes );
+      void erase_entry( lru_list::iterator itr );
+
+      mutable std::mutex                                       _mutex;
+      uint64_t                                                 _capacity_bytes = 0;
+      /// most recently used first
+      lru_list                                                 _entries;
+      std::unordered_map< std::string, lru_list::iterator >    _index;
+      api_response_cache_statistics                            _stats;
+   };
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::api_response_cache_statistics,
+            (capacity_bytes)(used_bytes)(entries)(hits)(misses)(insertions)(evictions) )
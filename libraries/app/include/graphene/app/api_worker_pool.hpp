@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/app/api_call_accounting.hpp>
+
+#include <fc/reflect/reflect.hpp>
+#include <fc/thread/future.hpp>
+#include <fc/thread/thread.hpp>
+#include <fc/time.hpp>
+
+#include <boost/thread/shared_mutex.hpp>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace graphene { namespace app {
+
+   struct api_concurrency_statistics
+   {
+      uint32_t limit = 0;    ///< maximum number of calls executed at the same time, 0 means unlimited
+      uint32_t running = 0;
+      uint32_t waiting = 0;
+   };
+
+   struct api_worker_pool_statistics
+   {
+      uint32_t                                          worker_threads = 0;
+      /// see @ref api_latency_histogram::bucket_upper_bounds
+      std::vector<uint64_t>                             latency_bucket_upper_bounds_us;
+      std::map< std::string, api_concurrency_statistics > apis;
+      /// keyed by "api_name.method_name"
+      std::map< std::string, api_latency_histogram >    methods;
+   };
+
+   /**
+    * @brief Executes read-only API calls on a pool of worker threads
+    *
+    * API calls are dispatched on the thread which also applies blocks, so a slow call delays block processing.
+    * Calls wrapped in @ref run_read_only are instead executed by a worker thread, while the calling task waits and
+    * lets the main thread continue with other work.
+    *
+    * Workers read the chain database concurrently with the main thread, so every code path which modifies the
+    * database has to hold a @ref write_guard, including paths which apply changes only to undo them, like
+    * validating a transaction. Objects reached by calls in the pool must not fill caches through const access,
+    * unless the cache is thread safe like the fee table of a fee schedule. Workers hold a read lock for the duration of a call, thus a call
+    * always sees the state between two blocks or transactions, never a partially applied one. All writers run on
+    * the main thread, so write guards are reentrant, also across tasks of the main thread. A write guard waits
+    * for the lock by yielding to other tasks, it never blocks the main thread.
+    *
+    * Calls which modify state, e.g. broadcasting transactions or subscribing to objects, must not be executed by
+    * the pool.
+    */
+   class api_worker_pool
+   {
+      struct worker;
+
+   public:
+      class write_guard
+      {
+      public:
+         explicit write_guard( api_worker_pool& pool );
+         ~write_guard();
+         write_guard( const write_guard& ) = delete;
+         write_guard& operator=( const write_guard& ) = delete;
+      private:
+         api_worker_pool& _pool;
+         bool             _locked = false;
+      };
+
+      api_worker_pool();
+      ~api_worker_pool();
+
+      /**
+       * Start the worker threads.
+       * @param num_threads number of worker threads, 0 leaves the pool disabled
+       * @param default_api_limit maximum number of concurrent calls of any one API, 0 means @p num_threads
+       * @param api_limits limits for individual APIs which override @p default_api_limit
+       */
+      void start( uint32_t num_threads, uint32_t default_api_limit,
+                  const std::map< std::string, uint32_t >& api_limits = std::map< std::string, uint32_t >() );
+      void stop();
+
+      bool is_enabled()const { return !_workers.empty(); }
+
+      /**
+       * Execute a read-only call on a worker thread and wait for its result. If the API already has as many calls
+       * in flight as its limit allows, wait for one of them to finish first. If the pool is disabled, the call is
+       * executed directly.
+       *
+       * This must be called from the thread which modifies the database.
+       */
+      template<typename Functor>
+      auto run_read_only( const std::string& api_name, const std::string& method_name, Functor&& call )
+         -> decltype( call() )
+      {
+         if( !is_enabled() )
+            return call();
+         call_scope scope( *this, api_name, method_name );
+         worker& w = scope.get_worker();
+         return w.thread->async( [this,&w,&call]() {
+            read_guard guard( *this, w );
+            return call();
+         }, "api worker call" ).wait();
+      }
+
+      api_worker_pool_statistics get_statistics()const;
+
+   private:
+      struct worker
+      {
+         std::shared_ptr<fc::thread> thread;
+         uint32_t                    in_flight = 0;  ///< only accessed by the dispatching thread
+         uint32_t                    read_depth = 0; ///< only accessed by the worker thread
+      };
+
+      struct api_state
+      {
+         uint32_t                                limit = 0;
+         uint32_t                                running = 0;
+         std::deque< fc::promise<void>::ptr >    waiting;
+      };
+
+      /// Holds a concurrency slot of an API and a worker while a call is in flight, and records its latency
+      class call_scope
+      {
+      public:
+         call_scope( api_worker_pool& pool, const std::string& api_name, const std::string& method_name );
+         ~call_scope();
+         worker& get_worker()const { return *_worker; }
+      private:
+         api_worker_pool& _pool;
+         api_state&       _api;
+         std::string      _method_key;
+         worker*          _worker = nullptr;
+         fc::time_point   _start;
+      };
+
+      /// Holds the read lock on a worker thread; a worker can start another call while one is waiting on I/O
+      class read_guard
+      {
+      public:
+         read_guard( api_worker_pool& pool, worker& w );
+         ~read_guard();
+      private:
+         api_worker_pool& _pool;
+         worker&          _worker;
+      };
+
+      void release_slot( api_state& api );
+
+      std::vector< std::unique_ptr<worker> >         _workers;
+      uint32_t                                       _default_api_limit = 0;
+      std::map< std::string, uint32_t >              _api_limits;
+      std::map< std::string, api_state >             _apis;
+      std::map< std::string, api_latency_histogram > _methods;
+
+      boost::shared_mutex                            _chain_state_mutex;
+      uint32_t                                       _write_depth = 0; ///< only accessed by the main thread
+      uint32_t                                       _writers_waiting = 0; ///< only accessed by the main thread
+   };
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::api_concurrency_statistics, (limit)(running)(waiting) )
+FC_REFLECT( graphene::app::api_worker_pool_statistics,
+            (worker_threads)(latency_bucket_upper_bounds_us)(apis)(methods) )
@@ -24,6 +24,9 @@
 #pragma once
 
 #include <graphene/app/api_access.hpp>
+#include <graphene/app/api_call_accounting.hpp>
+#include <graphene/app/api_response_cache.hpp>
+#include <graphene/app/api_worker_pool.hpp>
 #include <graphene/net/node.hpp>
 #include <graphene/chain/database.hpp>
 
@@ -50,9 +53,14 @@ namespace graphene { namespace app {
          uint64_t api_limit_get_account_history_by_operations = 100;
          uint64_t api_limit_get_asset_holders = 100;
          uint64_t api_limit_get_key_references = 100;
+         uint64_t api_limit_get_account_references = 1000;
          uint64_t api_limit_get_htlc_by = 100;
          uint64_t api_limit_get_full_accounts = 50;
          uint64_t api_limit_get_full_accounts_lists = 500;
+         uint64_t api_limit_get_full_accounts_batch = 1000;
+         uint64_t api_limit_get_full_accounts_batch_items = 10000;
+         uint64_t api_limit_scan_objects = 1000;
+         uint32_t api_scan_cursor_lifetime = 600;
          uint64_t api_limit_get_top_voters = 200;
          uint64_t api_limit_get_call_orders = 300;
          uint64_t api_limit_get_settle_orders = 300;
@@ -130,6 +138,12 @@ namespace graphene { namespace app {
 
          net::node_ptr                    p2p_node();
          std::shared_ptr<chain::database> chain_database()const;
+         /// Executes read-only API calls off the main thread; code modifying the database must hold its write guard
+         api_worker_pool& get_api_worker_pool();
+         /// Per method and per connection statistics of the API calls received over websocket connections
+         api_call_accounting& get_api_call_accounting();
+         /// Cache of API results derived from irreversible blocks, shared by all API connections
+         api_response_cache& get_api_response_cache();
          void set_api_limit();
          void set_block_production(bool producing_blocks);
          fc::optional< api_access_info > get_api_access_info( const string& username )const;
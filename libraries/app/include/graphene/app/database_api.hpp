@@ -59,6 +59,8 @@ using std::vector;
 using std::map;
 
 class database_api_impl;
+class api_worker_pool;
+class api_response_cache;
 
 /**
  * @brief The database_api class implements the RPC API for the chain database.
@@ -70,7 +72,12 @@ class database_api_impl;
 class database_api
 {
    public:
-      database_api(graphene::chain::database& db, const application_options* app_options = nullptr );
+      /**
+       * @param worker_pool if given, some expensive read-only calls are executed by its worker threads
+       * @param response_cache if given, results derived from irreversible blocks are served from and stored in it
+       */
+      database_api( graphene::chain::database& db, const application_options* app_options = nullptr,
+                    api_worker_pool* worker_pool = nullptr, api_response_cache* response_cache = nullptr );
       ~database_api();
 
       /////////////
@@ -185,6 +192,11 @@ class database_api
        * it will return NULL if it is not known.  Just because it is not known does not mean it wasn't
        * included in the blockchain.
        *
+       * Only transactions which have been pushed to this node, e.g. broadcast through it or relayed by a peer
+       * before they were included in a block, are found, and only while they are among the most recent ones as
+       * configured by recent-transaction-cache-size. Transactions which this node only received as part of a
+       * block are not found, use @ref get_transaction with the block number and position instead.
+       *
        * @param txid hash of the transaction
        * @return the corresponding transaction if found, or null if not found
        */
@@ -227,9 +239,17 @@ class database_api
        * @brief Get all accounts that refer to the specified public keys in their owner authority, active authorities
        *        or memo key
        * @param keys a list of public keys to query
-       * @return ID of all accounts that refer to the specified keys
+       * @param limit maximum number of accounts to return per key, not greater than a configured value
+       * @param start_id only return accounts whose IDs are greater than or equal to this ID
+       * @return ID of accounts that refer to the specified keys, in ascending order
+       *
+       * @note
+       * 1. @p limit can be omitted or be null, if so the configured maximum value will be used
+       * 2. to fetch the next page of a key, query it with @p start_id set to the successor of the last returned ID
        */
-      vector<flat_set<account_id_type>> get_key_references( vector<public_key_type> keys )const;
+      vector<flat_set<account_id_type>> get_key_references( vector<public_key_type> keys,
+            optional<uint32_t> limit = optional<uint32_t>(),
+            optional<account_id_type> start_id = optional<account_id_type>() )const;
 
       /**
        * Determine whether a textual representation of a public key
@@ -281,6 +301,24 @@ class database_api
       std::map<string,full_account> get_full_accounts( const vector<string>& names_or_ids,
                                                        optional<bool> subscribe = optional<bool>() );
 
+      /**
+       * @brief Fetch selected parts of the full account objects of many accounts at once
+       * @param names_or_ids Each item must be the name or ID of an account to retrieve
+       * @param fields Names of the @ref full_account fields to fill, e.g. @a balances or @a limit_orders,
+       *               the @a account field is always filled, an empty set means all fields
+       * @return Map of string from @p names_or_ids to the corresponding account
+       *
+       * Unlike @ref get_full_accounts, this function accepts a much larger number of accounts and does not
+       * subscribe to them. The lists are collected by walking each index once for all the queried accounts, so
+       * large clients can fetch the state of many accounts by splitting them into a few batches. Fields which are
+       * not requested are left empty. Inputs which cannot be tied to an account are ignored.
+       *
+       * Besides the limit per list, the number of list items of all accounts together is limited. A list which is
+       * cut short has its flag in @a more_data_available set.
+       */
+      std::map<string,full_account> get_full_accounts_batch( const vector<string>& names_or_ids,
+                                                             const flat_set<string>& fields )const;
+
       /**
        * @brief Returns vector of voting power sorted by reverse vp_active
        * @param limit Max number of results
@@ -298,9 +336,18 @@ class database_api
       /**
        * @brief Get all accounts that refer to the specified account in their owner or active authorities
        * @param account_name_or_id Account name or ID to query
-       * @return all accounts that refer to the specified account in their owner or active authorities
+       * @param limit maximum number of accounts to return, not greater than a configured value
+       * @param start_id only return accounts whose IDs are greater than or equal to this ID
+       * @return accounts that refer to the specified account in their owner or active authorities,
+       *         in ascending order
+       *
+       * @note
+       * 1. @p limit can be omitted or be null, if so the configured maximum value will be used
+       * 2. to fetch the next page, query with @p start_id set to the successor of the last returned ID
        */
-      vector<account_id_type> get_account_references( const std::string account_name_or_id )const;
+      vector<account_id_type> get_account_references( const std::string account_name_or_id,
+            optional<uint32_t> limit = optional<uint32_t>(),
+            optional<account_id_type> start_id = optional<account_id_type>() )const;
 
       /**
        * @brief Get a list of accounts by name
@@ -703,6 +750,26 @@ class database_api
             const vector<std::string>& asset_symbols_or_ids,
             optional<bool> subscribe = optional<bool>() )const;
 
+      /**
+       * @brief Get statistics of the liquidity pools of an asset with the highest volume in the last 24 hours
+       * @param asset_symbol_or_id symbol name or ID of the asset, which can be asset A or asset B of the pools
+       * @param limit  The limitation of items each query can fetch, not greater than a configured value
+       * @param start_id  Start liquidity pool id, fetch the pool with this ID and the pools with lower volumes
+       * @return The statistics of the liquidity pools, ordered by descending volume of the given asset, then by ID
+       *
+       * @note
+       * 1. the market history plugin is required
+       * 2. if @p asset_symbol_or_id cannot be tied to an asset, an error will be returned
+       * 3. @p limit can be omitted or be null, if so the default value 101 will be used
+       * 4. @p start_id can be omitted or be null, if so the api will return the "first page" of pools,
+       *    otherwise it must be a pool of the given asset
+       * 5. can only omit one or more arguments in the end of the list, but not one or more in the middle
+       */
+      vector<liquidity_pool_ticker> get_liquidity_pool_tickers_by_volume(
+            std::string asset_symbol_or_id,
+            optional<uint32_t> limit = 101,
+            optional<liquidity_pool_id_type> start_id = optional<liquidity_pool_id_type>() )const;
+
       ///////////////
       // Witnesses //
       ///////////////
@@ -895,6 +962,18 @@ class database_api
       vector< fc::variant > get_required_fees( const vector<operation>& ops,
                                                const std::string& asset_symbol_or_id )const;
 
+      /**
+       * @brief For each operation calculate the required fee in the asset of its fee field
+       * @param ops a list of operations to be query for required fees, the asset ID of the @a fee field of each
+       *            operation specifies the asset to be used to pay its fee
+       * @return the required fee of each operation, in the same order as @p ops
+       *
+       * All fees are calculated in one pass with the same fee schedule. Unlike @ref get_required_fees,
+       * the fees of operations nested in a proposal are not calculated, the result for a proposal is the fee of the
+       * proposal_create_operation itself.
+       */
+      vector< asset > get_operation_fees( const vector<operation>& ops )const;
+
       ///////////////////////////
       // Proposed transactions //
       ///////////////////////////
@@ -990,6 +1069,37 @@ class database_api
       */
       vector<htlc_object> list_htlcs(const htlc_id_type start, uint32_t limit) const;
 
+      ///////////
+      // Scans //
+      ///////////
+
+      /**
+       * @brief Read all objects of a collection page by page
+       * @param collection the collection to scan, one of
+       *        - @a accounts: all accounts, ordered by name
+       *        - @a assets: all assets, ordered by symbol
+       *        - @a htlcs: all HTLCs, ordered by ID
+       *        - @a call_orders: call orders of the asset in @p scope, ordered by collateral ratio
+       *        - @a trades: filled orders of the market in @p scope, latest first, requires the market_history
+       *          plugin
+       * @param scope an empty list, the symbol or ID of a market-issued asset for @a call_orders, or the symbols or
+       *        IDs of the two assets of a market for @a trades
+       * @param cursor @a null to start a scan, or the @a next_cursor of the previous page to continue it
+       * @param limit maximum number of objects to return, not greater than a configured value
+       * @return a page of objects
+       *
+       * @note
+       * 1. @p limit can be omitted or be null, if so the configured maximum value will be used
+       * 2. a cursor holds the position of the scan in the index, it stays valid for a limited time only; it is
+       *    signed with a secret of the node, so it is only accepted by the node which issued it, until its restart
+       * 3. objects are read from the current chain state, if the head block differs from the block the scan was
+       *    started at, objects which were changed in between may have been skipped or may appear twice
+       */
+      scan_page scan_objects( const string& collection,
+                              const vector<string>& scope,
+                              const optional<string>& cursor = optional<string>(),
+                              const optional<uint32_t>& limit = optional<uint32_t>() )const;
+
 
 private:
       std::shared_ptr< database_api_impl > my;
@@ -1032,6 +1142,7 @@ FC_API(graphene::app::database_api,
    (get_account_id_from_string)
    (get_accounts)
    (get_full_accounts)
+   (get_full_accounts_batch)
    (get_top_voters)
    (get_account_by_name)
    (get_account_references)
@@ -1078,6 +1189,7 @@ FC_API(graphene::app::database_api,
    (get_liquidity_pools_by_asset_b)
    (get_liquidity_pools_by_both_assets)
    (get_liquidity_pools_by_share_asset)
+   (get_liquidity_pool_tickers_by_volume)
 
    // Witnesses
    (get_witnesses)
@@ -1109,6 +1221,7 @@ FC_API(graphene::app::database_api,
    (verify_account_authority)
    (validate_transaction)
    (get_required_fees)
+   (get_operation_fees)
 
    // Proposed transactions
    (get_proposed_transactions)
@@ -1125,4 +1238,7 @@ FC_API(graphene::app::database_api,
    (get_htlc_by_from)
    (get_htlc_by_to)
    (list_htlcs)
+
+   // Scans
+   (scan_objects)
 )
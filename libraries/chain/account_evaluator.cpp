@@ -281,6 +281,10 @@ void_result account_update_evaluator::do_apply( const account_update_operation&
 
    bool sa_before = acnt->has_special_authority();
 
+   // memoized authority checks which have visited this account are no longer valid
+   if( o.owner || o.active )
+      d.authority_checks().invalidate( o.account );
+
    // update account statistics
    if( o.new_options.valid() )
    {
@@ -105,52 +105,88 @@ void account_statistics_object::pay_fee( share_type core_fee, share_type cashbac
       pending_vested_fees += core_fee;
 }
 
-set<account_id_type> account_member_index::get_account_members(const account_object& a)const
+void account_member_index::get_account_members( const account_object& a, vector<account_id_type>& result )const
 {
-   set<account_id_type> result;
-   for( auto auth : a.owner.account_auths )
-      result.insert(auth.first);
-   for( auto auth : a.active.account_auths )
-      result.insert(auth.first);
-   return result;
+   result.clear();
+   for( const auto& auth : a.owner.account_auths )
+      result.push_back( auth.first );
+   for( const auto& auth : a.active.account_auths )
+      result.push_back( auth.first );
+   std::sort( result.begin(), result.end() );
+   result.erase( std::unique( result.begin(), result.end() ), result.end() );
 }
-set<public_key_type, pubkey_comparator> account_member_index::get_key_members(const account_object& a)const
+void account_member_index::get_key_members( const account_object& a, vector<public_key_type>& result )const
 {
-   set<public_key_type, pubkey_comparator> result;
-   for( auto auth : a.owner.key_auths )
-      result.insert(auth.first);
-   for( auto auth : a.active.key_auths )
-      result.insert(auth.first);
-   result.insert( a.options.memo_key );
-   return result;
+   result.clear();
+   for( const auto& auth : a.owner.key_auths )
+      result.push_back( auth.first );
+   for( const auto& auth : a.active.key_auths )
+      result.push_back( auth.first );
+   result.push_back( a.options.memo_key );
+   std::sort( result.begin(), result.end(), pubkey_comparator() );
+   result.erase( std::unique( result.begin(), result.end() ), result.end() );
 }
-set<address> account_member_index::get_address_members(const account_object& a)const
+void account_member_index::get_address_members( const account_object& a, vector<address>& result )const
 {
-   set<address> result;
-   for( auto auth : a.owner.address_auths )
-      result.insert(auth.first);
-   for( auto auth : a.active.address_auths )
-      result.insert(auth.first);
-   result.insert( a.options.memo_key );
-   return result;
+   result.clear();
+   for( const auto& auth : a.owner.address_auths )
+      result.push_back( auth.first );
+   for( const auto& auth : a.active.address_auths )
+      result.push_back( auth.first );
+   result.push_back( a.options.memo_key );
+   std::sort( result.begin(), result.end() );
+   result.erase( std::unique( result.begin(), result.end() ), result.end() );
 }
 
+namespace detail {
+
+   /**
+    * Walk the sorted member lists before and after a change at once, and only touch the posting lists of the
+    * members which have been added or removed
+    */
+   template< typename Key, typename Map, typename Compare >
+   void update_memberships( Map& memberships, const vector<Key>& before, const vector<Key>& after,
+                            account_id_type account, Compare comp )
+   {
+      auto b = before.begin();
+      auto a = after.begin();
+      while( b != before.end() || a != after.end() )
+      {
+         if( a == after.end() || ( b != before.end() && comp( *b, *a ) ) )
+         {
+            auto itr = memberships.find( *b );
+            if( itr != memberships.end() )
+            {
+               itr->second.erase( account );
+               if( itr->second.empty() )
+                  memberships.erase( itr );
+            }
+            ++b;
+         }
+         else if( b == before.end() || comp( *a, *b ) )
+         {
+            memberships[*a].insert( account );
+            ++a;
+         }
+         else
+         {
+            ++a;
+            ++b;
+         }
+      }
+   }
+
+} // detail
+
 void account_member_index::object_inserted(const object& obj)
 {
     assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
     const account_object& a = static_cast<const account_object&>(obj);
 
-    auto account_members = get_account_members(a);
-    for( auto item : account_members )
-       account_to_account_memberships[item].insert(obj.id);
-
-    auto key_members = get_key_members(a);
-    for( auto item : key_members )
-       account_to_key_memberships[item].insert(obj.id);
-
-    auto address_members = get_address_members(a);
-    for( auto item : address_members )
-       account_to_address_memberships[item].insert(obj.id);
+    before_account_members.clear();
+    before_key_members.clear();
+    before_address_members.clear();
+    object_modified( a );
 }
 
 void account_member_index::object_removed(const object& obj)
@@ -158,28 +194,29 @@ void account_member_index::object_removed(const object& obj)
     assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
     const account_object& a = static_cast<const account_object&>(obj);
 
-    auto key_members = get_key_members(a);
-    for( auto item : key_members )
-       account_to_key_memberships[item].erase( obj.id );
+    get_key_members( a, before_key_members );
+    after_key_members.clear();
+    detail::update_memberships( account_to_key_memberships, before_key_members, after_key_members, a.id,
+                                pubkey_comparator() );
 
-    auto address_members = get_address_members(a);
-    for( auto item : address_members )
-       account_to_address_memberships[item].erase( obj.id );
+    get_address_members( a, before_address_members );
+    after_address_members.clear();
+    detail::update_memberships( account_to_address_memberships, before_address_members, after_address_members,
+                                a.id, std::less<address>() );
 
-    auto account_members = get_account_members(a);
-    for( auto item : account_members )
-       account_to_account_memberships[item].erase( obj.id );
+    get_account_members( a, before_account_members );
+    after_account_members.clear();
+    detail::update_memberships( account_to_account_memberships, before_account_members, after_account_members,
+                                a.id, std::less<account_id_type>() );
 }
 
 void account_member_index::about_to_modify(const object& before)
 {
-   before_key_members.clear();
-   before_account_members.clear();
    assert( dynamic_cast<const account_object*>(&before) ); // for debug only
    const account_object& a = static_cast<const account_object&>(before);
-   before_key_members     = get_key_members(a);
-   before_address_members = get_address_members(a);
-   before_account_members = get_account_members(a);
+   get_key_members( a, before_key_members );
+   get_address_members( a, before_address_members );
+   get_account_members( a, before_account_members );
 }
 
 void account_member_index::object_modified(const object& after)
@@ -187,66 +224,17 @@ void account_member_index::object_modified(const object& after)
     assert( dynamic_cast<const account_object*>(&after) ); // for debug only
     const account_object& a = static_cast<const account_object&>(after);
 
-    {
-       set<account_id_type> after_account_members = get_account_members(a);
-       vector<account_id_type> removed; removed.reserve(before_account_members.size());
-       std::set_difference(before_account_members.begin(), before_account_members.end(),
-                           after_account_members.begin(), after_account_members.end(),
-                           std::inserter(removed, removed.end()));
-
-       for( auto itr = removed.begin(); itr != removed.end(); ++itr )
-          account_to_account_memberships[*itr].erase(after.id);
-
-       vector<object_id_type> added; added.reserve(after_account_members.size());
-       std::set_difference(after_account_members.begin(), after_account_members.end(),
-                           before_account_members.begin(), before_account_members.end(),
-                           std::inserter(added, added.end()));
-
-       for( auto itr = added.begin(); itr != added.end(); ++itr )
-          account_to_account_memberships[*itr].insert(after.id);
-    }
-
-
-    {
-       set<public_key_type, pubkey_comparator> after_key_members = get_key_members(a);
-
-       vector<public_key_type> removed; removed.reserve(before_key_members.size());
-       std::set_difference(before_key_members.begin(), before_key_members.end(),
-                           after_key_members.begin(), after_key_members.end(),
-                           std::inserter(removed, removed.end()));
-
-       for( auto itr = removed.begin(); itr != removed.end(); ++itr )
-          account_to_key_memberships[*itr].erase(after.id);
-
-       vector<public_key_type> added; added.reserve(after_key_members.size());
-       std::set_difference(after_key_members.begin(), after_key_members.end(),
-                           before_key_members.begin(), before_key_members.end(),
-                           std::inserter(added, added.end()));
-
-       for( auto itr = added.begin(); itr != added.end(); ++itr )
-          account_to_key_memberships[*itr].insert(after.id);
-    }
-
-    {
-       set<address> after_address_members = get_address_members(a);
-
-       vector<address> removed; removed.reserve(before_address_members.size());
-       std::set_difference(before_address_members.begin(), before_address_members.end(),
-                           after_address_members.begin(), after_address_members.end(),
-                           std::inserter(removed, removed.end()));
-
-       for( auto itr = removed.begin(); itr != removed.end(); ++itr )
-          account_to_address_memberships[*itr].erase(after.id);
-
-       vector<address> added; added.reserve(after_address_members.size());
-       std::set_difference(after_address_members.begin(), after_address_members.end(),
-                           before_address_members.begin(), before_address_members.end(),
-                           std::inserter(added, added.end()));
+    get_account_members( a, after_account_members );
+    detail::update_memberships( account_to_account_memberships, before_account_members, after_account_members,
+                                a.id, std::less<account_id_type>() );
 
-       for( auto itr = added.begin(); itr != added.end(); ++itr )
-          account_to_address_memberships[*itr].insert(after.id);
-    }
+    get_key_members( a, after_key_members );
+    detail::update_memberships( account_to_key_memberships, before_key_members, after_key_members, a.id,
+                                pubkey_comparator() );
 
+    get_address_members( a, after_address_members );
+    detail::update_memberships( account_to_address_memberships, before_address_members, after_address_members,
+                                a.id, std::less<address>() );
 }
 
 const uint8_t  balances_by_account_index::bits = 20;
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <graphene/chain/block_candidate.hpp>
+
+namespace graphene { namespace chain {
+
+void merkle_accumulator::append( const digest_type& digest )
+{
+   _subtrees.emplace_back( 0, digest );
+   ++_count;
+   // merge subtrees of equal height, like carrying in a binary counter
+   while( _subtrees.size() > 1 && _subtrees.back().first == _subtrees[_subtrees.size() - 2].first )
+   {
+      auto& left = _subtrees[_subtrees.size() - 2];
+      left.second = digest_type::hash( std::make_pair( left.second, _subtrees.back().second ) );
+      ++left.first;
+      _subtrees.pop_back();
+   }
+}
+
+checksum_type merkle_accumulator::root()const
+{
+   if( _subtrees.empty() )
+      return checksum_type();
+   digest_type result = _subtrees.back().second;
+   for( auto itr = _subtrees.rbegin() + 1; itr != _subtrees.rend(); ++itr )
+      result = digest_type::hash( std::make_pair( itr->second, result ) );
+   return checksum_type::hash( result );
+}
+
+void merkle_accumulator::clear()
+{
+   _subtrees.clear();
+   _count = 0;
+}
+
+void block_candidate::reset( const block_id_type& head_block_id, uint64_t max_transactions_size,
+                             size_t first_transaction )
+{
+   _valid = true;
+   _full = false;
+   _head_block_id = head_block_id;
+   _max_transactions_size = max_transactions_size;
+   _transactions_size = 0;
+   _first_transaction = first_transaction;
+   _lowest_lane = transaction_lane::priority;
+   _lowest_fee_density = std::numeric_limits<uint64_t>::max();
+   _merkle.clear();
+}
+
+void block_candidate::append( const processed_transaction& trx, transaction_lane lane, uint64_t fee_density )
+{
+   if( !_valid || _full )
+      return;
+   const uint64_t size = fc::raw::pack_size( trx );
+   if( _transactions_size + size > _max_transactions_size )
+   {
+      _full = true;
+      return;
+   }
+   _transactions_size += size;
+   _merkle.append( trx.merkle_digest() );
+   if( lane > _lowest_lane || ( lane == _lowest_lane && fee_density < _lowest_fee_density ) )
+   {
+      _lowest_lane = lane;
+      _lowest_fee_density = fee_density;
+   }
+}
+
+bool block_candidate::is_outranked_by( transaction_lane lane, uint64_t fee_density )const
+{
+   // transactions of equal rank are sorted by arrival, so a new one comes last
+   if( _merkle.size() == 0 )
+      return false;
+   return lane < _lowest_lane || ( lane == _lowest_lane && fee_density > _lowest_fee_density );
+}
+
+} } // graphene::chain
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <graphene/chain/custom_authority_object.hpp>
+
+#include <fc/io/raw.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace chain {
+
+custom_authority_predicate_cache::predicate_ptr custom_authority_predicate_cache::get(
+      const unsigned_int& operation_type, const flat_map<uint16_t, restriction>& restrictions )
+{
+   // The restriction ids are not part of the predicate, only the restrictions in the order of their ids are
+   fc::sha256::encoder enc;
+   fc::raw::pack( enc, operation_type );
+   fc::raw::pack( enc, unsigned_int( restrictions.size() ) );
+   for( const auto& r : restrictions )
+      fc::raw::pack( enc, r.second );
+   const fc::sha256 key = enc.result();
+
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      auto itr = _predicates.find( key );
+      if( itr != _predicates.end() )
+      {
+         ++_hits;
+         return itr->second;
+      }
+   }
+
+   vector<restriction> rs;
+   rs.reserve( restrictions.size() );
+   for( const auto& r : restrictions )
+      rs.push_back( r.second );
+   predicate_ptr predicate = std::make_shared<const restriction_predicate_function>(
+                                   get_restriction_predicate( std::move( rs ), operation_type ) );
+
+   std::lock_guard<std::mutex> lock( _mutex );
+   ++_misses;
+   if( _predicates.size() >= _prune_threshold )
+      prune();
+   return _predicates.emplace( key, std::move( predicate ) ).first->second;
+}
+
+void custom_authority_predicate_cache::prune()
+{
+   for( auto itr = _predicates.begin(); itr != _predicates.end(); )
+   {
+      if( itr->second.use_count() == 1 )
+         itr = _predicates.erase( itr );
+      else
+         ++itr;
+   }
+   _prune_threshold = std::max<size_t>( 1024, 2 * _predicates.size() );
+}
+
+void custom_authority_predicate_cache::clear()
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _predicates.clear();
+   _prune_threshold = 1024;
+}
+
+custom_authority_predicate_cache_statistics custom_authority_predicate_cache::get_statistics()const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   custom_authority_predicate_cache_statistics result;
+   result.entries = _predicates.size();
+   result.hits = _hits;
+   result.misses = _misses;
+   return result;
+}
+
+} } // graphene::chain
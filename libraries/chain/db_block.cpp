@@ -83,10 +83,18 @@ optional<signed_block> database::fetch_block_by_number( uint32_t num )const
 
 const signed_transaction& database::get_recent_transaction(const transaction_id_type& trx_id) const
 {
-   auto& index = get_index_type<transaction_index>().indices().get<by_trx_id>();
-   auto itr = index.find(trx_id);
-   FC_ASSERT(itr != index.end());
-   return itr->trx;
+   const signed_transaction* trx = find_recent_transaction( trx_id );
+   if( trx == nullptr )
+      FC_THROW_EXCEPTION( fc::key_not_found_exception, "Transaction ${id} is not known or no longer cached",
+                          ("id",trx_id) );
+   return *trx;
+}
+
+const signed_transaction* database::find_recent_transaction(const transaction_id_type& trx_id) const
+{
+   if( !is_known_transaction( trx_id ) )
+      return nullptr;
+   return _recent_transactions.find( trx_id );
 }
 
 std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of_fork) const
@@ -255,6 +263,16 @@ void database::update_witnesses( fork_item& fork_entry )const
    }
 }
 
+/// @return an upper bound of the packed size of a block without transactions, which is produced by @p witness_id
+static size_t max_block_header_size( const witness_id_type& witness_id )
+{
+   static const size_t max_partial_block_header_size = fc::raw::pack_size( signed_block_header() )
+                                                       - fc::raw::pack_size( witness_id_type() ) // witness_id
+                                                       + 3; // max space to store size of transactions (out of block header),
+                                                            // +3 means 3*7=21 bits so it's practically safe
+   return max_partial_block_header_size + fc::raw::pack_size( witness_id );
+}
+
 /**
  * Attempts to push the transaction into the pending queue
  *
@@ -268,11 +286,17 @@ processed_transaction database::push_transaction( const precomputable_transactio
 { try {
    // see https://github.com/bitshares/bitshares-core/issues/1573
    FC_ASSERT( fc::raw::pack_size( trx ) < (1024 * 1024), "Transaction exceeds maximum transaction size." );
+   // Only check the rate here and charge it once the transaction has been accepted, so that invalid transactions
+   // naming somebody else as fee payer can not use up the rate of that account
+   const fc::time_point now = fc::time_point::now();
+   _admission.check_rate( trx, now );
    processed_transaction result;
    detail::with_skip_flags( *this, skip, [&]()
    {
       result = _push_transaction( trx );
    } );
+   _admission.charge_rate( trx, now );
+   _admission.on_accepted();
    return result;
 } FC_CAPTURE_AND_RETHROW( (trx) ) }
 
@@ -281,7 +305,21 @@ processed_transaction database::_push_transaction( const precomputable_transacti
    // If this is the first transaction pushed after applying a block, start a new undo session.
    // This allows us to quickly rewind to the clean state of the head block, in case a new block arrives.
    if( !_pending_tx_session.valid() )
+   {
       _pending_tx_session = _undo_db.start_undo_session();
+      if( _maintain_block_candidate )
+      {
+         // the witness is not known yet, so leave room for the largest possible witness id
+         static const size_t header_size = max_block_header_size( witness_id_type( GRAPHENE_DB_MAX_INSTANCE_ID ) );
+         _block_candidate.reset( head_block_id(), get_global_properties().parameters.maximum_block_size
+                                                  - header_size, _pending_tx.size() );
+      }
+   }
+
+   // Check whether there is room for the transaction before doing the expensive work
+   const transaction_lane lane = transaction_admission_controller::classify( trx );
+   const uint64_t fee_density = transaction_admission_controller::calculate_fee_density( *this, trx );
+   const optional<transaction_id_type> evicted = _admission.make_room( lane, fee_density );
 
    // Create a temporary undo session as a child of _pending_tx_session.
    // The temporary session will be discarded by the destructor if
@@ -291,16 +329,69 @@ processed_transaction database::_push_transaction( const precomputable_transacti
    auto temp_session = _undo_db.start_undo_session();
    auto processed_trx = _apply_transaction( trx );
    _pending_tx.push_back(processed_trx);
+   _recent_transactions.insert( trx.id(), trx );
 
    // notify_changed_objects();
    // The transaction applied successfully. Merge its changes into the pending block session.
    temp_session.merge();
 
+   _admission.on_pending( trx.id(), lane, fee_density );
+
+   // The evicted transaction is only dropped once the new one has been applied successfully, so that invalid
+   // transactions can not evict anything. It is dropped lazily: its changes stay in the pending state until the
+   // next rebuild, which skips it like block assembly does. The candidate may contain it, so it is dropped as well.
+   if( evicted.valid() )
+   {
+      _admission.on_evicted( *evicted );
+      _block_candidate.invalidate();
+   }
+   else if( _maintain_block_candidate )
+      update_block_candidate( processed_trx, lane, fee_density );
+
    // notify anyone listening to pending transactions
    notify_on_pending_transaction( trx );
    return processed_trx;
 }
 
+void database::reapply_pending_transactions( std::vector< processed_transaction >&& pending )
+{
+   std::vector< processed_transaction > failed_transactions;
+   while( !pending.empty() )
+   {
+      failed_transactions.clear();
+      for( processed_transaction& tx : pending )
+      {
+         try
+         {
+            if( !is_known_transaction( tx.id() ) )
+               _push_transaction( tx );
+         }
+         catch( const fc::exception& )
+         { // ignore invalid transactions
+            failed_transactions.push_back( std::move(tx) );
+         }
+      }
+      if( failed_transactions.size() == pending.size() )
+         break;
+      pending.swap( failed_transactions );
+   }
+}
+
+void database::update_block_candidate( const processed_transaction& trx, transaction_lane lane,
+                                       uint64_t fee_density )
+{
+   _block_candidate.append( trx, lane, fee_density );
+   // When the block is full, a rebuild would make room for a transaction of a better lane or a higher fee density
+   if( _block_candidate.is_full() && _block_candidate.is_outranked_by( lane, fee_density ) )
+      _block_candidate.invalidate();
+}
+
+void database::enable_block_candidate( bool enable )
+{
+   _maintain_block_candidate = enable;
+   _block_candidate.invalidate();
+}
+
 processed_transaction database::validate_transaction( const signed_transaction& trx )
 {
    auto session = _undo_db.start_undo_session();
@@ -387,14 +478,32 @@ signed_block database::_generate_block(
    )
 {
    try {
+   const fc::time_point start_time = fc::time_point::now();
    uint32_t skip = get_node_properties().skip_flags;
    uint32_t slot_num = get_slot_at_time( when );
    FC_ASSERT( slot_num > 0 );
    witness_id_type scheduled_witness = get_scheduled_witness( slot_num );
    FC_ASSERT( scheduled_witness == witness_id );
 
+   signed_block pending_block;
+   uint32_t deferred_tx_count = 0;
+
+   // If the block candidate is up to date, the pending state is the result of applying its transactions, possibly
+   // followed by more which do not fit into the block. They are applied in the same state again when the block is
+   // pushed, so they can be used as they are.
+   const bool from_candidate = _maintain_block_candidate && _pending_tx_session.valid()
+                               && _block_candidate.is_valid_for( head_block_id() );
+   if( from_candidate )
+   {
+      FC_ASSERT( _block_candidate.first_transaction() + _block_candidate.size() <= _pending_tx.size() );
+      const auto first = _pending_tx.begin() + _block_candidate.first_transaction();
+      pending_block.transaction_merkle_root = _block_candidate.merkle_root();
+      pending_block.transactions.assign( first, first + _block_candidate.size() );
+   }
+   _block_candidate.invalidate();
+
    //
-   // The following code throws away existing pending_tx_session and
+   // Otherwise, the following code throws away existing pending_tx_session and
    // rebuilds it by re-applying pending transactions.
    //
    // This rebuild is necessary because pending transactions' validity
@@ -407,6 +516,7 @@ signed_block database::_generate_block(
 
    // pop pending state (reset to head block state)
    _pending_tx_session.reset();
+   _authority_checks.clear();
 
    // Check witness signing key
    if( !(skip & skip_witness_signature) )
@@ -419,64 +529,99 @@ signed_block database::_generate_block(
       FC_ASSERT( witness_id(*this).signing_key == block_signing_private_key.get_public_key() );
    }
 
-   static const size_t max_partial_block_header_size = fc::raw::pack_size( signed_block_header() )
-                                                       - fc::raw::pack_size( witness_id_type() ) // witness_id
-                                                       + 3; // max space to store size of transactions (out of block header),
-                                                            // +3 means 3*7=21 bits so it's practically safe
-   const size_t max_block_header_size = max_partial_block_header_size + fc::raw::pack_size( witness_id );
-   auto maximum_block_size = get_global_properties().parameters.maximum_block_size;
-   size_t total_block_size = max_block_header_size;
-
-   signed_block pending_block;
-
-   _pending_tx_session = _undo_db.start_undo_session();
-
-   uint64_t postponed_tx_count = 0;
-   for( const processed_transaction& tx : _pending_tx )
+   if( !from_candidate )
    {
-      size_t new_total_size = total_block_size + fc::raw::pack_size( tx );
+      auto maximum_block_size = get_global_properties().parameters.maximum_block_size;
+      size_t total_block_size = max_block_header_size( witness_id );
 
-      // postpone transaction if it would make block too big
-      if( new_total_size > maximum_block_size )
-      {
-         postponed_tx_count++;
-         continue;
-      }
+      _pending_tx_session = _undo_db.start_undo_session();
 
-      try
+      // apply priority lane transactions first, then the rest by fee density, skipping evicted transactions
+      vector< const processed_transaction* > prioritized_pending_tx;
+      prioritized_pending_tx.reserve( _pending_tx.size() );
+      for( const processed_transaction& tx : _pending_tx )
+         prioritized_pending_tx.push_back( &tx );
+      _admission.prioritize( prioritized_pending_tx );
+
+      uint64_t postponed_tx_count = 0;
+      const bool has_time_budget = ( _block_assembly_time_budget.count() > 0 );
+      // A transaction can depend on one which has been sorted after it, so failed transactions are retried
+      // as long as the previous pass made progress
+      vector< std::pair< const processed_transaction*, fc::exception > > failed_tx;
+      while( !prioritized_pending_tx.empty() )
       {
-         auto temp_session = _undo_db.start_undo_session();
-         processed_transaction ptx = _apply_transaction( tx );
-
-         // We have to recompute pack_size(ptx) because it may be different
-         // than pack_size(tx) (i.e. if one or more results increased
-         // their size)
-         new_total_size = total_block_size + fc::raw::pack_size( ptx );
-         // postpone transaction if it would make block too big
-         if( new_total_size > maximum_block_size )
+         failed_tx.clear();
+         for( const processed_transaction* tx_ptr : prioritized_pending_tx )
          {
-            postponed_tx_count++;
-            continue;
-         }
+            // leave the remaining transactions for the next block when the time budget is used up
+            if( has_time_budget && fc::time_point::now() - start_time >= _block_assembly_time_budget )
+            {
+               ++deferred_tx_count;
+               continue;
+            }
+
+            const processed_transaction& tx = *tx_ptr;
+            size_t new_total_size = total_block_size + fc::raw::pack_size( tx );
+
+            // postpone transaction if it would make block too big
+            if( new_total_size > maximum_block_size )
+            {
+               postponed_tx_count++;
+               continue;
+            }
+
+            try
+            {
+               auto temp_session = _undo_db.start_undo_session();
+               processed_transaction ptx = _apply_transaction( tx );
+
+               // We have to recompute pack_size(ptx) because it may be different
+               // than pack_size(tx) (i.e. if one or more results increased
+               // their size)
+               new_total_size = total_block_size + fc::raw::pack_size( ptx );
+               // postpone transaction if it would make block too big
+               if( new_total_size > maximum_block_size )
+               {
+                  postponed_tx_count++;
+                  continue;
+               }
 
-         temp_session.merge();
+               temp_session.merge();
 
-         total_block_size = new_total_size;
-         pending_block.transactions.push_back( ptx );
+               total_block_size = new_total_size;
+               pending_block.transactions.push_back( ptx );
+            }
+            catch ( const fc::exception& e )
+            {
+               failed_tx.emplace_back( tx_ptr, e );
+            }
+         }
+         if( failed_tx.size() == prioritized_pending_tx.size() )
+            break;
+         prioritized_pending_tx.clear();
+         for( const auto& failed : failed_tx )
+            prioritized_pending_tx.push_back( failed.first );
       }
-      catch ( const fc::exception& e )
+      for( const auto& failed : failed_tx )
       {
          // Do nothing, transaction will not be re-applied
-         wlog( "Transaction was not processed while generating block due to ${e}", ("e", e) );
-         wlog( "The transaction was ${t}", ("t", tx) );
+         wlog( "Transaction was not processed while generating block due to ${e}", ("e", failed.second) );
+         wlog( "The transaction was ${t}", ("t", *failed.first) );
+      }
+      if( postponed_tx_count > 0 )
+      {
+         wlog( "Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count) );
+      }
+      if( deferred_tx_count > 0 )
+      {
+         wlog( "Deferred ${n} transactions due to block assembly time budget", ("n", deferred_tx_count) );
       }
-   }
-   if( postponed_tx_count > 0 )
-   {
-      wlog( "Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count) );
-   }
 
-   _pending_tx_session.reset();
+      _pending_tx_session.reset();
+      _authority_checks.clear();
+
+      pending_block.transaction_merkle_root = pending_block.calculate_merkle_root();
+   }
 
    // We have temporarily broken the invariant that
    // _pending_tx_session is the result of applying _pending_tx, as
@@ -486,13 +631,35 @@ signed_block database::_generate_block(
 
    pending_block.previous = head_block_id();
    pending_block.timestamp = when;
-   pending_block.transaction_merkle_root = pending_block.calculate_merkle_root();
    pending_block.witness = witness_id;
 
    if( !(skip & skip_witness_signature) )
       pending_block.sign( block_signing_private_key );
 
-   push_block( pending_block, skip | skip_transaction_signatures ); // skip authority check when pushing self-generated blocks
+   const fc::time_point assembled_time = fc::time_point::now();
+   // skip authority check when pushing self-generated blocks, and the merkle check if the root has been accumulated
+   // from the same digests
+   try
+   {
+      push_block( pending_block, skip | skip_transaction_signatures | ( from_candidate ? skip_merkle_check : 0 ) );
+   }
+   catch( const fc::exception& e )
+   {
+      if( !from_candidate )
+         throw;
+      // Pushing the block has restored the pending state and with it the candidate, so drop it to rebuild the block
+      wlog( "Failed to push the block assembled from the block candidate, rebuilding it: ${e}",
+            ("e", e.to_detail_string()) );
+      _block_candidate.invalidate();
+      return _generate_block( when, witness_id, block_signing_private_key );
+   }
+
+   _last_block_production.block_num = pending_block.block_num();
+   _last_block_production.transactions = pending_block.transactions.size();
+   _last_block_production.from_candidate = from_candidate;
+   _last_block_production.deferred_transactions = deferred_tx_count;
+   _last_block_production.assembly_time = assembled_time - start_time;
+   _last_block_production.apply_time = fc::time_point::now() - assembled_time;
 
    return pending_block;
 } FC_CAPTURE_AND_RETHROW( (witness_id) ) }
@@ -514,6 +681,7 @@ void database::pop_block()
       FC_ASSERT( fork_db_head, "Trying to pop() block that's not in fork database!?" );
    }
    pop_undo();
+   _authority_checks.clear();
    _popped_tx.insert( _popped_tx.begin(), fork_db_head->data.transactions.begin(), fork_db_head->data.transactions.end() );
 } FC_CAPTURE_AND_RETHROW() }
 
@@ -521,7 +689,9 @@ void database::clear_pending()
 { try {
    assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
    _pending_tx.clear();
+   _admission.clear_pending();
    _pending_tx_session.reset();
+   _authority_checks.clear();
 } FC_CAPTURE_AND_RETHROW() }
 
 uint32_t database::push_applied_operation( const operation& op )
@@ -578,6 +748,15 @@ void database::_apply_block( const signed_block& next_block )
    uint32_t skip = get_node_properties().skip_flags;
    _applied_ops.clear();
 
+   // Authority checks are memoized for the transactions of this block only. The cache is also dropped when the
+   // block fails to apply, since its changes are undone then.
+   _authority_checks.clear();
+   struct authority_checks_guard
+   {
+      authority_check_cache& cache;
+      ~authority_checks_guard() { cache.clear(); }
+   } clear_authority_checks_on_exit{ _authority_checks };
+
    if( !(skip & skip_block_size_check) )
    {
       FC_ASSERT( fc::raw::pack_size(next_block) <= get_global_properties().parameters.maximum_block_size );
@@ -651,11 +830,14 @@ void database::_apply_block( const signed_block& next_block )
    if( !_node_property_object.debug_updates.empty() )
       apply_debug_updates();
 
+   if( maint_needed && is_state_hash_enabled() )
+      check_state_hash( next_block_num );
+
    // notify observers that the block has been applied
    notify_applied_block( next_block ); //emit
    _applied_ops.clear();
 
-   notify_changed_objects();
+   notify_changed_objects( next_block );
 } FC_CAPTURE_AND_RETHROW( (next_block.block_num()) )  }
 
 
@@ -700,7 +882,7 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
 
       trx.verify_authority(chain_id, get_active, get_owner, get_custom, allow_non_immediate_owner,
                            MUST_IGNORE_CUSTOM_OP_REQD_AUTHS(head_block_time()),
-                           get_global_properties().parameters.max_authority_depth);
+                           get_global_properties().parameters.max_authority_depth, &_authority_checks);
    }
 
    //Skip all manner of expiration and TaPoS checking if we're on block 1; It's impossible that the transaction is
@@ -731,7 +913,7 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    {
       create<transaction_history_object>([&trx](transaction_history_object& transaction) {
          transaction.trx_id = trx.id();
-         transaction.trx = trx;
+         transaction.expiration = trx.expiration;
       });
    }
 
@@ -802,6 +984,46 @@ void database::add_checkpoints( const flat_map<uint32_t,block_id_type>& checkpts
       _checkpoints[i.first] = i.second;
 }
 
+void database::enable_state_hash( bool enable )
+{
+   _state_hash_history.clear();
+   object_database::enable_state_hash( enable, []( uint8_t space, uint8_t type ) {
+      if( space == protocol_ids )
+         return type != operation_history_object_type;
+      if( space == implementation_ids )
+         return type != impl_account_transaction_history_object_type
+             && type != impl_transaction_history_object_type;
+      return false;
+   });
+}
+
+void database::add_state_hash_checkpoints( const flat_map<uint32_t,fc::sha256>& checkpoints )
+{
+   for( const auto& i : checkpoints )
+      _state_hash_checkpoints[i.first] = i.second;
+}
+
+void database::check_state_hash( uint32_t block_num )
+{
+   const fc::sha256 hash = get_state_hash();
+
+   // drop entries of blocks which have been popped
+   _state_hash_history.erase( _state_hash_history.lower_bound( block_num ), _state_hash_history.end() );
+   _state_hash_history[block_num] = hash;
+   if( _state_hash_history.size() > GRAPHENE_STATE_HASH_HISTORY_SIZE )
+      _state_hash_history.erase( _state_hash_history.begin() );
+
+   auto itr = _state_hash_checkpoints.find( block_num );
+   if( itr == _state_hash_checkpoints.end() )
+      ilog( "State hash after maintenance in block ${b}: ${h}", ("b",block_num)("h",hash) );
+   else if( itr->second == hash )
+      ilog( "State hash after maintenance in block ${b} matches the checkpoint: ${h}", ("b",block_num)("h",hash) );
+   else
+      elog( "State hash after maintenance in block ${b} is ${h}, but the checkpoint expects ${e}. "
+            "Hashes by object type: ${i}",
+            ("b",block_num)("h",hash)("e",itr->second)("i",get_index_state_hashes()) );
+}
+
 bool database::before_last_checkpoint()const
 {
    return (_checkpoints.size() > 0) && (_checkpoints.rbegin()->first >= head_block_num());
@@ -103,21 +103,24 @@ vector<authority> database::get_viable_custom_authorities(
    const auto& index = get_index_type<custom_authority_index>().indices().get<by_account_custom>();
    auto range = index.equal_range(boost::make_tuple(account, unsigned_int(op.which()), true));
 
-   auto is_valid = [now=head_block_time()](const custom_authority_object& auth) { return auth.is_valid(now); };
-   vector<std::reference_wrapper<const custom_authority_object>> valid_auths;
-   std::copy_if(range.first, range.second, std::back_inserter(valid_auths), is_valid);
-
    vector<authority> results;
-   for (const auto& cust_auth : valid_auths) {
+   if (range.first == range.second)
+      return results;
+
+   const time_point_sec now = head_block_time();
+   for (auto itr = range.first; itr != range.second; ++itr) {
+      const custom_authority_object& cust_auth = *itr;
+      if (!cust_auth.is_valid(now))
+         continue;
       try {
-         auto result = cust_auth.get().get_predicate()(op);
+         auto result = cust_auth.get_predicate(_custom_authority_predicates)(op);
          if (result.success)
-            results.emplace_back(cust_auth.get().auth);
+            results.emplace_back(cust_auth.auth);
          else if (rejected_authorities != nullptr)
-            rejected_authorities->insert(std::make_pair(cust_auth.get().id, std::move(result)));
+            rejected_authorities->insert(std::make_pair(cust_auth.id, std::move(result)));
       } catch (fc::exception& e) {
          if (rejected_authorities != nullptr)
-            rejected_authorities->insert(std::make_pair(cust_auth.get().id, std::move(e)));
+            rejected_authorities->insert(std::make_pair(cust_auth.id, std::move(e)));
       }
    }
 
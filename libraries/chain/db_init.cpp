@@ -166,7 +166,7 @@ void database::initialize_indexes()
    //Implementation object indexes
    add_index< primary_index<transaction_index                             > >();
 
-   auto bal_idx = add_index< primary_index<account_balance_index          > >();
+   auto bal_idx = add_index< primary_index<account_balance_index,       18 > >(); // 256 Ki
    bal_idx->add_secondary_index<balances_by_account_index>();
 
    add_index< primary_index<asset_bitasset_data_index,                 13 > >(); // 8192
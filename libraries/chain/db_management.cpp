@@ -214,6 +214,18 @@ void database::open(
          _p_witness_schedule_obj = &get( witness_schedule_id_type() );
       }
 
+      // Compile the predicates of the loaded custom authorities now rather than in the first transactions using them
+      _custom_authority_predicates.clear();
+      get_index_type<custom_authority_index>().inspect_all_objects( [this]( const object& o ) {
+         const auto& cust_auth = static_cast<const custom_authority_object&>( o );
+         try {
+            cust_auth.update_predicate_cache( _custom_authority_predicates );
+         } catch( const fc::exception& e ) {
+            wlog( "Unable to compile the restrictions of custom authority ${id}: ${e}",
+                  ("id",cust_auth.id)("e",e.to_detail_string()) );
+         }
+      } );
+
       fc::optional<block_id_type> last_block = _block_id_to_block.last_id();
       if( last_block.valid() )
       {
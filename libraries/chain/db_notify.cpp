@@ -476,10 +476,7 @@ void get_relevant_accounts( const object* obj, flat_set<account_id_type>& accoun
               accounts.insert( aobj->owner );
               break;
            } case impl_transaction_history_object_type:{
-              const auto& aobj = dynamic_cast<const transaction_history_object*>(obj);
-              FC_ASSERT( aobj != nullptr );
-              transaction_get_impacted_accounts( aobj->trx, accounts,
-                                                 ignore_custom_operation_required_auths );
+              // the object does not hold the transaction, see database::notify_changed_objects
               break;
            } case impl_blinded_balance_object_type:{
               const auto& aobj = dynamic_cast<const blinded_balance_object*>(obj);
@@ -526,7 +523,7 @@ void database::notify_on_pending_transaction( const signed_transaction& tx )
    GRAPHENE_TRY_NOTIFY( on_pending_transaction, tx )
 }
 
-void database::notify_changed_objects()
+void database::notify_changed_objects( const signed_block& block )
 { try {
    if( _undo_db.enabled() ) 
    {
@@ -538,14 +535,25 @@ void database::notify_changed_objects()
       {
         vector<object_id_type> new_ids;  new_ids.reserve(head_undo.new_ids.size());
         flat_set<account_id_type> new_accounts_impacted;
+        bool new_transaction_history = false;
         for( const auto& item : head_undo.new_ids )
         {
           new_ids.push_back(item);
+          if( item.is<transaction_history_object>() )
+            new_transaction_history = true;
           auto obj = find_object(item);
           if(obj != nullptr)
             get_relevant_accounts(obj, new_accounts_impacted,
                                   MUST_IGNORE_CUSTOM_OP_REQD_AUTHS(chain_time));
         }
+        // Transaction history objects only hold transaction ids, so the accounts affected by the transactions of
+        // the block are computed here, for subscribers only rather than on every applied transaction
+        if( new_transaction_history )
+        {
+          for( const auto& trx : block.transactions )
+            transaction_get_impacted_accounts( trx, new_accounts_impacted,
+                                               MUST_IGNORE_CUSTOM_OP_REQD_AUTHS(chain_time) );
+        }
 
         if( new_ids.size() )
            GRAPHENE_TRY_NOTIFY( new_objects, new_ids, new_accounts_impacted)
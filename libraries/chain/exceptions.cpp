@@ -61,6 +61,10 @@ namespace graphene { namespace chain {
 
    FC_IMPLEMENT_DERIVED_EXCEPTION( duplicate_transaction,        transaction_process_exception, 3030001,
                                    "duplicate transaction" )
+   FC_IMPLEMENT_DERIVED_EXCEPTION( transaction_rate_limited,     transaction_process_exception, 3030002,
+                                   "transaction rate limit exceeded" )
+   FC_IMPLEMENT_DERIVED_EXCEPTION( mempool_full,                 transaction_process_exception, 3030003,
+                                   "pending transaction pool is full" )
 
    FC_IMPLEMENT_DERIVED_EXCEPTION( pop_empty_chain,              undo_database_exception, 3070001,
                                    "there are no blocks to pop" )
@@ -338,21 +338,27 @@ namespace graphene { namespace chain {
          virtual void object_modified( const object& after  ) override;
 
 
-         /** given an account or key, map it to the set of accounts that reference it in an active or owner authority */
-         map< account_id_type, set<account_id_type> >                    account_to_account_memberships;
-         map< public_key_type, set<account_id_type>, pubkey_comparator > account_to_key_memberships;
+         /** given an account or key, map it to the sorted list of accounts that reference it in an active or owner
+          *  authority, keys or accounts which are not referenced any more are removed */
+         map< account_id_type, flat_set<account_id_type> >                    account_to_account_memberships;
+         map< public_key_type, flat_set<account_id_type>, pubkey_comparator > account_to_key_memberships;
          /** some accounts use address authorities in the genesis block */
-         map< address, set<account_id_type> >                            account_to_address_memberships;
+         map< address, flat_set<account_id_type> >                            account_to_address_memberships;
 
 
       protected:
-         set<account_id_type>                    get_account_members( const account_object& a )const;
-         set<public_key_type, pubkey_comparator> get_key_members( const account_object& a )const;
-         set<address>                            get_address_members( const account_object& a )const;
-
-         set<account_id_type>                    before_account_members;
-         set<public_key_type, pubkey_comparator> before_key_members;
-         set<address>                            before_address_members;
+         /** these fill @p result with the sorted members of the account, without duplicates */
+         void get_account_members( const account_object& a, vector<account_id_type>& result )const;
+         void get_key_members( const account_object& a, vector<public_key_type>& result )const;
+         void get_address_members( const account_object& a, vector<address>& result )const;
+
+         /** the members before the modification, the buffers are reused to avoid allocations */
+         vector<account_id_type> before_account_members;
+         vector<public_key_type> before_key_members;
+         vector<address>         before_address_members;
+         vector<account_id_type> after_account_members;
+         vector<public_key_type> after_key_members;
+         vector<address>         after_address_members;
    };
 
 
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/transaction_admission.hpp>
+#include <graphene/chain/types.hpp>
+#include <graphene/protocol/block.hpp>
+
+namespace graphene { namespace chain {
+
+   /**
+    * @brief Computes the transaction merkle root of a block while its transactions are appended one by one
+    *
+    * The result is the same as @ref signed_block::calculate_merkle_root. That function hashes pairs of digests
+    * level by level and carries an odd digest up unchanged, so the tree is made of perfect subtrees for the binary
+    * decomposition of the number of transactions, from the largest on the left to the smallest on the right. The
+    * accumulator keeps the roots of these subtrees, so appending costs O(1) hashes amortized and computing the root
+    * costs O(log n).
+    */
+   class merkle_accumulator
+   {
+   public:
+      void append( const digest_type& digest );
+      checksum_type root()const;
+      uint32_t size()const { return _count; }
+      void clear();
+
+   private:
+      /// Roots of the perfect subtrees from left to right, together with their height
+      vector< std::pair< uint32_t, digest_type > > _subtrees;
+      uint32_t                                     _count = 0;
+   };
+
+   /// How the most recent block of this node was produced
+   struct block_production_info
+   {
+      uint32_t         block_num = 0;
+      uint32_t         transactions = 0;
+      /// Whether the transactions were taken from the block candidate or the pending state had to be re-applied
+      bool             from_candidate = false;
+      /// Number of pending transactions which were left for the next block because the time budget was used up
+      uint32_t         deferred_transactions = 0;
+      /// Time spent to select the transactions and to finalize and sign the block
+      fc::microseconds assembly_time;
+      /// Time spent to apply the new block
+      fc::microseconds apply_time;
+   };
+
+   /**
+    * @brief A block which is assembled while transactions are pushed to the pending state
+    *
+    * Every transaction which is applied to the pending state is appended to the candidate, i.e. its packed size and
+    * its merkle digest are accounted, until the next one would not fit into the block. The transactions themselves
+    * are not copied, the candidate is the range of pending transactions starting at @ref first_transaction. Since
+    * it is a prefix of the pending state, its transactions have been applied exactly as they will be applied in the
+    * block, and a witness only has to finalize and sign the header at its slot instead of re-applying all pending
+    * transactions.
+    *
+    * The candidate is invalidated when it no longer matches what a rebuild would include, i.e. when it is full and
+    * a transaction arrives which a rebuild would sort before one of the candidate, by lane and fee density. The
+    * block is then built from scratch as before.
+    */
+   class block_candidate
+   {
+   public:
+      /**
+       * Start an empty candidate on top of the given block
+       * @param max_transactions_size the space in the block which is left for transactions
+       * @param first_transaction index of the next pending transaction, which will be the first of the candidate
+       */
+      void reset( const block_id_type& head_block_id, uint64_t max_transactions_size, size_t first_transaction );
+      void invalidate() { _valid = false; }
+
+      /// @return true if the candidate can be used to produce the block after @p head_block_id
+      bool is_valid_for( const block_id_type& head_block_id )const
+      { return _valid && _head_block_id == head_block_id; }
+      /// @return true if a transaction has not fit into the candidate, so no more are appended
+      bool is_full()const { return _full; }
+
+      /// Append the next pending transaction if it fits, otherwise mark the candidate as full
+      void append( const processed_transaction& trx, transaction_lane lane, uint64_t fee_density );
+      /**
+       * @return true if a rebuild would sort a transaction of the given lane and fee density before a transaction of
+       * the candidate, so that a full block would include it instead
+       */
+      bool is_outranked_by( transaction_lane lane, uint64_t fee_density )const;
+
+      /// @return the index of the first pending transaction of the candidate
+      size_t first_transaction()const { return _first_transaction; }
+      /// @return the number of pending transactions in the candidate
+      uint32_t size()const { return _merkle.size(); }
+      /// @return the packed size of the transactions
+      uint64_t transactions_size()const { return _transactions_size; }
+      checksum_type merkle_root()const { return _merkle.root(); }
+
+   private:
+      bool                            _valid = false;
+      bool                            _full = false;
+      block_id_type                   _head_block_id;
+      uint64_t                        _max_transactions_size = 0;
+      uint64_t                        _transactions_size = 0;
+      size_t                          _first_transaction = 0;
+      /// Lane and fee density of the transaction of the candidate which a rebuild would sort last
+      transaction_lane                _lowest_lane = transaction_lane::priority;
+      uint64_t                        _lowest_fee_density = std::numeric_limits<uint64_t>::max();
+      merkle_accumulator              _merkle;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::block_production_info,
+            (block_num)(transactions)(from_candidate)(deferred_transactions)(assembly_time)(apply_time) )
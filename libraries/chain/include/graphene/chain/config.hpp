@@ -30,7 +30,10 @@
 
 #define GRAPHENE_MAX_NESTED_OBJECTS (200)
 
-#define GRAPHENE_CURRENT_DB_VERSION                          "20200910"
+/// Number of state hashes of past maintenance intervals kept in memory
+#define GRAPHENE_STATE_HASH_HISTORY_SIZE 64
+
+#define GRAPHENE_CURRENT_DB_VERSION                          "20201105"
 
 #define GRAPHENE_RECENTLY_MISSED_COUNT_INCREMENT             4
 #define GRAPHENE_RECENTLY_MISSED_COUNT_DECREMENT             3
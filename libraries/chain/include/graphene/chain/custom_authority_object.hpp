@@ -29,17 +29,65 @@
 #include <graphene/chain/types.hpp>
 #include <boost/multi_index/composite_key.hpp>
 
+#include <fc/crypto/sha256.hpp>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
 namespace graphene { namespace chain {
 
+   struct custom_authority_predicate_cache_statistics
+   {
+      uint64_t entries = 0;
+      uint64_t hits = 0;   ///< lookups which found an already compiled predicate
+      uint64_t misses = 0; ///< lookups which had to compile a predicate
+   };
+
+   /**
+    * @brief Compiled restriction predicates, shared by all custom authorities with the same operation type and
+    * restrictions
+    *
+    * Predicates are keyed by a hash of the operation type and the restrictions, so accounts which set up identical
+    * custom authorities only pay for compiling them once. Predicates which are no longer referenced by any custom
+    * authority object are dropped when the cache grows.
+    */
+   class custom_authority_predicate_cache
+   {
+   public:
+      using predicate_ptr = std::shared_ptr<const restriction_predicate_function>;
+
+      /// @return the compiled predicate for the given restrictions, compiling it if necessary
+      predicate_ptr get( const unsigned_int& operation_type, const flat_map<uint16_t, restriction>& restrictions );
+
+      void clear();
+      custom_authority_predicate_cache_statistics get_statistics()const;
+
+   private:
+      struct key_hash
+      {
+         size_t operator()( const fc::sha256& key )const { return key._hash[0]; }
+      };
+
+      /// Drop the predicates which are only referenced by the cache
+      void prune();
+
+      mutable std::mutex                                               _mutex;
+      std::unordered_map< fc::sha256, predicate_ptr, key_hash >        _predicates;
+      size_t                                                           _prune_threshold = 1024;
+      uint64_t                                                         _hits = 0;
+      uint64_t                                                         _misses = 0;
+   };
+
    /**
     * @brief Tracks account custom authorities
     * @ingroup object
     *
     */
    class custom_authority_object : public abstract_object<custom_authority_object> {
-      /// Unreflected field to store a cache of the predicate function
+      /// Unreflected field to store the compiled predicate function, shared with identical custom authorities
       /// Note that this cache can be modified when the object is const!
-      mutable optional<restriction_predicate_function> predicate_cache;
+      mutable custom_authority_predicate_cache::predicate_ptr predicate_cache;
 
    public:
       static constexpr uint8_t space_id = protocol_ids;
@@ -65,15 +113,15 @@ namespace graphene { namespace chain {
          return rs;
       }
       /// Get predicate, from cache if possible, and update cache if not (modifies const object!)
-      restriction_predicate_function get_predicate() const {
-         if (!predicate_cache.valid())
-            update_predicate_cache();
+      const restriction_predicate_function& get_predicate(custom_authority_predicate_cache& cache) const {
+         if (!predicate_cache)
+            update_predicate_cache(cache);
 
          return *predicate_cache;
       }
-      /// Regenerate predicate function and update predicate cache
-      void update_predicate_cache() const {
-         predicate_cache = get_restriction_predicate(get_restrictions(), operation_type);
+      /// Look up or compile the predicate function and update predicate cache
+      void update_predicate_cache(custom_authority_predicate_cache& cache) const {
+         predicate_cache = cache.get(operation_type, restrictions);
       }
       /// Clear the cache of the predicate function
       void clear_predicate_cache() { predicate_cache.reset(); }
@@ -116,4 +164,6 @@ MAP_OBJECT_ID_TO_TYPE(graphene::chain::custom_authority_object)
 
 FC_REFLECT_TYPENAME(graphene::chain::custom_authority_object)
 
+FC_REFLECT(graphene::chain::custom_authority_predicate_cache_statistics, (entries)(hits)(misses))
+
 GRAPHENE_DECLARE_EXTERNAL_SERIALIZATION(graphene::chain::custom_authority_object)
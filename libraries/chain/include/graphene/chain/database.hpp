@@ -23,16 +23,21 @@
  */
 #pragma once
 
+#include <graphene/protocol/authority_check_cache.hpp>
 #include <graphene/protocol/fee_schedule.hpp>
 
 #include <graphene/chain/global_property_object.hpp>
 #include <graphene/chain/node_property_object.hpp>
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/custom_authority_object.hpp>
 #include <graphene/chain/fork_database.hpp>
 #include <graphene/chain/block_database.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/evaluator.hpp>
+#include <graphene/chain/block_candidate.hpp>
+#include <graphene/chain/transaction_admission.hpp>
+#include <graphene/chain/transaction_history_object.hpp>
 
 #include <graphene/db/object_database.hpp>
 #include <graphene/db/object.hpp>
@@ -135,7 +140,10 @@ namespace graphene { namespace chain {
          block_id_type              get_block_id_for_num( uint32_t block_num )const;
          optional<signed_block>     fetch_block_by_id( const block_id_type& id )const;
          optional<signed_block>     fetch_block_by_number( uint32_t num )const;
+         /// @throws fc::key_not_found_exception if the transaction is unknown or no longer cached
          const signed_transaction&  get_recent_transaction( const transaction_id_type& trx_id )const;
+         /// @return the transaction if it is known and still cached, otherwise nullptr
+         const signed_transaction*  find_recent_transaction( const transaction_id_type& trx_id )const;
          std::vector<block_id_type> get_block_ids_on_fork(block_id_type head_of_fork) const;
 
          /**
@@ -168,8 +176,43 @@ namespace graphene { namespace chain {
             const fc::ecc::private_key& block_signing_private_key
             );
 
+         /**
+          * Assemble a @ref block_candidate while transactions are pushed to the pending state, so that
+          * @ref generate_block only has to finalize and sign it. This costs a merkle digest per pushed transaction,
+          * so it should only be enabled on nodes which produce blocks.
+          */
+         void enable_block_candidate( bool enable );
+         /// @return how the most recent block was produced by @ref generate_block
+         const block_production_info& get_last_block_production_info()const { return _last_block_production; }
+         /**
+          * Limit the time @ref generate_block spends to re-apply pending transactions. Transactions which are left
+          * when it is used up stay pending for the next block. Zero means no limit.
+          */
+         void set_block_assembly_time_budget( const fc::microseconds& budget )
+         { _block_assembly_time_budget = budget; }
+
          void pop_block();
          void clear_pending();
+         /**
+          * Re-apply formerly pending transactions in the given order. Since a transaction can depend on one which
+          * has been sorted after it, failed transactions are retried as long as the previous pass made progress.
+          */
+         void reapply_pending_transactions( std::vector< processed_transaction >&& pending );
+
+         /// Node-local admission control of pending transactions, see @ref transaction_admission_controller
+         ///@{
+         transaction_admission_controller&       admission_controller()       { return _admission; }
+         const transaction_admission_controller& admission_controller()const { return _admission; }
+
+         /// Cache of the bodies of transactions recently pushed to this node, see @ref get_recent_transaction
+         recent_transaction_cache&               recent_transactions()       { return _recent_transactions; }
+
+         /// Compiled custom authority predicates, shared by identical custom authorities
+         custom_authority_predicate_cache&       custom_authority_predicates()const { return _custom_authority_predicates; }
+
+         /// Memoized account authority checks of the transactions in the current block or pending state
+         authority_check_cache&                  authority_checks()       { return _authority_checks; }
+         ///@}
 
          /**
           *  This method is used to track appied operations during the evaluation of a block, these
@@ -518,6 +561,18 @@ namespace graphene { namespace chain {
          /// Enable or disable tracking of votes of standby witnesses and committee members
          inline void enable_standby_votes_tracking(bool enable)  { _track_standby_votes = enable; }
 
+         /**
+          * Enable or disable the state hash over all consensus objects, see @ref object_database::enable_state_hash.
+          * The operation history and the transaction dupe check objects are left out, since they depend on plugins
+          * and on the replay mode. When enabled, the state hash is recorded and checked after every maintenance
+          * interval.
+          */
+         void enable_state_hash( bool enable );
+         /// State hashes recorded after the most recent maintenance intervals, by block number
+         const flat_map<uint32_t,fc::sha256>& get_state_hash_history()const { return _state_hash_history; }
+         /// Expected state hashes after the maintenance intervals in the given blocks, a mismatch is logged
+         void add_state_hash_checkpoints( const flat_map<uint32_t,fc::sha256>& checkpoints );
+
          /** Precomputes digests, signatures and operation validations depending
           *  on skip flags. "Expensive" computations may be done in a parallel
           *  thread.
@@ -546,7 +601,7 @@ namespace graphene { namespace chain {
          void pop_undo() { object_database::pop_undo(); }
          void notify_applied_block( const signed_block& block );
          void notify_on_pending_transaction( const signed_transaction& tx );
-         void notify_changed_objects();
+         void notify_changed_objects( const signed_block& block );
 
       private:
          optional<undo_database::session>       _pending_tx_session;
@@ -576,6 +631,8 @@ namespace graphene { namespace chain {
          void verify_signing_witness( const signed_block& new_block, const fork_item& fork_entry )const;
          void update_witnesses( fork_item& fork_entry )const;
          void create_block_summary(const signed_block& next_block);
+         void update_block_candidate( const processed_transaction& trx, transaction_lane lane, uint64_t fee_density );
+         void check_state_hash( uint32_t block_num );
 
          //////////////////// db_witness_schedule.cpp ////////////////////
 
@@ -620,6 +677,12 @@ namespace graphene { namespace chain {
          ///@}
 
          vector< processed_transaction >        _pending_tx;
+         transaction_admission_controller       _admission;
+         recent_transaction_cache               _recent_transactions;
+         mutable custom_authority_predicate_cache _custom_authority_predicates;
+         authority_check_cache                  _authority_checks;
+         block_candidate                        _block_candidate;
+         block_production_info                  _last_block_production;
          fork_database                          _fork_db;
 
          /**
@@ -653,6 +716,8 @@ namespace graphene { namespace chain {
                                                                    // as in vote_id_type::vote_type
 
          flat_map<uint32_t,block_id_type>  _checkpoints;
+         flat_map<uint32_t,fc::sha256>     _state_hash_checkpoints;
+         flat_map<uint32_t,fc::sha256>     _state_hash_history;
 
          node_property_object              _node_property_object;
 
@@ -660,6 +725,10 @@ namespace graphene { namespace chain {
          /// Set it to true to provide accurate data to API clients, set to false to have better performance.
          bool                              _track_standby_votes = true;
 
+         /// Whether to assemble the next block while transactions are pushed
+         bool                              _maintain_block_candidate = false;
+         fc::microseconds                  _block_assembly_time_budget;
+
          /**
           * Whether database is successfully opened or not.
           *
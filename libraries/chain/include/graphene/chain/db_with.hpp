@@ -71,6 +71,8 @@ struct pending_transactions_restorer
    pending_transactions_restorer( database& db, std::vector<processed_transaction>&& pending_transactions )
       : _db(db), _pending_transactions( std::move(pending_transactions) )
    {
+      // drop evicted transactions and re-apply the most important ones first
+      _db.admission_controller().prioritize( _pending_transactions );
       _db.clear_pending();
    }
 
@@ -86,18 +88,7 @@ struct pending_transactions_restorer
          }
       }
       _db._popped_tx.clear();
-      for( const processed_transaction& tx : _pending_transactions )
-      {
-         try
-         {
-            if( !_db.is_known_transaction( tx.id() ) ) {
-               _db._push_transaction( tx );
-            }
-         }
-         catch( const fc::exception& )
-         { // ignore invalid transactions
-         }
-      }
+      _db.reapply_pending_transactions( std::move(_pending_transactions) );
    }
 
    database& _db;
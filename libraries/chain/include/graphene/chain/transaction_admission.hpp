@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/chain/types.hpp>
+#include <graphene/protocol/transaction.hpp>
+
+#include <graphene/utilities/token_bucket.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <tuple>
+
+namespace graphene { namespace chain {
+
+   class database;
+
+   /**
+    * Pending transactions are sorted into lanes. Transactions in a lower-numbered lane are always applied and
+    * included in blocks before transactions in a higher-numbered lane, and a part of the mempool can be reserved
+    * for the priority lane so that it can not be crowded out by spam.
+    */
+   enum class transaction_lane : uint8_t
+   {
+      priority = 0, ///< transactions which only contain feed publishes and order cancellations
+      normal   = 1
+   };
+
+   /// Node-local admission limits. A value of zero means "no limit".
+   struct transaction_admission_parameters
+   {
+      /// Number of transactions per second an account can push as fee payer of the first operation
+      uint32_t account_trx_per_second  = 0;
+      /// Number of transactions an account can push at once after being idle
+      uint32_t account_trx_burst       = 0;
+      /// Maximum number of pending transactions
+      uint32_t max_pending_transactions = 0;
+      /// Number of pending transaction slots which can only be used by the priority lane
+      uint32_t priority_lane_reserved  = 0;
+   };
+
+   /// Counters exported for monitoring
+   struct transaction_admission_statistics
+   {
+      uint32_t pending_priority      = 0; ///< current number of pending transactions in the priority lane
+      uint32_t pending_normal        = 0; ///< current number of pending transactions in the normal lane
+      uint64_t accepted              = 0;
+      uint64_t rejected_rate_limited = 0;
+      uint64_t rejected_mempool_full = 0;
+      uint64_t evicted               = 0;
+   };
+
+   /**
+    * @brief Decides whether a new transaction can enter the pending transaction pool and in which order pending
+    * transactions are applied
+    *
+    * The controller sits in front of @ref database::push_transaction. It rate-limits accounts with a token bucket
+    * per fee-paying account, keeps track of the fee density (core fee per kilobyte of packed transaction) of every
+    * pending transaction, and keeps the mempool bounded by evicting the pending transaction with the lowest fee
+    * density when a better one arrives.
+    *
+    * All of this is node-local policy, it does not affect consensus.
+    */
+   class transaction_admission_controller
+   {
+   public:
+      struct pending_entry
+      {
+         transaction_id_type trx_id;
+         transaction_lane    lane;
+         uint64_t            fee_density = 0;
+         uint64_t            sequence = 0;
+      };
+
+      struct by_trx_id;
+      struct by_priority;
+      typedef boost::multi_index_container<
+         pending_entry,
+         boost::multi_index::indexed_by<
+            boost::multi_index::hashed_unique< boost::multi_index::tag<by_trx_id>,
+               boost::multi_index::member< pending_entry, transaction_id_type, &pending_entry::trx_id >,
+               std::hash<transaction_id_type> >,
+            boost::multi_index::ordered_unique< boost::multi_index::tag<by_priority>,
+               boost::multi_index::composite_key< pending_entry,
+                  boost::multi_index::member< pending_entry, transaction_lane, &pending_entry::lane >,
+                  boost::multi_index::member< pending_entry, uint64_t, &pending_entry::fee_density >,
+                  boost::multi_index::member< pending_entry, uint64_t, &pending_entry::sequence >
+               >,
+               boost::multi_index::composite_key_compare<
+                  std::less< transaction_lane >,
+                  std::greater< uint64_t >,
+                  std::less< uint64_t >
+               >
+            >
+         >
+      > pending_index_type;
+
+      void set_parameters( const transaction_admission_parameters& params ) { _params = params; }
+      const transaction_admission_parameters& get_parameters()const { return _params; }
+
+      transaction_admission_statistics get_statistics()const;
+
+      /// @return the lane the given transaction belongs to
+      static transaction_lane classify( const transaction& trx );
+
+      /// @return the fee paid by the transaction in core asset per kilobyte of its packed size
+      static uint64_t calculate_fee_density( const database& db, const precomputable_transaction& trx );
+
+      /**
+       * Check that the account paying the fee of the first operation has a token left. The token is not taken,
+       * so that transactions which turn out to be invalid do not count against the rate of the fee payer.
+       * @throws transaction_rate_limited if the account has exceeded its rate
+       */
+      void check_rate( const transaction& trx, const fc::time_point& now );
+
+      /// Take a token from the bucket of the fee payer of a transaction which has been accepted
+      void charge_rate( const transaction& trx, const fc::time_point& now );
+
+      /**
+       * Check whether a transaction could enter the mempool.
+       * @return the id of the pending transaction which has to be evicted to make room, if any
+       * @throws mempool_full if there is no room and nothing can be evicted in favor of the new transaction
+       */
+      optional<transaction_id_type> make_room( transaction_lane lane, uint64_t fee_density );
+
+      /// Record a transaction which has been successfully added to the pending state
+      void on_pending( const transaction_id_type& trx_id, transaction_lane lane, uint64_t fee_density );
+
+      /// Count a transaction which has been pushed to this node and accepted into the pending state
+      void on_accepted() { ++_stats.accepted; }
+
+      /// Forget a transaction which has been evicted in favor of a better one
+      void on_evicted( const transaction_id_type& trx_id );
+
+      /// Forget all pending transactions
+      void clear_pending();
+
+      /**
+       * Drop evicted transactions from @p pending and sort the remaining ones into the order in which they should
+       * be applied: priority lane first, then by descending fee density, then by arrival.
+       * @p pending can hold transactions or pointers to transactions.
+       */
+      template<typename T>
+      void prioritize( vector<T>& pending )const
+      {
+         const auto& idx = _pending.get<by_trx_id>();
+         vector< std::pair< std::tuple< transaction_lane, uint64_t, uint64_t >, size_t > > keys;
+         keys.reserve( pending.size() );
+         for( size_t i = 0; i < pending.size(); ++i )
+         {
+            auto itr = idx.find( get_transaction( pending[i] ).id() );
+            if( itr != idx.end() )
+               keys.emplace_back( std::make_tuple( itr->lane, std::numeric_limits<uint64_t>::max() - itr->fee_density,
+                                                   itr->sequence ), i );
+         }
+         std::sort( keys.begin(), keys.end() );
+         vector<T> result;
+         result.reserve( keys.size() );
+         for( const auto& key : keys )
+            result.push_back( std::move( pending[key.second] ) );
+         pending = std::move( result );
+      }
+
+   private:
+      static const transaction& get_transaction( const transaction& trx ) { return trx; }
+      static const transaction& get_transaction( const transaction* trx ) { return *trx; }
+
+      void prune_idle_buckets( const fc::time_point& now );
+
+      transaction_admission_parameters                               _params;
+      transaction_admission_statistics                               _stats;
+      pending_index_type                                             _pending;
+      uint32_t                                                       _pending_priority_count = 0;
+      uint64_t                                                       _next_sequence = 0;
+      std::map< account_id_type, graphene::utilities::token_bucket > _account_buckets;
+      fc::time_point                                                 _last_prune;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT_ENUM( graphene::chain::transaction_lane, (priority)(normal) )
+
+FC_REFLECT( graphene::chain::transaction_admission_parameters,
+            (account_trx_per_second)(account_trx_burst)(max_pending_transactions)(priority_lane_reserved) )
+
+FC_REFLECT( graphene::chain::transaction_admission_statistics,
+            (pending_priority)(pending_normal)(accepted)(rejected_rate_limited)(rejected_mempool_full)(evicted) )
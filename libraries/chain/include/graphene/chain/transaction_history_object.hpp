@@ -32,6 +32,9 @@
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/mem_fun.hpp>
 
+#include <deque>
+#include <unordered_map>
+
 namespace graphene { namespace chain {
    using namespace graphene::db;
    using boost::multi_index_container;
@@ -40,6 +43,9 @@ namespace graphene { namespace chain {
     * The purpose of this object is to enable the detection of duplicate transactions. When a transaction is included
     * in a block a transaction_history_object is added. At the end of block processing all transaction_history_objects that
     * have expired can be removed from the index.
+    *
+    * Only the id and the expiration of the transaction are kept. Transactions pushed to this node can be found in
+    * the @ref recent_transaction_cache for a while.
     */
    class transaction_history_object : public abstract_object<transaction_history_object>
    {
@@ -47,10 +53,8 @@ namespace graphene { namespace chain {
          static constexpr uint8_t space_id = implementation_ids;
          static constexpr uint8_t type_id  = impl_transaction_history_object_type;
 
-         signed_transaction  trx;
          transaction_id_type trx_id;
-
-         time_point_sec get_expiration()const { return trx.expiration; }
+         time_point_sec      expiration;
    };
 
    struct by_expiration;
@@ -61,12 +65,69 @@ namespace graphene { namespace chain {
          ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
          hashed_unique< tag<by_trx_id>, BOOST_MULTI_INDEX_MEMBER(transaction_history_object, transaction_id_type, trx_id),
                         std::hash<transaction_id_type> >,
-         ordered_non_unique< tag<by_expiration>, const_mem_fun< transaction_history_object, time_point_sec,
-                                                                &transaction_history_object::get_expiration > >
+         ordered_non_unique< tag<by_expiration>,
+                             member< transaction_history_object, time_point_sec, &transaction_history_object::expiration > >
       >
    > transaction_multi_index_type;
 
    typedef generic_index<transaction_history_object, transaction_multi_index_type> transaction_index;
+
+   /**
+    * @brief A bounded cache of the transactions most recently pushed to the pending state
+    *
+    * It serves @ref database::get_recent_transaction, e.g. for peers fetching a transaction which this node has
+    * advertised. Transactions which are only applied as part of a block are not cached, peers get them with the
+    * block. It is node-local and not affected by undo, so a transaction must also be found in the
+    * @ref transaction_index to be considered known. When it is full, the oldest transaction is dropped.
+    */
+   class recent_transaction_cache
+   {
+   public:
+      /// @param capacity maximum number of transactions kept, 0 disables the cache
+      void set_capacity( size_t capacity )
+      {
+         _capacity = capacity;
+         shrink();
+      }
+      size_t get_capacity()const { return _capacity; }
+      size_t size()const { return _transactions.size(); }
+
+      void insert( const transaction_id_type& trx_id, const signed_transaction& trx )
+      {
+         if( _capacity == 0 || _transactions.find( trx_id ) != _transactions.end() )
+            return;
+         _transactions.emplace( trx_id, trx );
+         _order.push_back( trx_id );
+         shrink();
+      }
+
+      const signed_transaction* find( const transaction_id_type& trx_id )const
+      {
+         auto itr = _transactions.find( trx_id );
+         return itr == _transactions.end() ? nullptr : &itr->second;
+      }
+
+      void clear()
+      {
+         _transactions.clear();
+         _order.clear();
+      }
+
+   private:
+      void shrink()
+      {
+         while( _order.size() > _capacity )
+         {
+            _transactions.erase( _order.front() );
+            _order.pop_front();
+         }
+      }
+
+      size_t                                                                            _capacity = 10000;
+      std::unordered_map< transaction_id_type, signed_transaction, std::hash<transaction_id_type> > _transactions;
+      /// insertion order, oldest first
+      std::deque< transaction_id_type >                                                 _order;
+   };
 } }
 
 MAP_OBJECT_ID_TO_TYPE(graphene::chain::transaction_history_object)
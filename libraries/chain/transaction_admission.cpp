@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <graphene/chain/transaction_admission.hpp>
+
+#include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/exceptions.hpp>
+
+namespace graphene { namespace chain {
+
+namespace detail {
+
+   struct operation_fee_payer_visitor
+   {
+      using result_type = account_id_type;
+      template<typename Op>
+      account_id_type operator()( const Op& op )const { return op.fee_payer(); }
+   };
+
+   struct operation_fee_visitor
+   {
+      using result_type = asset;
+      template<typename Op>
+      asset operator()( const Op& op )const { return op.fee; }
+   };
+
+   struct operation_is_priority_visitor
+   {
+      using result_type = bool;
+      template<typename Op>
+      bool operator()( const Op& )const { return false; }
+      bool operator()( const asset_publish_feed_operation& )const { return true; }
+      bool operator()( const limit_order_cancel_operation& )const { return true; }
+   };
+
+} // detail
+
+transaction_admission_statistics transaction_admission_controller::get_statistics()const
+{
+   transaction_admission_statistics result = _stats;
+   result.pending_priority = _pending_priority_count;
+   result.pending_normal = _pending.size() - _pending_priority_count;
+   return result;
+}
+
+transaction_lane transaction_admission_controller::classify( const transaction& trx )
+{
+   if( trx.operations.empty() )
+      return transaction_lane::normal;
+   for( const auto& op : trx.operations )
+   {
+      if( !op.visit( detail::operation_is_priority_visitor() ) )
+         return transaction_lane::normal;
+   }
+   return transaction_lane::priority;
+}
+
+uint64_t transaction_admission_controller::calculate_fee_density( const database& db,
+                                                                  const precomputable_transaction& trx )
+{
+   fc::uint128_t total_core_fee = 0;
+   for( const auto& op : trx.operations )
+   {
+      const asset fee = op.visit( detail::operation_fee_visitor() );
+      if( fee.amount <= 0 )
+         continue;
+      if( fee.asset_id == asset_id_type() )
+      {
+         total_core_fee += fee.amount.value;
+         continue;
+      }
+      const asset_object* fee_asset = db.find( fee.asset_id );
+      if( fee_asset == nullptr )
+         continue;
+      const price& cer = fee_asset->options.core_exchange_rate;
+      if( cer.base.amount <= 0 || cer.quote.amount <= 0 )
+         continue;
+      try
+      {
+         total_core_fee += ( fee * cer ).amount.value;
+      }
+      catch( const fc::exception& )
+      { // a malformed rate makes the fee worthless for prioritization
+      }
+   }
+   const uint64_t packed_size = std::max<uint64_t>( trx.get_packed_size(), 1 );
+   const fc::uint128_t density = total_core_fee * 1024 / packed_size;
+   if( density > std::numeric_limits<uint64_t>::max() )
+      return std::numeric_limits<uint64_t>::max();
+   return static_cast<uint64_t>( density );
+}
+
+void transaction_admission_controller::check_rate( const transaction& trx, const fc::time_point& now )
+{
+   if( _params.account_trx_per_second == 0 || trx.operations.empty() )
+      return;
+
+   prune_idle_buckets( now );
+
+   const account_id_type payer = trx.operations.front().visit( detail::operation_fee_payer_visitor() );
+   if( !_account_buckets[payer].has_token( now, _params.account_trx_per_second, _params.account_trx_burst ) )
+   {
+      ++_stats.rejected_rate_limited;
+      FC_THROW_EXCEPTION( transaction_rate_limited,
+                          "Account ${a} exceeded the rate of ${r} transactions per second accepted by this node",
+                          ("a",payer)("r",_params.account_trx_per_second) );
+   }
+}
+
+void transaction_admission_controller::charge_rate( const transaction& trx, const fc::time_point& now )
+{
+   if( _params.account_trx_per_second == 0 || trx.operations.empty() )
+      return;
+
+   const account_id_type payer = trx.operations.front().visit( detail::operation_fee_payer_visitor() );
+   _account_buckets[payer].consume( now, _params.account_trx_per_second, _params.account_trx_burst );
+}
+
+void transaction_admission_controller::prune_idle_buckets( const fc::time_point& now )
+{
+   if( now - _last_prune < fc::seconds(60) )
+      return;
+   _last_prune = now;
+   for( auto itr = _account_buckets.begin(); itr != _account_buckets.end(); )
+   {
+      if( itr->second.is_idle( now, _params.account_trx_per_second, _params.account_trx_burst ) )
+         itr = _account_buckets.erase( itr );
+      else
+         ++itr;
+   }
+}
+
+optional<transaction_id_type> transaction_admission_controller::make_room( transaction_lane lane,
+                                                                           uint64_t fee_density )
+{
+   optional<transaction_id_type> result;
+   if( _params.max_pending_transactions == 0 )
+      return result;
+
+   const auto& idx = _pending.get<by_priority>();
+   const uint32_t reserved = std::min( _params.priority_lane_reserved, _params.max_pending_transactions );
+   const size_t normal_count = idx.size() - _pending_priority_count;
+
+   const bool full = ( idx.size() >= _params.max_pending_transactions );
+   const bool normal_full = ( lane == transaction_lane::normal
+                              && normal_count >= _params.max_pending_transactions - reserved );
+   if( !full && !normal_full )
+      return result;
+
+   // The worst pending transaction is the last one in the normal lane. Priority lane transactions are never evicted.
+   if( normal_count > 0 )
+   {
+      const pending_entry& worst = *idx.rbegin();
+      FC_ASSERT( worst.lane == transaction_lane::normal );
+      if( lane == transaction_lane::priority || worst.fee_density < fee_density )
+      {
+         result = worst.trx_id;
+         return result;
+      }
+   }
+
+   ++_stats.rejected_mempool_full;
+   FC_THROW_EXCEPTION( mempool_full,
+                       "The pending transaction pool of this node is full and the transaction does not pay a higher "
+                       "fee density than any pending transaction",
+                       ("lane",lane)("fee_density",fee_density)("max_pending",_params.max_pending_transactions) );
+}
+
+void transaction_admission_controller::on_pending( const transaction_id_type& trx_id, transaction_lane lane,
+                                                   uint64_t fee_density )
+{
+   pending_entry entry;
+   entry.trx_id = trx_id;
+   entry.lane = lane;
+   entry.fee_density = fee_density;
+   entry.sequence = _next_sequence++;
+   if( _pending.insert( entry ).second && lane == transaction_lane::priority )
+      ++_pending_priority_count;
+}
+
+void transaction_admission_controller::on_evicted( const transaction_id_type& trx_id )
+{
+   auto& idx = _pending.get<by_trx_id>();
+   auto itr = idx.find( trx_id );
+   if( itr == idx.end() )
+      return;
+   if( itr->lane == transaction_lane::priority )
+      --_pending_priority_count;
+   idx.erase( itr );
+   ++_stats.evicted;
+}
+
+void transaction_admission_controller::clear_pending()
+{
+   _pending.clear();
+   _pending_priority_count = 0;
+}
+
+} } // graphene::chain
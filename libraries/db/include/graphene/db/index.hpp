@@ -166,6 +166,9 @@ namespace graphene { namespace db {
          /** called just after obj is modified */
          void on_modify( const object& obj );
 
+         /** called after modifying an object failed, with the object as it has been left */
+         void on_modify_failed( const object& obj );
+
          template<typename T, typename... Args>
          T* add_secondary_index(Args... args)
          {
@@ -416,7 +419,18 @@ namespace graphene { namespace db {
             save_undo( obj );
             for( const auto& item : _sindex )
                item->about_to_modify( obj );
-            DerivedIndex::modify( obj, m );
+            const object_id_type id = obj.id;
+            try
+            {
+               DerivedIndex::modify( obj, m );
+            }
+            catch( ... )
+            {
+               // save_undo() took the object out of the state hash, put it back unless the index dropped it
+               if( const object* left = DerivedIndex::find( id ) )
+                  on_modify_failed( *left );
+               throw;
+            }
             for( const auto& item : _sindex )
                item->object_modified( obj );
             on_modify( obj );
@@ -24,6 +24,7 @@
 #pragma once
 #include <graphene/db/object.hpp>
 #include <graphene/db/index.hpp>
+#include <graphene/db/state_hash.hpp>
 #include <graphene/db/undo_database.hpp>
 
 #include <fc/log/logger.hpp>
@@ -151,6 +152,20 @@ namespace graphene { namespace db {
 
          void pop_undo();
 
+         /**
+          * Enable or disable the state hash, a commitment to the objects in the database. Enabling it hashes all
+          * objects once, after that it is updated whenever an object is created, modified or removed, including by
+          * undo. See @ref state_hash_accumulator.
+          *
+          * @param filter if set, only object types for which it returns true are part of the state hash
+          */
+         void enable_state_hash( bool enable, std::function<bool(uint8_t space, uint8_t type)> filter = {} );
+         bool is_state_hash_enabled()const { return _state_hash_enabled; }
+         /// @return the combined state hash of all included object types
+         fc::sha256 get_state_hash()const;
+         /// @return the state hash of every object type which has objects, to locate a divergence
+         std::map< std::pair<uint8_t,uint8_t>, fc::sha256 > get_index_state_hashes()const;
+
          fc::path get_data_dir()const { return _data_dir; }
 
          /** public for testing purposes only... should be private in practice. */
@@ -173,9 +188,23 @@ namespace graphene { namespace db {
          void save_undo( const object& obj );
          void save_undo_add( const object& obj );
          void save_undo_remove( const object& obj );
+         void on_modified( const object& obj );
+
+         struct state_hash_slot
+         {
+            bool                   known = false;
+            bool                   included = false;
+            state_hash_accumulator hash;
+         };
+         /// @return the state hash of the type of @p id, or nullptr if it is not included
+         state_hash_accumulator* find_state_hash( const object_id_type& id );
+         void rebuild_state_hash();
 
          fc::path                                                  _data_dir;
          vector< vector< unique_ptr<index> > >                     _index;
+         bool                                                      _state_hash_enabled = false;
+         std::function<bool(uint8_t,uint8_t)>                      _state_hash_filter;
+         vector< vector< state_hash_slot > >                       _state_hashes;
    };
 
 } } // graphene::db
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <graphene/db/object.hpp>
+
+#include <fc/crypto/sha256.hpp>
+
+#include <array>
+
+namespace graphene { namespace db {
+
+   /**
+    * @brief An incremental hash of a multiset of objects
+    *
+    * The hash is the lane-wise sum, modulo 2^64, of the SHA-256 digests of the packed objects. Adding or removing an
+    * object updates it in constant time, and the result does not depend on the order of the updates, so two
+    * databases holding the same objects have the same hash no matter how they got there.
+    */
+   class state_hash_accumulator
+   {
+      public:
+         void add( const object& obj );
+         void remove( const object& obj );
+
+         /// @return the number of objects in the multiset
+         uint64_t size()const { return _count; }
+
+         /// @return the hash of the multiset, all zero if it is empty
+         fc::sha256 result()const;
+
+      private:
+         std::array<uint64_t,4> _sum = {};
+         uint64_t               _count = 0;
+   };
+
+} } // graphene::db
@@ -39,5 +39,8 @@ namespace graphene { namespace db {
    { _db.save_undo_remove( obj ); for( auto ob : _observers ) ob->on_remove( obj ); }
 
    void base_primary_index::on_modify( const object& obj )
-   {for( auto ob : _observers ) ob->on_modify(  obj ); }
+   { _db.on_modified( obj ); for( auto ob : _observers ) ob->on_modify(  obj ); }
+
+   void base_primary_index::on_modify_failed( const object& obj )
+   { _db.on_modified( obj ); }
 } } // graphene::chain
@@ -120,6 +120,9 @@ void object_database::open(const fc::path& data_dir)
             } ) );
    for( auto& task : tasks )
       task.wait();
+   // objects loaded from disk bypass the change notifications
+   if( _state_hash_enabled )
+      rebuild_state_hash();
    ilog( "Done opening object database." );
 
 } FC_CAPTURE_AND_RETHROW( (data_dir) ) }
@@ -132,17 +135,102 @@ void object_database::pop_undo()
 
 void object_database::save_undo( const object& obj )
 {
+   if( _state_hash_enabled )
+   {
+      if( auto* hash = find_state_hash( obj.id ) )
+         hash->remove( obj );
+   }
    _undo_db.on_modify( obj );
 }
 
 void object_database::save_undo_add( const object& obj )
 {
+   if( _state_hash_enabled )
+   {
+      if( auto* hash = find_state_hash( obj.id ) )
+         hash->add( obj );
+   }
    _undo_db.on_create( obj );
 }
 
 void object_database::save_undo_remove(const object& obj)
 {
+   if( _state_hash_enabled )
+   {
+      if( auto* hash = find_state_hash( obj.id ) )
+         hash->remove( obj );
+   }
    _undo_db.on_remove( obj );
 }
 
+void object_database::on_modified( const object& obj )
+{
+   if( _state_hash_enabled )
+   {
+      if( auto* hash = find_state_hash( obj.id ) )
+         hash->add( obj );
+   }
+}
+
+void object_database::enable_state_hash( bool enable, std::function<bool(uint8_t,uint8_t)> filter )
+{
+   _state_hash_enabled = enable;
+   _state_hash_filter = std::move( filter );
+   _state_hashes.clear();
+   if( enable )
+      rebuild_state_hash();
+}
+
+state_hash_accumulator* object_database::find_state_hash( const object_id_type& id )
+{
+   const uint8_t space = id.space();
+   const uint8_t type = id.type();
+   if( _state_hashes.size() <= space )
+      _state_hashes.resize( space + 1 );
+   auto& by_type = _state_hashes[space];
+   if( by_type.size() <= type )
+      by_type.resize( type + 1 );
+   auto& slot = by_type[type];
+   if( !slot.known )
+   {
+      slot.known = true;
+      slot.included = !_state_hash_filter || _state_hash_filter( space, type );
+   }
+   return slot.included ? &slot.hash : nullptr;
+}
+
+void object_database::rebuild_state_hash()
+{
+   _state_hashes.clear();
+   for( uint32_t space = 0; space < _index.size(); ++space )
+      for( uint32_t type = 0; type < _index[space].size(); ++type )
+      {
+         if( !_index[space][type] )
+            continue;
+         auto* hash = find_state_hash( object_id_type( space, type, 0 ) );
+         if( hash != nullptr )
+            _index[space][type]->inspect_all_objects( [hash]( const object& o ) { hash->add( o ); } );
+      }
+}
+
+fc::sha256 object_database::get_state_hash()const
+{
+   FC_ASSERT( _state_hash_enabled, "The state hash is not enabled" );
+   fc::sha256::encoder enc;
+   for( const auto& item : get_index_state_hashes() )
+      fc::raw::pack( enc, item );
+   return enc.result();
+}
+
+std::map< std::pair<uint8_t,uint8_t>, fc::sha256 > object_database::get_index_state_hashes()const
+{
+   FC_ASSERT( _state_hash_enabled, "The state hash is not enabled" );
+   std::map< std::pair<uint8_t,uint8_t>, fc::sha256 > result;
+   for( uint32_t space = 0; space < _state_hashes.size(); ++space )
+      for( uint32_t type = 0; type < _state_hashes[space].size(); ++type )
+         if( _state_hashes[space][type].included && _state_hashes[space][type].hash.size() > 0 )
+            result[ std::make_pair( uint8_t(space), uint8_t(type) ) ] = _state_hashes[space][type].hash.result();
+   return result;
+}
+
 } } // namespace graphene::db
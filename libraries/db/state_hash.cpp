@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/db/state_hash.hpp>
+
+namespace graphene { namespace db {
+
+namespace {
+   fc::sha256 object_digest( const object& obj )
+   {
+      const vector<char> packed = obj.pack();
+      return fc::sha256::hash( packed.data(), packed.size() );
+   }
+}
+
+void state_hash_accumulator::add( const object& obj )
+{
+   const fc::sha256 digest = object_digest( obj );
+   for( size_t i = 0; i < _sum.size(); ++i )
+      _sum[i] += digest._hash[i].value();
+   ++_count;
+}
+
+void state_hash_accumulator::remove( const object& obj )
+{
+   const fc::sha256 digest = object_digest( obj );
+   for( size_t i = 0; i < _sum.size(); ++i )
+      _sum[i] -= digest._hash[i].value();
+   --_count;
+}
+
+fc::sha256 state_hash_accumulator::result()const
+{
+   fc::sha256 result;
+   for( size_t i = 0; i < _sum.size(); ++i )
+      result._hash[i] = _sum[i];
+   return result;
+}
+
+} } // graphene::db
@@ -28,6 +28,8 @@
 #include <graphene/net/message_oriented_connection.hpp>
 #include <graphene/net/config.hpp>
 
+#include <graphene/utilities/token_bucket.hpp>
+
 #include <boost/tuple/tuple.hpp>
 
 #include <boost/multi_index_container.hpp>
@@ -169,6 +171,8 @@ namespace graphene { namespace net
       fc::future<void> _send_queued_messages_done;
     public:
       fc::time_point connection_initiation_time;
+      fc::time_point connection_activated_time; ///< when the handshake completed and the peer became active
+      bool connection_uptime_recorded = false; ///< whether the uptime has been added to the peer database already
       fc::time_point connection_closed_time;
       fc::time_point connection_terminated_time;
       peer_connection_direction direction = peer_connection_direction::unknown;
@@ -258,6 +262,9 @@ namespace graphene { namespace net
       // blockchain catch up
       fc::time_point transaction_fetching_inhibited_until;
 
+      /// bounds the rate of transactions we accept from this peer
+      graphene::utilities::token_bucket transaction_rate_bucket;
+
       uint32_t last_known_fork_block_number = 0;
 
       fc::future<void> accept_or_connect_task_done;
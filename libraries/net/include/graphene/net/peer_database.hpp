@@ -54,6 +54,15 @@ namespace graphene { namespace net {
     uint32_t                          number_of_failed_connection_attempts;
     fc::optional<fc::exception>       last_error;
 
+    /// moving average of the round trip delay measured with time requests, 0 if it has never been measured
+    uint32_t                          average_latency_ms = 0;
+    /// total time we have spent connected to this peer
+    uint64_t                          total_connected_seconds = 0;
+    /// number of times we have caught up with the peer's blockchain while syncing from it
+    uint32_t                          number_of_successful_syncs = 0;
+    /// number of times we have disconnected the peer because it misbehaved
+    uint32_t                          number_of_protocol_errors = 0;
+
     potential_peer_record() :
       number_of_successful_connection_attempts(0),
     number_of_failed_connection_attempts(0){}
@@ -67,6 +76,16 @@ namespace graphene { namespace net {
       number_of_successful_connection_attempts(0),
       number_of_failed_connection_attempts(0)
     {}  
+
+    /// fold a new round trip delay measurement into @ref average_latency_ms
+    void record_round_trip_delay(const fc::microseconds& round_trip_delay);
+
+    /**
+     * @return a quality score for this peer, higher is better.  It rewards reliable connections, long uptime and
+     * successful syncs, and penalizes protocol errors and high latency.  It does not depend on the current time,
+     * so it can be used as an index key.
+     */
+    int64_t score() const;
   };
 
   namespace detail
@@ -99,6 +118,11 @@ namespace graphene { namespace net {
     peer_database();
     ~peer_database();
 
+    /**
+     * Load the peer database from a binary file.  Changes made afterwards are appended to that file in batches,
+     * and the file is compacted when it is opened and closed.  If the file does not exist yet, the JSON
+     * database written by older versions (the same file name with a ".json" extension) is imported.
+     */
     void open(const fc::path& databaseFilename);
     void close();
     void clear();
@@ -109,6 +133,7 @@ namespace graphene { namespace net {
     potential_peer_record lookup_or_create_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup);
     fc::optional<potential_peer_record> lookup_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup);
 
+    /// iterates over the peers from the highest to the lowest @ref potential_peer_record::score
     typedef detail::peer_database_iterator iterator;
     iterator begin() const;
     iterator end() const;
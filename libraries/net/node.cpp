@@ -320,7 +320,8 @@ namespace graphene { namespace net { namespace detail {
       _node_is_shutting_down(false),
       _maximum_number_of_blocks_to_handle_at_one_time(MAXIMUM_NUMBER_OF_BLOCKS_TO_HANDLE_AT_ONE_TIME),
       _maximum_number_of_sync_blocks_to_prefetch(MAXIMUM_NUMBER_OF_BLOCKS_TO_PREFETCH),
-      _maximum_blocks_per_peer_during_syncing(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING)
+      _maximum_blocks_per_peer_during_syncing(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING),
+      _maximum_transactions_per_second_per_peer(GRAPHENE_NET_MAX_TRX_PER_SECOND)
     {
       _rate_limiter.set_actual_rate_time_constant(fc::seconds(2));
       fc::rand_bytes((char*) _node_id.data(), (int)_node_id.size());
@@ -335,19 +336,7 @@ namespace graphene { namespace net { namespace detail {
       {
          fc::scoped_lock<fc::mutex> lock(_active_connections.get_mutex());
          for (const peer_connection_ptr& active_peer : _active_connections)
-         {
-            fc::optional<fc::ip::endpoint> inbound_endpoint = active_peer->get_endpoint_for_connecting();
-            if (inbound_endpoint)
-            {
-               fc::optional<potential_peer_record> updated_peer_record = _potential_peer_db
-                     .lookup_entry_for_endpoint(*inbound_endpoint);
-               if (updated_peer_record)
-               {
-                  updated_peer_record->last_seen_time = fc::time_point::now();
-                  _potential_peer_db.update_entry(*updated_peer_record);
-               }
-            }
-         }
+            record_connection_uptime(active_peer);
       }
 
       try
@@ -420,9 +409,10 @@ namespace graphene { namespace net { namespace detail {
             bool initiated_connection_this_pass = false;
             _potential_peer_database_updated = false;
 
-            for (peer_database::iterator iter = _potential_peer_db.begin();
-                 iter != _potential_peer_db.end() && is_wanting_new_connections();
-                 ++iter)
+            // the peer database iterates from the best to the worst scoring peer.  Collect the candidates first,
+            // connecting updates their records and would move them around in the database while we iterate
+            std::vector<fc::ip::endpoint> candidate_endpoints;
+            for (peer_database::iterator iter = _potential_peer_db.begin(); iter != _potential_peer_db.end(); ++iter)
             {
               fc::microseconds delay_until_retry = fc::seconds((iter->number_of_failed_connection_attempts + 1) * _peer_connection_retry_timeout);
 
@@ -431,10 +421,17 @@ namespace graphene { namespace net { namespace detail {
                     iter->last_connection_disposition != last_connection_rejected &&
                     iter->last_connection_disposition != last_connection_handshaking_failed) ||
                    (fc::time_point::now() - iter->last_connection_attempt_time) > delay_until_retry))
-              {
-                connect_to_endpoint(iter->endpoint);
-                initiated_connection_this_pass = true;
-              }
+                candidate_endpoints.push_back(iter->endpoint);
+            }
+
+            for (const fc::ip::endpoint& candidate_endpoint : candidate_endpoints)
+            {
+              if (!is_wanting_new_connections())
+                break;
+              if (is_connection_to_endpoint_in_progress(candidate_endpoint))
+                continue;
+              connect_to_endpoint(candidate_endpoint);
+              initiated_connection_this_pass = true;
             }
 
             if (!initiated_connection_this_pass && !_potential_peer_database_updated)
@@ -2151,6 +2148,17 @@ namespace graphene { namespace net { namespace detail {
             dlog( "sync: peer said we're up-to-date, entering normal operation with this peer" );
             originating_peer->we_need_sync_items_from_peer = false;
 
+            fc::optional<fc::ip::endpoint> inbound_endpoint = originating_peer->get_endpoint_for_connecting();
+            if( inbound_endpoint )
+            {
+              fc::optional<potential_peer_record> updated_peer_record = _potential_peer_db.lookup_entry_for_endpoint( *inbound_endpoint );
+              if( updated_peer_record )
+              {
+                ++updated_peer_record->number_of_successful_syncs;
+                _potential_peer_db.update_entry( *updated_peer_record );
+              }
+            }
+
             uint32_t new_number_of_unfetched_items = calculate_unsynced_block_count_from_all_peers();
             _total_number_of_unfetched_items = new_number_of_unfetched_items;
             if( new_number_of_unfetched_items == 0 )
@@ -2584,17 +2592,9 @@ namespace graphene { namespace net { namespace detail {
       _terminating_connections.erase(originating_peer_ptr);
       if (_active_connections.find(originating_peer_ptr) != _active_connections.end())
       {
+        if (originating_peer_ptr->get_remote_endpoint())
+          record_connection_uptime(originating_peer_ptr);
         _active_connections.erase(originating_peer_ptr);
-
-        if (inbound_endpoint && originating_peer_ptr->get_remote_endpoint())
-        {
-          fc::optional<potential_peer_record> updated_peer_record = _potential_peer_db.lookup_entry_for_endpoint(*inbound_endpoint);
-          if (updated_peer_record)
-          {
-            updated_peer_record->last_seen_time = fc::time_point::now();
-            _potential_peer_db.update_entry(*updated_peer_record);
-          }
-        }
       }
 
       ilog("Remote peer ${endpoint} closed their connection to us", ("endpoint", originating_peer->get_remote_endpoint()));
@@ -3253,6 +3253,17 @@ namespace graphene { namespace net { namespace detail {
                                                          (current_time_reply_message_received.reply_transmitted_time - reply_received_time)).count() / 2);
       originating_peer->round_trip_delay = (reply_received_time - current_time_reply_message_received.request_sent_time) -
                                            (current_time_reply_message_received.reply_transmitted_time - current_time_reply_message_received.request_received_time);
+
+      fc::optional<fc::ip::endpoint> inbound_endpoint = originating_peer->get_endpoint_for_connecting();
+      if (inbound_endpoint)
+      {
+        fc::optional<potential_peer_record> updated_peer_record = _potential_peer_db.lookup_entry_for_endpoint(*inbound_endpoint);
+        if (updated_peer_record)
+        {
+          updated_peer_record->record_round_trip_delay(originating_peer->round_trip_delay);
+          _potential_peer_db.update_entry(*updated_peer_record);
+        }
+      }
     }
 
     void node_impl::forward_firewall_check_to_next_available_peer(firewall_check_state_data* firewall_check_state)
@@ -3532,6 +3543,16 @@ namespace graphene { namespace net { namespace detail {
         {
           if (message_to_process.msg_type.value() == trx_message_type)
           {
+            if( !originating_peer->transaction_rate_bucket.consume( message_receive_time,
+                                                                   _maximum_transactions_per_second_per_peer,
+                                                                   _maximum_transactions_per_second_per_peer ) )
+            {
+              // don't record it as failed, another peer may deliver it later
+              ++_transactions_rejected_by_peer_rate_limit;
+              dlog( "peer ${peer} exceeded the transaction rate limit, dropping transaction",
+                    ("peer", originating_peer->get_remote_endpoint()) );
+              return;
+            }
             trx_message transaction_message_to_process = message_to_process.as<trx_message>();
             dlog( "passing message containing transaction ${trx} to client",
                   ("trx", transaction_message_to_process.trx.id()) );
@@ -4432,9 +4453,33 @@ namespace graphene { namespace net { namespace detail {
       return get_connection_to_endpoint( remote_endpoint ) != peer_connection_ptr();
     }
 
+    void node_impl::record_connection_uptime(const peer_connection_ptr& peer)
+    {
+      VERIFY_CORRECT_THREAD();
+      // a connection is closed through several paths, only the first one counts
+      if (peer->connection_uptime_recorded || peer->connection_activated_time == fc::time_point())
+        return;
+      peer->connection_uptime_recorded = true;
+      fc::optional<fc::ip::endpoint> inbound_endpoint = peer->get_endpoint_for_connecting();
+      if (!inbound_endpoint)
+        return;
+      fc::optional<potential_peer_record> updated_peer_record = _potential_peer_db.lookup_entry_for_endpoint(*inbound_endpoint);
+      if (updated_peer_record)
+      {
+        fc::time_point now = fc::time_point::now();
+        // the handshake does not count as connected time
+        if (now > peer->connection_activated_time)
+          updated_peer_record->total_connected_seconds += (now - peer->connection_activated_time).to_seconds();
+        updated_peer_record->last_seen_time = now;
+        _potential_peer_db.update_entry(*updated_peer_record);
+      }
+    }
+
     void node_impl::move_peer_to_active_list(const peer_connection_ptr& peer)
     {
       VERIFY_CORRECT_THREAD();
+      if (peer->connection_activated_time == fc::time_point())
+        peer->connection_activated_time = fc::time_point::now();
       _active_connections.insert(peer);
       _handshaking_connections.erase(peer);
       _closing_connections.erase(peer);
@@ -4514,6 +4559,8 @@ namespace graphene { namespace net { namespace detail {
                                           const fc::oexception& error /* = fc::oexception() */ )
     {
       VERIFY_CORRECT_THREAD();
+      if (_active_connections.find(peer_to_disconnect->shared_from_this()) != _active_connections.end())
+        record_connection_uptime(peer_to_disconnect->shared_from_this());
       move_peer_to_closing_list(peer_to_disconnect->shared_from_this());
 
       if (peer_to_disconnect->they_have_requested_close)
@@ -4531,6 +4578,8 @@ namespace graphene { namespace net { namespace detail {
           if (updated_peer_record)
           {
             updated_peer_record->last_seen_time = fc::time_point::now();
+            if (caused_by_error)
+              ++updated_peer_record->number_of_protocol_errors;
             if (error)
               updated_peer_record->last_error = error;
             else
@@ -4736,6 +4785,8 @@ namespace graphene { namespace net { namespace detail {
         _maximum_number_of_sync_blocks_to_prefetch = params["maximum_number_of_sync_blocks_to_prefetch"].as<uint32_t>(1);
       if (params.contains("maximum_blocks_per_peer_during_syncing"))
         _maximum_blocks_per_peer_during_syncing = params["maximum_blocks_per_peer_during_syncing"].as<uint32_t>(1);
+      if (params.contains("maximum_transactions_per_second_per_peer"))
+        _maximum_transactions_per_second_per_peer = params["maximum_transactions_per_second_per_peer"].as<uint32_t>(1);
 
       _desired_number_of_connections = std::min(_desired_number_of_connections, _maximum_number_of_connections);
 
@@ -4755,6 +4806,7 @@ namespace graphene { namespace net { namespace detail {
       result["maximum_number_of_blocks_to_handle_at_one_time"] = _maximum_number_of_blocks_to_handle_at_one_time;
       result["maximum_number_of_sync_blocks_to_prefetch"] = _maximum_number_of_sync_blocks_to_prefetch;
       result["maximum_blocks_per_peer_during_syncing"] = _maximum_blocks_per_peer_during_syncing;
+      result["maximum_transactions_per_second_per_peer"] = _maximum_transactions_per_second_per_peer;
       return result;
     }
 
@@ -4826,6 +4878,7 @@ namespace graphene { namespace net { namespace detail {
       info["node_public_key"] = fc::variant( _node_public_key, 1 );
       info["node_id"] = fc::variant( _node_id, 1 );
       info["firewalled"] = fc::variant( _is_firewalled, 1 );
+      info["transactions_rejected_by_peer_rate_limit"] = _transactions_rejected_by_peer_rate_limit;
       return info;
     }
     fc::variant_object node_impl::network_get_usage_stats() const
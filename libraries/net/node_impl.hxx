@@ -275,7 +275,7 @@ class node_impl : public peer_connection_delegate
       fc::sha256           _chain_id;
 
 #define NODE_CONFIGURATION_FILENAME      "node_config.json"
-#define POTENTIAL_PEER_DATABASE_FILENAME "peers.json"
+#define POTENTIAL_PEER_DATABASE_FILENAME "peers.dat"
       fc::path             _node_configuration_directory;
       node_configuration   _node_configuration;
 
@@ -436,6 +436,10 @@ class node_impl : public peer_connection_delegate
       unsigned _maximum_number_of_blocks_to_handle_at_one_time;
       unsigned _maximum_number_of_sync_blocks_to_prefetch;
       unsigned _maximum_blocks_per_peer_during_syncing;
+      /// transactions per second accepted from a single peer, 0 means unlimited
+      uint32_t _maximum_transactions_per_second_per_peer;
+      /// number of transactions dropped because a peer exceeded @ref _maximum_transactions_per_second_per_peer
+      uint64_t _transactions_rejected_by_peer_rate_limit = 0;
 
       std::list<fc::future<void> > _handle_message_calls_in_progress;
 
@@ -570,6 +574,8 @@ class node_impl : public peer_connection_delegate
       void connect_to_task(peer_connection_ptr new_peer, const fc::ip::endpoint& remote_endpoint);
       bool is_connection_to_endpoint_in_progress(const fc::ip::endpoint& remote_endpoint);
 
+      /// add the time we have been connected to an active peer to its record in the peer database, once per connection
+      void record_connection_uptime(const peer_connection_ptr& peer);
       void move_peer_to_active_list(const peer_connection_ptr& peer);
       void move_peer_to_closing_list(const peer_connection_ptr& peer);
       void move_peer_to_terminating_list(const peer_connection_ptr& peer);
@@ -26,25 +26,99 @@
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/composite_key.hpp>
 #include <boost/multi_index/tag.hpp>
 
 #include <fc/io/raw.hpp>
 #include <fc/io/raw_variant.hpp>
+#include <fc/io/fstream.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/io/json.hpp>
 
 #include <graphene/net/peer_database.hpp>
 #include <graphene/net/config.hpp>
 
+#include <fstream>
+#include <limits>
+#include <unordered_set>
+
 namespace graphene { namespace net {
+
+  // weights of the terms of potential_peer_record::score()
+  namespace peer_score
+  {
+    const int64_t max_reliability_bonus      = 1000; // scaled by the share of successful connection attempts
+    const uint64_t max_uptime_minutes        = 1440; // one point per minute connected, up to a day
+    const int64_t successful_sync_bonus      = 100;
+    const uint32_t max_counted_syncs         = 10;
+    const int64_t protocol_error_penalty     = 250;
+    const uint32_t max_counted_errors        = 20;
+    const uint32_t assumed_latency_ms        = 500;  // for peers whose latency has never been measured
+    const uint32_t max_counted_latency_ms    = 5000;
+    const uint32_t latency_ms_per_point      = 2;
+  }
+
+  void potential_peer_record::record_round_trip_delay(const fc::microseconds& round_trip_delay)
+  {
+    uint64_t sample_ms = std::max<int64_t>(round_trip_delay.count(), 0) / 1000;
+    // 0 means "never measured", so a very fast peer is recorded as 1ms
+    sample_ms = std::min<uint64_t>(std::max<uint64_t>(sample_ms, 1), std::numeric_limits<uint32_t>::max());
+    if (average_latency_ms == 0)
+      average_latency_ms = (uint32_t)sample_ms;
+    else
+      average_latency_ms = (uint32_t)(((uint64_t)average_latency_ms * 3 + sample_ms) / 4);
+  }
+
+  int64_t potential_peer_record::score() const
+  {
+    using namespace peer_score;
+    int64_t result = 0;
+
+    uint64_t attempts = (uint64_t)number_of_successful_connection_attempts + number_of_failed_connection_attempts;
+    if (attempts > 0)
+      result += max_reliability_bonus * (int64_t)number_of_successful_connection_attempts / (int64_t)attempts;
+
+    result += (int64_t)std::min<uint64_t>(total_connected_seconds / 60, max_uptime_minutes);
+    result += successful_sync_bonus * std::min<uint32_t>(number_of_successful_syncs, max_counted_syncs);
+    result -= protocol_error_penalty * std::min<uint32_t>(number_of_protocol_errors, max_counted_errors);
+
+    uint32_t latency_ms = average_latency_ms != 0 ? average_latency_ms : assumed_latency_ms;
+    result -= std::min<uint32_t>(latency_ms, max_counted_latency_ms) / latency_ms_per_point;
+    return result;
+  }
+
   namespace detail
   {
     using namespace boost::multi_index;
 
+    /**
+     * The peer database file starts with the format version, followed by a journal of entries.  When the database
+     * is opened or closed, the file is rewritten with one update entry per known peer; in between, changes are
+     * appended to it in batches so that little is lost if the node does not shut down cleanly.
+     *
+     * Version 1 stored the raw serialization of potential_peer_record, which cannot be read back once a field is
+     * added.  Since version 2 the records are stored as serialized variants, so fields can be added (and missing
+     * ones take their default value) without changing the format again.  Version 1 files are still read.
+     */
+    const uint32_t PEER_DATABASE_FILE_FORMAT_VERSION = 2;
+    const uint32_t PEER_DATABASE_RAW_RECORD_FORMAT_VERSION = 1;
+
+    // the journal is written when this many peers have unsaved changes, or when a change is made this long after
+    // the last write, so that frequent updates like round trip delay samples don't each cost a disk write
+    const size_t PEER_DATABASE_JOURNAL_BATCH_SIZE = 64;
+    const fc::microseconds PEER_DATABASE_JOURNAL_WRITE_INTERVAL = fc::seconds(60);
+
+    enum class peer_database_journal_entry_type : uint8_t
+    {
+      update_entry = 0,
+      erase_entry  = 1
+    };
+
     class peer_database_impl
     {
     public:
       struct last_seen_time_index {};
+      struct score_index {};
       struct endpoint_index {};
       typedef boost::multi_index_container<potential_peer_record, 
                                            indexed_by<ordered_non_unique<tag<last_seen_time_index>, 
@@ -52,6 +126,16 @@ namespace graphene { namespace net {
                                                                                 fc::time_point_sec, 
                                                                                 &potential_peer_record::last_seen_time>,
                                                                          std::greater<fc::time_point_sec> >,
+                                                      ordered_non_unique<tag<score_index>,
+                                                                         composite_key<potential_peer_record,
+                                                                                       const_mem_fun<potential_peer_record,
+                                                                                                     int64_t,
+                                                                                                     &potential_peer_record::score>,
+                                                                                       member<potential_peer_record,
+                                                                                              fc::time_point_sec,
+                                                                                              &potential_peer_record::last_seen_time> >,
+                                                                         composite_key_compare<std::greater<int64_t>,
+                                                                                               std::greater<fc::time_point_sec> > >,
                                                       hashed_unique<tag<endpoint_index>, 
                                                                     member<potential_peer_record, 
                                                                            fc::ip::endpoint, 
@@ -61,8 +145,24 @@ namespace graphene { namespace net {
     private:
       potential_peer_set     _potential_peer_set;
       fc::path _peer_database_filename;
+      std::ofstream _journal;
+      size_t _journal_entry_count = 0;
+      /// peers changed or erased since the journal was last written
+      std::unordered_set<fc::ip::endpoint, std::hash<fc::ip::endpoint> > _unsaved_endpoints;
+      fc::time_point _last_journal_write;
+
+      void load_binary_database();
+      void load_legacy_json_database(const fc::path& json_filename);
+      void prune();
+      void write_snapshot();
+      void open_journal();
+      void mark_unsaved(const fc::ip::endpoint& endpoint);
+      void write_journal();
+      void compact_journal();
 
     public:
+      ~peer_database_impl();
+
       void open(const fc::path& databaseFilename);
       void close();
       void clear();
@@ -79,9 +179,9 @@ namespace graphene { namespace net {
     class peer_database_iterator_impl
     {
     public:
-      typedef peer_database_impl::potential_peer_set::index<peer_database_impl::last_seen_time_index>::type::iterator last_seen_time_index_iterator;
-      last_seen_time_index_iterator _iterator;
-      explicit peer_database_iterator_impl(const last_seen_time_index_iterator& iterator) :
+      typedef peer_database_impl::potential_peer_set::index<peer_database_impl::score_index>::type::iterator score_index_iterator;
+      score_index_iterator _iterator;
+      explicit peer_database_iterator_impl(const score_index_iterator& iterator) :
         _iterator(iterator)
       {}
     };
@@ -92,58 +192,267 @@ namespace graphene { namespace net {
     {
       _peer_database_filename = peer_database_filename;
       if (fc::exists(_peer_database_filename))
+        load_binary_database();
+      else
       {
-        try
+        fc::path legacy_json_filename = _peer_database_filename;
+        legacy_json_filename.replace_extension(".json");
+        if (legacy_json_filename != _peer_database_filename && fc::exists(legacy_json_filename))
+          load_legacy_json_database(legacy_json_filename);
+      }
+      prune();
+
+      try
+      {
+        write_snapshot();
+        open_journal();
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error writing peer database file ${peer_database_filename}, changes to the database will not be saved: ${e}",
+             ("peer_database_filename", _peer_database_filename)("e", e.to_detail_string()));
+      }
+    }
+
+    void peer_database_impl::load_binary_database()
+    {
+      try
+      {
+        std::string file_contents;
+        fc::read_file_contents(_peer_database_filename, file_contents);
+        fc::datastream<const char*> ds(file_contents.data(), file_contents.size());
+
+        uint32_t format_version = 0;
+        fc::raw::unpack(ds, format_version);
+        FC_ASSERT(format_version == PEER_DATABASE_FILE_FORMAT_VERSION
+                  || format_version == PEER_DATABASE_RAW_RECORD_FORMAT_VERSION,
+                  "Unsupported peer database format version ${v}", ("v", format_version));
+
+        while (ds.remaining() > 0)
         {
-          std::vector<potential_peer_record> peer_records = fc::json::from_file(_peer_database_filename).as<std::vector<potential_peer_record> >( GRAPHENE_NET_MAX_NESTED_OBJECTS );
-          std::copy(peer_records.begin(), peer_records.end(), std::inserter(_potential_peer_set, _potential_peer_set.end()));
-          if (_potential_peer_set.size() > MAXIMUM_PEERDB_SIZE)
+          try
+          {
+            uint8_t entry_type = 0;
+            std::vector<char> payload;
+            fc::raw::unpack(ds, entry_type);
+            fc::raw::unpack(ds, payload);
+            if (entry_type == (uint8_t)peer_database_journal_entry_type::update_entry)
+            {
+              potential_peer_record record;
+              if (format_version == PEER_DATABASE_RAW_RECORD_FORMAT_VERSION)
+                record = fc::raw::unpack<potential_peer_record>(payload);
+              else
+                record = fc::raw::unpack<fc::variant>(payload, GRAPHENE_NET_MAX_NESTED_OBJECTS)
+                           .as<potential_peer_record>(GRAPHENE_NET_MAX_NESTED_OBJECTS);
+              auto iter = _potential_peer_set.get<endpoint_index>().find(record.endpoint);
+              if (iter != _potential_peer_set.get<endpoint_index>().end())
+                _potential_peer_set.get<endpoint_index>().replace(iter, record);
+              else
+                _potential_peer_set.get<endpoint_index>().insert(record);
+            }
+            else if (entry_type == (uint8_t)peer_database_journal_entry_type::erase_entry)
+              _potential_peer_set.get<endpoint_index>().erase(fc::raw::unpack<fc::ip::endpoint>(payload));
+            else
+              FC_THROW("Unknown peer database journal entry type ${t}", ("t", entry_type));
+          }
+          catch (const fc::exception& e)
           {
-            // prune database to a reasonable size
-            auto iter = _potential_peer_set.begin();
-            std::advance(iter, MAXIMUM_PEERDB_SIZE);
-            _potential_peer_set.erase(iter, _potential_peer_set.end());
+            // most likely the node was killed while appending to the journal, keep what we have read so far
+            wlog("ignoring the damaged tail of peer database file ${peer_database_filename}: ${e}",
+                 ("peer_database_filename", _peer_database_filename)("e", e.to_string()));
+            break;
           }
         }
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error opening peer database file ${peer_database_filename}, starting with a clean database",
+             ("peer_database_filename", _peer_database_filename));
+        _potential_peer_set.clear();
+      }
+    }
+
+    void peer_database_impl::load_legacy_json_database(const fc::path& json_filename)
+    {
+      try
+      {
+        ilog("importing peer database from ${json_filename}", ("json_filename", json_filename));
+        std::vector<potential_peer_record> peer_records = fc::json::from_file(json_filename).as<std::vector<potential_peer_record> >( GRAPHENE_NET_MAX_NESTED_OBJECTS );
+        std::copy(peer_records.begin(), peer_records.end(), std::inserter(_potential_peer_set, _potential_peer_set.end()));
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error opening peer database file ${peer_database_filename}, starting with a clean database", 
+             ("peer_database_filename", json_filename));
+        _potential_peer_set.clear();
+      }
+    }
+
+    void peer_database_impl::prune()
+    {
+      if (_potential_peer_set.size() > MAXIMUM_PEERDB_SIZE)
+      {
+        // prune database to a reasonable size, dropping the peers we haven't seen for the longest time
+        auto iter = _potential_peer_set.begin();
+        std::advance(iter, MAXIMUM_PEERDB_SIZE);
+        _potential_peer_set.erase(iter, _potential_peer_set.end());
+      }
+    }
+
+    static void pack_update_entry(std::ostream& out, const potential_peer_record& record)
+    {
+      fc::raw::pack(out, (uint8_t)peer_database_journal_entry_type::update_entry);
+      fc::raw::pack(out, fc::raw::pack(fc::variant(record, GRAPHENE_NET_MAX_NESTED_OBJECTS),
+                                       GRAPHENE_NET_MAX_NESTED_OBJECTS));
+    }
+
+    static void pack_erase_entry(std::ostream& out, const fc::ip::endpoint& endpoint)
+    {
+      fc::raw::pack(out, (uint8_t)peer_database_journal_entry_type::erase_entry);
+      fc::raw::pack(out, fc::raw::pack(endpoint));
+    }
+
+    void peer_database_impl::write_snapshot()
+    {
+      fc::path peer_database_filename_dir = _peer_database_filename.parent_path();
+      if (!fc::exists(peer_database_filename_dir))
+        fc::create_directories(peer_database_filename_dir);
+
+      fc::path temporary_filename(_peer_database_filename.generic_string() + ".tmp");
+      {
+        std::ofstream out(temporary_filename.generic_string(),
+                          std::ofstream::binary | std::ofstream::out | std::ofstream::trunc);
+        FC_ASSERT(out, "Unable to create ${f}", ("f", temporary_filename));
+        fc::raw::pack(out, PEER_DATABASE_FILE_FORMAT_VERSION);
+        for (const potential_peer_record& record : _potential_peer_set)
+          pack_update_entry(out, record);
+        out.flush();
+        FC_ASSERT(out, "Unable to write ${f}", ("f", temporary_filename));
+      }
+      fc::rename(temporary_filename, _peer_database_filename);
+    }
+
+    void peer_database_impl::open_journal()
+    {
+      _journal.open(_peer_database_filename.generic_string(),
+                    std::ofstream::binary | std::ofstream::out | std::ofstream::app);
+      FC_ASSERT(_journal, "Unable to open ${f} for appending", ("f", _peer_database_filename));
+      _journal_entry_count = 0;
+      _unsaved_endpoints.clear();
+      _last_journal_write = fc::time_point::now();
+    }
+
+    void peer_database_impl::mark_unsaved(const fc::ip::endpoint& endpoint)
+    {
+      if (!_journal.is_open())
+        return;
+
+      _unsaved_endpoints.insert(endpoint);
+      if (_unsaved_endpoints.size() >= PEER_DATABASE_JOURNAL_BATCH_SIZE
+          || fc::time_point::now() - _last_journal_write >= PEER_DATABASE_JOURNAL_WRITE_INTERVAL)
+        write_journal();
+    }
+
+    void peer_database_impl::write_journal()
+    {
+      if (!_journal.is_open() || _unsaved_endpoints.empty())
+        return;
+
+      // only the latest state of each peer is written, however many times it changed since the last write
+      for (const fc::ip::endpoint& endpoint : _unsaved_endpoints)
+      {
+        auto iter = _potential_peer_set.get<endpoint_index>().find(endpoint);
+        if (iter != _potential_peer_set.get<endpoint_index>().end())
+          pack_update_entry(_journal, *iter);
+        else
+          pack_erase_entry(_journal, endpoint);
+      }
+      _journal.flush();
+      _journal_entry_count += _unsaved_endpoints.size();
+      _unsaved_endpoints.clear();
+      _last_journal_write = fc::time_point::now();
+
+      // once the journal is much larger than the set of peers it describes, start over with a fresh snapshot
+      if (!_journal || _journal_entry_count > std::max<size_t>(MAXIMUM_PEERDB_SIZE, 4 * _potential_peer_set.size()))
+        compact_journal();
+    }
+
+    void peer_database_impl::compact_journal()
+    {
+      _journal.close();
+      try
+      {
+        write_snapshot();
+        open_journal();
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error compacting peer database file ${peer_database_filename}, changes to the database will not be saved: ${e}",
+             ("peer_database_filename", _peer_database_filename)("e", e.to_detail_string()));
+      }
+    }
+
+    void peer_database_impl::close()
+    {
+      if (_journal.is_open())
+      {
+        // the snapshot contains every unsaved change
+        _unsaved_endpoints.clear();
+        _journal.close();
+        try
+        {
+          write_snapshot();
+        }
         catch (const fc::exception& e)
         {
-          elog("error opening peer database file ${peer_database_filename}, starting with a clean database", 
+          elog("error saving peer database to file ${peer_database_filename}", 
                ("peer_database_filename", _peer_database_filename));
         }
       }
+      _potential_peer_set.clear();
     }
 
-    void peer_database_impl::close()
+    peer_database_impl::~peer_database_impl()
     {
-      std::vector<potential_peer_record> peer_records;
-      peer_records.reserve(_potential_peer_set.size());
-      std::copy(_potential_peer_set.begin(), _potential_peer_set.end(), std::back_inserter(peer_records));
-
+      // the database was not closed, at least keep the changes made since the journal was last written
       try
       {
-        fc::path peer_database_filename_dir = _peer_database_filename.parent_path();
-        if (!fc::exists(peer_database_filename_dir))
-          fc::create_directories(peer_database_filename_dir);
-        fc::json::save_to_file( peer_records, _peer_database_filename, GRAPHENE_NET_MAX_NESTED_OBJECTS );
+        write_journal();
       }
       catch (const fc::exception& e)
       {
-        elog("error saving peer database to file ${peer_database_filename}", 
-             ("peer_database_filename", _peer_database_filename));
+        elog("error writing peer database file ${peer_database_filename}: ${e}",
+             ("peer_database_filename", _peer_database_filename)("e", e.to_detail_string()));
       }
-      _potential_peer_set.clear();
     }
 
     void peer_database_impl::clear()
     {
       _potential_peer_set.clear();
+      if (_journal.is_open())
+      {
+        _journal.close();
+        try
+        {
+          write_snapshot();
+          open_journal();
+        }
+        catch (const fc::exception& e)
+        {
+          elog("error clearing peer database file ${peer_database_filename}: ${e}",
+               ("peer_database_filename", _peer_database_filename)("e", e.to_detail_string()));
+        }
+      }
     }
 
     void peer_database_impl::erase(const fc::ip::endpoint& endpointToErase)
     {
       auto iter = _potential_peer_set.get<endpoint_index>().find(endpointToErase);
       if (iter != _potential_peer_set.get<endpoint_index>().end())
+      {
         _potential_peer_set.get<endpoint_index>().erase(iter);
+        mark_unsaved(endpointToErase);
+      }
     }
 
     void peer_database_impl::update_entry(const potential_peer_record& updatedRecord)
@@ -153,6 +462,7 @@ namespace graphene { namespace net {
         _potential_peer_set.get<endpoint_index>().modify(iter, [&updatedRecord](potential_peer_record& record) { record = updatedRecord; });
       else
         _potential_peer_set.get<endpoint_index>().insert(updatedRecord);
+      mark_unsaved(updatedRecord.endpoint);
     }
 
     potential_peer_record peer_database_impl::lookup_or_create_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup)
@@ -173,12 +483,12 @@ namespace graphene { namespace net {
 
     peer_database::iterator peer_database_impl::begin() const
     {
-      return peer_database::iterator(new peer_database_iterator_impl(_potential_peer_set.get<last_seen_time_index>().begin()));
+      return peer_database::iterator(new peer_database_iterator_impl(_potential_peer_set.get<score_index>().begin()));
     }
 
     peer_database::iterator peer_database_impl::end() const
     {
-      return peer_database::iterator(new peer_database_iterator_impl(_potential_peer_set.get<last_seen_time_index>().end()));
+      return peer_database::iterator(new peer_database_iterator_impl(_potential_peer_set.get<score_index>().end()));
     }
 
     size_t peer_database_impl::size() const
@@ -283,6 +593,8 @@ FC_REFLECT_ENUM( graphene::net::potential_peer_last_connection_disposition,
 FC_REFLECT_DERIVED_NO_TYPENAME( graphene::net::potential_peer_record, BOOST_PP_SEQ_NIL,
                                 (endpoint)(last_seen_time)(last_connection_disposition)
                                 (last_connection_attempt_time)(number_of_successful_connection_attempts)
-                                (number_of_failed_connection_attempts)(last_error) )
+                                (number_of_failed_connection_attempts)(last_error)
+                                (average_latency_ms)(total_connected_seconds)
+                                (number_of_successful_syncs)(number_of_protocol_errors) )
 
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::net::potential_peer_record)
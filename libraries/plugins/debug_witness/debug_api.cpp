@@ -28,6 +28,7 @@ class debug_api_impl
       void debug_update_object( const fc::variant_object& update );
       void debug_stream_json_objects( const std::string& filename );
       void debug_stream_json_objects_flush();
+      debug_state_hash debug_get_state_hash();
       std::shared_ptr< graphene::debug_witness_plugin::debug_witness_plugin > get_plugin();
 
       graphene::app::application& app;
@@ -60,6 +61,7 @@ void debug_api_impl::debug_push_blocks( const std::string& src_filename, uint32_
          }
          try
          {
+            graphene::app::api_worker_pool::write_guard guard( app.get_api_worker_pool() );
             db->push_block( *block );
          }
          catch( const fc::exception& e )
@@ -82,6 +84,7 @@ void debug_api_impl::debug_generate_blocks( const std::string& debug_key, uint32
    graphene::chain::public_key_type debug_public_key = debug_private_key->get_public_key();
 
    std::shared_ptr< graphene::chain::database > db = app.chain_database();
+   graphene::app::api_worker_pool::write_guard guard( app.get_api_worker_pool() );
    for( uint32_t i=0; i<count; i++ )
    {
       graphene::chain::witness_id_type scheduled_witness = db->get_scheduled_witness( 1 );
@@ -101,9 +104,28 @@ void debug_api_impl::debug_generate_blocks( const std::string& debug_key, uint32
 void debug_api_impl::debug_update_object( const fc::variant_object& update )
 {
    std::shared_ptr< graphene::chain::database > db = app.chain_database();
+   graphene::app::api_worker_pool::write_guard guard( app.get_api_worker_pool() );
    db->debug_update( update );
 }
 
+debug_state_hash debug_api_impl::debug_get_state_hash()
+{
+   std::shared_ptr< graphene::chain::database > db = app.chain_database();
+   graphene::app::api_worker_pool::write_guard guard( app.get_api_worker_pool() );
+   if( !db->is_state_hash_enabled() )
+      db->enable_state_hash( true );
+
+   debug_state_hash result;
+   result.head_block_num = db->head_block_num();
+   result.state_hash = db->get_state_hash();
+   for( const auto& item : db->get_index_state_hashes() )
+      result.object_type_hashes[ fc::to_string( uint64_t( item.first.first ) ) + "."
+                                 + fc::to_string( uint64_t( item.first.second ) ) ]
+            = item.second;
+   result.maintenance_hashes = db->get_state_hash_history();
+   return result;
+}
+
 std::shared_ptr< graphene::debug_witness_plugin::debug_witness_plugin > debug_api_impl::get_plugin()
 {
    return app.get_plugin< graphene::debug_witness_plugin::debug_witness_plugin >( "debug_witness" );
@@ -151,5 +173,10 @@ void debug_api::debug_stream_json_objects_flush()
    my->debug_stream_json_objects_flush();
 }
 
+debug_state_hash debug_api::debug_get_state_hash()
+{
+   return my->debug_get_state_hash();
+}
+
 
 } } // graphene::debug_witness
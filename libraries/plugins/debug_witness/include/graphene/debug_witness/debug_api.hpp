@@ -23,10 +23,13 @@
  */
 #pragma once
 
+#include <map>
 #include <memory>
 #include <string>
 
 #include <fc/api.hpp>
+#include <fc/container/flat.hpp>
+#include <fc/crypto/sha256.hpp>
 #include <fc/variant_object.hpp>
 
 namespace graphene { namespace app {
@@ -39,6 +42,17 @@ namespace detail {
 class debug_api_impl;
 }
 
+/// A commitment to the chain state, see @ref debug_api::debug_get_state_hash
+struct debug_state_hash
+{
+   uint32_t                              head_block_num = 0;
+   fc::sha256                            state_hash;
+   /// The state hash of every object type, keyed by "space.type", to locate a divergence
+   std::map< std::string, fc::sha256 >   object_type_hashes;
+   /// The state hashes recorded after the most recent maintenance intervals, by block number
+   fc::flat_map< uint32_t, fc::sha256 >  maintenance_hashes;
+};
+
 class debug_api
 {
    public:
@@ -82,15 +96,26 @@ class debug_api
        */
       void debug_stream_json_objects_flush();
 
+      /**
+       * Get a hash of the current chain state, which is equal on two nodes if and only if they hold the same
+       * consensus objects. Enables the state hash if the node was not started with it, which hashes all objects
+       * once.
+       */
+      debug_state_hash debug_get_state_hash();
+
       std::shared_ptr< detail::debug_api_impl > my;
 };
 
 } }
 
+FC_REFLECT( graphene::debug_witness::debug_state_hash,
+            (head_block_num)(state_hash)(object_type_hashes)(maintenance_hashes) )
+
 FC_API(graphene::debug_witness::debug_api,
        (debug_push_blocks)
        (debug_generate_blocks)
        (debug_update_object)
        (debug_stream_json_objects)
        (debug_stream_json_objects_flush)
+       (debug_get_state_hash)
      )
@@ -121,6 +121,7 @@ void delayed_node_plugin::sync_with_trusted_node()
          FC_ASSERT(block, "Trusted node claims it has blocks it doesn't actually have.");
          ilog("Pushing block #${n}", ("n", block->block_num()));
          db.precompute_parallel( *block, graphene::chain::database::skip_nothing ).wait();
+         graphene::app::api_worker_pool::write_guard guard( app().get_api_worker_pool() );
          db.push_block(*block);
          synced_blocks++;
       }
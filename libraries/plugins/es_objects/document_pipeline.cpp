@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <graphene/es_objects/document_pipeline.hpp>
+#include <graphene/es_objects/es_objects.hpp>
+
+#include <graphene/utilities/elasticsearch.hpp>
+
+#include <fc/io/fstream.hpp>
+#include <fc/io/json.hpp>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem.hpp>
+
+#include <algorithm>
+#include <fstream>
+
+namespace graphene { namespace es_objects {
+
+void pending_documents::add(pending_document&& doc)
+{
+   if (_keep_only_current) {
+      auto itr = _positions.find(doc.id);
+      if (itr != _positions.end()) {
+         _documents[itr->second] = std::move(doc);
+         return;
+      }
+      _positions[doc.id] = _documents.size();
+   }
+   _documents.push_back(std::move(doc));
+}
+
+void pending_documents::add_removed(const graphene::db::object_id_type& id, const std::string& index,
+                                    uint32_t block_number, const fc::time_point_sec& block_time)
+{
+   // without es-objects-keep-only-current, the documents are the history of the object and stay
+   if (!_keep_only_current)
+      return;
+   pending_document doc;
+   doc.id = id;
+   doc.index = index;
+   doc.block_number = block_number;
+   doc.block_time = block_time;
+   add(std::move(doc));
+}
+
+std::vector<pending_document> pending_documents::take()
+{
+   std::vector<pending_document> result = std::move(_documents);
+   _documents.clear();
+   _positions.clear();
+   return result;
+}
+
+std::vector<std::string> serialize_documents(const std::vector<pending_document>& docs, size_t begin, size_t end,
+                                             const std::string& index_prefix, bool keep_only_current)
+{
+   std::vector<std::string> lines;
+   lines.reserve((end - begin) * 2);
+   for (size_t i = begin; i < end; ++i) {
+      const pending_document& doc = docs[i];
+      if (!doc.object) {
+         fc::mutable_variant_object delete_line;
+         delete_line["_id"] = std::string(doc.id);
+         delete_line["_index"] = index_prefix + doc.index;
+         delete_line["_type"] = "data";
+         fc::mutable_variant_object final_delete_line;
+         final_delete_line["delete"] = delete_line;
+         lines.push_back(fc::json::to_string(final_delete_line));
+         continue;
+      }
+
+      fc::mutable_variant_object bulk_header;
+      bulk_header["_index"] = index_prefix + doc.index;
+      bulk_header["_type"] = "data";
+      if (keep_only_current)
+         bulk_header["_id"] = std::string(doc.id);
+
+      adaptor_struct adaptor;
+      fc::variant blockchain_object_variant = doc.object->to_variant();
+      fc::mutable_variant_object o = adaptor.adapt(blockchain_object_variant.get_object());
+
+      o["object_id"] = std::string(doc.id);
+      o["block_time"] = doc.block_time;
+      o["block_number"] = doc.block_number;
+
+      std::string data = fc::json::to_string(o, fc::json::legacy_generator);
+
+      auto prepare = graphene::utilities::createBulk(bulk_header, std::move(data));
+      std::move(prepare.begin(), prepare.end(), std::back_inserter(lines));
+   }
+   return lines;
+}
+
+backlog_directory::backlog_directory(const fc::path& dir)
+   : _dir(dir)
+{
+   fc::create_directories(_dir);
+}
+
+fc::path backlog_directory::file(uint64_t sequence)const
+{
+   const std::string number = std::to_string(sequence);
+   return _dir / (std::string(20 - number.size(), '0') + number + ".json");
+}
+
+std::vector<fc::path> backlog_directory::files()const
+{
+   std::vector<fc::path> result;
+   const boost::filesystem::directory_iterator end_itr;
+   for (boost::filesystem::directory_iterator itr(_dir.string()); itr != end_itr; ++itr)
+      result.push_back(itr->path());
+   std::sort(result.begin(), result.end(), [](const fc::path& a, const fc::path& b) {
+      return a.string() < b.string();
+   });
+   return result;
+}
+
+uint64_t backlog_directory::next_sequence()const
+{
+   const std::vector<fc::path> existing = files();
+   if (existing.empty())
+      return 0;
+   return std::stoull(existing.back().filename().string()) + 1;
+}
+
+void backlog_directory::store(const fc::path& file, const std::vector<std::string>& lines)
+{
+   std::ofstream out(file.string(), std::ios::out | std::ios::trunc);
+   out << graphene::utilities::joinBulkLines(lines);
+}
+
+std::vector<std::string> backlog_directory::load(const fc::path& file)
+{
+   std::string content;
+   fc::read_file_contents(file, content);
+   std::vector<std::string> lines;
+   boost::split(lines, content, boost::is_any_of("\n"));
+   lines.erase(std::remove(lines.begin(), lines.end(), std::string()), lines.end());
+   return lines;
+}
+
+void batch_queue::make_room()
+{
+   while (!_batches.empty() && (_batches.front().ready() || _batches.size() >= _max_batches)) {
+      _batches.front().wait();
+      _batches.pop_front();
+   }
+}
+
+void batch_queue::wait_all()
+{
+   for (auto& batch : _batches) {
+      try {
+         batch.wait();
+      } catch (const fc::exception& e) {
+         elog("elasticsearch OBJECTS: ${e}", ("e", e.to_detail_string()));
+      }
+   }
+   _batches.clear();
+}
+
+} } // graphene::es_objects
@@ -23,6 +23,7 @@
  */
 
 #include <graphene/es_objects/es_objects.hpp>
+#include <graphene/es_objects/document_pipeline.hpp>
 
 #include <curl/curl.h>
 #include <graphene/chain/proposal_object.hpp>
@@ -33,11 +34,23 @@
 
 #include <graphene/utilities/elasticsearch.hpp>
 
+#include <fc/thread/parallel.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <atomic>
+
 namespace graphene { namespace es_objects {
 
 namespace detail
 {
 
+/**
+ * Changed objects are collected on the thread which applies blocks. With es-objects-keep-only-current, only the last
+ * version of every object is kept until the batch is flushed. A flushed batch is serialized on the worker threads
+ * and written to the backlog directory while the previous batch is being sent, then it is sent to ES by a single
+ * sender thread, in order and over one keep-alive connection. A batch is removed from the backlog once ES has
+ * accepted it, so batches which have not been sent before a shutdown are sent after the restart.
+ */
 class es_objects_plugin_impl
 {
    public:
@@ -46,15 +59,19 @@ class es_objects_plugin_impl
       {  curl = curl_easy_init(); }
       virtual ~es_objects_plugin_impl();
 
-      bool index_database(const vector<object_id_type>& ids, std::string action);
+      void index_database(const vector<object_id_type>& ids, bool removed);
       bool genesis();
-      void remove_from_database(object_id_type id, std::string index);
+      void start_pipeline();
+      /// Send what is pending and wait until all batches have been sent or stored in the backlog
+      void stop_pipeline(bool flush_pending = true);
+      void flush();
 
       es_objects_plugin& _self;
       std::string _es_objects_elasticsearch_url = "http://localhost:9200/";
       std::string _es_objects_auth = "";
       uint32_t _es_objects_bulk_replay = 10000;
       uint32_t _es_objects_bulk_sync = 100;
+      uint32_t _es_objects_max_backlog = 16;
       bool _es_objects_proposals = true;
       bool _es_objects_accounts = true;
       bool _es_objects_assets = true;
@@ -64,8 +81,6 @@ class es_objects_plugin_impl
       std::string _es_objects_index_prefix = "objects-";
       uint32_t _es_objects_start_es_after_block = 0;
       CURL *curl; // curl handler
-      vector <std::string> bulk;
-      vector<std::string> prepare;
 
       bool _es_objects_keep_only_current = true;
 
@@ -73,10 +88,25 @@ class es_objects_plugin_impl
       fc::time_point_sec block_time;
 
    private:
-      template<typename T>
-      void prepareTemplate(T blockchain_object, string index_name);
+      const std::string* index_name(const object_id_type& id)const;
+      bool send(const vector<std::string>& lines);
+      void send_until_done(const fc::path& backlog_file, const vector<std::string>& lines);
+      void resend_backlog(const vector<fc::path>& files);
+
+      /// Documents which have not been flushed yet
+      pending_documents _pending;
+
+      std::shared_ptr<fc::thread> _sender_thread;
+      CURL *_sender_curl = nullptr; // curl handler of the sender thread
+      /// Flushed batches which have not been sent yet
+      batch_queue _batches;
+      uint64_t _next_batch = 0;
+      std::unique_ptr<backlog_directory> _backlog;
+      std::atomic<bool> _stopping{false};
 };
 
+static const size_t serialize_chunk_size = 500;
+
 bool es_objects_plugin_impl::genesis()
 {
    ilog("elasticsearch OBJECTS: inserting data from genesis");
@@ -86,186 +116,222 @@ bool es_objects_plugin_impl::genesis()
    block_number = db.head_block_num();
    block_time = db.head_block_time();
 
-   if (_es_objects_accounts) {
-      auto &index_accounts = db.get_index(1, 2);
-      index_accounts.inspect_all_objects([this, &db](const graphene::db::object &o) {
-         auto obj = db.find_object(o.id);
-         auto a = static_cast<const account_object *>(obj);
-         prepareTemplate<account_object>(*a, "account");
-      });
-   }
-   if (_es_objects_assets) {
-      auto &index_assets = db.get_index(1, 3);
-      index_assets.inspect_all_objects([this, &db](const graphene::db::object &o) {
-         auto obj = db.find_object(o.id);
-         auto a = static_cast<const asset_object *>(obj);
-         prepareTemplate<asset_object>(*a, "asset");
-      });
-   }
-   if (_es_objects_balances) {
-      auto &index_balances = db.get_index(2, 5);
-      index_balances.inspect_all_objects([this, &db](const graphene::db::object &o) {
-         auto obj = db.find_object(o.id);
-         auto b = static_cast<const account_balance_object *>(obj);
-         prepareTemplate<account_balance_object>(*b, "balance");
+   auto add_all = [this, &db](uint8_t space, uint8_t type) {
+      db.get_index(space, type).inspect_all_objects([this](const graphene::db::object &o) {
+         pending_document doc;
+         doc.id = o.id;
+         doc.index = *index_name(o.id);
+         doc.object = o.clone();
+         doc.block_number = block_number;
+         doc.block_time = block_time;
+         _pending.add(std::move(doc));
       });
-   }
-
-   graphene::utilities::ES es;
-   es.curl = curl;
-   es.bulk_lines = bulk;
-   es.elasticsearch_url = _es_objects_elasticsearch_url;
-   es.auth = _es_objects_auth;
-   if (!graphene::utilities::SendBulk(std::move(es)))
-      FC_THROW_EXCEPTION(graphene::chain::plugin_exception, "Error inserting genesis data.");
-   else
-      bulk.clear();
-
+   };
+   if (_es_objects_accounts)
+      add_all(1, 2);
+   if (_es_objects_assets)
+      add_all(1, 3);
+   if (_es_objects_balances)
+      add_all(2, 5);
+
+   flush();
    return true;
 }
 
-bool es_objects_plugin_impl::index_database(const vector<object_id_type>& ids, std::string action)
+const std::string* es_objects_plugin_impl::index_name(const object_id_type& id)const
+{
+   static const std::string proposal = "proposal";
+   static const std::string account = "account";
+   static const std::string asset = "asset";
+   static const std::string balance = "balance";
+   static const std::string limitorder = "limitorder";
+   static const std::string bitasset = "bitasset";
+
+   if (id.is<proposal_object>() && _es_objects_proposals)
+      return &proposal;
+   if (id.is<account_object>() && _es_objects_accounts)
+      return &account;
+   if (id.is<asset_object>() && _es_objects_assets)
+      return &asset;
+   if (id.is<account_balance_object>() && _es_objects_balances)
+      return &balance;
+   if (id.is<limit_order_object>() && _es_objects_limit_orders)
+      return &limitorder;
+   if (id.is<asset_bitasset_data_object>() && _es_objects_asset_bitasset)
+      return &bitasset;
+   return nullptr;
+}
+
+void es_objects_plugin_impl::index_database(const vector<object_id_type>& ids, bool removed)
 {
    graphene::chain::database &db = _self.database();
 
    block_time = db.head_block_time();
    block_number = db.head_block_num();
 
-   if(block_number > _es_objects_start_es_after_block) {
-
-      // check if we are in replay or in sync and change number of bulk documents accordingly
-      uint32_t limit_documents = 0;
-      if ((fc::time_point::now() - block_time) < fc::seconds(30))
-         limit_documents = _es_objects_bulk_sync;
-      else
-         limit_documents = _es_objects_bulk_replay;
-
-
-      for (auto const &value: ids) {
-         if (value.is<proposal_object>() && _es_objects_proposals) {
-            auto obj = db.find_object(value);
-            auto p = static_cast<const proposal_object *>(obj);
-            if (p != nullptr) {
-               if (action == "delete")
-                  remove_from_database(p->id, "proposal");
-               else
-                  prepareTemplate<proposal_object>(*p, "proposal");
-            }
-         } else if (value.is<account_object>() && _es_objects_accounts) {
-            auto obj = db.find_object(value);
-            auto a = static_cast<const account_object *>(obj);
-            if (a != nullptr) {
-               if (action == "delete")
-                  remove_from_database(a->id, "account");
-               else
-                  prepareTemplate<account_object>(*a, "account");
-            }
-         } else if (value.is<asset_object>() && _es_objects_assets) {
-            auto obj = db.find_object(value);
-            auto a = static_cast<const asset_object *>(obj);
-            if (a != nullptr) {
-               if (action == "delete")
-                  remove_from_database(a->id, "asset");
-               else
-                  prepareTemplate<asset_object>(*a, "asset");
-            }
-         } else if (value.is<account_balance_object>() && _es_objects_balances) {
-            auto obj = db.find_object(value);
-            auto b = static_cast<const account_balance_object *>(obj);
-            if (b != nullptr) {
-               if (action == "delete")
-                  remove_from_database(b->id, "balance");
-               else
-                  prepareTemplate<account_balance_object>(*b, "balance");
-            }
-         } else if (value.is<limit_order_object>() && _es_objects_limit_orders) {
-            auto obj = db.find_object(value);
-            auto l = static_cast<const limit_order_object *>(obj);
-            if (l != nullptr) {
-               if (action == "delete")
-                  remove_from_database(l->id, "limitorder");
-               else
-                  prepareTemplate<limit_order_object>(*l, "limitorder");
-            }
-         } else if (value.is<asset_bitasset_data_object>() && _es_objects_asset_bitasset) {
-            auto obj = db.find_object(value);
-            auto ba = static_cast<const asset_bitasset_data_object *>(obj);
-            if (ba != nullptr) {
-               if (action == "delete")
-                  remove_from_database(ba->id, "bitasset");
-               else
-                  prepareTemplate<asset_bitasset_data_object>(*ba, "bitasset");
-            }
-         }
-      }
-
-      if (curl && bulk.size() >= limit_documents) { // we are in bulk time, ready to add data to elasticsearech
+   if(block_number <= _es_objects_start_es_after_block)
+      return;
 
-         graphene::utilities::ES es;
-         es.curl = curl;
-         es.bulk_lines = bulk;
-         es.elasticsearch_url = _es_objects_elasticsearch_url;
-         es.auth = _es_objects_auth;
+   for (auto const &id: ids) {
+      const std::string* index = index_name(id);
+      if (index == nullptr)
+         continue;
 
-         if (!graphene::utilities::SendBulk(std::move(es)))
-            return false;
-         else
-            bulk.clear();
+      if (removed) {
+         _pending.add_removed(id, *index, block_number, block_time);
+         continue;
       }
+
+      // the object is copied, so that it can be serialized on another thread
+      const graphene::db::object* obj = db.find_object(id);
+      if (obj == nullptr)
+         continue;
+      pending_document doc;
+      doc.id = id;
+      doc.index = *index;
+      doc.object = obj->clone();
+      doc.block_number = block_number;
+      doc.block_time = block_time;
+      _pending.add(std::move(doc));
    }
 
-   return true;
+   // check if we are in replay or in sync and change number of bulk documents accordingly
+   uint32_t limit_documents = 0;
+   if ((fc::time_point::now() - block_time) < fc::seconds(30))
+      limit_documents = _es_objects_bulk_sync;
+   else
+      limit_documents = _es_objects_bulk_replay;
+
+   if (_pending.size() >= limit_documents)
+      flush();
 }
 
-void es_objects_plugin_impl::remove_from_database( object_id_type id, std::string index)
+void es_objects_plugin_impl::start_pipeline()
 {
-   if(_es_objects_keep_only_current)
-   {
-      fc::mutable_variant_object delete_line;
-      delete_line["_id"] = string(id);
-      delete_line["_index"] = _es_objects_index_prefix + index;
-      delete_line["_type"] = "data";
-      fc::mutable_variant_object final_delete_line;
-      final_delete_line["delete"] = delete_line;
-      prepare.push_back(fc::json::to_string(final_delete_line));
-      std::move(prepare.begin(), prepare.end(), std::back_inserter(bulk));
-      prepare.clear();
-   }
+   _pending.set_keep_only_current(_es_objects_keep_only_current);
+   _batches.set_max_batches(_es_objects_max_backlog);
+   _sender_thread = std::make_shared<fc::thread>("es_objects");
+   _sender_curl = curl_easy_init();
+   if (_sender_curl)
+      curl_easy_setopt(_sender_curl, CURLOPT_TCP_KEEPALIVE, 1L);
 }
 
-template<typename T>
-void es_objects_plugin_impl::prepareTemplate(T blockchain_object, string index_name)
+void es_objects_plugin_impl::flush()
 {
-   fc::mutable_variant_object bulk_header;
-   bulk_header["_index"] = _es_objects_index_prefix + index_name;
-   bulk_header["_type"] = "data";
-   if(_es_objects_keep_only_current)
-   {
-      bulk_header["_id"] = string(blockchain_object.id);
+   if (_pending.empty())
+      return;
+
+   if (!_backlog) {
+      // the database is open now, send what has been left over from the last run first
+      _backlog.reset(new backlog_directory(_self.database().get_data_dir() / "es_objects_backlog"));
+      const vector<fc::path> files = _backlog->files();
+      if (!files.empty()) {
+         ilog("elasticsearch OBJECTS: sending ${n} batches left over from the last run", ("n", files.size()));
+         _next_batch = _backlog->next_sequence();
+         _batches.push(_sender_thread->async([this, files]() { resend_backlog(files); }, "es_objects backlog"));
+      }
    }
 
-   adaptor_struct adaptor;
-   fc::variant blockchain_object_variant;
-   fc::to_variant( blockchain_object, blockchain_object_variant, GRAPHENE_NET_MAX_NESTED_OBJECTS );
-   fc::mutable_variant_object o = adaptor.adapt(blockchain_object_variant.get_object());
+   auto batch = std::make_shared< vector<pending_document> >(_pending.take());
+
+   // Apply back pressure if ES can not keep up or is down
+   _batches.make_room();
+
+   const fc::path file = _backlog->file(_next_batch++);
+   const fc::future<void> previous = _batches.back();
+   const std::string index_prefix = _es_objects_index_prefix;
+   const bool keep_only_current = _es_objects_keep_only_current;
+   _batches.push(_sender_thread->async([this, batch, file, previous, index_prefix, keep_only_current]() mutable {
+      vector< fc::future< vector<std::string> > > parts;
+      for (size_t begin = 0; begin < batch->size(); begin += serialize_chunk_size) {
+         const size_t end = std::min(batch->size(), begin + serialize_chunk_size);
+         parts.push_back(fc::do_parallel([batch, begin, end, index_prefix, keep_only_current]() {
+            return serialize_documents(*batch, begin, end, index_prefix, keep_only_current);
+         }));
+      }
+      vector<std::string> lines;
+      for (auto& part : parts) {
+         vector<std::string> part_lines = part.wait();
+         std::move(part_lines.begin(), part_lines.end(), std::back_inserter(lines));
+      }
+      batch.reset();
+
+      backlog_directory::store(file, lines);
+
+      // bulk requests are sent in order, since a later batch can contain a newer version of the same object
+      if (previous.valid())
+         previous.wait();
+      send_until_done(file, lines);
+   }, "es_objects batch"));
+}
+
+bool es_objects_plugin_impl::send(const vector<std::string>& lines)
+{
+   if (lines.empty())
+      return true;
+   graphene::utilities::ES es;
+   es.curl = _sender_curl;
+   es.bulk_lines = lines;
+   es.elasticsearch_url = _es_objects_elasticsearch_url;
+   es.auth = _es_objects_auth;
+   return graphene::utilities::SendBulk(std::move(es));
+}
 
-   o["object_id"] = string(blockchain_object.id);
-   o["block_time"] = block_time;
-   o["block_number"] = block_number;
+void es_objects_plugin_impl::send_until_done(const fc::path& backlog_file, const vector<std::string>& lines)
+{
+   uint32_t delay_ms = 100;
+   while (!send(lines)) {
+      if (_stopping) {
+         wlog("elasticsearch OBJECTS: ${f} is kept for the next start", ("f", backlog_file.string()));
+         return;
+      }
+      elog("elasticsearch OBJECTS: error sending ${f}, retrying in ${d} ms",
+           ("f", backlog_file.string())("d", delay_ms));
+      fc::usleep(fc::milliseconds(delay_ms));
+      delay_ms = std::min<uint32_t>(delay_ms * 2, 5000);
+   }
+   fc::remove_all(backlog_file);
+}
 
-   string data = fc::json::to_string(o, fc::json::legacy_generator);
+void es_objects_plugin_impl::resend_backlog(const vector<fc::path>& files)
+{
+   for (const fc::path& file : files) {
+      send_until_done(file, backlog_directory::load(file));
+      if (_stopping)
+         return;
+   }
+}
 
-   prepare = graphene::utilities::createBulk(bulk_header, std::move(data));
-   std::move(prepare.begin(), prepare.end(), std::back_inserter(bulk));
-   prepare.clear();
+void es_objects_plugin_impl::stop_pipeline(bool flush_pending)
+{
+   if (!_sender_thread)
+      return;
+   if (flush_pending) {
+      try {
+         flush();
+      } catch (const fc::exception& e) {
+         elog("elasticsearch OBJECTS: failed to flush pending documents: ${e}", ("e", e.to_detail_string()));
+      }
+   }
+   // batches which can not be sent right away stay in the backlog
+   _stopping = true;
+   _batches.wait_all();
+   _sender_thread->quit();
+   _sender_thread.reset();
 }
 
 es_objects_plugin_impl::~es_objects_plugin_impl()
 {
+   // the database may be gone already, so only the batches which have been flushed are finished
+   stop_pipeline(false);
    if (curl) {
       curl_easy_cleanup(curl);
       curl = nullptr;
    }
+   if (_sender_curl) {
+      curl_easy_cleanup(_sender_curl);
+      _sender_curl = nullptr;
+   }
    return;
 }
 
@@ -302,6 +368,8 @@ void es_objects_plugin::plugin_set_program_options(
                "Number of bulk documents to index on replay(10000)")
          ("es-objects-bulk-sync", boost::program_options::value<uint32_t>(),
                "Number of bulk documents to index on a synchronized chain(100)")
+         ("es-objects-max-backlog", boost::program_options::value<uint32_t>(),
+               "Number of bulk requests which can wait to be sent before block processing waits for ES(16)")
          ("es-objects-proposals", boost::program_options::value<bool>(), "Store proposal objects(true)")
          ("es-objects-accounts", boost::program_options::value<bool>(), "Store account objects(true)")
          ("es-objects-assets", boost::program_options::value<bool>(), "Store asset objects(true)")
@@ -332,6 +400,9 @@ void es_objects_plugin::plugin_initialize(const boost::program_options::variable
    if (options.count("es-objects-bulk-sync")) {
       my->_es_objects_bulk_sync = options["es-objects-bulk-sync"].as<uint32_t>();
    }
+   if (options.count("es-objects-max-backlog")) {
+      my->_es_objects_max_backlog = std::max<uint32_t>(1, options["es-objects-max-backlog"].as<uint32_t>());
+   }
    if (options.count("es-objects-proposals")) {
       my->_es_objects_proposals = options["es-objects-proposals"].as<bool>();
    }
@@ -366,29 +437,20 @@ void es_objects_plugin::plugin_initialize(const boost::program_options::variable
             FC_THROW_EXCEPTION(graphene::chain::plugin_exception, "Error populating genesis data.");
       }
    });
+   // documents are sent in the background, failed requests are retried there
+   my->start_pipeline();
+
    database().new_objects.connect([this]( const vector<object_id_type>& ids,
          const flat_set<account_id_type>& impacted_accounts ) {
-      if(!my->index_database(ids, "create"))
-      {
-         FC_THROW_EXCEPTION(graphene::chain::plugin_exception,
-               "Error creating object from ES database, we are going to keep trying.");
-      }
+      my->index_database(ids, false);
    });
    database().changed_objects.connect([this]( const vector<object_id_type>& ids,
          const flat_set<account_id_type>& impacted_accounts ) {
-      if(!my->index_database(ids, "update"))
-      {
-         FC_THROW_EXCEPTION(graphene::chain::plugin_exception,
-               "Error updating object from ES database, we are going to keep trying.");
-      }
+      my->index_database(ids, false);
    });
    database().removed_objects.connect([this](const vector<object_id_type>& ids,
          const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts) {
-      if(!my->index_database(ids, "delete"))
-      {
-         FC_THROW_EXCEPTION(graphene::chain::plugin_exception,
-               "Error deleting object from ES database, we are going to keep trying.");
-      }
+      my->index_database(ids, true);
    });
 }
 
@@ -405,4 +467,9 @@ void es_objects_plugin::plugin_startup()
    ilog("elasticsearch OBJECTS: plugin_startup() begin");
 }
 
+void es_objects_plugin::plugin_shutdown()
+{
+   my->stop_pipeline();
+}
+
 } }
\ No newline at end of file
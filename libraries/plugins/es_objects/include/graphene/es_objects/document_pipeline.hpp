@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#pragma once
+
+#include <graphene/db/object.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/thread/future.hpp>
+#include <fc/time.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace graphene { namespace es_objects {
+
+/// A version of an object to index, or the deletion of the object if @ref object is null
+struct pending_document
+{
+   graphene::db::object_id_type                 id;
+   std::string                                  index;
+   std::shared_ptr<const graphene::db::object>  object;
+   uint32_t                                     block_number = 0;
+   fc::time_point_sec                           block_time;
+};
+
+/**
+ * The documents collected since the last flush. If only the current state of the objects is kept, every object has
+ * a single document, the last version or its deletion, at the position of its first document. Otherwise every
+ * version is kept and removed objects are not deleted, since the documents are the history of the object.
+ */
+class pending_documents
+{
+   public:
+      explicit pending_documents(bool keep_only_current = true) : _keep_only_current(keep_only_current) {}
+
+      void set_keep_only_current(bool keep_only_current) { _keep_only_current = keep_only_current; }
+      bool keep_only_current()const { return _keep_only_current; }
+
+      void add(pending_document&& doc);
+      /// Add the deletion of an object which has been removed from the database
+      void add_removed(const graphene::db::object_id_type& id, const std::string& index, uint32_t block_number,
+                       const fc::time_point_sec& block_time);
+
+      bool empty()const { return _documents.empty(); }
+      size_t size()const { return _documents.size(); }
+      const std::vector<pending_document>& documents()const { return _documents; }
+
+      /// @return the documents in the order in which they have to be sent, and start a new batch
+      std::vector<pending_document> take();
+
+   private:
+      bool _keep_only_current;
+      std::vector<pending_document> _documents;
+      /// Position of the document of every object, if only the current state is kept
+      std::unordered_map<graphene::db::object_id_type, size_t> _positions;
+};
+
+/// @return the bulk request lines of the documents in [begin, end)
+std::vector<std::string> serialize_documents(const std::vector<pending_document>& docs, size_t begin, size_t end,
+                                             const std::string& index_prefix, bool keep_only_current);
+
+/**
+ * The directory in which flushed batches are kept until ES has accepted them, one file of bulk request lines per
+ * batch. The files are named by the sequence number of their batch, zero-padded so that they sort in the order in
+ * which the batches have to be sent.
+ */
+class backlog_directory
+{
+   public:
+      /// Create the directory if it does not exist
+      explicit backlog_directory(const fc::path& dir);
+
+      const fc::path& path()const { return _dir; }
+      fc::path file(uint64_t sequence)const;
+      /// @return the files left in the directory, oldest first
+      std::vector<fc::path> files()const;
+      /// @return the sequence number of the batch after the ones left in the directory
+      uint64_t next_sequence()const;
+
+      static void store(const fc::path& file, const std::vector<std::string>& lines);
+      static std::vector<std::string> load(const fc::path& file);
+
+   private:
+      fc::path _dir;
+};
+
+/**
+ * The batches which are being serialized or sent, oldest first. Making room for a new batch drops the ones which
+ * are done, and waits for the oldest ones while the queue is full, which applies back pressure to block processing
+ * if ES can not keep up or is down.
+ */
+class batch_queue
+{
+   public:
+      explicit batch_queue(uint32_t max_batches = 16) : _max_batches(std::max<uint32_t>(1, max_batches)) {}
+
+      void set_max_batches(uint32_t max_batches) { _max_batches = std::max<uint32_t>(1, max_batches); }
+
+      void make_room();
+      void push(const fc::future<void>& batch) { _batches.push_back(batch); }
+      /// @return the most recent batch, or an invalid future if there is none
+      fc::future<void> back()const { return _batches.empty() ? fc::future<void>() : _batches.back(); }
+      bool empty()const { return _batches.empty(); }
+      size_t size()const { return _batches.size(); }
+
+      /// Wait for all batches, errors are logged
+      void wait_all();
+
+   private:
+      uint32_t _max_batches;
+      std::deque< fc::future<void> > _batches;
+};
+
+} } // graphene::es_objects
@@ -63,33 +63,63 @@ class limit_order_group_index : public secondary_index
       const flat_set<uint16_t>& get_tracked_groups() const
       { return _tracked_groups; }
 
-      const map< limit_order_group_key, limit_order_group_data >& get_order_groups() const
-      { return _og_data; }
+      const limit_order_group_book* find_book( const limit_order_group_book_key& key ) const
+      {
+         auto itr = _books.find( key );
+         return itr == _books.end() ? nullptr : &itr->second;
+      }
 
    private:
       void remove_order( const limit_order_object& obj, bool remove_empty = true );
 
+      /** lowers the min_price of the group at itr to new_min_price and adds amount to it */
+      static void extend_group_down( limit_order_group_book& book, limit_order_group_book::iterator itr,
+                                     const price& new_min_price, share_type amount );
+
       /** tracked groups */
       flat_set<uint16_t> _tracked_groups;
 
-      /** maps the group key to group data */
-      map< limit_order_group_key, limit_order_group_data > _og_data;
+      /** maps the market and group width to the groups in it */
+      map< limit_order_group_book_key, limit_order_group_book > _books;
 };
 
+void limit_order_group_index::extend_group_down( limit_order_group_book& book, limit_order_group_book::iterator itr,
+                                                 const price& new_min_price, share_type amount )
+{
+   const limit_order_group_key new_key( itr->key.group, new_min_price );
+   auto next = std::next( itr );
+   if( next == book.end() || next->key.min_price < new_min_price )
+   {
+      // the group stays at its position, so modify() does not need to relink the node
+      itr->data.total_for_sale += amount;
+      book.modify( itr, [&new_key]( limit_order_group_entry& e ) { e.key = new_key; } );
+      return;
+   }
+   // the new key reaches the next group, which should not happen since groups do not overlap,
+   // keep the old behavior of replacing that group
+   limit_order_group_data data( itr->data.max_price, itr->data.total_for_sale + amount );
+   book.erase( itr );
+   auto existing = book.find( new_key );
+   if( existing != book.end() )
+      existing->data = data;
+   else
+      book.emplace( new_key, data );
+}
+
 void limit_order_group_index::object_inserted( const object& objct )
 { try {
    const limit_order_object& o = static_cast<const limit_order_object&>( objct );
 
-   auto& idx = _og_data;
-
    for( uint16_t group : get_tracked_groups() )
    {
+      auto& book = _books[ limit_order_group_book_key( group, o.sell_price.base.asset_id,
+                                                       o.sell_price.quote.asset_id ) ];
       auto create_ogo = [&]() {
-         idx[ limit_order_group_key( group, o.sell_price ) ] = limit_order_group_data( o.sell_price, o.for_sale );
+         book.emplace( limit_order_group_key( group, o.sell_price ), limit_order_group_data( o.sell_price, o.for_sale ) );
       };
-      // if idx is empty, insert this order
+      // if there is no group in this market, insert this order
       // Note: not capped
-      if( idx.empty() )
+      if( book.empty() )
       {
          create_ogo();
          continue;
@@ -111,76 +141,60 @@ void limit_order_group_index::object_inserted( const object& objct )
          capped_price = min;
          capped_min = true;
       }
-      // if idx is not empty, find the group that is next to this order
-      auto itr = idx.lower_bound( limit_order_group_key( group, capped_price ) );
+      // find the group that is next to this order
+      auto itr = book.lower_bound( limit_order_group_key( group, capped_price ) );
       bool check_previous = false;
-      if( itr == idx.end() || itr->first.group != group
-            || itr->first.min_price.base.asset_id != o.sell_price.base.asset_id
-            || itr->first.min_price.quote.asset_id != o.sell_price.quote.asset_id )
-         // not same market or group type
+      if( itr == book.end() )
          check_previous = true;
-      else // same market and group type
+      else
       {
          bool update_max = false;
-         if( capped_price > itr->second.max_price ) // implies itr->min_price <= itr->max_price < max
+         if( capped_price > itr->data.max_price ) // implies itr->min_price <= itr->max_price < max
          {
             update_max = true;
-            price max_price = itr->first.min_price * ratio_type( GRAPHENE_100_PERCENT + group, GRAPHENE_100_PERCENT );
+            price max_price = itr->key.min_price * ratio_type( GRAPHENE_100_PERCENT + group, GRAPHENE_100_PERCENT );
             // max_price should have been capped here
             if( capped_price > max_price ) // new order is out of range
                check_previous = true;
          }
          if( !check_previous ) // new order is within the range
          {
-            if( capped_min && o.sell_price < itr->first.min_price )
+            if( capped_min && o.sell_price < itr->key.min_price )
             {  // need to update itr->min_price here, if itr is below min, and new order is even lower
-               // TODO improve performance
-               limit_order_group_data data( itr->second.max_price, o.for_sale + itr->second.total_for_sale );
-               idx.erase( itr );
-               idx[ limit_order_group_key( group, o.sell_price ) ] = data;
+               extend_group_down( book, itr, o.sell_price, o.for_sale );
             }
             else
             {
-               if( update_max || ( capped_max && o.sell_price > itr->second.max_price ) )
-                  itr->second.max_price = o.sell_price; // store real price here, not capped
-               itr->second.total_for_sale += o.for_sale;
+               if( update_max || ( capped_max && o.sell_price > itr->data.max_price ) )
+                  itr->data.max_price = o.sell_price; // store real price here, not capped
+               itr->data.total_for_sale += o.for_sale;
             }
          }
       }
 
       if( check_previous )
       {
-         if( itr == idx.begin() ) // no previous
+         if( itr == book.begin() ) // no previous
             create_ogo();
          else
          {
             --itr; // should be valid
-            if( itr->first.group != group || itr->first.min_price.base.asset_id != o.sell_price.base.asset_id
-                                          || itr->first.min_price.quote.asset_id != o.sell_price.quote.asset_id )
-               // not same market or group type
+            // due to lower_bound, always true: capped_price < itr->key.min_price, so no need to check again,
+            // if new order is in range of itr group, always need to update itr->key.min_price, unless
+            //   o.sell_price is higher than max
+            price min_price = itr->data.max_price / ratio_type( GRAPHENE_100_PERCENT + group, GRAPHENE_100_PERCENT );
+            // min_price should have been capped here
+            if( capped_price < min_price ) // new order is out of range
                create_ogo();
-            else // same market and group type
-            {
-               // due to lower_bound, always true: capped_price < itr->first.min_price, so no need to check again,
-               // if new order is in range of itr group, always need to update itr->first.min_price, unless
-               //   o.sell_price is higher than max
-               price min_price = itr->second.max_price / ratio_type( GRAPHENE_100_PERCENT + group, GRAPHENE_100_PERCENT );
-               // min_price should have been capped here
-               if( capped_price < min_price ) // new order is out of range
-                  create_ogo();
-               else if( capped_max && o.sell_price >= itr->first.min_price )
-               {  // itr is above max, and price of new order is even higher
-                  if( o.sell_price > itr->second.max_price )
-                     itr->second.max_price = o.sell_price;
-                  itr->second.total_for_sale += o.for_sale;
-               }
-               else
-               {  // new order is within the range
-                  // TODO improve performance
-                  limit_order_group_data data( itr->second.max_price, o.for_sale + itr->second.total_for_sale );
-                  idx.erase( itr );
-                  idx[ limit_order_group_key( group, o.sell_price ) ] = data;
-               }
+            else if( capped_max && o.sell_price >= itr->key.min_price )
+            {  // itr is above max, and price of new order is even higher
+               if( o.sell_price > itr->data.max_price )
+                  itr->data.max_price = o.sell_price;
+               itr->data.total_for_sale += o.for_sale;
+            }
+            else
+            {  // new order is within the range
+               extend_group_down( book, itr, o.sell_price, o.for_sale );
             }
          }
       }
@@ -206,16 +220,20 @@ void limit_order_group_index::object_modified( const object& objct )
 
 void limit_order_group_index::remove_order( const limit_order_object& o, bool remove_empty )
 {
-   auto& idx = _og_data;
-
    for( uint16_t group : get_tracked_groups() )
    {
+      auto book_itr = _books.find( limit_order_group_book_key( group, o.sell_price.base.asset_id,
+                                                               o.sell_price.quote.asset_id ) );
+      if( book_itr == _books.end() )
+      {
+         // can not find corresponding market, should not happen
+         wlog( "can not find the order group containing order for removing (market dismatch): ${o}", ("o",o) );
+         continue;
+      }
+      auto& book = book_itr->second;
       // find the group that should contain this order
-      auto itr = idx.lower_bound( limit_order_group_key( group, o.sell_price ) );
-      if( itr == idx.end() || itr->first.group != group
-            || itr->first.min_price.base.asset_id != o.sell_price.base.asset_id
-            || itr->first.min_price.quote.asset_id != o.sell_price.quote.asset_id
-            || itr->second.max_price < o.sell_price )
+      auto itr = book.lower_bound( limit_order_group_key( group, o.sell_price ) );
+      if( itr == book.end() || itr->data.max_price < o.sell_price )
       {
          // can not find corresponding group, should not happen
          wlog( "can not find the order group containing order for removing (price dismatch): ${o}", ("o",o) );
@@ -223,14 +241,18 @@ void limit_order_group_index::remove_order( const limit_order_object& o, bool re
       }
       else // found
       {
-         if( itr->second.total_for_sale < o.for_sale )
+         if( itr->data.total_for_sale < o.for_sale )
             // should not happen
             wlog( "can not find the order group containing order for removing (amount dismatch): ${o}", ("o",o) );
-         else if( !remove_empty || itr->second.total_for_sale > o.for_sale )
-            itr->second.total_for_sale -= o.for_sale;
+         else if( !remove_empty || itr->data.total_for_sale > o.for_sale )
+            itr->data.total_for_sale -= o.for_sale;
          else
+         {
             // it's the only order in the group and need to be removed
-            idx.erase( itr );
+            book.erase( itr );
+            if( book.empty() )
+               _books.erase( book_itr );
+         }
       }
    }
 }
@@ -294,12 +316,14 @@ const flat_set<uint16_t>& grouped_orders_plugin::tracked_groups() const
    return my->_tracked_groups;
 }
 
-const map< limit_order_group_key, limit_order_group_data >& grouped_orders_plugin::limit_order_groups()
+const limit_order_group_book* grouped_orders_plugin::find_limit_order_group_book( uint16_t group,
+                                                                                   asset_id_type base,
+                                                                                   asset_id_type quote )
 {
    const auto& idx = database().get_index_type< limit_order_index >();
    const auto& pidx = dynamic_cast<const primary_index< limit_order_index >&>(idx);
    const auto& logidx = pidx.get_secondary_index< detail::limit_order_group_index >();
-   return logidx.get_order_groups();
+   return logidx.find_book( limit_order_group_book_key( group, base, quote ) );
 }
 
 } }
@@ -26,6 +26,10 @@
 #include <graphene/app/plugin.hpp>
 #include <graphene/chain/database.hpp>
 
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+
 namespace graphene { namespace grouped_orders {
 using namespace chain;
 
@@ -57,6 +61,49 @@ struct limit_order_group_data
    share_type    total_for_sale; ///< asset id is min_price.base.asset_id
 };
 
+/**
+ *  @brief Identifies the order groups of one market with one group width
+ */
+struct limit_order_group_book_key
+{
+   limit_order_group_book_key( const uint16_t g, const asset_id_type b, const asset_id_type q )
+   : group(g), base(b), quote(q) {}
+   limit_order_group_book_key() {}
+
+   uint16_t      group = 0;
+   asset_id_type base;  ///< asset being sold
+   asset_id_type quote; ///< asset being purchased
+
+   friend bool operator < ( const limit_order_group_book_key& a, const limit_order_group_book_key& b )
+   {
+      return std::tie( a.group, a.base, a.quote ) < std::tie( b.group, b.base, b.quote );
+   }
+};
+
+struct limit_order_group_entry
+{
+   limit_order_group_entry( const limit_order_group_key& k, const limit_order_group_data& d ) : key(k), data(d) {}
+
+   limit_order_group_key          key;
+   /// not a part of the sort key, so it is updated in place without touching the index
+   mutable limit_order_group_data data;
+};
+
+/**
+ *  The order groups of one market with one group width, ordered from best offered price to worst.
+ *
+ *  Groups never overlap, so the minimum price of a group can be lowered with an in-place @c modify which keeps the
+ *  node where it is, instead of erasing and re-inserting it.
+ */
+typedef boost::multi_index_container<
+   limit_order_group_entry,
+   boost::multi_index::indexed_by<
+      boost::multi_index::ordered_unique<
+         boost::multi_index::member< limit_order_group_entry, limit_order_group_key, &limit_order_group_entry::key >
+      >
+   >
+> limit_order_group_book;
+
 namespace detail
 {
     class grouped_orders_plugin_impl;
@@ -82,7 +129,12 @@ class grouped_orders_plugin : public graphene::app::plugin
 
       const flat_set<uint16_t>&   tracked_groups()const;
 
-      const map< limit_order_group_key, limit_order_group_data >& limit_order_groups();
+      /**
+       *  @return the order groups of the given market with the given group width,
+       *          or nullptr if there is no such group
+       */
+      const limit_order_group_book* find_limit_order_group_book( uint16_t group, asset_id_type base,
+                                                                 asset_id_type quote );
 
    private:
       friend class detail::grouped_orders_plugin_impl;
@@ -93,3 +145,4 @@ class grouped_orders_plugin : public graphene::app::plugin
 
 FC_REFLECT( graphene::grouped_orders::limit_order_group_key, (group)(min_price) )
 FC_REFLECT( graphene::grouped_orders::limit_order_group_data, (max_price)(total_for_sale) )
+FC_REFLECT( graphene::grouped_orders::limit_order_group_book_key, (group)(base)(quote) )
@@ -25,6 +25,7 @@
 
 #include <graphene/app/plugin.hpp>
 #include <graphene/chain/database.hpp>
+#include <graphene/chain/liquidity_pool_object.hpp>
 
 #include <fc/thread/future.hpp>
 #include <fc/uint128.hpp>
@@ -53,7 +54,8 @@ enum market_history_object_type
    order_history_object_type = 0,
    bucket_object_type = 1,
    market_ticker_object_type = 2,
-   market_ticker_meta_object_type = 3
+   market_ticker_meta_object_type = 3,
+   liquidity_pool_ticker_object_type = 4
 };
 
 struct bucket_key
@@ -159,6 +161,53 @@ struct market_ticker_meta_object : public abstract_object<market_ticker_meta_obj
    bool                skip_min_order_his_id = false;
 };
 
+/// Activity of a liquidity pool during one hour
+struct liquidity_pool_hourly_stats
+{
+   uint32_t            hour = 0;             ///< number of hours since the epoch
+   uint32_t            exchange_count = 0;
+   uint32_t            deposit_count = 0;
+   uint32_t            withdrawal_count = 0;
+   fc::uint128_t       volume_a;             ///< amount of asset A paid or received by accounts in exchanges
+   fc::uint128_t       volume_b;             ///< amount of asset B paid or received by accounts in exchanges
+   fc::uint128_t       fee_a;                ///< market fees paid in asset A in exchanges
+   fc::uint128_t       fee_b;                ///< market fees paid in asset B in exchanges
+   /// exchange prices, the base asset is asset A, only valid if exchange_count is not zero
+   price               open;
+   price               high;
+   price               low;
+   price               close;
+};
+
+/**
+ *  Statistics of a liquidity pool in the last 24 hours. Activity is kept per hour, so that the totals can be rolled out
+ *  incrementally when an hour gets older than 24 hours.
+ */
+struct liquidity_pool_ticker_object : public abstract_object<liquidity_pool_ticker_object>
+{
+   static constexpr uint8_t space_id = MARKET_HISTORY_SPACE_ID;
+   static constexpr uint8_t type_id  = liquidity_pool_ticker_object_type;
+
+   liquidity_pool_id_type                pool;
+   /// the assets of the pool, volumes are only comparable among pools of the same asset
+   asset_id_type                         asset_a;
+   asset_id_type                         asset_b;
+   /// the hours of the last 24 hours in which the pool was active, oldest first
+   vector<liquidity_pool_hourly_stats>   hourly_stats;
+   /// when the oldest hourly stats will be rolled out
+   fc::time_point_sec                    next_expiration = fc::time_point_sec::maximum();
+
+   uint32_t                              _24h_exchange_count = 0;
+   uint32_t                              _24h_deposit_count = 0;
+   uint32_t                              _24h_withdrawal_count = 0;
+   fc::uint128_t                         _24h_volume_a;
+   fc::uint128_t                         _24h_volume_b;
+   fc::uint128_t                         _24h_fee_a;
+   fc::uint128_t                         _24h_fee_b;
+
+   uint64_t                              total_exchange_count = 0;
+};
+
 struct by_key;
 typedef multi_index_container<
    bucket_object,
@@ -212,9 +261,54 @@ typedef multi_index_container<
    >
 > market_ticker_object_multi_index_type;
 
+struct by_pool;
+struct by_volume_a;
+struct by_volume_b;
+struct by_expiration;
+typedef multi_index_container<
+   liquidity_pool_ticker_object,
+   indexed_by<
+      ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
+      ordered_unique< tag<by_pool>,
+                      member< liquidity_pool_ticker_object, liquidity_pool_id_type, &liquidity_pool_ticker_object::pool > >,
+      ordered_unique<
+         tag<by_volume_a>,
+         composite_key<
+            liquidity_pool_ticker_object,
+            member<liquidity_pool_ticker_object, asset_id_type, &liquidity_pool_ticker_object::asset_a>,
+            member<liquidity_pool_ticker_object, fc::uint128_t, &liquidity_pool_ticker_object::_24h_volume_a>,
+            member<liquidity_pool_ticker_object, liquidity_pool_id_type, &liquidity_pool_ticker_object::pool>
+         >,
+         composite_key_compare<
+            std::less< asset_id_type >,
+            std::greater< fc::uint128_t >,
+            std::less< liquidity_pool_id_type >
+         >
+      >,
+      ordered_unique<
+         tag<by_volume_b>,
+         composite_key<
+            liquidity_pool_ticker_object,
+            member<liquidity_pool_ticker_object, asset_id_type, &liquidity_pool_ticker_object::asset_b>,
+            member<liquidity_pool_ticker_object, fc::uint128_t, &liquidity_pool_ticker_object::_24h_volume_b>,
+            member<liquidity_pool_ticker_object, liquidity_pool_id_type, &liquidity_pool_ticker_object::pool>
+         >,
+         composite_key_compare<
+            std::less< asset_id_type >,
+            std::greater< fc::uint128_t >,
+            std::less< liquidity_pool_id_type >
+         >
+      >,
+      ordered_non_unique< tag<by_expiration>,
+         member< liquidity_pool_ticker_object, fc::time_point_sec, &liquidity_pool_ticker_object::next_expiration > >
+   >
+> liquidity_pool_ticker_multi_index_type;
+
 typedef generic_index<bucket_object, bucket_object_multi_index_type> bucket_index;
 typedef generic_index<order_history_object, order_history_multi_index_type> history_index;
 typedef generic_index<market_ticker_object, market_ticker_object_multi_index_type> market_ticker_index;
+typedef generic_index<liquidity_pool_ticker_object, liquidity_pool_ticker_multi_index_type>
+        liquidity_pool_ticker_index;
 
 
 namespace detail
@@ -226,6 +320,10 @@ namespace detail
  *  The market history plugin can be configured to track any number of intervals via its configuration.  Once per block it
  *  will scan the virtual operations and look for fill_order_operations and then adjust the appropriate bucket objects for
  *  each fill order.
+ *
+ *  Only the finest bucket size is updated by a fill. Buckets which become older than the history kept for their size are
+ *  merged into the next coarser stored size, so every fill is stored in exactly one bucket. OHLCV data for any multiple
+ *  of the finest size is aggregated from the stored buckets on demand, see @ref get_market_history.
  */
 class market_history_plugin : public graphene::app::plugin
 {
@@ -243,9 +341,23 @@ class market_history_plugin : public graphene::app::plugin
 
       uint32_t                    max_history()const;
       const flat_set<uint32_t>&   tracked_buckets()const;
+      /// The bucket sizes data is stored in, ascending, each one is a multiple of the previous one
+      const vector<uint32_t>&     stored_buckets()const;
       uint32_t                    max_order_his_records_per_market()const;
       uint32_t                    max_order_his_seconds_per_market()const;
 
+      /**
+       *  Aggregate the OHLCV data of a market into buckets of @p bucket_seconds.
+       *
+       *  @param bucket_seconds has to be a multiple of the finest stored bucket size, otherwise no data is returned
+       *  @return at most @p limit buckets which open in [start, end], in "least recent first" order.
+       *          Buckets are only returned for periods which are completely covered by the stored data.
+       *          The returned buckets are aggregates, their IDs are not set.
+       */
+      vector<bucket_object> get_market_history( asset_id_type base, asset_id_type quote, uint32_t bucket_seconds,
+                                                fc::time_point_sec start, fc::time_point_sec end,
+                                                uint32_t limit );
+
    private:
       friend class detail::market_history_plugin_impl;
       std::unique_ptr<detail::market_history_plugin_impl> my;
@@ -270,3 +382,12 @@ FC_REFLECT_DERIVED( graphene::market_history::market_ticker_object, (graphene::d
                     (base_volume)(quote_volume) )
 FC_REFLECT_DERIVED( graphene::market_history::market_ticker_meta_object, (graphene::db::object),
                     (rolling_min_order_his_id)(skip_min_order_his_id) )
+FC_REFLECT( graphene::market_history::liquidity_pool_hourly_stats,
+            (hour)(exchange_count)(deposit_count)(withdrawal_count)
+            (volume_a)(volume_b)(fee_a)(fee_b)
+            (open)(high)(low)(close) )
+FC_REFLECT_DERIVED( graphene::market_history::liquidity_pool_ticker_object, (graphene::db::object),
+                    (pool)(asset_a)(asset_b)(hourly_stats)(next_expiration)
+                    (_24h_exchange_count)(_24h_deposit_count)(_24h_withdrawal_count)
+                    (_24h_volume_a)(_24h_volume_b)(_24h_fee_a)(_24h_fee_b)
+                    (total_exchange_count) )
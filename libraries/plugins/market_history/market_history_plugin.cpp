@@ -35,6 +35,10 @@
 
 #include <fc/thread/thread.hpp>
 
+#include <algorithm>
+#include <deque>
+#include <mutex>
+
 namespace graphene { namespace market_history {
 
 namespace detail
@@ -57,13 +61,122 @@ class market_history_plugin_impl
          return _self.database();
       }
 
+      /// Keep track of the time of the last irreversible block, which tells which buckets can be cached
+      void update_irreversible_time( const signed_block& b );
+
+      /// Add the effect of an applied liquidity pool operation to the ticker of the pool
+      void update_liquidity_pool_ticker( const operation_history_object& oho, fc::time_point_sec now );
+
+      /// Remove activity which is older than 24 hours from the liquidity pool tickers
+      void roll_out_liquidity_pool_tickers( fc::time_point_sec now );
+
       market_history_plugin&     _self;
       flat_set<uint32_t>         _tracked_buckets;
+      vector<uint32_t>           _stored_buckets;
       uint32_t                   _maximum_history_per_bucket_size = 1000;
       uint32_t                   _max_order_his_records_per_market = 1000;
       uint32_t                   _max_order_his_seconds_per_market = 259200;
+
+      /// Protects the members below, which are also used by API calls
+      std::mutex                                              _cache_mutex;
+      /// Aggregated buckets which can not change any more
+      std::map< bucket_key, bucket_object >                   _bucket_cache;
+      /// Number and time of the reversible blocks
+      std::deque< std::pair< uint32_t, fc::time_point_sec > > _recent_block_times;
+      fc::time_point_sec                                      _irreversible_time;
 };
 
+/// Maximum number of aggregated buckets kept in the cache, it is cleared when it grows beyond this
+static const size_t max_cached_buckets = 10000;
+
+static void copy_bucket_data( bucket_object& to, const bucket_object& from )
+{
+   to.high_base    = from.high_base;
+   to.high_quote   = from.high_quote;
+   to.low_base     = from.low_base;
+   to.low_quote    = from.low_quote;
+   to.open_base    = from.open_base;
+   to.open_quote   = from.open_quote;
+   to.close_base   = from.close_base;
+   to.close_quote  = from.close_quote;
+   to.base_volume  = from.base_volume;
+   to.quote_volume = from.quote_volume;
+}
+
+/// Add the trades of @p later, which have all been made after the trades in @p into, to @p into
+static void merge_bucket( bucket_object& into, const bucket_object& later )
+{
+   try {
+      into.base_volume += later.base_volume;
+   } catch( fc::overflow_exception& ) {
+      into.base_volume = std::numeric_limits<int64_t>::max();
+   }
+   try {
+      into.quote_volume += later.quote_volume;
+   } catch( fc::overflow_exception& ) {
+      into.quote_volume = std::numeric_limits<int64_t>::max();
+   }
+   into.close_base = later.close_base;
+   into.close_quote = later.close_quote;
+   if( into.high() < later.high() )
+   {
+      into.high_base = later.high_base;
+      into.high_quote = later.high_quote;
+   }
+   if( into.low() > later.low() )
+   {
+      into.low_base = later.low_base;
+      into.low_quote = later.low_quote;
+   }
+}
+
+/**
+ *  Merge the buckets of a market which are older than the history kept for their size into the next stored size.
+ *  Buckets of the coarsest stored size are removed instead.
+ */
+static void roll_up_buckets( graphene::chain::database& db, const vector<uint32_t>& stored_buckets,
+                             uint32_t max_history, asset_id_type base, asset_id_type quote, fc::time_point_sec now )
+{
+   const auto& by_key_idx = db.get_index_type<bucket_index>().indices().get<by_key>();
+   for( size_t i = 0; i < stored_buckets.size(); ++i )
+   {
+      const uint32_t bucket = stored_buckets[i];
+      const auto bucket_num = now.sec_since_epoch() / bucket;
+      if( bucket_num <= max_history )
+         continue;
+      const fc::time_point_sec cutoff = fc::time_point_sec() + ( bucket * ( bucket_num - max_history ) );
+
+      auto bucket_itr = by_key_idx.lower_bound( bucket_key( base, quote, bucket, fc::time_point_sec() ) );
+      while( bucket_itr != by_key_idx.end() &&
+             bucket_itr->key.base == base &&
+             bucket_itr->key.quote == quote &&
+             bucket_itr->key.seconds == bucket &&
+             bucket_itr->key.open < cutoff )
+      {
+         if( i + 1 < stored_buckets.size() )
+         {
+            // buckets are rolled up in time order, so the coarser bucket only contains older trades
+            const uint32_t next_bucket = stored_buckets[i + 1];
+            const bucket_key next_key( base, quote, next_bucket, fc::time_point_sec()
+                                       + ( bucket_itr->key.open.sec_since_epoch() / next_bucket * next_bucket ) );
+            auto next_itr = by_key_idx.find( next_key );
+            if( next_itr == by_key_idx.end() )
+               db.create<bucket_object>( [&]( bucket_object& b ){
+                  b.key = next_key;
+                  copy_bucket_data( b, *bucket_itr );
+               });
+            else
+               db.modify( *next_itr, [&]( bucket_object& b ){
+                  merge_bucket( b, *bucket_itr );
+               });
+         }
+         auto old_bucket_itr = bucket_itr;
+         ++bucket_itr;
+         db.remove( *old_bucket_itr );
+      }
+   }
+}
+
 
 struct operation_process_fill_order
 {
@@ -206,96 +319,246 @@ struct operation_process_fill_order
       const auto max_history = _plugin.max_history();
       if( max_history == 0 ) return;
 
-      const auto& buckets = _plugin.tracked_buckets();
+      const auto& buckets = _plugin.stored_buckets();
       if( buckets.size() == 0 ) return;
 
-      const auto& bucket_idx = db.get_index_type<bucket_index>();
-      for( auto bucket : buckets )
-      {
-          auto bucket_num = _now.sec_since_epoch() / bucket;
-          fc::time_point_sec cutoff;
-          if( bucket_num > max_history )
-             cutoff = cutoff + ( bucket * ( bucket_num - max_history ) );
-
-          key.seconds = bucket;
-          key.open    = fc::time_point_sec() + ( bucket_num * bucket );
-
-          const auto& by_key_idx = bucket_idx.indices().get<by_key>();
-          auto bucket_itr = by_key_idx.find( key );
-          if( bucket_itr == by_key_idx.end() )
-          { // create new bucket
-            /* const auto& obj = */
-            db.create<bucket_object>( [&]( bucket_object& b ){
-                 b.key = key;
-                 b.base_volume = trade_price.base.amount;
-                 b.quote_volume = trade_price.quote.amount;
-                 b.open_base = fill_price.base.amount;
-                 b.open_quote = fill_price.quote.amount;
-                 b.close_base = fill_price.base.amount;
-                 b.close_quote = fill_price.quote.amount;
-                 b.high_base = b.close_base;
-                 b.high_quote = b.close_quote;
-                 b.low_base = b.close_base;
-                 b.low_quote = b.close_quote;
-            });
-            //wlog( "    creating bucket ${b}", ("b",obj) );
-          }
-          else
-          { // update existing bucket
-             //wlog( "    before updating bucket ${b}", ("b",*bucket_itr) );
-             db.modify( *bucket_itr, [&]( bucket_object& b ){
-                  try {
-                     b.base_volume += trade_price.base.amount;
-                  } catch( fc::overflow_exception& ) {
-                     b.base_volume = std::numeric_limits<int64_t>::max();
-                  }
-                  try {
-                     b.quote_volume += trade_price.quote.amount;
-                  } catch( fc::overflow_exception& ) {
-                     b.quote_volume = std::numeric_limits<int64_t>::max();
-                  }
-                  b.close_base = fill_price.base.amount;
-                  b.close_quote = fill_price.quote.amount;
-                  if( b.high() < fill_price )
-                  {
-                      b.high_base = b.close_base;
-                      b.high_quote = b.close_quote;
-                  }
-                  if( b.low() > fill_price )
-                  {
-                      b.low_base = b.close_base;
-                      b.low_quote = b.close_quote;
-                  }
-             });
-             //wlog( "    after bucket bucket ${b}", ("b",*bucket_itr) );
-          }
-
-          {
-             key.open = fc::time_point_sec();
-             bucket_itr = by_key_idx.lower_bound( key );
-
-             while( bucket_itr != by_key_idx.end() &&
-                    bucket_itr->key.base == key.base &&
-                    bucket_itr->key.quote == key.quote &&
-                    bucket_itr->key.seconds == bucket &&
-                    bucket_itr->key.open < cutoff )
-             {
-              //  elog( "    removing old bucket ${b}", ("b", *bucket_itr) );
-                auto old_bucket_itr = bucket_itr;
-                ++bucket_itr;
-                db.remove( *old_bucket_itr );
-             }
-          }
+      // only the finest bucket is updated, coarser buckets are rolled up from it when it becomes old
+      const uint32_t bucket = buckets.front();
+      key.seconds = bucket;
+      key.open    = fc::time_point_sec() + ( _now.sec_since_epoch() / bucket * bucket );
+
+      const auto& by_key_idx = db.get_index_type<bucket_index>().indices().get<by_key>();
+      auto bucket_itr = by_key_idx.find( key );
+      if( bucket_itr == by_key_idx.end() )
+      { // create new bucket
+         db.create<bucket_object>( [&]( bucket_object& b ){
+              b.key = key;
+              b.base_volume = trade_price.base.amount;
+              b.quote_volume = trade_price.quote.amount;
+              b.open_base = fill_price.base.amount;
+              b.open_quote = fill_price.quote.amount;
+              b.close_base = fill_price.base.amount;
+              b.close_quote = fill_price.quote.amount;
+              b.high_base = b.close_base;
+              b.high_quote = b.close_quote;
+              b.low_base = b.close_base;
+              b.low_quote = b.close_quote;
+         });
+      }
+      else
+      { // update existing bucket
+         db.modify( *bucket_itr, [&]( bucket_object& b ){
+              try {
+                 b.base_volume += trade_price.base.amount;
+              } catch( fc::overflow_exception& ) {
+                 b.base_volume = std::numeric_limits<int64_t>::max();
+              }
+              try {
+                 b.quote_volume += trade_price.quote.amount;
+              } catch( fc::overflow_exception& ) {
+                 b.quote_volume = std::numeric_limits<int64_t>::max();
+              }
+              b.close_base = fill_price.base.amount;
+              b.close_quote = fill_price.quote.amount;
+              if( b.high() < fill_price )
+              {
+                  b.high_base = b.close_base;
+                  b.high_quote = b.close_quote;
+              }
+              if( b.low() > fill_price )
+              {
+                  b.low_base = b.close_base;
+                  b.low_quote = b.close_quote;
+              }
+         });
       }
+
+      roll_up_buckets( db, buckets, max_history, key.base, key.quote, _now );
    }
 };
 
 market_history_plugin_impl::~market_history_plugin_impl()
 {}
 
+static void roll_out_liquidity_pool_stats( liquidity_pool_ticker_object& t, fc::time_point_sec now )
+{
+   const uint32_t now_hour = now.sec_since_epoch() / 3600;
+   auto itr = t.hourly_stats.begin();
+   for( ; itr != t.hourly_stats.end() && itr->hour + 24 <= now_hour; ++itr )
+   {
+      t._24h_exchange_count   -= itr->exchange_count;
+      t._24h_deposit_count    -= itr->deposit_count;
+      t._24h_withdrawal_count -= itr->withdrawal_count;
+      t._24h_volume_a         -= itr->volume_a;
+      t._24h_volume_b         -= itr->volume_b;
+      t._24h_fee_a            -= itr->fee_a;
+      t._24h_fee_b            -= itr->fee_b;
+   }
+   t.hourly_stats.erase( t.hourly_stats.begin(), itr );
+   if( t.hourly_stats.empty() )
+      t.next_expiration = fc::time_point_sec::maximum();
+   else
+      t.next_expiration = fc::time_point_sec( ( t.hourly_stats.front().hour + 24 ) * 3600 );
+}
+
+/// @return the stats of the current hour, which are created if needed
+static liquidity_pool_hourly_stats& current_liquidity_pool_stats( liquidity_pool_ticker_object& t,
+                                                                  fc::time_point_sec now )
+{
+   roll_out_liquidity_pool_stats( t, now );
+   const uint32_t now_hour = now.sec_since_epoch() / 3600;
+   if( t.hourly_stats.empty() || t.hourly_stats.back().hour != now_hour )
+   {
+      t.hourly_stats.emplace_back();
+      t.hourly_stats.back().hour = now_hour;
+      if( t.hourly_stats.size() == 1 )
+         t.next_expiration = fc::time_point_sec( ( now_hour + 24 ) * 3600 );
+   }
+   return t.hourly_stats.back();
+}
+
+void market_history_plugin_impl::update_liquidity_pool_ticker( const operation_history_object& oho,
+                                                               fc::time_point_sec now )
+{
+   const int which = oho.op.which();
+   liquidity_pool_id_type pool_id;
+   if( which == operation::tag<liquidity_pool_exchange_operation>::value )
+      pool_id = oho.op.get<liquidity_pool_exchange_operation>().pool;
+   else if( which == operation::tag<liquidity_pool_deposit_operation>::value )
+      pool_id = oho.op.get<liquidity_pool_deposit_operation>().pool;
+   else if( which == operation::tag<liquidity_pool_withdraw_operation>::value )
+      pool_id = oho.op.get<liquidity_pool_withdraw_operation>().pool;
+   else if( which == operation::tag<liquidity_pool_delete_operation>::value )
+      pool_id = oho.op.get<liquidity_pool_delete_operation>().pool;
+   else
+      return;
+
+   graphene::chain::database& db = database();
+   const auto& ticker_idx = db.get_index_type<liquidity_pool_ticker_index>().indices().get<by_pool>();
+   auto ticker_itr = ticker_idx.find( pool_id );
+
+   if( which == operation::tag<liquidity_pool_delete_operation>::value )
+   {
+      if( ticker_itr != ticker_idx.end() )
+         db.remove( *ticker_itr );
+      return;
+   }
+
+   const liquidity_pool_object* pool = db.find( pool_id );
+   if( pool == nullptr ) // should not happen
+      return;
+
+   const liquidity_pool_ticker_object* ticker;
+   if( ticker_itr != ticker_idx.end() )
+      ticker = &( *ticker_itr );
+   else
+      ticker = &db.create<liquidity_pool_ticker_object>( [pool]( liquidity_pool_ticker_object& t ) {
+         t.pool = pool->id;
+         t.asset_a = pool->asset_a;
+         t.asset_b = pool->asset_b;
+      });
+
+   if( which == operation::tag<liquidity_pool_deposit_operation>::value )
+   {
+      db.modify( *ticker, [now]( liquidity_pool_ticker_object& t ) {
+         ++current_liquidity_pool_stats( t, now ).deposit_count;
+         ++t._24h_deposit_count;
+      });
+      return;
+   }
+   if( which == operation::tag<liquidity_pool_withdraw_operation>::value )
+   {
+      db.modify( *ticker, [now]( liquidity_pool_ticker_object& t ) {
+         ++current_liquidity_pool_stats( t, now ).withdrawal_count;
+         ++t._24h_withdrawal_count;
+      });
+      return;
+   }
+
+   // exchange
+   const auto& result = oho.result.get<generic_exchange_operation_result>();
+   FC_ASSERT( result.paid.size() == 1 && result.received.size() == 1, "Unexpected exchange result" );
+   const asset& paid = result.paid.front();
+   const asset& received = result.received.front();
+   const bool sells_a = ( paid.asset_id == pool->asset_a );
+   const asset& amount_a = sells_a ? paid : received;
+   const asset& amount_b = sells_a ? received : paid;
+   fc::uint128_t fee_a;
+   fc::uint128_t fee_b;
+   for( const asset& fee : result.fees )
+   {
+      if( fee.asset_id == pool->asset_a )
+         fee_a += fee.amount.value;
+      else if( fee.asset_id == pool->asset_b )
+         fee_b += fee.amount.value;
+   }
+   const bool has_price = ( amount_a.amount > 0 && amount_b.amount > 0 );
+   const price exchange_price = has_price ? amount_a / amount_b : price();
+
+   db.modify( *ticker, [&]( liquidity_pool_ticker_object& t ) {
+      liquidity_pool_hourly_stats& stats = current_liquidity_pool_stats( t, now );
+      if( has_price )
+      {
+         if( stats.exchange_count == 0 )
+         {
+            stats.open = exchange_price;
+            stats.high = exchange_price;
+            stats.low = exchange_price;
+         }
+         else if( exchange_price > stats.high )
+            stats.high = exchange_price;
+         else if( exchange_price < stats.low )
+            stats.low = exchange_price;
+         stats.close = exchange_price;
+      }
+      ++stats.exchange_count;
+      stats.volume_a += amount_a.amount.value;
+      stats.volume_b += amount_b.amount.value;
+      stats.fee_a += fee_a;
+      stats.fee_b += fee_b;
+
+      ++t._24h_exchange_count;
+      t._24h_volume_a += amount_a.amount.value;
+      t._24h_volume_b += amount_b.amount.value;
+      t._24h_fee_a += fee_a;
+      t._24h_fee_b += fee_b;
+      ++t.total_exchange_count;
+   });
+}
+
+void market_history_plugin_impl::roll_out_liquidity_pool_tickers( fc::time_point_sec now )
+{
+   graphene::chain::database& db = database();
+   const auto& expiration_idx = db.get_index_type<liquidity_pool_ticker_index>().indices().get<by_expiration>();
+   auto itr = expiration_idx.begin();
+   while( itr != expiration_idx.end() && itr->next_expiration <= now )
+   {
+      db.modify( *itr, [now]( liquidity_pool_ticker_object& t ) {
+         roll_out_liquidity_pool_stats( t, now );
+      });
+      itr = expiration_idx.begin();
+   }
+}
+
+void market_history_plugin_impl::update_irreversible_time( const signed_block& b )
+{
+   std::lock_guard<std::mutex> guard( _cache_mutex );
+   // blocks which have been popped are replaced
+   while( !_recent_block_times.empty() && _recent_block_times.back().first >= b.block_num() )
+      _recent_block_times.pop_back();
+   _recent_block_times.emplace_back( b.block_num(), b.timestamp );
+   const uint32_t lib = database().get_dynamic_global_properties().last_irreversible_block_num;
+   while( !_recent_block_times.empty() && _recent_block_times.front().first <= lib )
+   {
+      _irreversible_time = _recent_block_times.front().second;
+      _recent_block_times.pop_front();
+   }
+}
+
 void market_history_plugin_impl::update_market_histories( const signed_block& b )
 {
    graphene::chain::database& db = database();
+   update_irreversible_time( b );
    const market_ticker_meta_object* _meta = nullptr;
    const auto& meta_idx = db.get_index_type<simple_index<market_ticker_meta_object>>();
    if( meta_idx.size() > 0 )
@@ -308,9 +571,11 @@ void market_history_plugin_impl::update_market_histories( const signed_block& b
          try
          {
             o_op->op.visit( operation_process_fill_order( _self, b.timestamp, _meta ) );
+            update_liquidity_pool_ticker( *o_op, b.timestamp );
          } FC_CAPTURE_AND_LOG( (o_op) )
       }
    }
+   roll_out_liquidity_pool_tickers( b.timestamp );
    // roll out expired data from ticker
    if( _meta != nullptr )
    {
@@ -411,9 +676,12 @@ void market_history_plugin::plugin_set_program_options(
 {
    cli.add_options()
          ("bucket-size", boost::program_options::value<string>()->default_value("[60,300,900,1800,3600,14400,86400]"),
-           "Track market history by grouping orders into buckets of equal size measured in seconds specified as a JSON array of numbers")
+           "Track market history by grouping orders into buckets of equal size measured in seconds specified as a JSON array of numbers. "
+           "Only the sizes which are multiples of the next smaller size are stored, data of other multiples of the greatest "
+           "common divisor of the sizes is aggregated on request and keeps a shorter history, which is logged at startup")
          ("history-per-size", boost::program_options::value<uint32_t>()->default_value(1000),
-           "How far back in time to track history for each bucket size, measured in the number of buckets (default: 1000)")
+           "How far back in time to track history for each bucket size, measured in the number of buckets (default: 1000). "
+           "Older data is merged into the next larger size")
          ("max-order-his-records-per-market", boost::program_options::value<uint32_t>()->default_value(1000),
            "Will only store this amount of matched orders for each market in order history for querying, or those meet the other option, which has more data (default: 1000)")
          ("max-order-his-seconds-per-market", boost::program_options::value<uint32_t>()->default_value(259200),
@@ -429,6 +697,7 @@ void market_history_plugin::plugin_initialize(const boost::program_options::vari
    database().add_index< primary_index< history_index  > >();
    database().add_index< primary_index< market_ticker_index  > >();
    database().add_index< primary_index< simple_index< market_ticker_meta_object > > >();
+   database().add_index< primary_index< liquidity_pool_ticker_index > >();
 
    if( options.count( "bucket-size" ) )
    {
@@ -436,8 +705,48 @@ void market_history_plugin::plugin_initialize(const boost::program_options::vari
       my->_tracked_buckets = fc::json::from_string(buckets).as<flat_set<uint32_t>>(2);
       my->_tracked_buckets.erase( 0 );
    }
+   if( !my->_tracked_buckets.empty() )
+   {
+      // the finest stored size divides all tracked sizes, every coarser stored size is a multiple of the previous one
+      uint32_t finest = *my->_tracked_buckets.begin();
+      for( uint32_t bucket : my->_tracked_buckets )
+      {
+         uint32_t a = bucket;
+         while( a != 0 )
+         {
+            const uint32_t r = finest % a;
+            finest = a;
+            a = r;
+         }
+      }
+      my->_stored_buckets.push_back( finest );
+      for( uint32_t bucket : my->_tracked_buckets )
+      {
+         if( bucket % my->_stored_buckets.back() == 0 && bucket != my->_stored_buckets.back() )
+            my->_stored_buckets.push_back( bucket );
+      }
+   }
    if( options.count( "history-per-size" ) )
       my->_maximum_history_per_bucket_size = options["history-per-size"].as<uint32_t>();
+   // A tracked size which is not stored is aggregated from the coarsest stored size dividing it, so its history only
+   // reaches back as far as the history of that size
+   for( uint32_t bucket : my->_tracked_buckets )
+   {
+      const auto& stored = my->_stored_buckets;
+      if( std::find( stored.begin(), stored.end(), bucket ) != stored.end() )
+         continue;
+      uint32_t source = stored.front();
+      for( uint32_t s : stored )
+      {
+         if( bucket % s == 0 )
+            source = s;
+      }
+      const uint64_t history = uint64_t( my->_maximum_history_per_bucket_size ) * source / bucket;
+      wlog( "Market history bucket size ${b} is not stored, since it is not a multiple of every smaller stored size. "
+            "It is aggregated from buckets of ${f} seconds and keeps ${h} instead of ${m} buckets of history. "
+            "Use bucket sizes of which each is a multiple of the previous one to keep the full history.",
+            ("b",bucket)("f",source)("h",history)("m",my->_maximum_history_per_bucket_size) );
+   }
    if( options.count( "max-order-his-records-per-market" ) )
       my->_max_order_his_records_per_market = options["max-order-his-records-per-market"].as<uint32_t>();
    if( options.count( "max-order-his-seconds-per-market" ) )
@@ -453,6 +762,11 @@ const flat_set<uint32_t>& market_history_plugin::tracked_buckets() const
    return my->_tracked_buckets;
 }
 
+const vector<uint32_t>& market_history_plugin::stored_buckets() const
+{
+   return my->_stored_buckets;
+}
+
 uint32_t market_history_plugin::max_history()const
 {
    return my->_maximum_history_per_bucket_size;
@@ -468,4 +782,145 @@ uint32_t market_history_plugin::max_order_his_seconds_per_market()const
    return my->_max_order_his_seconds_per_market;
 }
 
+vector<bucket_object> market_history_plugin::get_market_history( asset_id_type base, asset_id_type quote,
+                                                                uint32_t bucket_seconds,
+                                                                fc::time_point_sec start, fc::time_point_sec end,
+                                                                uint32_t limit )
+{
+   vector<bucket_object> result;
+   const auto& stored = my->_stored_buckets;
+   if( stored.empty() || bucket_seconds == 0 || bucket_seconds % stored.front() != 0 || limit == 0 )
+      return result;
+   if( base > quote )
+      std::swap( base, quote );
+
+   const auto& by_key_idx = database().get_index_type<bucket_index>().indices().get<by_key>();
+
+   // stored sizes which divide the requested size, each stored size divides the next one
+   size_t usable = 0;
+   while( usable < stored.size() && bucket_seconds % stored[usable] == 0 )
+      ++usable;
+
+   // trades which have been rolled up into a size which does not divide the requested size can not be split up
+   uint64_t valid_from = start.sec_since_epoch();
+   for( size_t i = usable; i < stored.size(); ++i )
+   {
+      auto itr = by_key_idx.upper_bound( bucket_key( base, quote, stored[i], fc::time_point_sec::maximum() ) );
+      if( itr == by_key_idx.begin() )
+         continue;
+      --itr;
+      if( itr->key.base == base && itr->key.quote == quote && itr->key.seconds == stored[i] )
+         valid_from = std::max<uint64_t>( valid_from, uint64_t( itr->key.open.sec_since_epoch() ) + stored[i] );
+   }
+   // trades older than the history of the coarsest stored size have been removed
+   if( usable == stored.size() )
+   {
+      const uint32_t coarsest = stored.back();
+      const auto bucket_num = database().head_block_time().sec_since_epoch() / coarsest;
+      if( bucket_num > max_history() )
+         valid_from = std::max<uint64_t>( valid_from, uint64_t( coarsest ) * ( bucket_num - max_history() ) );
+   }
+
+   const uint64_t seconds = bucket_seconds;
+   const uint64_t first_open = ( valid_from + seconds - 1 ) / seconds * seconds;
+   // stored buckets which open before this belong to the last bucket to be returned
+   const uint64_t last_end = uint64_t( end.sec_since_epoch() ) / seconds * seconds + seconds;
+   if( first_open >= last_end )
+      return result;
+
+   auto to_time = []( uint64_t t ) {
+      return t >= fc::time_point_sec::maximum().sec_since_epoch() ? fc::time_point_sec::maximum()
+                                                                   : fc::time_point_sec( static_cast<uint32_t>( t ) );
+   };
+
+   struct cursor
+   {
+      uint32_t                                          seconds;
+      bucket_object_multi_index_type::index<by_key>::type::const_iterator current;
+      bucket_object_multi_index_type::index<by_key>::type::const_iterator end;
+   };
+   vector<cursor> cursors;
+   cursors.reserve( usable );
+   for( size_t i = 0; i < usable; ++i )
+      cursors.push_back( { stored[i],
+                           by_key_idx.lower_bound( bucket_key( base, quote, stored[i], to_time( first_open ) ) ),
+                           by_key_idx.lower_bound( bucket_key( base, quote, stored[i], to_time( last_end ) ) ) } );
+
+   result.reserve( std::min<uint32_t>( limit, 200 ) );
+
+   std::lock_guard<std::mutex> guard( my->_cache_mutex );
+   const uint64_t irreversible_time = my->_irreversible_time.sec_since_epoch();
+   auto& cache = my->_bucket_cache;
+   bool last_from_cache = false;
+   auto cache_last = [&]() {
+      const bucket_object& b = result.back();
+      if( last_from_cache || b.key.open.sec_since_epoch() + seconds > irreversible_time )
+         return;
+      if( cache.size() >= detail::max_cached_buckets )
+         cache.clear();
+      cache[ b.key ] = b;
+   };
+
+   // merge the stored buckets of all usable sizes in time order, for the same open time a coarser bucket contains
+   // older trades
+   bool stopped_by_limit = false;
+   while( true )
+   {
+      cursor* next = nullptr;
+      for( cursor& c : cursors )
+      {
+         if( c.current == c.end )
+            continue;
+         if( next == nullptr || c.current->key.open < next->current->key.open
+             || ( c.current->key.open == next->current->key.open && c.seconds > next->seconds ) )
+            next = &c;
+      }
+      if( next == nullptr )
+         break;
+
+      const bucket_object& stored_bucket = *next->current;
+      const uint32_t open = stored_bucket.key.open.sec_since_epoch() / bucket_seconds * bucket_seconds;
+      if( !result.empty() && result.back().key.open.sec_since_epoch() == open )
+      {
+         detail::merge_bucket( result.back(), stored_bucket );
+         ++next->current;
+         continue;
+      }
+
+      if( !result.empty() )
+         cache_last();
+      if( result.size() >= limit )
+      {
+         stopped_by_limit = true;
+         break;
+      }
+
+      const bucket_key key( base, quote, bucket_seconds, fc::time_point_sec( open ) );
+      auto cached = cache.find( key );
+      if( cached != cache.end() )
+      {
+         result.push_back( cached->second );
+         last_from_cache = true;
+         const auto bucket_end = to_time( uint64_t( open ) + seconds );
+         for( cursor& c : cursors )
+         {
+            if( c.current != c.end && c.current->key.open < bucket_end )
+               c.current = by_key_idx.lower_bound( bucket_key( base, quote, c.seconds, bucket_end ) );
+         }
+         continue;
+      }
+
+      result.emplace_back();
+      bucket_object& b = result.back();
+      b.key = key;
+      detail::copy_bucket_data( b, stored_bucket );
+      last_from_cache = false;
+      ++next->current;
+   }
+   if( !stopped_by_limit && !result.empty() )
+      cache_last();
+
+   return result;
+}
+
 } }
@@ -27,6 +27,7 @@
 #include <graphene/chain/database.hpp>
 
 #include <fc/thread/future.hpp>
+#include <fc/variant_object.hpp>
 
 namespace graphene { namespace witness_plugin {
 
@@ -46,6 +47,25 @@ namespace block_production_condition
    };
 }
 
+/**
+ * Counts durations in buckets with fixed bounds, to report the timing of block production. The buckets are
+ * [-inf,0), [0,50), [50,100), [100,200), [200,500), [500,1000), [1000,2000) and [2000,inf) milliseconds.
+ */
+class latency_histogram
+{
+public:
+   void add( const fc::microseconds& value );
+   uint64_t count()const { return _count; }
+   /// @return the number of values in every bucket by the upper bound of the bucket, and the largest value
+   fc::mutable_variant_object to_variant_object()const;
+
+private:
+   static const std::vector<int64_t> bucket_bounds_ms;
+   std::vector<uint64_t> _buckets = std::vector<uint64_t>( bucket_bounds_ms.size() + 1 );
+   uint64_t              _count = 0;
+   fc::microseconds      _max;
+};
+
 class witness_plugin : public graphene::app::plugin {
 public:
    ~witness_plugin() { stop_block_production(); }
@@ -67,11 +87,17 @@ public:
    inline const fc::flat_map< chain::witness_id_type, fc::optional<chain::public_key_type> >& get_witness_key_cache()
    { return _witness_key_cache; }
 
+   /// Time from waking up for a slot until the produced block has been applied
+   const latency_histogram& get_assembly_histogram()const { return _assembly_histogram; }
+   /// Time of the broadcast of produced blocks relative to their slot time
+   const latency_histogram& get_lateness_histogram()const { return _lateness_histogram; }
+
 private:
    void schedule_production_loop();
    block_production_condition::block_production_condition_enum block_production_loop();
    block_production_condition::block_production_condition_enum maybe_produce_block( fc::limited_mutable_variant_object& capture );
    void add_private_key(const std::string& key_id_to_wif_pair_string);
+   void broadcast_block( const chain::signed_block& block, const fc::time_point& slot_time );
 
    /// Fetch signing keys of all witnesses in the cache from object database and update the cache accordingly
    void refresh_witness_key_cache();
@@ -81,6 +107,8 @@ private:
    bool _shutting_down = false;
    uint32_t _required_witness_participation = 33 * GRAPHENE_1_PERCENT;
    uint32_t _production_skip_flags = graphene::chain::database::skip_nothing;
+   /// If set, wake up this long before every slot instead of polling on whole seconds
+   fc::microseconds _production_lead_time;
 
    std::map<chain::public_key_type, fc::ecc::private_key, chain::pubkey_comparator> _private_keys;
    std::set<chain::witness_id_type> _witnesses;
@@ -89,6 +117,9 @@ private:
    /// For tracking signing keys of specified witnesses, only update when applied a block
    fc::flat_map< chain::witness_id_type, fc::optional<chain::public_key_type> > _witness_key_cache;
 
+   latency_histogram _assembly_histogram;
+   latency_histogram _lateness_histogram;
+
 };
 
 } } //graphene::witness_plugin
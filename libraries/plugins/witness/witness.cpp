@@ -33,6 +33,7 @@
 
 #include <boost/filesystem/path.hpp>
 
+#include <algorithm>
 #include <iostream>
 
 using namespace graphene::witness_plugin;
@@ -59,6 +60,28 @@ void new_chain_banner( const graphene::chain::database& db )
    }
 }
 
+const std::vector<int64_t> latency_histogram::bucket_bounds_ms = { 0, 50, 100, 200, 500, 1000, 2000 };
+
+void latency_histogram::add( const fc::microseconds& value )
+{
+   const int64_t ms = value.count() / 1000 - ( value.count() < 0 && value.count() % 1000 != 0 ? 1 : 0 );
+   const auto bound = std::upper_bound( bucket_bounds_ms.begin(), bucket_bounds_ms.end(), ms );
+   ++_buckets[ bound - bucket_bounds_ms.begin() ];
+   if( _count == 0 || value > _max )
+      _max = value;
+   ++_count;
+}
+
+fc::mutable_variant_object latency_histogram::to_variant_object()const
+{
+   fc::mutable_variant_object result;
+   for( size_t i = 0; i < bucket_bounds_ms.size(); ++i )
+      result( "<" + std::to_string( bucket_bounds_ms[i] ) + "ms", _buckets[i] );
+   result( ">=" + std::to_string( bucket_bounds_ms.back() ) + "ms", _buckets.back() );
+   result( "max_ms", double( _max.count() ) / 1000 );
+   return result;
+}
+
 void witness_plugin::plugin_set_program_options(
    boost::program_options::options_description& command_line_options,
    boost::program_options::options_description& config_file_options)
@@ -81,6 +104,12 @@ void witness_plugin::plugin_set_program_options(
           "Path to a file containing tuples of [PublicKey, WIF private key]."
           " The file has to contain exactly one tuple (i.e. private - public key pair) per line."
           " This option may be specified multiple times, thus multiple files can be provided.")
+         ("production-lead-time-ms", bpo::value<uint32_t>()->default_value(0),
+          "Wake up this many milliseconds (less than 500) before a slot to produce the block, and broadcast it at "
+          "the slot time. With 0, the node polls on whole seconds and broadcasts a block as soon as it is produced.")
+         ("block-assembly-time-budget-ms", bpo::value<uint32_t>()->default_value(0),
+          "Stop adding pending transactions to a block after this many milliseconds, 0 means no limit. "
+          "Transactions which are left stay pending for the next block.")
          ;
    config_file_options.add(command_line_options);
 }
@@ -164,6 +193,15 @@ void witness_plugin::plugin_initialize(const boost::program_options::variables_m
        else if(required_participation > 90)
            wlog("witness plugin: Warning - High required participation of ${rp}% found", ("rp", required_participation));
    }
+   if( options.count("production-lead-time-ms") )
+   {
+      const uint32_t lead_time_ms = options["production-lead-time-ms"].as<uint32_t>();
+      FC_ASSERT( lead_time_ms < 500, "The production lead time must be less than 500 milliseconds" );
+      _production_lead_time = fc::milliseconds( lead_time_ms );
+   }
+   if( options.count("block-assembly-time-budget-ms") )
+      database().set_block_assembly_time_budget(
+            fc::milliseconds( options["block-assembly-time-budget-ms"].as<uint32_t>() ) );
    ilog("witness plugin:  plugin_initialize() end");
 } FC_LOG_AND_RETHROW() }
 
@@ -182,6 +220,8 @@ void witness_plugin::plugin_startup()
          _production_skip_flags |= graphene::chain::database::skip_undo_history_check;
       }
       refresh_witness_key_cache();
+      // assemble the next block while transactions arrive, so that only the header has to be signed at the slot
+      d.enable_block_candidate( true );
       d.applied_block.connect( [this]( const chain::signed_block& b )
       {
          refresh_witness_key_cache();
@@ -231,14 +271,29 @@ void witness_plugin::schedule_production_loop()
 {
    if (_shutting_down) return;
 
-   //Schedule for the next second's tick regardless of chain state
-   // If we would wait less than 50ms, wait for the whole second.
    fc::time_point now = fc::time_point::now();
-   int64_t time_to_next_second = 1000000 - (now.time_since_epoch().count() % 1000000);
-   if( time_to_next_second < 50000 )      // we must sleep for at least 50ms
-       time_to_next_second += 1000000;
+   fc::time_point next_wakeup;
+   if( _production_lead_time.count() > 0 )
+   {
+      // Wake up the lead time before the next slot. Slots are aligned to multiples of the block interval.
+      // If we would wait less than 50ms, wait for the slot after it.
+      const int64_t interval = int64_t( database().block_interval() ) * 1000000;
+      const int64_t now_us = now.time_since_epoch().count();
+      int64_t wakeup_us = ( now_us / interval + 1 ) * interval - _production_lead_time.count();
+      while( wakeup_us - now_us < 50000 )
+         wakeup_us += interval;
+      next_wakeup = fc::time_point( fc::microseconds( wakeup_us ) );
+   }
+   else
+   {
+      //Schedule for the next second's tick regardless of chain state
+      // If we would wait less than 50ms, wait for the whole second.
+      int64_t time_to_next_second = 1000000 - (now.time_since_epoch().count() % 1000000);
+      if( time_to_next_second < 50000 )      // we must sleep for at least 50ms
+          time_to_next_second += 1000000;
 
-   fc::time_point next_wakeup( now + fc::microseconds( time_to_next_second ) );
+      next_wakeup = now + fc::microseconds( time_to_next_second );
+   }
 
    _block_production_task = fc::schedule([this]{block_production_loop();},
                                          next_wakeup, "Witness Block Production");
@@ -274,7 +329,8 @@ block_production_condition::block_production_condition_enum witness_plugin::bloc
    switch( result )
    {
       case block_production_condition::produced:
-         ilog("Generated block #${n} with ${x} transaction(s) and timestamp ${t} at time ${c}", (capture));
+         ilog("Generated block #${n} with ${x} transaction(s) and timestamp ${t} at time ${c}, "
+              "assembled in ${a} us (from candidate: ${f}) and applied in ${p} us", (capture));
          break;
       case block_production_condition::not_synced:
          ilog("Not producing block because production is disabled until we receive a recent block "
@@ -374,14 +430,39 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
       return block_production_condition::lag;
    }
 
+   graphene::app::api_worker_pool::write_guard guard( app().get_api_worker_pool() );
    auto block = db.generate_block(
       scheduled_time,
       scheduled_witness,
       private_key_itr->second,
       _production_skip_flags
       );
-   capture("n", block.block_num())("t", block.timestamp)("c", now)("x", block.transactions.size());
-   fc::async( [this,block](){ p2p_node().broadcast(net::block_message(block)); } );
+   const auto& production = db.get_last_block_production_info();
+   capture("n", block.block_num())("t", block.timestamp)("c", now)("x", block.transactions.size())
+          ("a", production.assembly_time.count())("f", production.from_candidate)
+          ("p", production.apply_time.count());
+
+   // A block produced ahead of its slot is held back until the slot begins
+   const fc::time_point produced_time = fc::time_point::now();
+   const fc::time_point slot_time = scheduled_time;
+   _assembly_histogram.add( produced_time - now_fine );
+   if( produced_time < slot_time )
+      fc::schedule( [this,block,slot_time](){ broadcast_block( block, slot_time ); }, slot_time,
+                    "Witness Block Broadcast" );
+   else
+      fc::async( [this,block,slot_time](){ broadcast_block( block, slot_time ); } );
 
    return block_production_condition::produced;
 }
+
+void witness_plugin::broadcast_block( const chain::signed_block& block, const fc::time_point& slot_time )
+{
+   p2p_node().broadcast(net::block_message(block));
+   _lateness_histogram.add( fc::time_point::now() - slot_time );
+
+   static const uint64_t histogram_log_interval = 100;
+   if( _lateness_histogram.count() % histogram_log_interval == 0 )
+      ilog( "Timing of the ${n} blocks produced so far: assembly ${a}, lateness of the broadcast ${l}",
+            ("n", _lateness_histogram.count())("a", _assembly_histogram.to_variant_object())
+            ("l", _lateness_histogram.to_variant_object()) );
+}
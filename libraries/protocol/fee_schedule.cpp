@@ -26,10 +26,18 @@
 
 #include <fc/io/raw.hpp>
 
+#include <atomic>
+
 #define MAX_FEE_STABILIZATION_ITERATION 4
 
 namespace graphene { namespace protocol {
 
+   uint64_t fee_parameter_set::next_version()
+   {
+      static std::atomic<uint64_t> last_version( 0 );
+      return ++last_version;
+   }
+
    fee_schedule::fee_schedule()
    {
    }
@@ -73,19 +81,38 @@ namespace graphene { namespace protocol {
    void fee_schedule::zero_all_fees()
    {
       *this = get_default();
-      for( fee_parameters& i : parameters )
+      for( fee_parameters& i : parameters.get_mutable() )
          i.visit( zero_fee_visitor() );
       this->scale = 0;
    }
 
    asset fee_schedule::set_fee( operation& op, const price& core_exchange_rate )const
    {
-      auto f = calculate_fee( op, core_exchange_rate );
+      return set_fee( op, core_exchange_rate, *get_fee_table() );
+   }
+
+   vector<asset> fee_schedule::set_fees( vector<operation>& ops, const price& core_exchange_rate )const
+   {
+      const auto table = get_fee_table();
+      vector<asset> result;
+      result.reserve( ops.size() );
+      for( operation& op : ops )
+         result.push_back( set_fee( op, core_exchange_rate, *table ) );
+      return result;
+   }
+
+   asset fee_schedule::set_fee( operation& op, const price& core_exchange_rate,
+                                const fee_parameter_table& table )const
+   {
+      auto calculate = [this, &table, &core_exchange_rate]( const operation& o ) {
+         return calculate_fee( o, table ).multiply_and_round_up( core_exchange_rate );
+      };
+      auto f = calculate( op );
       auto f_max = f;
       for( size_t i=0; i<MAX_FEE_STABILIZATION_ITERATION; i++ )
       {
          op.visit( set_fee_visitor( f_max ) );
-         auto f2 = calculate_fee( op, core_exchange_rate );
+         auto f2 = calculate( op );
          if( f == f2 )
             break;
          f_max = std::max( f_max, f2 );
@@ -101,3 +128,19 @@ namespace graphene { namespace protocol {
    }
 
 } } // graphene::protocol
+
+namespace fc {
+
+   void to_variant( const graphene::protocol::fee_parameter_set& in, fc::variant& out, uint32_t max_depth )
+   {
+      to_variant( in.get(), out, max_depth );
+   }
+
+   void from_variant( const fc::variant& in, graphene::protocol::fee_parameter_set& out, uint32_t max_depth )
+   {
+      graphene::protocol::fee_parameter_set::container_type parameters;
+      from_variant( in, parameters, max_depth );
+      out = graphene::protocol::fee_parameter_set( std::move( parameters ) );
+   }
+
+} // fc
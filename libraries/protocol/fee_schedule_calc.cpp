@@ -31,54 +31,90 @@
 
 namespace graphene { namespace protocol {
 
+   /// Resolves the fee parameters of an operation type the way the schedule would for every calculation
+   struct resolve_fee_parameters_visitor
+   {
+      typedef fee_parameters result_type;
+
+      const fee_schedule& param;
+      resolve_fee_parameters_visitor( const fee_schedule& p ):param(p){}
+
+      template<typename OpType>
+      result_type operator()( const OpType& )const
+      {
+         try {
+            return param.get<OpType>();
+         } catch (fc::assert_exception&) {
+            // not in the schedule, use the defaults
+            return typename OpType::fee_parameters_type();
+         }
+      }
+   };
+
    struct calc_fee_visitor
    {
       typedef uint64_t result_type;
 
-      const fee_schedule& param;
+      const fee_parameter_table& table;
       const int current_op;
-      calc_fee_visitor( const fee_schedule& p, const operation& op ):param(p),current_op(op.which()){}
+      calc_fee_visitor( const fee_parameter_table& t, const operation& op ):table(t),current_op(op.which()){}
 
       template<typename OpType>
       result_type operator()( const OpType& op )const
       {
-         try {
-            return op.calculate_fee( param.get<OpType>() ).value;
-         } catch (fc::assert_exception& e) {
-             fee_parameters params; params.set_which(current_op);
-             auto itr = param.parameters.find(params);
-             if( itr != param.parameters.end() ) params = *itr;
-             return op.calculate_fee( params.get<typename OpType::fee_parameters_type>() ).value;
-         }
+         return op.calculate_fee( table.parameters[current_op].get<typename OpType::fee_parameters_type>() ).value;
       }
    };
 
    template<>
    uint64_t calc_fee_visitor::operator()(const htlc_create_operation& op)const
    {
-      //TODO: refactor for performance (see https://github.com/bitshares/bitshares-core/issues/2150)
-      transfer_operation::fee_parameters_type t;
-      if (param.exists<transfer_operation>())
-         t = param.get<transfer_operation>();
-      return op.calculate_fee( param.get<htlc_create_operation>(), t.price_per_kbyte).value;
+      return op.calculate_fee( table.parameters[current_op].get<htlc_create_operation::fee_parameters_type>(),
+                               table.transfer_price_per_kbyte ).value;
    }
 
    template<>
    uint64_t calc_fee_visitor::operator()(const asset_create_operation& op)const
    {
-      //TODO: refactor for performance (see https://github.com/bitshares/bitshares-core/issues/2150)
-      optional<uint64_t> sub_asset_creation_fee;
-      if( param.exists<account_transfer_operation>() && param.exists<ticket_create_operation>() )
-         sub_asset_creation_fee = param.get<account_transfer_operation>().fee;
-      asset_create_operation::fee_parameters_type old_asset_creation_fee_params;
-      if( param.exists<asset_create_operation>() )
-         old_asset_creation_fee_params = param.get<asset_create_operation>();
-      return op.calculate_fee( old_asset_creation_fee_params, sub_asset_creation_fee ).value;
+      return op.calculate_fee( table.parameters[current_op].get<asset_create_operation::fee_parameters_type>(),
+                               table.sub_asset_creation_fee ).value;
+   }
+
+   std::shared_ptr<const fee_parameter_table> fee_schedule::get_fee_table()const
+   {
+      auto table = std::atomic_load( &_fee_table );
+      if( table && table->source_version == parameters.version() )
+         return table;
+
+      auto new_table = std::make_shared<fee_parameter_table>();
+      new_table->source_version = parameters.version();
+      const size_t count = fee_parameters().count();
+      new_table->parameters.reserve( count );
+      for( size_t i = 0; i < count; ++i )
+      {
+         operation op;
+         op.set_which( i );
+         new_table->parameters.push_back( op.visit( resolve_fee_parameters_visitor( *this ) ) );
+      }
+      transfer_operation::fee_parameters_type t;
+      if( exists<transfer_operation>() )
+         t = get<transfer_operation>();
+      new_table->transfer_price_per_kbyte = t.price_per_kbyte;
+      if( exists<account_transfer_operation>() && exists<ticket_create_operation>() )
+         new_table->sub_asset_creation_fee = get<account_transfer_operation>().fee;
+
+      std::atomic_store( &_fee_table, std::shared_ptr<const fee_parameter_table>( std::move(new_table) ) );
+      return std::atomic_load( &_fee_table );
    }
 
    asset fee_schedule::calculate_fee( const operation& op )const
    {
-      uint64_t required_fee = op.visit( calc_fee_visitor( *this, op ) );
+      return calculate_fee( op, *get_fee_table() );
+   }
+
+   asset fee_schedule::calculate_fee( const operation& op, const fee_parameter_table& table )const
+   {
+      uint64_t required_fee = op.visit( calc_fee_visitor( table, op ) );
       if( scale != GRAPHENE_100_PERCENT )
       {
          auto scaled = fc::uint128_t(required_fee) * scale;
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <graphene/protocol/types.hpp>
+
+#include <fc/crypto/sha256.hpp>
+
+#include <unordered_map>
+
+namespace graphene { namespace protocol {
+
+   struct authority_check_cache_statistics
+   {
+      uint64_t entries = 0;
+      uint64_t hits = 0;
+      uint64_t misses = 0;
+      uint64_t invalidations = 0; ///< entries dropped because an authority they depend on has changed
+   };
+
+   /**
+    * @brief Memoizes the results of resolving account authorities against sets of signature keys
+    *
+    * Many transactions in a block are signed by the same accounts. An entry records whether an account's active or
+    * owner authority is satisfied by a given set of signature keys and already approved accounts, together with the
+    * signatures and account approvals used along the way, so that @ref verify_authority can skip the recursive
+    * walk through nested account authorities the next time the same signers show up.
+    *
+    * An entry is only valid as long as the authorities of all accounts which were visited during the walk are
+    * unchanged. The owner of the cache has to call @ref invalidate whenever an account authority changes and
+    * @ref clear whenever the state is rewound.
+    */
+   class authority_check_cache
+   {
+   public:
+      struct entry
+      {
+         bool                       result = false;
+         flat_set<public_key_type>  used_signatures;   ///< provided signatures which the walk consulted
+         flat_set<account_id_type>  approved_accounts; ///< accounts which the walk added to the approved set
+         flat_set<account_id_type>  visited_accounts;  ///< accounts whose authorities were read during the walk
+      };
+
+      /// @return the cached entry for @p key or nullptr
+      const entry* find( const fc::sha256& key );
+      void insert( const fc::sha256& key, entry&& e );
+
+      /// Drop all entries which depend on the authorities of @p account
+      void invalidate( account_id_type account );
+      void clear();
+
+      void set_max_entries( size_t max_entries ) { _max_entries = max_entries; }
+      authority_check_cache_statistics get_statistics()const;
+
+   private:
+      struct key_hash
+      {
+         size_t operator()( const fc::sha256& key )const { return key._hash[0]; }
+      };
+
+      std::unordered_map< fc::sha256, entry, key_hash >         _entries;
+      /// Keys of the entries which depend on an account, by account instance
+      std::unordered_map< uint64_t, vector<fc::sha256> >        _by_account;
+      size_t                                                    _max_entries = 100000;
+      uint64_t                                                  _hits = 0;
+      uint64_t                                                  _misses = 0;
+      uint64_t                                                  _invalidations = 0;
+   };
+
+} } // graphene::protocol
+
+FC_REFLECT( graphene::protocol::authority_check_cache_statistics, (entries)(hits)(misses)(invalidations) )
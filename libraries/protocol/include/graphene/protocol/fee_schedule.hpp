@@ -24,6 +24,8 @@
 #pragma once
 #include <graphene/protocol/operations.hpp>
 
+#include <memory>
+
 namespace graphene { namespace protocol {
 
    template<typename T> struct transform_to_fee_parameters;
@@ -34,6 +36,62 @@ namespace graphene { namespace protocol {
    };
    using fee_parameters = transform_to_fee_parameters<operation>::type;
 
+   /**
+    *  @brief The fee parameters of a schedule, at most one per operation type
+    *
+    *  A sorted set which can only be modified through its own members. Every modification gives the set a new
+    *  version, unique within the process, so that a @ref fee_parameter_table can tell whether it was built from the
+    *  current content. A copy has the same content as its source and thus keeps its version.
+    *
+    *  It is serialized like the underlying set.
+    */
+   class fee_parameter_set
+   {
+   public:
+      using container_type = fee_parameters::flat_set_type;
+      using const_iterator = container_type::const_iterator;
+
+      fee_parameter_set() : _version( next_version() ) {}
+      fee_parameter_set( container_type parameters )
+         : _parameters( std::move( parameters ) ), _version( next_version() ) {}
+      // no move operations, a moved-from set would keep the version of its former content
+      fee_parameter_set( const fee_parameter_set& ) = default;
+      fee_parameter_set& operator=( const fee_parameter_set& ) = default;
+
+      const container_type& get()const { return _parameters; }
+      /// Access the parameters for modification in place, this counts as a modification
+      container_type& get_mutable() { _version = next_version(); return _parameters; }
+      uint64_t version()const { return _version; }
+
+      const_iterator begin()const { return _parameters.begin(); }
+      const_iterator end()const { return _parameters.end(); }
+      const_iterator find( const fee_parameters& p )const { return _parameters.find( p ); }
+      size_t size()const { return _parameters.size(); }
+      bool empty()const { return _parameters.empty(); }
+
+      std::pair<const_iterator,bool> insert( const fee_parameters& p )
+      {
+         _version = next_version();
+         return _parameters.insert( p );
+      }
+      size_t erase( const fee_parameters& p )
+      {
+         _version = next_version();
+         return _parameters.erase( p );
+      }
+      void clear()
+      {
+         _version = next_version();
+         _parameters.clear();
+      }
+
+   private:
+      static uint64_t next_version();
+
+      container_type _parameters;
+      uint64_t       _version;
+   };
+
    template<typename Operation>
    class fee_helper {
      public:
@@ -167,6 +225,23 @@ namespace graphene { namespace protocol {
          return htlc_extend_operation_fee_dummy;
       }
    };
+   /**
+    *  @brief The fee parameters of a fee schedule, resolved for every operation type and indexed by operation tag
+    *
+    *  Resolving the parameters of an operation means a search in the schedule and, for some operations, falling
+    *  back to the parameters of another operation or to defaults. The table does this once for all operation
+    *  types, so that calculating a fee is an array lookup.
+    */
+   struct fee_parameter_table
+   {
+      vector<fee_parameters>  parameters;               ///< indexed by operation tag
+      optional<uint64_t>      sub_asset_creation_fee;   ///< see asset_create_operation::calculate_fee
+      uint32_t                transfer_price_per_kbyte = 0;
+
+      /// Version of the schedule parameters the table was built from, see @ref fee_parameter_set
+      uint64_t                source_version = 0;
+   };
+
    /**
     *  @brief contains all of the parameters necessary to calculate the fee for any operation
     */
@@ -191,9 +266,23 @@ namespace graphene { namespace protocol {
        *  Updates the operation with appropriate fee and returns the fee.
        */
       asset set_fee( operation& op, const price& core_exchange_rate = price::unit_price() )const;
+      /**
+       *  Updates all operations with appropriate fees and returns the fees, in the same order.
+       */
+      vector<asset> set_fees( vector<operation>& ops, const price& core_exchange_rate = price::unit_price() )const;
 
       void zero_all_fees();
 
+      /**
+       *  @return the fee parameters resolved for every operation type. The table is built on first use and rebuilt
+       *  when @ref parameters has been modified since.
+       *
+       *  The table is published with atomic shared_ptr operations, so threads which calculate fees with the same
+       *  schedule concurrently, e.g. API worker threads, at worst build it more than once. The schedule itself
+       *  must not be modified while other threads use it.
+       */
+      std::shared_ptr<const fee_parameter_table> get_fee_table()const;
+
       /**
        *  Validates all of the parameters are present and accounted for.
        */
@@ -202,12 +291,13 @@ namespace graphene { namespace protocol {
       template<typename Operation>
       const typename Operation::fee_parameters_type& get()const
       {
-         return fee_helper<Operation>().cget(parameters);
+         return fee_helper<Operation>().cget(parameters.get());
       }
+      /// The returned reference must not be used to modify the parameters after the next fee calculation
       template<typename Operation>
       typename Operation::fee_parameters_type& get()
       {
-         return fee_helper<Operation>().get(parameters);
+         return fee_helper<Operation>().get(parameters.get_mutable());
       }
       template<typename Operation>
       bool exists()const
@@ -219,16 +309,49 @@ namespace graphene { namespace protocol {
       /**
        *  @note must be sorted by fee_parameters.which() and have no duplicates
        */
-      fee_parameters::flat_set_type parameters;
+      fee_parameter_set        parameters;
       uint32_t                 scale = GRAPHENE_100_PERCENT; ///< fee * scale / GRAPHENE_100_PERCENT
       private:
       static void set_fee_parameters(fee_schedule& sched);
+      asset calculate_fee( const operation& op, const fee_parameter_table& table )const;
+      asset set_fee( operation& op, const price& core_exchange_rate, const fee_parameter_table& table )const;
+
+      mutable std::shared_ptr<const fee_parameter_table> _fee_table;
    };
 
    typedef fee_schedule fee_schedule_type;
 
 } } // graphene::protocol
 
+namespace fc {
+   void to_variant( const graphene::protocol::fee_parameter_set& in, fc::variant& out, uint32_t max_depth );
+   void from_variant( const fc::variant& in, graphene::protocol::fee_parameter_set& out, uint32_t max_depth );
+
+namespace raw {
+   template< typename Stream >
+   void pack( Stream& s, const graphene::protocol::fee_parameter_set& v, uint32_t _max_depth=FC_PACK_MAX_DEPTH )
+   {
+      fc::raw::pack( s, v.get(), _max_depth );
+   }
+
+   template< typename Stream >
+   void unpack( Stream& s, graphene::protocol::fee_parameter_set& v, uint32_t _max_depth=FC_PACK_MAX_DEPTH )
+   {
+      graphene::protocol::fee_parameter_set::container_type parameters;
+      fc::raw::unpack( s, parameters, _max_depth );
+      v = graphene::protocol::fee_parameter_set( std::move( parameters ) );
+   }
+} // fc::raw
+
+   template<> struct get_typename< graphene::protocol::fee_parameter_set >
+   {
+      static const char* name()
+      {
+         return get_typename< graphene::protocol::fee_parameter_set::container_type >::name();
+      }
+   };
+} // fc
+
 FC_REFLECT_TYPENAME( graphene::protocol::fee_parameters )
 FC_REFLECT( graphene::protocol::fee_schedule, (parameters)(scale) )
 
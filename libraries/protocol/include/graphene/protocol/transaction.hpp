@@ -25,6 +25,8 @@
 #include <graphene/protocol/operations.hpp>
 
 namespace graphene { namespace protocol {
+
+   class authority_check_cache;
    struct predicate_result;
 
    using rejected_predicate = static_variant<predicate_result, fc::exception>;
@@ -174,6 +176,7 @@ namespace graphene { namespace protocol {
        *            required_auths field of custom_operation or not
        * @param max_recursion maximum level of recursion when verifying, since an account
        *            can have another account in active authorities and/or owner authorities
+       * @param cache optional cache to memoize the resolution of account authorities across transactions
        */
       void verify_authority(
               const chain_id_type& chain_id,
@@ -182,7 +185,8 @@ namespace graphene { namespace protocol {
               const custom_authority_lookup& get_custom,
               bool allow_non_immediate_owner,
               bool ignore_custom_operation_required_auths,
-              uint32_t max_recursion = GRAPHENE_MAX_SIG_CHECK_DEPTH )const;
+              uint32_t max_recursion = GRAPHENE_MAX_SIG_CHECK_DEPTH,
+              authority_check_cache* cache = nullptr )const;
 
       /**
        * This is a slower replacement for get_required_signatures()
@@ -264,6 +268,7 @@ namespace graphene { namespace protocol {
     * @param allow_committee whether to allow the special "committee account" to authorize the operations
     * @param active_approvals accounts that approved the operations with their active authories
     * @param owner_approvals accounts that approved the operations with their owner authories
+    * @param cache optional cache to memoize the resolution of account authorities across calls
     */
    void verify_authority( const vector<operation>& ops, const flat_set<public_key_type>& sigs,
                           const std::function<const authority*(account_id_type)>& get_active,
@@ -274,7 +279,8 @@ namespace graphene { namespace protocol {
                           uint32_t max_recursion = GRAPHENE_MAX_SIG_CHECK_DEPTH,
                           bool allow_committee = false,
                           const flat_set<account_id_type>& active_aprovals = flat_set<account_id_type>(),
-                          const flat_set<account_id_type>& owner_approvals = flat_set<account_id_type>() );
+                          const flat_set<account_id_type>& owner_approvals = flat_set<account_id_type>(),
+                          authority_check_cache* cache = nullptr );
 
    /**
     *  @brief captures the result of evaluating the operations contained in the transaction
@@ -23,6 +23,7 @@
  */
 
 #include <graphene/protocol/transaction.hpp>
+#include <graphene/protocol/authority_check_cache.hpp>
 #include <graphene/protocol/block.hpp>
 #include <graphene/protocol/exceptions.hpp>
 #include <graphene/protocol/fee_schedule.hpp>
@@ -129,6 +130,7 @@ struct sign_state
                return provided_signatures[k] = true;
             return false;
          }
+         if( used_signatures != nullptr ) used_signatures->insert( k );
          return itr->second = true;
       }
 
@@ -165,13 +167,65 @@ struct sign_state
                return false;
             }
          }
+         if( used_signatures != nullptr ) used_signatures->insert( itr->second );
          return provided_signatures[itr->second] = true;
       }
 
       bool check_authority( account_id_type id )
       {
          if( approved_by.find(id) != approved_by.end() ) return true;
-         return check_authority( get_active(id) ) || ( allow_non_immediate_owner && check_authority( get_owner(id) ) );
+         return check_authority( active_of(id) ) || ( allow_non_immediate_owner && check_authority( owner_of(id) ) );
+      }
+
+      /**
+       *  Checks the active (or owner) authority of an account like check_authority() does, using the authority
+       *  check cache if there is one. On a hit, the signatures and approvals which the walk would have used are
+       *  marked as used, so the outcome for the whole transaction is the same as without the cache. A miss records
+       *  every signature the walk consults, also those which an earlier check of the transaction marked already.
+       */
+      bool check_account_authority( account_id_type id, bool owner )
+      {
+         if( cache == nullptr )
+            return owner ? check_authority( get_owner(id) ) : check_authority( id );
+
+         fc::sha256::encoder enc;
+         fc::raw::pack( enc, id );
+         fc::raw::pack( enc, owner );
+         fc::raw::pack( enc, allow_non_immediate_owner );
+         fc::raw::pack( enc, max_recursion );
+         fc::raw::pack( enc, signatures_digest );
+         fc::raw::pack( enc, approved_by );
+         const fc::sha256 key = enc.result();
+
+         if( const authority_check_cache::entry* cached = cache->find( key ) )
+         {
+            for( const auto& k : cached->used_signatures )
+            {
+               auto itr = provided_signatures.find( k );
+               if( itr != provided_signatures.end() )
+                  itr->second = true;
+            }
+            approved_by.insert( cached->approved_accounts.begin(), cached->approved_accounts.end() );
+            return cached->result;
+         }
+
+         authority_check_cache::entry e;
+         const flat_set<account_id_type> approved_before = approved_by;
+
+         e.visited_accounts.insert( id );
+         visited_accounts = &e.visited_accounts;
+         used_signatures = &e.used_signatures;
+         e.result = owner ? check_authority( owner_of(id) ) : check_authority( id );
+         visited_accounts = nullptr;
+         used_signatures = nullptr;
+
+         for( const auto& a : approved_by )
+            if( approved_before.find( a ) == approved_before.end() )
+               e.approved_accounts.insert( a );
+
+         const bool result = e.result;
+         cache->insert( key, std::move(e) );
+         return result;
       }
 
       /**
@@ -206,8 +260,8 @@ struct sign_state
             {
                if( depth == max_recursion )
                   continue;
-               if( check_authority( get_active( a.first ), depth+1 )
-                     || ( allow_non_immediate_owner && check_authority( get_owner( a.first ), depth+1 ) ) )
+               if( check_authority( active_of( a.first ), depth+1 )
+                     || ( allow_non_immediate_owner && check_authority( owner_of( a.first ), depth+1 ) ) )
                {
                   approved_by.insert( a.first );
                   total_weight += a.second;
@@ -254,6 +308,31 @@ struct sign_state
          approved_by.insert( GRAPHENE_TEMP_ACCOUNT  );
       }
 
+      /// Use @p c to memoize account authority checks. Only valid without available keys.
+      void set_cache( authority_check_cache* c )
+      {
+         cache = c;
+         if( cache != nullptr )
+         {
+            flat_set<public_key_type> sigs;
+            for( const auto& sig : provided_signatures )
+               sigs.insert( sig.first );
+            signatures_digest = fc::sha256::hash( sigs );
+         }
+      }
+
+      const authority* active_of( account_id_type id )
+      {
+         if( visited_accounts != nullptr ) visited_accounts->insert( id );
+         return get_active( id );
+      }
+
+      const authority* owner_of( account_id_type id )
+      {
+         if( visited_accounts != nullptr ) visited_accounts->insert( id );
+         return get_owner( id );
+      }
+
       const std::function<const authority*(account_id_type)>& get_active;
       const std::function<const authority*(account_id_type)>& get_owner;
 
@@ -263,6 +342,13 @@ struct sign_state
 
       flat_map<public_key_type,bool>   provided_signatures;
       flat_set<account_id_type>        approved_by;
+
+      authority_check_cache*           cache = nullptr;
+      fc::sha256                       signatures_digest;
+      /// While filling a cache entry, the accounts whose authorities are read
+      flat_set<account_id_type>*       visited_accounts = nullptr;
+      /// While filling a cache entry, the provided signatures which the walk consults
+      flat_set<public_key_type>*       used_signatures = nullptr;
 };
 
 
@@ -275,7 +361,8 @@ void verify_authority( const vector<operation>& ops, const flat_set<public_key_t
                        uint32_t max_recursion_depth,
                        bool  allow_committee,
                        const flat_set<account_id_type>& active_aprovals,
-                       const flat_set<account_id_type>& owner_approvals )
+                       const flat_set<account_id_type>& owner_approvals,
+                       authority_check_cache* cache )
 {
    rejected_predicate_map rejected_custom_auths;
    try {
@@ -284,6 +371,7 @@ void verify_authority( const vector<operation>& ops, const flat_set<public_key_t
    vector<authority> other;
 
    sign_state s( sigs, get_active, get_owner, allow_non_immediate_owner, max_recursion_depth );
+   s.set_cache( cache );
    for( auto& id : active_aprovals )
       s.approved_by.insert( id );
    for( auto& id : owner_approvals )
@@ -327,14 +415,14 @@ void verify_authority( const vector<operation>& ops, const flat_set<public_key_t
    for( auto id : required_owner )
    {
       GRAPHENE_ASSERT( owner_approvals.find(id) != owner_approvals.end() ||
-                       s.check_authority(get_owner(id)),
+                       s.check_account_authority(id, true),
                        tx_missing_owner_auth, "Missing Owner Authority ${id}", ("id",id)("auth",*get_owner(id)) );
    }
 
    for( auto id : required_active )
    {
-      GRAPHENE_ASSERT( s.check_authority(id) ||
-                       s.check_authority(get_owner(id)),
+      GRAPHENE_ASSERT( s.check_account_authority(id, false) ||
+                       s.check_account_authority(id, true),
                        tx_missing_active_auth, "Missing Active Authority ${id}",
                        ("id",id)("auth",*get_active(id))("owner",*get_owner(id)) );
    }
@@ -467,13 +555,65 @@ void signed_transaction::verify_authority( const chain_id_type& chain_id,
                                            const custom_authority_lookup& get_custom,
                                            bool allow_non_immediate_owner,
                                            bool ignore_custom_operation_required_auths,
-                                           uint32_t max_recursion )const
+                                           uint32_t max_recursion,
+                                           authority_check_cache* cache )const
 { try {
    graphene::protocol::verify_authority( operations, get_signature_keys( chain_id ), get_active, get_owner,
                                          get_custom, allow_non_immediate_owner,
-                                         ignore_custom_operation_required_auths, max_recursion );
+                                         ignore_custom_operation_required_auths, max_recursion,
+                                         false, flat_set<account_id_type>(), flat_set<account_id_type>(), cache );
 } FC_CAPTURE_AND_RETHROW( (*this) ) }
 
+const authority_check_cache::entry* authority_check_cache::find( const fc::sha256& key )
+{
+   auto itr = _entries.find( key );
+   if( itr == _entries.end() )
+   {
+      ++_misses;
+      return nullptr;
+   }
+   ++_hits;
+   return &itr->second;
+}
+
+void authority_check_cache::insert( const fc::sha256& key, entry&& e )
+{
+   if( _entries.size() >= _max_entries )
+   {
+      _entries.clear();
+      _by_account.clear();
+   }
+   for( const auto& account : e.visited_accounts )
+      _by_account[account.instance.value].push_back( key );
+   _entries[key] = std::move(e);
+}
+
+void authority_check_cache::invalidate( account_id_type account )
+{
+   auto itr = _by_account.find( account.instance.value );
+   if( itr == _by_account.end() )
+      return;
+   for( const auto& key : itr->second )
+      _invalidations += _entries.erase( key );
+   _by_account.erase( itr );
+}
+
+void authority_check_cache::clear()
+{
+   _entries.clear();
+   _by_account.clear();
+}
+
+authority_check_cache_statistics authority_check_cache::get_statistics()const
+{
+   authority_check_cache_statistics result;
+   result.entries = _entries.size();
+   result.hits = _hits;
+   result.misses = _misses;
+   result.invalidations = _invalidations;
+   return result;
+}
+
 } } // graphene::protocol
 
 GRAPHENE_IMPLEMENT_EXTERNAL_SERIALIZATION( graphene::protocol::transaction)
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+
+#include <fc/time.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace graphene { namespace utilities {
+
+/**
+ * @brief A token bucket which refills continuously at @p rate tokens per second, up to @p burst tokens
+ *
+ * It is used to bound the rate at which a single source, e.g. an account or a p2p peer, can submit
+ * transactions. A rate of zero means unlimited.
+ */
+class token_bucket
+{
+public:
+   /// @return true if a token was available and has been taken, false otherwise
+   bool consume( const fc::time_point& now, uint32_t rate, uint32_t burst )
+   {
+      if( rate == 0 )
+         return true;
+      refill( now, rate, burst );
+      if( _tokens < 1 )
+         return false;
+      _tokens -= 1;
+      return true;
+   }
+
+   /// @return true if a token is available at @p now, without taking it
+   bool has_token( const fc::time_point& now, uint32_t rate, uint32_t burst )
+   {
+      if( rate == 0 )
+         return true;
+      refill( now, rate, burst );
+      return _tokens >= 1;
+   }
+
+   /// @return true if the bucket would be full at @p now, i.e. it can be dropped without changing behavior
+   bool is_idle( const fc::time_point& now, uint32_t rate, uint32_t burst )const
+   {
+      if( rate == 0 || _last_refill == fc::time_point() )
+         return true;
+      const double elapsed = double( (now - _last_refill).count() ) / 1000000;
+      return _tokens + elapsed * rate >= capacity( rate, burst );
+   }
+
+private:
+   static double capacity( uint32_t rate, uint32_t burst )
+   {
+      return double( std::max( rate, burst ) );
+   }
+
+   void refill( const fc::time_point& now, uint32_t rate, uint32_t burst )
+   {
+      if( _last_refill == fc::time_point() )
+         _tokens = capacity( rate, burst );
+      else if( now > _last_refill )
+      {
+         const double elapsed = double( (now - _last_refill).count() ) / 1000000;
+         _tokens = std::min( capacity( rate, burst ), _tokens + elapsed * rate );
+      }
+      _last_refill = now;
+   }
+
+   double         _tokens = 0;
+   fc::time_point _last_refill;
+};
+
+} } // graphene::utilities
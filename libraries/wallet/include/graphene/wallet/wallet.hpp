@@ -560,6 +560,21 @@ class wallet_api
        */
       void    set_wallet_filename(string wallet_filename);
 
+      /** Sets the file the local object cache is kept in.
+       *
+       * Accounts, assets and balances fetched from the node are cached by the wallet. Accounts and assets are
+       * dropped from the cache when the node reports a change, balances whenever a new block is applied.
+       * If the file exists, the cached accounts and assets are loaded from it and refreshed from the node
+       * in a few batched requests. The cache is saved to the file whenever the wallet file is saved and when
+       * the wallet is closed.
+       *
+       * @param filename the cache file, or an empty string to not keep the cache in a file
+       */
+      void    set_object_cache_file(string filename);
+
+      /** Drops all objects from the local object cache, they will be fetched from the node again. */
+      void    clear_object_cache();
+
       /** Suggests a safe brain key to use for creating your account.
        * \c create_account_with_brain_key() requires you to specify a 'brain key',
        * a long passphrase that provides enough entropy to generate cyrptographic
@@ -1628,7 +1643,8 @@ class wallet_api
 
       /** Get key references.
        *
-       * Returns accounts related to given public keys.
+       * Returns accounts related to given public keys. All of them are returned: the node returns a limited
+       * number of accounts per key and call, so keys referenced by more accounts are queried page by page.
        * @param keys public keys to search for related accounts
        * @return the set of related accounts
        */
@@ -1884,6 +1900,8 @@ FC_API( graphene::wallet::wallet_api,
         (get_call_orders)
         (get_settle_orders)
         (save_wallet_file)
+        (set_object_cache_file)
+        (clear_object_cache)
         (serialize_transaction)
         (sign_transaction)
         (sign_transaction2)
@@ -196,6 +196,14 @@ struct wallet_data
    string                    ws_password;
 };
 
+/// Contents of the object cache file
+struct object_cache_data
+{
+   chain_id_type                  chain_id;
+   vector<account_object>         accounts;
+   vector<extended_asset_object>  assets;
+};
+
 struct exported_account_keys
 {
     string account_name;
@@ -350,6 +358,8 @@ FC_REFLECT( graphene::wallet::brain_key_info,
             (pub_key)
           )
 
+FC_REFLECT( graphene::wallet::object_cache_data, (chain_id)(accounts)(assets) )
+
 FC_REFLECT( graphene::wallet::exported_account_keys, (account_name)(encrypted_private_keys)(public_keys) )
 
 FC_REFLECT( graphene::wallet::exported_keys, (password_checksum)(account_keys) )
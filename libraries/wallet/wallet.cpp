@@ -187,7 +187,12 @@ map<string,account_id_type> wallet_api::list_accounts(const string& lowerbound,
 
 vector<asset> wallet_api::list_account_balances(const string& id)
 {
-   return my->_remote_db->get_account_balances(id, flat_set<asset_id_type>());
+   auto itr = my->_cached_balances.find( id );
+   if( itr != my->_cached_balances.end() )
+      return itr->second;
+   auto balances = my->_remote_db->get_account_balances(id, flat_set<asset_id_type>());
+   my->_cached_balances[id] = balances;
+   return balances;
 }
 
 vector<extended_asset_object> wallet_api::list_assets(const string& lowerbound, uint32_t limit)const
@@ -1221,6 +1226,16 @@ void wallet_api::save_wallet_file( string wallet_filename )
    my->save_wallet_file( wallet_filename );
 }
 
+void wallet_api::set_object_cache_file( string filename )
+{
+   my->set_object_cache_file( filename );
+}
+
+void wallet_api::clear_object_cache()
+{
+   my->clear_object_cache();
+}
+
 std::map<string,std::function<string(fc::variant,const fc::variants&)> >
 wallet_api::get_result_formatters() const
 {
@@ -194,10 +194,15 @@ namespace graphene { namespace wallet { namespace detail {
 
    account_object wallet_api_impl::get_account(account_id_type id) const
    {
+      auto itr = _cached_accounts.find( id );
+      if( itr != _cached_accounts.end() )
+         return itr->second;
+
       std::string account_id = account_id_to_string(id);
 
-      auto rec = _remote_db->get_accounts({account_id}, {}).front();
+      auto rec = _remote_db->get_accounts({account_id}, true).front();
       FC_ASSERT(rec);
+      cache_account( *rec );
       return *rec;
    }
 
@@ -210,8 +215,12 @@ namespace graphene { namespace wallet { namespace detail {
          // It's an ID
          return get_account(*id);
       } else {
-         auto rec = _remote_db->lookup_account_names({account_name_or_id}).front();
+         auto itr = _cached_account_ids.find( account_name_or_id );
+         if( itr != _cached_account_ids.end() )
+            return get_account( itr->second );
+         auto rec = _remote_db->get_accounts({account_name_or_id}, true).front();
          FC_ASSERT( rec && rec->name == account_name_or_id );
+         cache_account( *rec );
          return *rec;
       }
    }
@@ -417,7 +426,10 @@ namespace graphene { namespace wallet { namespace detail {
          boost::erase(signed_tx.signatures, boost::unique<boost::return_found_end>(boost::sort(signed_tx.signatures)));
          result.push_back( signed_tx );
          if( broadcast )
+         {
             _remote_net_broadcast->broadcast_transaction(signed_tx);
+            clear_object_cache();
+         }
       }
 
       return result;
@@ -425,7 +437,29 @@ namespace graphene { namespace wallet { namespace detail {
 
    vector<flat_set<account_id_type>> wallet_api_impl::get_key_references(const vector<public_key_type> &keys) const
    {
-       return _remote_db->get_key_references(keys);
+      vector<flat_set<account_id_type>> result = _remote_db->get_key_references( keys, optional<uint32_t>(),
+                                                                                 optional<account_id_type>() );
+      // The node returns at most a configured number of accounts per key, which is at least the size of the largest
+      // page. Only the keys which got a page of that size can have more accounts, so page through them.
+      size_t page_size = 0;
+      for( const auto& refs : result )
+         page_size = std::max( page_size, refs.size() );
+      if( page_size == 0 )
+         return result;
+      for( size_t i = 0; i < result.size(); ++i )
+      {
+         size_t last_page_size = result[i].size();
+         while( last_page_size == page_size )
+         {
+            const account_id_type next_id( result[i].rbegin()->instance.value + 1 );
+            const auto page = _remote_db->get_key_references( vector<public_key_type>{ keys[i] },
+                                                              optional<uint32_t>( static_cast<uint32_t>( page_size ) ), next_id );
+            FC_ASSERT( page.size() == 1, "Unexpected result of get_key_references" );
+            last_page_size = page.front().size();
+            result[i].insert( page.front().begin(), page.front().end() );
+         }
+      }
+      return result;
    }
 
 }}} // namespace graphene::wallet::detail
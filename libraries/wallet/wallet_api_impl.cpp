@@ -74,6 +74,12 @@ namespace graphene { namespace wallet { namespace detail {
       }
       init_prototype_ops();
 
+      // this resets all subscriptions on the node, so it has to be set before anything is subscribed to
+      _remote_db->set_subscribe_callback( [this](const variant& changes )
+      {
+         on_objects_changed( changes );
+      }, false );
+
       _remote_db->set_block_applied_callback( [this](const variant& block_id )
       {
          on_block_applied( block_id );
@@ -87,6 +93,14 @@ namespace graphene { namespace wallet { namespace detail {
 
    wallet_api_impl::~wallet_api_impl()
    {
+      try
+      {
+         save_object_cache();
+      }
+      catch (const fc::exception& e)
+      {
+         wlog( "Failed to save the object cache: ${e}", ("e", e.to_detail_string()) );
+      }
       try
       {
          _remote_db->cancel_all_subscriptions();
@@ -185,9 +199,129 @@ namespace graphene { namespace wallet { namespace detail {
 
    void wallet_api_impl::on_block_applied( const variant& block_id )
    {
+      // Balances and the collateral totals of market-issued assets are not subscribed to
+      _cached_balances.clear();
+      for( auto itr = _cached_assets.begin(); itr != _cached_assets.end(); )
+      {
+         if( itr->second.bitasset_data_id.valid() )
+            itr = _cached_assets.erase( itr );
+         else
+            ++itr;
+      }
       fc::async([this]{resync();}, "Resync after block");
    }
 
+   void wallet_api_impl::on_objects_changed( const variant& changes )
+   {
+      if( !changes.is_array() )
+         return;
+      for( const variant& item : changes.get_array() )
+      {
+         try
+         {
+            object_id_type id;
+            if( item.is_object() && item.get_object().contains( "id" ) )
+               id = item.get_object()["id"].as<object_id_type>( 1 );
+            else if( item.is_string() )
+               id = item.as<object_id_type>( 1 );
+            else
+               continue;
+
+            if( id.is<account_id_type>() )
+               _cached_accounts.erase( account_id_type( id ) );
+            else if( id.is<asset_id_type>() )
+               _cached_assets.erase( asset_id_type( id ) );
+         }
+         catch( const fc::exception& e )
+         {
+            wlog( "Ignoring unexpected object notification ${n}: ${e}", ("n", item)("e", e.to_detail_string()) );
+         }
+      }
+   }
+
+   void wallet_api_impl::cache_account( const account_object& account )const
+   {
+      _cached_accounts[account.get_id()] = account;
+      _cached_account_ids[account.name] = account.get_id();
+   }
+
+   void wallet_api_impl::cache_asset( const extended_asset_object& asset )const
+   {
+      _cached_assets[asset.get_id()] = asset;
+      _cached_asset_ids[asset.symbol] = asset.get_id();
+   }
+
+   void wallet_api_impl::clear_object_cache()
+   {
+      _cached_accounts.clear();
+      _cached_account_ids.clear();
+      _cached_assets.clear();
+      _cached_asset_ids.clear();
+      _cached_balances.clear();
+   }
+
+   void wallet_api_impl::set_object_cache_file( string filename )
+   {
+      _object_cache_filename = filename;
+      if( filename.empty() || !fc::exists( filename ) )
+         return;
+
+      const auto data = fc::json::from_file( filename ).as< object_cache_data >( 2 * GRAPHENE_MAX_NESTED_OBJECTS );
+      if( data.chain_id != _chain_id )
+      {
+         wlog( "Ignoring object cache file ${fn} of another chain", ("fn", filename) );
+         return;
+      }
+
+      // Names and symbols never change, so only the objects have to be refreshed. This is done in a few batched
+      // requests, which also subscribe to the objects.
+      const size_t batch_size = 100;
+      vector<string> ids;
+      for( size_t start = 0; start < data.accounts.size(); start += batch_size )
+      {
+         ids.clear();
+         const size_t end = std::min( start + batch_size, data.accounts.size() );
+         for( size_t i = start; i < end; ++i )
+            ids.push_back( account_id_to_string( data.accounts[i].get_id() ) );
+         for( const auto& account : _remote_db->get_accounts( ids, true ) )
+         {
+            if( account.valid() )
+               cache_account( *account );
+         }
+      }
+      for( size_t start = 0; start < data.assets.size(); start += batch_size )
+      {
+         ids.clear();
+         const size_t end = std::min( start + batch_size, data.assets.size() );
+         for( size_t i = start; i < end; ++i )
+            ids.push_back( asset_id_to_string( data.assets[i].get_id() ) );
+         for( const auto& asset : _remote_db->get_assets( ids, true ) )
+         {
+            if( asset.valid() )
+               cache_asset( *asset );
+         }
+      }
+   }
+
+   void wallet_api_impl::save_object_cache()const
+   {
+      if( _object_cache_filename.empty() )
+         return;
+
+      object_cache_data data;
+      data.chain_id = _chain_id;
+      data.accounts.reserve( _cached_accounts.size() );
+      for( const auto& item : _cached_accounts )
+         data.accounts.push_back( item.second );
+      data.assets.reserve( _cached_assets.size() );
+      for( const auto& item : _cached_assets )
+         data.assets.push_back( item.second );
+
+      const string tmp_filename = _object_cache_filename + ".tmp";
+      fc::json::save_to_file( data, tmp_filename, false );
+      fc::rename( tmp_filename, _object_cache_filename );
+   }
+
    void wallet_api_impl::set_operation_fees( signed_transaction& tx, const fee_schedule& s  )
    {
       for( auto& op : tx.operations )
@@ -483,6 +617,8 @@ namespace graphene { namespace wallet { namespace detail {
          disable_umask_protection();
          throw;
       }
+
+      save_object_cache();
    }
 
 }}} // namespace graphene::wallet::detail
@@ -112,6 +112,11 @@ public:
     */
    void on_block_applied( const variant& block_id );
 
+   /***
+    * @brief called when subscribed objects have been changed or removed on the node
+    */
+   void on_objects_changed( const variant& changes );
+
    /**
     * @brief make a copy of the wallet file
     * Note: this will not overwrite. It simply adds a version suffix.
@@ -212,6 +217,10 @@ public:
 
    void save_wallet_file(string wallet_filename = "");
 
+   void set_object_cache_file( string filename );
+   void save_object_cache()const;
+   void clear_object_cache();
+
    transaction_handle_type begin_builder_transaction();
    void add_operation_to_builder_transaction(transaction_handle_type transaction_handle, const operation& op);
    void replace_operation_in_builder_transaction(transaction_handle_type handle,
@@ -420,6 +429,15 @@ public:
 
    flat_map<string, operation> _prototype_ops;
 
+   // Objects fetched from the node. Accounts and assets are subscribed to and dropped from the cache when the node
+   // reports a change, balances are dropped whenever a block is applied. Names and symbols never change.
+   mutable map<account_id_type, account_object>        _cached_accounts;
+   mutable map<string, account_id_type>                _cached_account_ids;
+   mutable map<asset_id_type, extended_asset_object>   _cached_assets;
+   mutable map<string, asset_id_type>                  _cached_asset_ids;
+   mutable map<string, vector<asset>>                  _cached_balances;
+   string                                              _object_cache_filename;
+
    static_variant_map _operation_which_map = create_static_variant_map< operation >();
 
 private:
@@ -439,6 +457,9 @@ private:
 
    void claim_registered_account(const graphene::chain::account_object& account);
 
+   void cache_account( const account_object& account )const;
+   void cache_asset( const extended_asset_object& asset )const;
+
    // after a witness registration succeeds, this saves the private key in the wallet permanently
    //
    void claim_registered_witness(const std::string& witness_name);
@@ -36,7 +36,13 @@ namespace graphene { namespace wallet { namespace detail {
 
    optional<extended_asset_object> wallet_api_impl::find_asset(asset_id_type id)const
    {
-      auto rec = _remote_db->get_assets({asset_id_to_string(id)}, {}).front();
+      auto itr = _cached_assets.find( id );
+      if( itr != _cached_assets.end() )
+         return itr->second;
+
+      auto rec = _remote_db->get_assets({asset_id_to_string(id)}, true).front();
+      if( rec )
+         cache_asset( *rec );
       return rec;
    }
 
@@ -50,11 +56,15 @@ namespace graphene { namespace wallet { namespace detail {
          return find_asset(*id);
       } else {
          // It's a symbol
-         auto rec = _remote_db->lookup_asset_symbols({asset_symbol_or_id}).front();
+         auto itr = _cached_asset_ids.find( asset_symbol_or_id );
+         if( itr != _cached_asset_ids.end() )
+            return find_asset( itr->second );
+         auto rec = _remote_db->get_assets({asset_symbol_or_id}, true).front();
          if( rec )
          {
             if( rec->symbol != asset_symbol_or_id )
                return optional<asset_object>();
+            cache_asset( *rec );
          }
          return rec;
       }
@@ -80,6 +90,9 @@ namespace graphene { namespace wallet { namespace detail {
       vector<optional<extended_asset_object>> opt_asset;
       if( std::isdigit( asset_symbol_or_id.front() ) )
          return fc::variant(asset_symbol_or_id, 1).as<asset_id_type>( 1 );
+      auto itr = _cached_asset_ids.find( asset_symbol_or_id );
+      if( itr != _cached_asset_ids.end() )
+         return itr->second;
       opt_asset = _remote_db->lookup_asset_symbols( {asset_symbol_or_id} );
       FC_ASSERT( (opt_asset.size() > 0) && (opt_asset[0].valid()) );
       return opt_asset[0]->id;
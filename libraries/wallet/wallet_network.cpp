@@ -107,6 +107,8 @@ namespace graphene { namespace wallet { namespace detail {
    {
        try {
            _remote_net_broadcast->broadcast_transaction(tx);
+           // the node does not report changes of pending objects, so cached objects may be outdated now
+           clear_object_cache();
        }
        catch (const fc::exception& e) {
            elog("Caught exception while broadcasting tx ${id}:  ${e}",
@@ -298,6 +298,7 @@ namespace graphene { namespace wallet { namespace detail {
          try
          {
             _remote_net_broadcast->broadcast_transaction( tx );
+            clear_object_cache();
          }
          catch ( const fc::exception &e )
          {
@@ -368,6 +369,7 @@ namespace graphene { namespace wallet { namespace detail {
          try
          {
             _remote_net_broadcast->broadcast_transaction( tx );
+            clear_object_cache();
          }
          catch (const fc::exception& e)
          {
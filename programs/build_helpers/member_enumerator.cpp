@@ -54,6 +54,8 @@ struct class_processor
    template< typename T >
    void process_class( const fc::flat_set< T >* dummy );
 
+   void process_class( const graphene::protocol::fee_parameter_set* dummy );
+
    template< typename K, typename V >
    void process_class( const fc::flat_map< K, V >* dummy );
 
@@ -166,6 +168,11 @@ void class_processor::process_class( const fc::flat_set< T >* dummy )
    process_class( (T*) nullptr );
 }
 
+void class_processor::process_class( const graphene::protocol::fee_parameter_set* dummy )
+{
+   process_class( (const graphene::protocol::fee_parameter_set::container_type*) nullptr );
+}
+
 template< typename K, typename V >
 void class_processor::process_class( const fc::flat_map< K, V >* dummy )
 {
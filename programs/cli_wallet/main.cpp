@@ -144,6 +144,8 @@ int main( int argc, char** argv )
                "Endpoint for wallet HTTP and websocket RPC to listen on")
          ("daemon,d", "Run the wallet in daemon mode" )
          ("wallet-file,w", bpo::value<string>()->implicit_value("wallet.json"), "wallet to load")
+         ("object-cache-file", bpo::value<string>()->implicit_value("wallet_cache.json"),
+               "file to keep the local cache of accounts and assets in")
          ("chain-id", bpo::value<string>(), "chain ID to connect to")
          ("suggest-brain-key", "Suggest a safe brain key to use for creating your account")
          ("logs-rpc-console-level", bpo::value<string>()->default_value("info"),
@@ -239,6 +241,8 @@ int main( int argc, char** argv )
       auto wapiptr = std::make_shared<wallet_api>( wdata, remote_api );
       wapiptr->set_wallet_filename( wallet_file.generic_string() );
       wapiptr->load_wallet_file();
+      if( options.count("object-cache-file") )
+         wapiptr->set_object_cache_file( options.at("object-cache-file").as<string>() );
 
       fc::api<wallet_api> wapi(wapiptr);
 
@@ -115,6 +115,8 @@ template<size_t N>   struct js_name<std::array<uint8_t,N>>{ static std::string n
 template<typename T> struct js_name< fc::optional<T> >    { static std::string name(){ return "optional(" + js_name<T>::name() + ")"; } };
 template<>           struct js_name< object_id_type >     { static std::string name(){ return "object_id_type"; } };
 template<typename T> struct js_name< fc::flat_set<T> >    { static std::string name(){ return "set(" + js_name<T>::name() + ")"; } };
+template<> struct js_name< fee_parameter_set >
+{ static std::string name(){ return js_name< fee_parameter_set::container_type >::name(); } };
 template<typename T> struct js_name< std::vector<T> >     { static std::string name(){ return "array(" + js_name<T>::name() + ")"; } };
 template<typename T> struct js_name< fc::safe<T> > { static std::string name(){ return js_name<T>::name(); } };
 
@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/included/unit_test.hpp>
+
+boost::unit_test::test_suite* init_unit_test_suite(int argc, char* argv[]) {
+   std::srand(time(NULL));
+   std::cout << "Random number generator seeded to " << time(NULL) << std::endl;
+   return nullptr;
+}
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/hardfork.hpp>
+
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/liquidity_pool_object.hpp>
+
+#include <graphene/chain/asset_evaluator.hpp>
+#include <graphene/chain/custom_authority_evaluator.hpp>
+#include <graphene/chain/htlc_evaluator.hpp>
+#include <graphene/chain/liquidity_pool_evaluator.hpp>
+#include <graphene/chain/market_evaluator.hpp>
+#include <graphene/chain/ticket_evaluator.hpp>
+#include <graphene/chain/transfer_evaluator.hpp>
+
+#include <fc/io/json.hpp>
+
+#include "../common/database_fixture.hpp"
+#include <cstdlib>
+#include <iostream>
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+/// Reads an unsigned integer from the environment, falling back to @p def if it is not set or not valid
+uint32_t env_uint( const char* name, uint32_t def )
+{
+   const char* value = std::getenv( name );
+   if( value == nullptr || *value == '\0' )
+      return def;
+   const long parsed = std::strtol( value, nullptr, 10 );
+   return parsed > 0 ? static_cast<uint32_t>( parsed ) : def;
+}
+
+/**
+ * Builds a chain state which resembles the main network at a small scale: many funded accounts, a number of
+ * bitassets with feeds, a debt position per account and bitasset, deep order books on both sides of every
+ * bitasset market and a liquidity pool. The scale is multiplied by GRAPHENE_BENCHMARK_SCALE.
+ */
+struct evaluator_benchmark_fixture : database_fixture
+{
+   uint32_t scale = env_uint( "GRAPHENE_BENCHMARK_SCALE", 1 );
+   uint32_t num_accounts = 1000 * scale;
+   uint32_t num_bitassets = 10;
+
+   vector<account_id_type>  accounts;
+   vector<asset_id_type>    bitassets;
+   account_id_type          feeder;
+   asset_id_type            pool_asset;
+   liquidity_pool_id_type   pool;
+
+   fc::variants results;
+
+   evaluator_benchmark_fixture()
+   {
+      generate_blocks( HARDFORK_BSIP_40_TIME );
+      generate_blocks( 5 );
+      db.modify( db.get_global_properties(), []( global_property_object& gpo ) {
+         gpo.parameters.extensions.value.custom_authority_options = custom_authority_options_type();
+         gpo.parameters.extensions.value.updatable_htlc_options = htlc_options{ 60 * 60 * 24 * 28, 19200 };
+      });
+      set_expiration( db, trx );
+
+      const auto start = fc::time_point::now();
+      create_markets();
+      db._undo_db.disable(); // bulk state creation does not need to be reversible
+      create_accounts();
+      create_positions_and_orders();
+      create_pool();
+      db._undo_db.enable(); // undo sessions reset the state after each apply measurement
+      const auto elapsed = fc::time_point::now() - start;
+      ilog( "Benchmark state: ${a} accounts, ${b} bitassets, ${o} limit orders, created in ${ms}ms",
+            ("a",num_accounts)("b",num_bitassets)
+            ("o",db.get_index_type<limit_order_index>().indices().size())("ms",elapsed.count()/1000) );
+   }
+
+   ~evaluator_benchmark_fixture()
+   {
+      const char* path = std::getenv( "GRAPHENE_BENCHMARK_OUTPUT" );
+      if( path != nullptr && *path != '\0' )
+         fc::json::save_to_file( fc::variant( results ), fc::path( path ) );
+   }
+
+   /// Applies the operations in transactions of up to 100 operations each, without any checks
+   vector<operation_result> apply_operations( const vector<operation>& ops )
+   {
+      vector<operation_result> op_results;
+      op_results.reserve( ops.size() );
+      signed_transaction tx;
+      set_expiration( db, tx );
+      for( size_t i = 0; i < ops.size(); )
+      {
+         tx.operations.clear();
+         for( size_t n = 0; n < 100 && i < ops.size(); ++n, ++i )
+            tx.operations.push_back( ops[i] );
+         const auto ptx = db.apply_transaction( tx, ~0 );
+         op_results.insert( op_results.end(), ptx.operation_results.begin(), ptx.operation_results.end() );
+      }
+      return op_results;
+   }
+
+   price_feed make_feed( asset_id_type bitasset, share_type core_amount )const
+   {
+      price_feed feed;
+      feed.maintenance_collateral_ratio = 1750;
+      feed.maximum_short_squeeze_ratio = 1100;
+      feed.settlement_price = price( asset( 100, bitasset ), asset( core_amount ) );
+      feed.core_exchange_rate = feed.settlement_price;
+      return feed;
+   }
+
+   void create_markets()
+   {
+      feeder = create_account( "feeder" ).get_id();
+      for( uint32_t i = 0; i < num_bitassets; ++i )
+      {
+         const string symbol = string( "BENCH" ) + char( 'A' + i / 26 ) + char( 'A' + i % 26 );
+         const asset_object& mia = create_bitasset( symbol, account_id_type(), 100, charge_market_fee, 2 );
+         bitassets.push_back( mia.get_id() );
+         update_feed_producers( mia, { feeder } );
+         publish_feed( mia, feeder( db ), make_feed( mia.get_id(), 500 ) );
+      }
+   }
+
+   void create_accounts()
+   {
+      const auto key = generate_private_key( "bench" ).get_public_key();
+      vector<operation> ops;
+      ops.reserve( num_accounts );
+      for( uint32_t i = 0; i < num_accounts; ++i )
+         ops.push_back( make_account( "bench" + fc::to_string( i ), key ) );
+      for( const auto& result : apply_operations( ops ) )
+         accounts.push_back( result.get<object_id_type>() );
+
+      ops.clear();
+      for( const auto& account : accounts )
+      {
+         transfer_operation op;
+         op.from = account_id_type();
+         op.to = account;
+         op.amount = asset( 100000000 );
+         ops.push_back( op );
+      }
+      apply_operations( ops );
+   }
+
+   void create_positions_and_orders()
+   {
+      vector<operation> ops;
+      for( uint32_t i = 0; i < num_accounts; ++i )
+      {
+         for( const auto& bitasset : bitassets )
+         {
+            // a debt position at a collateral ratio of 4
+            call_order_update_operation borrow;
+            borrow.funding_account = accounts[i];
+            borrow.delta_debt = asset( 100000, bitasset );
+            borrow.delta_collateral = asset( 2000000 );
+            ops.push_back( borrow );
+
+            // an ask above and a bid below the feed price, so that the books are deep but never cross
+            limit_order_create_operation ask;
+            ask.seller = accounts[i];
+            ask.amount_to_sell = asset( 1000, bitasset );
+            ask.min_to_receive = asset( 6000 + 100 * ( i % 50 ) );
+            ask.expiration = time_point_sec::maximum();
+            ops.push_back( ask );
+
+            limit_order_create_operation bid;
+            bid.seller = accounts[i];
+            bid.amount_to_sell = asset( 10000 );
+            bid.min_to_receive = asset( 3000 + 100 * ( i % 50 ), bitasset );
+            bid.expiration = time_point_sec::maximum();
+            ops.push_back( bid );
+         }
+      }
+      apply_operations( ops );
+   }
+
+   void create_pool()
+   {
+      const asset_object& uia = create_user_issued_asset( "BENCHUIA" );
+      pool_asset = uia.get_id();
+      const account_object& owner = create_account( "poolowner" );
+      fund( owner, asset( 1000000000 ) );
+      issue_uia( owner, uia.amount( 1000000000 ) );
+      const asset_object& share = create_user_issued_asset( "BENCHLP", owner, 0 );
+      pool = create_liquidity_pool( owner.get_id(), asset_id_type(), uia.get_id(), share.get_id(), 0, 0 ).get_id();
+      deposit_to_liquidity_pool( owner.get_id(), pool, asset( 1000000000 ), uia.amount( 1000000000 ) );
+   }
+
+   void report( const string& operation, const string& phase, size_t count, const fc::microseconds& elapsed )
+   {
+      const int64_t us = std::max<int64_t>( elapsed.count(), 1 );
+      fc::mutable_variant_object result;
+      result( "operation", operation )
+            ( "phase", phase )
+            ( "count", count )
+            ( "elapsed_us", elapsed.count() )
+            ( "ops_per_second", double( count ) * 1000000 / us )
+            ( "us_per_op", double( us ) / std::max<size_t>( count, 1 ) );
+      std::cout << fc::json::to_string( result ) << std::endl;
+      results.emplace_back( result );
+   }
+
+   /**
+    * Measures the throughput of one operation type in two passes:
+    *  - evaluate: every operation is evaluated by a fresh @p Evaluator against the unchanged state, which includes
+    *    fee preparation and do_evaluate
+    *  - apply: every operation is applied through the database in sequence, which adds fee payment and do_apply
+    * The difference between both is reported as do_apply. The applied changes are undone afterwards, so that every
+    * operation type is measured against the same state.
+    */
+   template<typename Evaluator>
+   void measure( const string& operation, const vector<graphene::chain::operation>& ops )
+   { try {
+      fc::microseconds evaluate_time;
+      {
+         const auto start = fc::time_point::now();
+         for( const auto& op : ops )
+         {
+            transaction_evaluation_state eval_state( &db );
+            Evaluator evaluator;
+            evaluator.start_evaluate( eval_state, op, false );
+         }
+         evaluate_time = fc::time_point::now() - start;
+      }
+
+      fc::microseconds apply_time;
+      {
+         auto session = db._undo_db.start_undo_session();
+         const auto start = fc::time_point::now();
+         for( const auto& op : ops )
+         {
+            transaction_evaluation_state eval_state( &db );
+            db.apply_operation( eval_state, op );
+         }
+         apply_time = fc::time_point::now() - start;
+      }
+
+      report( operation, "evaluate", ops.size(), evaluate_time );
+      report( operation, "apply", ops.size(), apply_time );
+      report( operation, "do_apply", ops.size(),
+              apply_time > evaluate_time ? apply_time - evaluate_time : fc::microseconds() );
+   } FC_CAPTURE_AND_RETHROW( (operation) ) }
+};
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE( evaluator_benchmarks, evaluator_benchmark_fixture )
+
+BOOST_AUTO_TEST_CASE( operation_throughput )
+{ try {
+   const uint32_t n = num_accounts;
+   vector<operation> ops;
+
+   for( uint32_t i = 0; i < n; ++i )
+   {
+      transfer_operation op;
+      op.from = accounts[i];
+      op.to = accounts[(i + 1) % n];
+      op.amount = asset( 100 );
+      ops.push_back( op );
+   }
+   measure<transfer_evaluator>( "transfer", ops );
+
+   ops.clear();
+   for( uint32_t i = 0; i < n; ++i )
+   {
+      limit_order_create_operation op;
+      op.seller = accounts[i];
+      op.amount_to_sell = asset( 1000 );
+      op.min_to_receive = asset( 400 + i % 50, bitassets[i % num_bitassets] );
+      op.expiration = time_point_sec::maximum();
+      ops.push_back( op );
+   }
+   measure<limit_order_create_evaluator>( "limit_order_create", ops );
+
+   ops.clear();
+   for( uint32_t i = 0; i < n; ++i )
+   {
+      call_order_update_operation op;
+      op.funding_account = accounts[i];
+      op.delta_debt = asset( 10, bitassets[i % num_bitassets] );
+      op.delta_collateral = asset( 1000 );
+      ops.push_back( op );
+   }
+   measure<call_order_update_evaluator>( "call_order_update", ops );
+
+   ops.clear();
+   for( uint32_t i = 0; i < n; ++i )
+   {
+      asset_publish_feed_operation op;
+      op.publisher = feeder;
+      op.asset_id = bitassets[i % num_bitassets];
+      op.feed = make_feed( op.asset_id, 490 + i % 20 );
+      ops.push_back( op );
+   }
+   measure<asset_publish_feeds_evaluator>( "asset_publish_feed", ops );
+
+   ops.clear();
+   for( uint32_t i = 0; i < n; ++i )
+      ops.push_back( make_liquidity_pool_exchange_op( accounts[i], pool, asset( 10000 ), asset( 1, pool_asset ) ) );
+   measure<liquidity_pool_exchange_evaluator>( "liquidity_pool_exchange", ops );
+
+   ops.clear();
+   for( uint32_t i = 0; i < n; ++i )
+   {
+      htlc_create_operation op;
+      op.from = accounts[i];
+      op.to = accounts[(i + 1) % n];
+      op.amount = asset( 1000 );
+      op.preimage_hash = fc::sha256::hash( fc::to_string( i ) );
+      op.preimage_size = 32;
+      op.claim_period_seconds = 3600;
+      ops.push_back( op );
+   }
+   measure<htlc_create_evaluator>( "htlc_create", ops );
+
+   ops.clear();
+   for( uint32_t i = 0; i < n; ++i )
+      ops.push_back( make_ticket_create_op( accounts[i], lock_180_days, asset( 1000 ) ) );
+   measure<ticket_create_evaluator>( "ticket_create", ops );
+
+   ops.clear();
+   for( uint32_t i = 0; i < n; ++i )
+   {
+      custom_authority_create_operation op;
+      op.account = accounts[i];
+      op.auth.add_authority( accounts[(i + 1) % n], 1 );
+      op.auth.weight_threshold = 1;
+      op.enabled = true;
+      op.valid_to = db.head_block_time() + 3600;
+      op.operation_type = operation::tag<transfer_operation>::value;
+      // transfer_operation::amount is member 3, asset::amount is member 0
+      op.restrictions = { restriction( 3, restriction::func_attr,
+                                       vector<restriction>{ restriction( 0, restriction::func_lt, int64_t( 1000 ) ) } ) };
+      ops.push_back( op );
+   }
+   measure<custom_authority_create_evaluator>( "custom_authority_create", ops );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -868,6 +868,53 @@ BOOST_FIXTURE_TEST_CASE( account_history_pagination, cli_fixture )
 }
 
 
+///////////////////////
+// Cached accounts, assets and balances are refreshed after the wallet
+// broadcasts a transaction, and can be kept in a cache file
+///////////////////////
+BOOST_FIXTURE_TEST_CASE( cli_object_cache, cli_fixture )
+{
+   try
+   {
+      INVOKE(create_new_account);
+
+      const std::string cache_filename = con.wallet_filename + ".cache";
+      con.wallet_api_ptr->set_object_cache_file( cache_filename );
+
+      account_object jmj = con.wallet_api_ptr->get_account( "jmjatlanta" );
+      BOOST_CHECK( con.wallet_api_ptr->get_account( "jmjatlanta" ).id == jmj.id );
+      BOOST_CHECK( con.wallet_api_ptr->get_account( std::string( object_id_type( jmj.id ) ) ).name == "jmjatlanta" );
+      BOOST_CHECK_EQUAL( con.wallet_api_ptr->get_asset( "1.3.0" ).symbol, GRAPHENE_SYMBOL );
+
+      vector<asset> balances_before = con.wallet_api_ptr->list_account_balances( "jmjatlanta" );
+      BOOST_REQUIRE_EQUAL( balances_before.size(), 1u );
+      BOOST_CHECK( con.wallet_api_ptr->list_account_balances( "jmjatlanta" ) == balances_before );
+
+      BOOST_TEST_MESSAGE("Transferring bitshares from Nathan to jmjatlanta");
+      con.wallet_api_ptr->transfer( "nathan", "jmjatlanta", "1", "1.3.0", "", true );
+      vector<asset> balances_after = con.wallet_api_ptr->list_account_balances( "jmjatlanta" );
+      BOOST_REQUIRE_EQUAL( balances_after.size(), 1u );
+      BOOST_CHECK_EQUAL( balances_after[0].amount.value,
+                         balances_before[0].amount.value + int64_t( GRAPHENE_BLOCKCHAIN_PRECISION ) );
+
+      BOOST_TEST_MESSAGE("Saving and reloading the cache file");
+      con.wallet_api_ptr->get_account( "jmjatlanta" );
+      con.wallet_api_ptr->save_wallet_file( con.wallet_filename );
+      BOOST_REQUIRE( fc::exists( cache_filename ) );
+      auto cached = fc::json::from_file( cache_filename ).as<graphene::wallet::object_cache_data>(
+            2 * GRAPHENE_MAX_NESTED_OBJECTS );
+      BOOST_CHECK( std::any_of( cached.accounts.begin(), cached.accounts.end(),
+                                [&jmj]( const account_object& a ) { return a.id == jmj.id; } ) );
+
+      con.wallet_api_ptr->clear_object_cache();
+      con.wallet_api_ptr->set_object_cache_file( cache_filename );
+      BOOST_CHECK( con.wallet_api_ptr->get_account( "jmjatlanta" ).id == jmj.id );
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 ///////////////////////
 // Create a multi-sig account and verify that only when all signatures are
 // signed, the transaction could be broadcast
@@ -34,7 +34,9 @@ boost::unit_test::test_suite* init_unit_test_suite(int argc, char* argv[]) {
 
 #include <graphene/chain/account_object.hpp>
 #include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/custom_authority_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
+#include <graphene/chain/transaction_history_object.hpp>
 
 #include <graphene/db/simple_index.hpp>
 
@@ -214,4 +216,258 @@ BOOST_AUTO_TEST_CASE( one_hundred_k_benchmark )
    db._undo_db.enable();
 } FC_LOG_AND_RETHROW() }
 
+
+// Measures the cost of the duplicate transaction check: apply throughput with and without keeping transaction
+// bodies in the recent transaction cache, and the memory taken by the deduplication index
+BOOST_AUTO_TEST_CASE( transaction_dedupe_benchmark )
+{ try {
+   ACTORS( (alice) );
+   db._undo_db.disable();
+
+   const uint32_t skip = ~database::skip_transaction_dupe_check;
+   const uint32_t cycles = 100000;
+   const auto& committee_account = account_id_type()(db);
+   const auto& dedupe_index = db.get_index_type<transaction_index>().indices();
+
+   auto run = [&]( size_t cache_capacity, int64_t amount_offset )
+   {
+      db.recent_transactions().clear();
+      db.recent_transactions().set_capacity( cache_capacity );
+      const size_t entries_before = dedupe_index.size();
+
+      std::vector<signed_transaction> transactions;
+      transactions.reserve( cycles );
+      uint64_t body_bytes = 0;
+      transfer_operation op;
+      op.from = committee_account.id;
+      op.to = alice_id;
+      op.fee = asset( 10 );
+      for( uint32_t i = 0; i < cycles; ++i )
+      {
+         signed_transaction tx;
+         op.amount = asset( amount_offset + i + 1 );
+         tx.operations.push_back( op );
+         test::set_expiration( db, tx );
+         body_bytes += sizeof( signed_transaction ) + fc::raw::pack_size( tx );
+         transactions.push_back( std::move( tx ) );
+      }
+
+      auto start = fc::time_point::now();
+      for( uint32_t i = 0; i < cycles; ++i )
+         db.apply_transaction( transactions[i], skip );
+      auto elapsed = fc::time_point::now() - start;
+
+      const size_t entries = dedupe_index.size() - entries_before;
+      wlog( "Dedupe with ${c} cached bodies: ${tps} transactions/s over ${total}ms, "
+            "${n} index entries of ${s} bytes each, at least ${b} bytes if every entry held its transaction, "
+            "${k} bodies cached",
+            ("c",cache_capacity)("tps",(uint64_t(cycles)*1000000)/std::max<int64_t>(elapsed.count(),1))
+            ("total",elapsed.count()/1000)("n",entries)("s",sizeof(transaction_history_object))
+            ("b",body_bytes)("k",db.recent_transactions().size()) );
+   };
+
+   run( 0, 0 );
+   run( 10000, cycles );
+   run( cycles, 2 * cycles );
+
+   db.recent_transactions().set_capacity( 10000 );
+   db._undo_db.enable();
+} FC_LOG_AND_RETHROW() }
+
+
+// Compares looking up objects by id through the dense direct index of their primary index with a walk of the
+// ordered by_id index of the same objects
+BOOST_AUTO_TEST_CASE( object_lookup_benchmark )
+{ try {
+   db._undo_db.disable();
+
+   const uint32_t count = 200000;
+   const uint64_t lookups = 2000000;
+   // the owners do not need to exist, they only keep the balances unique
+   for( uint32_t i = 0; i < count; ++i )
+   {
+      db.create<account_balance_object>( [i]( account_balance_object& b ) {
+         b.owner = account_id_type( i + 1000 );
+         b.asset_type = asset_id_type();
+         b.balance = i;
+      } );
+   }
+
+   const auto& bal_idx = db.get_index_type<account_balance_index>();
+   const auto& by_id = bal_idx.indices().get<by_id>();
+   const uint64_t first = by_id.rbegin()->id.instance() + 1 - count;
+
+   std::vector<object_id_type> ids;
+   ids.reserve( lookups );
+   for( uint64_t i = 0; i < lookups; ++i )
+      ids.push_back( account_balance_id_type( first + std::rand() % count ) );
+
+   auto benchmark = [&ids]( const std::string& what, const std::function<const object*(object_id_type)>& lookup )
+   {
+      uint64_t found = 0;
+      auto start = fc::time_point::now();
+      for( const auto& id : ids )
+         found += ( lookup( id ) != nullptr );
+      auto elapsed = fc::time_point::now() - start;
+      BOOST_CHECK_EQUAL( found, ids.size() );
+      wlog( "${what}: ${n} random lookups in ${ms}ms, ${ns} ns per lookup",
+            ("what",what)("n",ids.size())("ms",elapsed.count()/1000)
+            ("ns",elapsed.count()*1000/int64_t(ids.size())) );
+   };
+
+   benchmark( "dense index", [&bal_idx]( object_id_type id ) { return bal_idx.find( id ); } );
+   benchmark( "database::find_object", [this]( object_id_type id ) { return db.find_object( id ); } );
+   benchmark( "ordered by_id index", [&by_id]( object_id_type id ) -> const object* {
+      auto itr = by_id.find( id );
+      return itr == by_id.end() ? nullptr : &*itr;
+   } );
+
+   db._undo_db.enable();
+} FC_LOG_AND_RETHROW() }
+
+
+// Custom authority workload: many accounts with a few identical restriction sets. Measures compiling the
+// predicates per object versus through the shared predicate cache, and checking operations against them.
+BOOST_AUTO_TEST_CASE( custom_authority_predicate_benchmark )
+{ try {
+   db._undo_db.disable();
+
+   const uint32_t accounts = 2000;
+   const uint32_t auths_per_account = 4;
+   const uint32_t checks = 200000;
+   const auto transfer_tag = operation::tag<transfer_operation>::value;
+
+   vector< flat_map<uint16_t, restriction> > restriction_sets( auths_per_account );
+   for( uint32_t i = 0; i < auths_per_account; ++i )
+   {
+      restriction_sets[i][0] = restriction( 2, restriction::func_eq, account_id_type( 100 + i ) );
+      restriction_sets[i][1] = restriction( 3, restriction::func_attr,
+                                            vector<restriction>{ restriction( 0, restriction::func_le,
+                                                                              int64_t( 1000 * ( i + 1 ) ) ) } );
+   }
+
+   vector<const custom_authority_object*> objects;
+   objects.reserve( accounts * auths_per_account );
+   for( uint32_t a = 0; a < accounts; ++a )
+      for( uint32_t i = 0; i < auths_per_account; ++i )
+         objects.push_back( &db.create<custom_authority_object>( [&]( custom_authority_object& obj ) {
+            obj.account = account_id_type( 1000 + a );
+            obj.enabled = true;
+            obj.valid_from = db.head_block_time();
+            obj.valid_to = db.head_block_time() + fc::days(1);
+            obj.operation_type = transfer_tag;
+            obj.auth = authority( 1, obj.account, 1 );
+            obj.restrictions = restriction_sets[i];
+         } ) );
+
+   auto start = fc::time_point::now();
+   for( const auto* obj : objects )
+      get_restriction_predicate( obj->get_restrictions(), obj->operation_type.value );
+   auto elapsed = fc::time_point::now() - start;
+   wlog( "Compiling ${n} predicates one by one took ${ms}ms", ("n",objects.size())("ms",elapsed.count()/1000) );
+
+   db.custom_authority_predicates().clear();
+   start = fc::time_point::now();
+   for( const auto* obj : objects )
+      obj->update_predicate_cache( db.custom_authority_predicates() );
+   elapsed = fc::time_point::now() - start;
+   auto stats = db.custom_authority_predicates().get_statistics();
+   wlog( "Compiling ${n} predicates through the shared cache took ${ms}ms, ${e} entries, ${h} hits, ${m} misses",
+         ("n",objects.size())("ms",elapsed.count()/1000)("e",stats.entries)("h",stats.hits)("m",stats.misses) );
+
+   transfer_operation op;
+   op.amount = asset( 500 );
+   uint64_t viable = 0;
+   start = fc::time_point::now();
+   for( uint32_t i = 0; i < checks; ++i )
+   {
+      op.from = account_id_type( 1000 + i % accounts );
+      op.to = account_id_type( 100 + i % auths_per_account );
+      viable += db.get_viable_custom_authorities( op.from, op ).size();
+   }
+   elapsed = fc::time_point::now() - start;
+   BOOST_CHECK_EQUAL( viable, checks );
+   wlog( "Checked ${n} operations against the custom authorities of their fee payer in ${ms}ms, ${ns} ns each",
+         ("n",checks)("ms",elapsed.count()/1000)("ns",elapsed.count()*1000/checks) );
+
+   db._undo_db.enable();
+} FC_LOG_AND_RETHROW() }
+
+// Market makers and feed publishers sign many transactions per block. Accounts here are controlled by a team
+// account with a 2-of-3 authority of signer accounts, so every check walks two levels of account authorities.
+BOOST_AUTO_TEST_CASE( authority_check_benchmark )
+{ try {
+   const uint32_t signers = 60;
+   const uint32_t traders = 200;
+   const uint32_t cycles = 100000;
+
+   vector<fc::ecc::private_key> signer_keys;
+   vector<account_id_type> signer_ids;
+   for( uint32_t i = 0; i < signers; ++i )
+   {
+      signer_keys.push_back( generate_private_key( "signer" + fc::to_string(i) ) );
+      signer_ids.push_back( create_account( "signer" + fc::to_string(i), signer_keys.back() ).id );
+   }
+   vector<account_id_type> team_ids;
+   for( uint32_t i = 0; i < signers / 3; ++i )
+   {
+      const account_object& team = create_account( "team" + fc::to_string(i) );
+      db.modify( team, [&]( account_object& a ) {
+         a.active = authority( 2, signer_ids[3*i], 1, signer_ids[3*i+1], 1, signer_ids[3*i+2], 1 );
+      });
+      team_ids.push_back( team.id );
+   }
+   vector<account_id_type> trader_ids;
+   for( uint32_t i = 0; i < traders; ++i )
+   {
+      const account_object& trader = create_account( "trader" + fc::to_string(i) );
+      db.modify( trader, [&]( account_object& a ) {
+         a.active = authority( 1, team_ids[i % team_ids.size()], 1 );
+      });
+      trader_ids.push_back( trader.id );
+   }
+
+   vector<precomputable_transaction> transactions;
+   transactions.reserve( traders );
+   for( uint32_t i = 0; i < traders; ++i )
+   {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = trader_ids[i];
+      op.to = account_id_type();
+      op.amount = asset( 1 );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      const uint32_t team = i % team_ids.size();
+      sign( tx, signer_keys[3*team] );
+      sign( tx, signer_keys[3*team+1] );
+      transactions.emplace_back( tx );
+      transactions.back().get_signature_keys( db.get_chain_id() );
+   }
+
+   auto get_active = [this]( account_id_type id ) { return &id(db).active; };
+   auto get_owner  = [this]( account_id_type id ) { return &id(db).owner;  };
+   auto get_custom = [this]( account_id_type id, const operation& op, rejected_predicate_map* rejects ) {
+      return db.get_viable_custom_authorities( id, op, rejects );
+   };
+
+   auto run = [&]( authority_check_cache* cache ) {
+      auto start = fc::time_point::now();
+      for( uint32_t i = 0; i < cycles; ++i )
+         transactions[i % traders].verify_authority( db.get_chain_id(), get_active, get_owner, get_custom,
+                                                     true, true, GRAPHENE_MAX_SIG_CHECK_DEPTH, cache );
+      return fc::time_point::now() - start;
+   };
+
+   auto elapsed = run( nullptr );
+   wlog( "Benchmark: ${cps} authority checks/s without memoization", ("cps",(cycles*1000000)/elapsed.count()) );
+
+   authority_check_cache cache;
+   elapsed = run( &cache );
+   auto stats = cache.get_statistics();
+   wlog( "Benchmark: ${cps} authority checks/s with memoization, ${h} hits, ${m} misses",
+         ("cps",(cycles*1000000)/elapsed.count())("h",stats.hits)("m",stats.misses) );
+   BOOST_CHECK_EQUAL( stats.misses, traders );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,601 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+
+#include <fc/filesystem.hpp>
+#include <fc/io/json.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/balance_object.hpp>
+#include <graphene/chain/db_with.hpp>
+#include <graphene/chain/market_object.hpp>
+
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#ifndef WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace graphene::chain;
+using namespace std;
+namespace bpo = boost::program_options;
+
+// hack:  import create_example_genesis() even though it's a way, way
+// specific internal detail
+namespace graphene { namespace app { namespace detail {
+genesis_state_type create_example_genesis();
+} } } // graphene::app::detail
+
+// Count every allocation made through operator new, so that changes to the chain engine which add or remove
+// allocations show up in the report
+namespace {
+   std::atomic<uint64_t> allocation_count( 0 );
+   std::atomic<uint64_t> allocation_bytes( 0 );
+}
+
+void* operator new( size_t size )
+{
+   allocation_count.fetch_add( 1, std::memory_order_relaxed );
+   allocation_bytes.fetch_add( size, std::memory_order_relaxed );
+   if( void* p = std::malloc( size == 0 ? 1 : size ) )
+      return p;
+   throw std::bad_alloc();
+}
+void* operator new[]( size_t size ) { return ::operator new( size ); }
+void operator delete( void* p ) noexcept { std::free( p ); }
+void operator delete[]( void* p ) noexcept { std::free( p ); }
+void operator delete( void* p, size_t ) noexcept { std::free( p ); }
+void operator delete[]( void* p, size_t ) noexcept { std::free( p ); }
+
+namespace {
+
+/// The relative weights of the operation types in the generated workload
+struct workload_mix
+{
+   uint32_t transfers = 40;
+   uint32_t order_creates = 30;
+   uint32_t order_cancels = 15;
+   uint32_t feed_publishes = 5;
+   uint32_t borrows = 10;
+
+   uint32_t total()const { return transfers + order_creates + order_cancels + feed_publishes + borrows; }
+};
+
+/**
+ * Generates a chain with a deterministic, mainnet-like workload: accounts trade a number of bitassets against the
+ * core asset, publish feeds which move in a random walk, and keep debt positions close to the maintenance
+ * collateral ratio so that feed moves regularly trigger margin calls.
+ */
+class workload_generator
+{
+public:
+   workload_generator( database& db, uint64_t seed )
+      : _db( db ), _rng( seed ), _key( fc::ecc::private_key::regenerate( fc::sha256::hash( string( "nathan" ) ) ) )
+   {
+      _nathan = _db.get_index_type<account_index>().indices().get<by_name>().find( "nathan" )->id;
+   }
+
+   uint32_t pushed = 0;
+   uint32_t failed = 0;
+
+   void setup( uint32_t num_accounts, uint32_t num_bitassets, uint32_t trx_per_block )
+   {
+      balance_claim_operation claim;
+      claim.deposit_to_account = _nathan;
+      claim.balance_to_claim = balance_id_type();
+      claim.balance_owner_key = _key.get_public_key();
+      claim.total_claimed = balance_id_type()( _db ).balance;
+      push( claim );
+
+      account_upgrade_operation upgrade;
+      upgrade.account_to_upgrade = _nathan;
+      upgrade.upgrade_to_lifetime_member = true;
+      push( upgrade );
+      generate_block();
+
+      for( uint32_t i = 0; i < num_bitassets; ++i )
+      {
+         asset_create_operation create;
+         create.issuer = _nathan;
+         create.symbol = string( "BENCH" ) + char( 'A' + i / 26 ) + char( 'A' + i % 26 );
+         create.precision = 4;
+         create.common_options.max_supply = GRAPHENE_MAX_SHARE_SUPPLY;
+         create.common_options.market_fee_percent = 10;
+         create.common_options.issuer_permissions = charge_market_fee;
+         create.common_options.flags = charge_market_fee;
+         create.common_options.core_exchange_rate = price( asset( 1, asset_id_type(1) ), asset( 1 ) );
+         create.bitasset_opts = bitasset_options();
+         _bitassets.push_back( push( create ).get<object_id_type>() );
+      }
+      generate_block();
+
+      for( size_t i = 0; i < _bitassets.size(); ++i )
+      {
+         asset_update_feed_producers_operation producers;
+         producers.issuer = _nathan;
+         producers.asset_to_update = _bitassets[i];
+         producers.new_feed_producers = { _nathan };
+         push( producers );
+         _feeds.push_back( 50000 );
+         publish_feed( i );
+      }
+      generate_block();
+
+      uint32_t in_block = 0;
+      for( uint32_t i = 0; i < num_accounts; ++i )
+      {
+         account_create_operation create;
+         create.name = "bench" + fc::to_string( i );
+         create.registrar = _nathan;
+         create.referrer = _nathan;
+         create.owner = authority( 1, public_key_type( _key.get_public_key() ), 1 );
+         create.active = create.owner;
+         create.options.memo_key = _key.get_public_key();
+         create.options.voting_account = GRAPHENE_PROXY_TO_SELF_ACCOUNT;
+         const account_id_type account = push( create ).get<object_id_type>();
+         _accounts.push_back( account );
+
+         transfer_operation fund;
+         fund.from = _nathan;
+         fund.to = account;
+         fund.amount = asset( 100000 * GRAPHENE_BLOCKCHAIN_PRECISION );
+         push( fund );
+
+         if( ++in_block >= trx_per_block )
+         {
+            generate_block();
+            in_block = 0;
+         }
+      }
+      generate_block();
+   }
+
+   void generate_workload_block( const workload_mix& mix, uint32_t trx_per_block )
+   {
+      for( uint32_t i = 0; i < trx_per_block; ++i )
+      {
+         uint32_t pick = _rng() % mix.total();
+         if( pick < mix.transfers )
+            transfer();
+         else if( ( pick -= mix.transfers ) < mix.order_creates )
+            create_order();
+         else if( ( pick -= mix.order_creates ) < mix.order_cancels )
+            cancel_order();
+         else if( ( pick -= mix.order_cancels ) < mix.feed_publishes )
+            publish_feed( _rng() % _bitassets.size() );
+         else
+            borrow();
+      }
+      generate_block();
+   }
+
+   void generate_block()
+   {
+      _db.generate_block( _db.get_slot_time( 1 ), _db.get_scheduled_witness( 1 ), _key, database::skip_nothing );
+   }
+
+private:
+   template<typename Op>
+   operation_result push( const Op& op )
+   {
+      signed_transaction trx;
+      trx.operations.push_back( op );
+      _db.current_fee_schedule().set_fee( trx.operations.back() );
+      trx.set_reference_block( _db.head_block_id() );
+      trx.set_expiration( _db.head_block_time() + fc::minutes( 1 ) );
+      trx.sign( _key, _db.get_chain_id() );
+      operation_result result = _db.push_transaction( trx ).operation_results.front();
+      ++pushed;
+      return result;
+   }
+
+   /// Pushes an operation of the random workload, which may legitimately fail, e.g. for lack of funds
+   template<typename Op>
+   optional<operation_result> try_push( const Op& op )
+   {
+      try
+      {
+         return push( op );
+      }
+      catch( const fc::exception& )
+      {
+         ++failed;
+         return {};
+      }
+   }
+
+   account_id_type random_account() { return _accounts[ _rng() % _accounts.size() ]; }
+
+   /// The current feed price of the bitasset with the given index, in core asset per 10000 units of the bitasset
+   price feed_price( size_t index )const
+   {
+      return price( asset( 10000, _bitassets[index] ), asset( _feeds[index] ) );
+   }
+
+   void publish_feed( size_t index )
+   {
+      // random walk of up to 2% per publication
+      int64_t step = int64_t( _rng() % 401 ) - 200;
+      _feeds[index] = std::max<int64_t>( 1000, _feeds[index] + _feeds[index] * step / 10000 );
+
+      asset_publish_feed_operation publish;
+      publish.publisher = _nathan;
+      publish.asset_id = _bitassets[index];
+      publish.feed.settlement_price = feed_price( index );
+      publish.feed.core_exchange_rate = publish.feed.settlement_price;
+      publish.feed.maintenance_collateral_ratio = GRAPHENE_DEFAULT_MAINTENANCE_COLLATERAL_RATIO;
+      publish.feed.maximum_short_squeeze_ratio = GRAPHENE_DEFAULT_MAX_SHORT_SQUEEZE_RATIO;
+      try_push( publish );
+   }
+
+   void transfer()
+   {
+      transfer_operation op;
+      op.from = random_account();
+      op.to = random_account();
+      if( op.from == op.to )
+         op.to = _nathan;
+      op.amount = asset( 1 + _rng() % ( 100 * GRAPHENE_BLOCKCHAIN_PRECISION ) );
+      try_push( op );
+   }
+
+   void create_order()
+   {
+      const size_t index = _rng() % _bitassets.size();
+      const asset_id_type bitasset = _bitassets[index];
+      // prices within 10% of the feed, so that some of the orders match right away
+      const int64_t core_amount = _feeds[index] * int64_t( 900 + _rng() % 201 ) / 1000;
+      const int64_t units = 1 + _rng() % 100;
+
+      limit_order_create_operation op;
+      op.seller = random_account();
+      op.expiration = _db.head_block_time() + fc::days( 1 + _rng() % 30 );
+      if( _rng() % 2 )
+      {
+         op.amount_to_sell = asset( core_amount * units, asset_id_type() );
+         op.min_to_receive = asset( 10000 * units, bitasset );
+      }
+      else
+      {
+         op.amount_to_sell = asset( 10000 * units, bitasset );
+         op.min_to_receive = asset( core_amount * units, asset_id_type() );
+      }
+      auto result = try_push( op );
+      if( result.valid() )
+         _orders.push_back( result->get<object_id_type>() );
+   }
+
+   void cancel_order()
+   {
+      while( !_orders.empty() )
+      {
+         const size_t pos = _rng() % _orders.size();
+         const limit_order_id_type order = _orders[pos];
+         _orders[pos] = _orders.back();
+         _orders.pop_back();
+         const limit_order_object* obj = _db.find( order );
+         if( obj == nullptr ) // filled or expired
+            continue;
+         limit_order_cancel_operation op;
+         op.fee_paying_account = obj->seller;
+         op.order = order;
+         try_push( op );
+         return;
+      }
+   }
+
+   void borrow()
+   {
+      const size_t index = _rng() % _bitassets.size();
+      const int64_t units = 1 + _rng() % 100;
+      // between 1.8 and 2.5 times the value of the debt, i.e. close to the maintenance collateral ratio
+      const int64_t collateral = _feeds[index] * units * int64_t( 1800 + _rng() % 701 ) / 1000;
+
+      call_order_update_operation op;
+      op.funding_account = random_account();
+      op.delta_debt = asset( 10000 * units, _bitassets[index] );
+      op.delta_collateral = asset( collateral );
+      try_push( op );
+   }
+
+   database&                      _db;
+   std::mt19937_64                _rng;
+   fc::ecc::private_key           _key;
+   account_id_type                _nathan;
+   vector<account_id_type>        _accounts;
+   vector<asset_id_type>          _bitassets;
+   vector<int64_t>                _feeds;
+   vector<limit_order_id_type>    _orders;
+};
+
+/// Resets the peak resident set size of this process, if supported
+void reset_peak_rss()
+{
+#ifdef __linux__
+   std::ofstream clear_refs( "/proc/self/clear_refs" );
+   if( clear_refs )
+      clear_refs << "5";
+#endif
+}
+
+/// @return the peak resident set size of this process in kilobytes
+uint64_t peak_rss_kb()
+{
+#ifdef __linux__
+   std::ifstream status( "/proc/self/status" );
+   string line;
+   while( std::getline( status, line ) )
+   {
+      if( line.compare( 0, 6, "VmHWM:" ) == 0 )
+         return std::strtoull( line.c_str() + 6, nullptr, 10 );
+   }
+#endif
+#ifndef WIN32
+   struct rusage usage;
+   if( getrusage( RUSAGE_SELF, &usage ) == 0 )
+#ifdef __APPLE__
+      return usage.ru_maxrss / 1024;
+#else
+      return usage.ru_maxrss;
+#endif
+#endif
+   return 0;
+}
+
+double to_ms( const fc::microseconds& us ) { return double( us.count() ) / 1000; }
+
+/// Percentile of sorted per-block durations, in milliseconds
+double percentile_ms( const vector<int64_t>& sorted_us, uint32_t pct )
+{
+   if( sorted_us.empty() )
+      return 0;
+   return double( sorted_us[ ( sorted_us.size() - 1 ) * pct / 100 ] ) / 1000;
+}
+
+fc::mutable_variant_object replay( const fc::path& db_path, const genesis_state_type& genesis, bool revalidate,
+                                   bool state_hash )
+{
+   database db;
+   db.wipe( db_path, false );
+   if( state_hash )
+      db.enable_state_hash( true );
+
+   // The time between two applied_block notifications is attributed to the later block. A block which moved the
+   // next maintenance time has run the maintenance interval. Everything up to and including the first block, i.e.
+   // opening the object database and initializing the genesis state, is reported as the startup phase.
+   vector<int64_t> block_times;
+   vector<int64_t> maintenance_times;
+   uint64_t transactions = 0;
+   uint32_t blocks = 0;
+   fc::microseconds startup_time;
+   fc::time_point_sec next_maintenance;
+   const fc::time_point start = fc::time_point::now();
+   fc::time_point last = start;
+
+   db.applied_block.connect( [&]( const signed_block& b ) {
+      const fc::time_point now = fc::time_point::now();
+      const fc::time_point_sec maintenance = db.get_dynamic_global_properties().next_maintenance_time;
+      if( blocks == 0 )
+         startup_time = now - start;
+      else if( maintenance != next_maintenance )
+         maintenance_times.push_back( ( now - last ).count() );
+      else
+         block_times.push_back( ( now - last ).count() );
+      next_maintenance = maintenance;
+      transactions += b.transactions.size();
+      ++blocks;
+      last = now;
+   } );
+
+   uint32_t skip = revalidate ? database::skip_transaction_signatures
+                              : database::skip_witness_signature |
+                                database::skip_block_size_check |
+                                database::skip_merkle_check |
+                                database::skip_transaction_signatures |
+                                database::skip_transaction_dupe_check |
+                                database::skip_tapos_check |
+                                database::skip_witness_schedule_check;
+
+   reset_peak_rss();
+   const uint64_t allocations_before = allocation_count.load();
+   const uint64_t allocated_before = allocation_bytes.load();
+
+   graphene::chain::detail::with_skip_flags( db, skip, [&]() {
+      db.open( db_path, [&]() { return genesis; }, "TEST" );
+   } );
+   const fc::microseconds total = fc::time_point::now() - start;
+
+   const uint64_t allocations = allocation_count.load() - allocations_before;
+   const uint64_t allocated = allocation_bytes.load() - allocated_before;
+   const uint64_t rss = peak_rss_kb();
+
+   int64_t block_sum = 0;
+   for( auto t : block_times ) block_sum += t;
+   int64_t maintenance_sum = 0;
+   for( auto t : maintenance_times ) maintenance_sum += t;
+   std::sort( block_times.begin(), block_times.end() );
+   std::sort( maintenance_times.begin(), maintenance_times.end() );
+
+   fc::mutable_variant_object result;
+   result( "blocks", blocks )
+         ( "transactions", transactions )
+         ( "total_ms", to_ms( total ) )
+         ( "blocks_per_second", total.count() > 0 ? double( blocks ) * 1000000 / total.count() : 0 )
+         ( "transactions_per_second", total.count() > 0 ? double( transactions ) * 1000000 / total.count() : 0 )
+         ( "phases", fc::mutable_variant_object()
+               ( "startup_ms", to_ms( startup_time ) )
+               ( "regular_blocks_ms", double( block_sum ) / 1000 )
+               ( "maintenance_blocks_ms", double( maintenance_sum ) / 1000 ) )
+         ( "regular_block_ms", fc::mutable_variant_object()
+               ( "p50", percentile_ms( block_times, 50 ) )
+               ( "p99", percentile_ms( block_times, 99 ) )
+               ( "max", percentile_ms( block_times, 100 ) ) )
+         ( "maintenance_block_ms", fc::mutable_variant_object()
+               ( "count", maintenance_times.size() )
+               ( "p50", percentile_ms( maintenance_times, 50 ) )
+               ( "max", percentile_ms( maintenance_times, 100 ) ) )
+         ( "peak_rss_kb", rss )
+         ( "allocations", allocations )
+         ( "allocated_bytes", allocated );
+   if( state_hash )
+      result( "state_hash", db.get_state_hash() );
+   db.close();
+   return result;
+}
+
+} // anonymous namespace
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      workload_mix mix;
+      bpo::options_description cli_options("BitShares replay benchmark");
+      cli_options.add_options()
+            ("help,h", "Print this help message and exit.")
+            ("data-dir", bpo::value<boost::filesystem::path>()->default_value("replay_bench_data_dir"),
+             "Directory containing the generated chain")
+            ("regenerate", "Generate the chain even if the data directory already contains one")
+            ("num-blocks,n", bpo::value<uint32_t>()->default_value(10000), "Number of workload blocks to generate")
+            ("transactions-per-block", bpo::value<uint32_t>()->default_value(100),
+             "Number of transactions in each generated block")
+            ("accounts", bpo::value<uint32_t>()->default_value(1000), "Number of trading accounts")
+            ("bitassets", bpo::value<uint32_t>()->default_value(5), "Number of bitassets traded against the core asset")
+            ("maintenance-interval", bpo::value<uint32_t>()->default_value(600),
+             "Seconds between maintenance intervals of the generated chain")
+            ("seed", bpo::value<uint64_t>()->default_value(1), "Seed of the workload generator")
+            ("transfer-weight", bpo::value<uint32_t>(&mix.transfers)->default_value(mix.transfers),
+             "Relative frequency of transfers")
+            ("order-create-weight", bpo::value<uint32_t>(&mix.order_creates)->default_value(mix.order_creates),
+             "Relative frequency of limit order creations")
+            ("order-cancel-weight", bpo::value<uint32_t>(&mix.order_cancels)->default_value(mix.order_cancels),
+             "Relative frequency of limit order cancellations")
+            ("feed-weight", bpo::value<uint32_t>(&mix.feed_publishes)->default_value(mix.feed_publishes),
+             "Relative frequency of feed publications, which move feeds and trigger margin calls")
+            ("borrow-weight", bpo::value<uint32_t>(&mix.borrows)->default_value(mix.borrows),
+             "Relative frequency of debt position updates close to the maintenance collateral ratio")
+            ("runs", bpo::value<uint32_t>()->default_value(1), "Number of times to replay the chain")
+            ("revalidate", "Replay with full validation except signatures, like --revalidate-blockchain")
+            ("state-hash", "Report the state hash at the end of the replay, which must be equal for all runs")
+            ("output,o", bpo::value<boost::filesystem::path>(), "Also write the JSON report to this file")
+            ;
+
+      bpo::variables_map options;
+      try
+      {
+         boost::program_options::store( boost::program_options::parse_command_line(argc, argv, cli_options), options );
+         boost::program_options::notify( options );
+      }
+      catch (const boost::program_options::error& e)
+      {
+         std::cerr << "replay_bench:  error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count("help") )
+      {
+         std::cout << cli_options << "\n";
+         return 0;
+      }
+      FC_ASSERT( mix.total() > 0, "At least one operation type must have a non-zero weight" );
+
+      fc::path data_dir = options["data-dir"].as<boost::filesystem::path>();
+      if( data_dir.is_relative() )
+         data_dir = fc::current_path() / data_dir;
+      const fc::path db_path = data_dir / "db";
+      const fc::path genesis_path = data_dir / "genesis.json";
+
+      fc::mutable_variant_object report;
+      genesis_state_type genesis;
+      if( options.count("regenerate") || !fc::exists( genesis_path ) )
+      {
+         // the genesis time is fixed, so that the same options always produce the same chain
+         genesis = graphene::app::detail::create_example_genesis();
+         genesis.initial_timestamp = fc::time_point_sec( 1600000000 );
+         genesis.initial_parameters.maintenance_interval = options["maintenance-interval"].as<uint32_t>();
+         fc::remove_all( data_dir );
+         fc::create_directories( data_dir );
+         fc::json::save_to_file( genesis, genesis_path );
+
+         const uint32_t num_blocks = options["num-blocks"].as<uint32_t>();
+         const uint32_t trx_per_block = options["transactions-per-block"].as<uint32_t>();
+         std::cerr << "replay_bench:  Generating " << num_blocks << " blocks\n";
+
+         const fc::time_point start = fc::time_point::now();
+         database db;
+         db.open( db_path, [&]() { return genesis; }, "TEST" );
+         workload_generator generator( db, options["seed"].as<uint64_t>() );
+         generator.setup( options["accounts"].as<uint32_t>(), options["bitassets"].as<uint32_t>(), trx_per_block );
+         for( uint32_t i = 0; i < num_blocks; ++i )
+         {
+            generator.generate_workload_block( mix, trx_per_block );
+            if( ( i % 1000 ) == 0 )
+               std::cerr << "\rblock #" << i;
+         }
+         std::cerr << "\n";
+         report( "generate", fc::mutable_variant_object()
+                  ( "blocks", db.head_block_num() )
+                  ( "transactions", generator.pushed )
+                  ( "failed_transactions", generator.failed )
+                  ( "total_ms", to_ms( fc::time_point::now() - start ) ) );
+         db.close();
+      }
+      else
+         genesis = fc::json::from_file( genesis_path ).as<genesis_state_type>( 20 );
+
+      fc::variants runs;
+      const uint32_t num_runs = options["runs"].as<uint32_t>();
+      for( uint32_t i = 0; i < num_runs; ++i )
+      {
+         std::cerr << "replay_bench:  Replay " << ( i + 1 ) << " of " << num_runs << "\n";
+         runs.emplace_back( replay( db_path, genesis, options.count("revalidate") > 0,
+                                   options.count("state-hash") > 0 ) );
+      }
+      report( "replay", runs );
+
+      const string json = fc::json::to_pretty_string( report );
+      std::cout << json << "\n";
+      if( options.count("output") )
+      {
+         std::ofstream out( options["output"].as<boost::filesystem::path>().string() );
+         out << json << "\n";
+      }
+   }
+   catch ( const fc::exception& e )
+   {
+      std::cout << e.to_detail_string() << "\n";
+      return 1;
+   }
+   return 0;
+}
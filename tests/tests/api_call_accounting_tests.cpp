@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/api_call_accounting.hpp>
+
+#include <fc/variant_object.hpp>
+
+using namespace graphene::app;
+
+BOOST_AUTO_TEST_SUITE(api_call_accounting_tests)
+
+BOOST_AUTO_TEST_CASE(calls_are_accounted_per_method_and_connection)
+{
+   api_call_accounting accounting;
+   accounting.set_slow_call_threshold( fc::milliseconds(100) );
+   accounting.set_history_size( 2 );
+
+   const uint64_t conn = accounting.open_connection( "127.0.0.1:1234" );
+   accounting.set_connection_username( conn, "alice" );
+
+   accounting.record_call( conn, "database_api.get_objects", 100, 1000, fc::microseconds(1500), false );
+   accounting.record_call( conn, "database_api.get_objects", 50, 0, fc::milliseconds(150), true );
+   accounting.record_call( conn, "history_api.get_account_history", 10, 20, fc::milliseconds(200), false );
+   accounting.record_call( conn, "history_api.get_account_history", 10, 20, fc::milliseconds(300), false );
+
+   api_call_statistics stats = accounting.get_statistics();
+   BOOST_REQUIRE_EQUAL( stats.methods.size(), 2u );
+   const api_method_statistics& get_objects = stats.methods["database_api.get_objects"];
+   BOOST_CHECK_EQUAL( get_objects.latency.total_calls, 2u );
+   BOOST_CHECK_EQUAL( get_objects.latency.max_microseconds, 150000u );
+   BOOST_CHECK_EQUAL( get_objects.total_request_bytes, 150u );
+   BOOST_CHECK_EQUAL( get_objects.total_response_bytes, 1000u );
+   BOOST_CHECK_EQUAL( get_objects.failed_calls, 1u );
+   BOOST_REQUIRE_EQUAL( get_objects.latency.counts.size(), stats.latency_bucket_upper_bounds_us.size() + 1 );
+   BOOST_CHECK_EQUAL( get_objects.latency.counts[1], 1u ); // 1.5 ms is in the 2 ms bucket
+
+   BOOST_REQUIRE_EQUAL( stats.connections.size(), 1u );
+   BOOST_CHECK_EQUAL( stats.connections[0].username, "alice" );
+   BOOST_CHECK_EQUAL( stats.connections[0].calls, 4u );
+   BOOST_CHECK_EQUAL( stats.connections[0].failed_calls, 1u );
+   BOOST_CHECK_EQUAL( stats.connections[0].total_microseconds, 651500u );
+
+   // only the newest two slow calls are kept
+   auto slow = accounting.get_slow_calls();
+   BOOST_REQUIRE_EQUAL( slow.size(), 2u );
+   BOOST_CHECK_EQUAL( slow[0].microseconds, 300000u );
+   BOOST_CHECK_EQUAL( slow[1].microseconds, 200000u );
+   BOOST_CHECK_EQUAL( slow[0].remote_endpoint, "127.0.0.1:1234" );
+
+   accounting.close_connection( conn );
+   stats = accounting.get_statistics();
+   BOOST_CHECK( stats.connections.empty() );
+   BOOST_REQUIRE_EQUAL( stats.closed_connections.size(), 1u );
+   BOOST_CHECK_EQUAL( stats.closed_connections[0].calls, 4u );
+
+   accounting.reset();
+   BOOST_CHECK( accounting.get_statistics().methods.empty() );
+   BOOST_CHECK( accounting.get_slow_calls().empty() );
+}
+
+BOOST_AUTO_TEST_CASE(prometheus_metrics)
+{
+   api_call_accounting accounting;
+   const uint64_t conn = accounting.open_connection( "127.0.0.1:1234" );
+   accounting.record_call( conn, "database_api.get_objects", 100, 1000, fc::microseconds(1500), false );
+   accounting.record_call( conn, "database_api.get_objects", 100, 1000, fc::milliseconds(7), false );
+
+   const std::string metrics = accounting.get_prometheus_metrics();
+   const auto contains = [&metrics]( const std::string& line ) {
+      return metrics.find( line + "\n" ) != std::string::npos;
+   };
+   BOOST_CHECK( contains( "# TYPE graphene_api_call_duration_seconds histogram" ) );
+   BOOST_CHECK( contains( "graphene_api_call_duration_seconds_bucket{method=\"database_api.get_objects\",le=\"0.001000\"} 0" ) );
+   BOOST_CHECK( contains( "graphene_api_call_duration_seconds_bucket{method=\"database_api.get_objects\",le=\"0.002000\"} 1" ) );
+   BOOST_CHECK( contains( "graphene_api_call_duration_seconds_bucket{method=\"database_api.get_objects\",le=\"0.010000\"} 2" ) );
+   BOOST_CHECK( contains( "graphene_api_call_duration_seconds_bucket{method=\"database_api.get_objects\",le=\"+Inf\"} 2" ) );
+   BOOST_CHECK( contains( "graphene_api_call_duration_seconds_sum{method=\"database_api.get_objects\"} 0.008500" ) );
+   BOOST_CHECK( contains( "graphene_api_call_duration_seconds_count{method=\"database_api.get_objects\"} 2" ) );
+   BOOST_CHECK( contains( "graphene_api_call_response_bytes_total{method=\"database_api.get_objects\"} 2000" ) );
+   BOOST_CHECK( contains( "graphene_api_connections 1" ) );
+}
+
+BOOST_AUTO_TEST_CASE(json_size_estimate)
+{
+   BOOST_CHECK_EQUAL( api_call_accounting::estimate_json_size( fc::variant( std::string("abc") ) ), 5u );
+   fc::variants array = { fc::variant( std::string("a") ), fc::variant( true ) };
+   // ["a",true]
+   BOOST_CHECK_EQUAL( api_call_accounting::estimate_json_size( fc::variant( array ) ), 2u + 3 + 1 + 4 + 1 );
+   fc::mutable_variant_object obj;
+   obj( "key", std::string("v") );
+   // {"key":"v"}
+   BOOST_CHECK_EQUAL( api_call_accounting::estimate_json_size( fc::variant( obj ) ), 2u + 3 + 4 + 3 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
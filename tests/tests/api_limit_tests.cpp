@@ -551,4 +551,146 @@ BOOST_AUTO_TEST_CASE( api_limit_lookup_committee_member_accounts ) {
    }
 }
 
+BOOST_AUTO_TEST_CASE( api_limit_get_key_and_account_references_paged ) {
+   try {
+      ACTOR(alice);
+
+      graphene::app::application_options opt = app.get_options();
+      opt.has_api_helper_indexes_plugin = true;
+      graphene::app::database_api db_api( db, &opt );
+
+      const public_key_type shared_key = generate_private_key("shared_key").get_public_key();
+      vector<account_id_type> refs;
+      for( int i = 0; i < 5; ++i )
+      {
+         const account_object& acc = create_account( "ref" + std::to_string(i), shared_key );
+         db.modify( acc, [&]( account_object& a ) {
+            a.active = authority( 1, alice_id, 1 );
+         });
+         refs.push_back( acc.id );
+      }
+
+      // unpaged
+      auto key_refs = db_api.get_key_references( { shared_key } );
+      BOOST_REQUIRE_EQUAL( key_refs.size(), 1u );
+      BOOST_CHECK( vector<account_id_type>( key_refs[0].begin(), key_refs[0].end() ) == refs );
+      BOOST_CHECK( db_api.get_account_references( "alice" ) == refs );
+
+      // paged
+      vector<account_id_type> key_pages;
+      vector<account_id_type> account_pages;
+      optional<account_id_type> key_start;
+      optional<account_id_type> account_start;
+      for( int page = 0; page < 3; ++page )
+      {
+         auto key_page = db_api.get_key_references( { shared_key }, 2, key_start );
+         BOOST_REQUIRE_EQUAL( key_page.size(), 1u );
+         BOOST_CHECK_LE( key_page[0].size(), 2u );
+         key_pages.insert( key_pages.end(), key_page[0].begin(), key_page[0].end() );
+         if( !key_page[0].empty() )
+            key_start = account_id_type( key_page[0].rbegin()->instance.value + 1 );
+
+         auto account_page = db_api.get_account_references( "alice", 2, account_start );
+         BOOST_CHECK_LE( account_page.size(), 2u );
+         account_pages.insert( account_pages.end(), account_page.begin(), account_page.end() );
+         if( !account_page.empty() )
+            account_start = account_id_type( account_page.back().instance.value + 1 );
+      }
+      BOOST_CHECK( key_pages == refs );
+      BOOST_CHECK( account_pages == refs );
+      BOOST_CHECK( db_api.get_key_references( { shared_key }, 2, key_start )[0].empty() );
+      BOOST_CHECK( db_api.get_account_references( "alice", 2, account_start ).empty() );
+
+      // references are updated when an account drops the key and the account
+      db.modify( refs[2]( db ), [&]( account_object& a ) {
+         a.owner = authority( 1, alice_public_key, 1 );
+         a.active = authority( 1, alice_public_key, 1 );
+         a.options.memo_key = alice_public_key;
+      });
+      vector<account_id_type> expected = { refs[0], refs[1], refs[3], refs[4] };
+      key_refs = db_api.get_key_references( { shared_key } );
+      BOOST_CHECK( vector<account_id_type>( key_refs[0].begin(), key_refs[0].end() ) == expected );
+      BOOST_CHECK( db_api.get_account_references( "alice" ) == expected );
+      BOOST_CHECK( db_api.get_key_references( { alice_public_key } )[0].count( refs[2] ) == 1 );
+
+      // the limit can not exceed the configured value
+      GRAPHENE_CHECK_THROW( db_api.get_key_references( { shared_key }, 1001 ), fc::exception );
+      GRAPHENE_CHECK_THROW( db_api.get_account_references( "alice", 1001 ), fc::exception );
+
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( api_limit_get_full_accounts_batch ) {
+
+   try {
+      ACTORS( (alice)(bob)(carol) );
+
+      graphene::app::application_options opt = app.get_options();
+      opt.has_api_helper_indexes_plugin = true;
+      opt.api_limit_get_full_accounts_batch = 3;
+      opt.api_limit_get_full_accounts_lists = 2;
+      graphene::app::database_api db_api( db, &opt );
+
+      const asset_object& usd = create_user_issued_asset( "MYUSD", carol, 0 );
+      fund( alice );
+      fund( bob );
+      for( int i = 1; i <= 3; ++i )
+      {
+         create_sell_order( alice, asset(100 * i), usd.amount(10) );
+         create_sell_order( bob, asset(100 * i), usd.amount(20) );
+      }
+      generate_block();
+
+      vector<string> accounts = { "alice", "bob", "carol", "nosuchaccount" };
+
+      // Too many accounts
+      GRAPHENE_CHECK_THROW( db_api.get_full_accounts_batch( accounts, {} ), fc::exception );
+      // Unknown field
+      accounts.pop_back();
+      GRAPHENE_CHECK_THROW( db_api.get_full_accounts_batch( accounts, { "no_such_field" } ), fc::exception );
+
+      // Same content as get_full_accounts when all fields are requested
+      opt.api_limit_get_full_accounts = 3;
+      auto all = db_api.get_full_accounts_batch( accounts, {} );
+      auto expected = db_api.get_full_accounts( accounts, false );
+      BOOST_REQUIRE_EQUAL( all.size(), 3u );
+      for( const auto& name : accounts )
+      {
+         BOOST_CHECK( fc::json::to_string( fc::variant( all[name], GRAPHENE_MAX_NESTED_OBJECTS ) )
+                     == fc::json::to_string( fc::variant( expected[name], GRAPHENE_MAX_NESTED_OBJECTS ) ) );
+      }
+      BOOST_CHECK_EQUAL( all["alice"].limit_orders.size(), 2u );
+      BOOST_CHECK( all["alice"].more_data_available.limit_orders );
+      BOOST_CHECK_EQUAL( all["bob"].limit_orders.size(), 2u );
+      BOOST_CHECK( all["bob"].limit_orders.front().seller == bob_id );
+      BOOST_CHECK( all["carol"].limit_orders.empty() );
+      BOOST_CHECK( !all["carol"].more_data_available.limit_orders );
+      BOOST_REQUIRE_EQUAL( all["carol"].assets.size(), 1u );
+      BOOST_CHECK( all["carol"].assets.front() == usd.get_id() );
+
+      // Only the requested fields are filled
+      auto orders_only = db_api.get_full_accounts_batch( { "bob", "alice" }, { "limit_orders" } );
+      BOOST_REQUIRE_EQUAL( orders_only.size(), 2u );
+      BOOST_CHECK( orders_only["alice"].account.id == alice_id );
+      BOOST_CHECK_EQUAL( orders_only["alice"].limit_orders.size(), 2u );
+      BOOST_CHECK( orders_only["alice"].balances.empty() );
+      BOOST_CHECK( orders_only["alice"].registrar_name.empty() );
+      BOOST_CHECK( orders_only["bob"].limit_orders.front().seller == bob_id );
+
+      // The items of all lists together are limited as well
+      opt.api_limit_get_full_accounts_batch_items = 3;
+      auto limited = db_api.get_full_accounts_batch( { "alice", "bob" }, { "limit_orders" } );
+      BOOST_CHECK_EQUAL( limited["alice"].limit_orders.size(), 2u );
+      BOOST_CHECK_EQUAL( limited["bob"].limit_orders.size(), 1u );
+      BOOST_CHECK( limited["bob"].more_data_available.limit_orders );
+
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
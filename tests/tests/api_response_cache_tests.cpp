@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/api_response_cache.hpp>
+
+#include <string>
+
+using namespace graphene::app;
+
+BOOST_AUTO_TEST_SUITE(api_response_cache_tests)
+
+BOOST_AUTO_TEST_CASE(disabled_cache_stores_nothing)
+{
+   api_response_cache cache;
+   BOOST_CHECK( !cache.is_enabled() );
+   cache.insert( "a", std::string("value"), 10 );
+   BOOST_CHECK( !cache.find<std::string>( "a" ) );
+   BOOST_CHECK_EQUAL( cache.get_statistics().entries, 0u );
+}
+
+BOOST_AUTO_TEST_CASE(least_recently_used_entries_are_evicted)
+{
+   api_response_cache cache;
+   // keys are counted in, so every entry below takes 101 bytes
+   cache.set_capacity( 303 );
+
+   cache.insert( "a", std::string("A"), 100 );
+   cache.insert( "b", std::string("B"), 100 );
+   cache.insert( "c", std::string("C"), 100 );
+   BOOST_CHECK_EQUAL( cache.get_statistics().entries, 3u );
+
+   // touch "a" so that "b" is the least recently used entry
+   auto a = cache.find<std::string>( "a" );
+   BOOST_REQUIRE( a );
+   BOOST_CHECK_EQUAL( *a, "A" );
+
+   cache.insert( "d", std::string("D"), 100 );
+   BOOST_CHECK( !cache.find<std::string>( "b" ) );
+   BOOST_CHECK( cache.find<std::string>( "a" ) );
+   BOOST_CHECK( cache.find<std::string>( "c" ) );
+   BOOST_CHECK( cache.find<std::string>( "d" ) );
+
+   // an entry larger than the cache is not stored and does not flush it
+   cache.insert( "e", std::string("E"), 1000 );
+   BOOST_CHECK( !cache.find<std::string>( "e" ) );
+   BOOST_CHECK_EQUAL( cache.get_statistics().entries, 3u );
+
+   cache.erase( "a" );
+   BOOST_CHECK( !cache.find<std::string>( "a" ) );
+
+   const api_response_cache_statistics stats = cache.get_statistics();
+   BOOST_CHECK_EQUAL( stats.entries, 2u );
+   BOOST_CHECK_EQUAL( stats.used_bytes, 202u );
+   BOOST_CHECK_EQUAL( stats.insertions, 4u );
+   BOOST_CHECK_EQUAL( stats.evictions, 1u );
+   BOOST_CHECK_EQUAL( stats.hits, 4u );
+   BOOST_CHECK_EQUAL( stats.misses, 3u );
+
+   // shrinking the cache evicts the least recently used entries
+   cache.set_capacity( 101 );
+   BOOST_CHECK( !cache.find<std::string>( "c" ) );
+   BOOST_CHECK( cache.find<std::string>( "d" ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/app/api_worker_pool.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <atomic>
+#include <vector>
+
+using namespace graphene::app;
+
+BOOST_AUTO_TEST_SUITE(api_worker_pool_tests)
+
+BOOST_AUTO_TEST_CASE(disabled_pool_runs_inline)
+{
+   api_worker_pool pool;
+   BOOST_CHECK( !pool.is_enabled() );
+   const fc::thread* caller = &fc::thread::current();
+   const fc::thread* executor = nullptr;
+   int result = pool.run_read_only( "database_api", "test", [&]() {
+      executor = &fc::thread::current();
+      return 42;
+   } );
+   BOOST_CHECK_EQUAL( result, 42 );
+   BOOST_CHECK( executor == caller );
+   BOOST_CHECK( pool.get_statistics().methods.empty() );
+
+   // write guards are no-ops while the pool is disabled
+   api_worker_pool::write_guard guard( pool );
+}
+
+BOOST_AUTO_TEST_CASE(calls_run_on_workers_within_limits)
+{
+   api_worker_pool pool;
+   pool.start( 3, 0, { { "history_api", 1 } } );
+   BOOST_REQUIRE( pool.is_enabled() );
+
+   std::atomic<uint32_t> running_history_calls( 0 );
+   std::atomic<uint32_t> max_running_history_calls( 0 );
+   std::atomic<bool> ran_on_caller_thread( false );
+   const fc::thread* caller = &fc::thread::current();
+
+   std::vector< fc::future<int> > calls;
+   for( int i = 0; i < 6; ++i )
+   {
+      calls.push_back( fc::async( [&,caller,i]() {
+         return pool.run_read_only( "history_api", "get_account_history", [&]() {
+            if( &fc::thread::current() == caller )
+               ran_on_caller_thread = true;
+            uint32_t now_running = ++running_history_calls;
+            uint32_t max_running = max_running_history_calls;
+            while( now_running > max_running
+                   && !max_running_history_calls.compare_exchange_weak( max_running, now_running ) ) {}
+            fc::usleep( fc::milliseconds(5) );
+            --running_history_calls;
+            return i;
+         } );
+      } ) );
+   }
+   for( int i = 0; i < 6; ++i )
+      BOOST_CHECK_EQUAL( calls[i].wait(), i );
+
+   BOOST_CHECK( !ran_on_caller_thread );
+   BOOST_CHECK_EQUAL( max_running_history_calls.load(), 1u );
+
+   // exceptions are passed to the caller
+   BOOST_CHECK_THROW( pool.run_read_only( "database_api", "list_assets", []() -> int {
+      FC_THROW( "failure" );
+   } ), fc::exception );
+
+   const api_worker_pool_statistics stats = pool.get_statistics();
+   BOOST_CHECK_EQUAL( stats.worker_threads, 3u );
+   BOOST_CHECK_EQUAL( stats.apis.at("history_api").limit, 1u );
+   BOOST_CHECK_EQUAL( stats.apis.at("history_api").running, 0u );
+   BOOST_CHECK_EQUAL( stats.apis.at("database_api").limit, 3u );
+   const api_latency_histogram& histogram = stats.methods.at("history_api.get_account_history");
+   BOOST_CHECK_EQUAL( histogram.total_calls, 6u );
+   BOOST_CHECK_EQUAL( histogram.counts.size(), stats.latency_bucket_upper_bounds_us.size() + 1 );
+   BOOST_CHECK_GE( histogram.max_microseconds, 5000u );
+   BOOST_CHECK_EQUAL( stats.methods.at("database_api.list_assets").total_calls, 1u );
+
+   {
+      // the main thread can take the write lock again while it holds it
+      api_worker_pool::write_guard guard( pool );
+      api_worker_pool::write_guard nested_guard( pool );
+   }
+   BOOST_CHECK_EQUAL( pool.run_read_only( "database_api", "get_top_voters", []() { return 7; } ), 7 );
+
+   pool.stop();
+   BOOST_CHECK( !pool.is_enabled() );
+}
+
+BOOST_AUTO_TEST_CASE(write_guard_does_not_block_the_thread)
+{
+   api_worker_pool pool;
+   pool.start( 1, 0 );
+
+   std::atomic<bool> read_started( false );
+   fc::future<int> read = fc::async( [&]() {
+      return pool.run_read_only( "database_api", "get_objects", [&]() {
+         read_started = true;
+         fc::usleep( fc::milliseconds(100) );
+         return 1;
+      } );
+   } );
+   while( !read_started )
+      fc::usleep( fc::milliseconds(1) );
+
+   bool write_done = false;
+   fc::future<void> write = fc::async( [&]() {
+      api_worker_pool::write_guard guard( pool );
+      write_done = true;
+   } );
+   // the writer waits for the call in flight, while other tasks of this thread keep running
+   fc::usleep( fc::milliseconds(20) );
+   BOOST_CHECK( !write_done );
+   write.wait();
+   BOOST_CHECK( write_done );
+   BOOST_CHECK_EQUAL( read.wait(), 1 );
+
+   pool.stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
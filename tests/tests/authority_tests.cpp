@@ -2399,4 +2399,99 @@ BOOST_AUTO_TEST_CASE( self_deleting_proposal )
    db.get<proposal_object>(pid1);
 } FC_LOG_AND_RETHROW() }
 
+
+BOOST_AUTO_TEST_CASE( memoized_authority_checks )
+{ try {
+   ACTORS( (alice)(bob)(carol) );
+   fund( alice );
+
+   auto set_alice_active = [&]( account_id_type controller, const fc::ecc::private_key& key ) {
+      signed_transaction tx;
+      account_update_operation op;
+      op.account = alice_id;
+      op.active = authority( 1, controller, 1 );
+      db.current_fee_schedule().set_fee( op );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      sign( tx, key );
+      PUSH_TX( db, tx );
+   };
+   auto transfer_from_alice = [&]( int64_t amount, const fc::ecc::private_key& key ) {
+      signed_transaction tx;
+      transfer_operation op;
+      op.from = alice_id;
+      op.to = carol_id;
+      op.amount = asset( amount );
+      db.current_fee_schedule().set_fee( op );
+      tx.operations.push_back( op );
+      set_expiration( db, tx );
+      sign( tx, key );
+      PUSH_TX( db, tx );
+   };
+
+   // bob controls alice
+   set_alice_active( bob_id, alice_private_key );
+   generate_block();
+   BOOST_CHECK_EQUAL( db.authority_checks().get_statistics().entries, 0u );
+
+   // the second transaction signed by bob on behalf of alice is served from the cache, which also has to mark
+   // bob's signature as used, otherwise it would be rejected as irrelevant
+   auto before = db.authority_checks().get_statistics();
+   transfer_from_alice( 1, bob_private_key );
+   transfer_from_alice( 2, bob_private_key );
+   auto after = db.authority_checks().get_statistics();
+   BOOST_CHECK_EQUAL( after.misses - before.misses, 1u );
+   BOOST_CHECK_EQUAL( after.hits - before.hits, 1u );
+
+   // bob hands control over to carol, the cached result for bob's signature must not be used any more
+   set_alice_active( carol_id, bob_private_key );
+   BOOST_CHECK_GT( db.authority_checks().get_statistics().invalidations, after.invalidations );
+   GRAPHENE_REQUIRE_THROW( transfer_from_alice( 3, bob_private_key ), tx_missing_active_auth );
+   transfer_from_alice( 4, carol_private_key );
+
+   generate_block();
+   BOOST_CHECK_EQUAL( db.authority_checks().get_statistics().entries, 0u );
+   BOOST_CHECK_EQUAL( get_balance( carol_id, asset_id_type() ), 7 );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( memoized_authority_checks_with_shared_key )
+{ try {
+   ACTORS( (alice)(carol) );
+   // bob uses the key of alice
+   const account_id_type bob_id = create_account( "bob", alice_public_key ).id;
+   fund( alice );
+   fund( bob_id(db) );
+   generate_block();
+
+   auto make_transfer = [&]( account_id_type from ) {
+      transfer_operation op;
+      op.from = from;
+      op.to = carol_id;
+      op.amount = asset( 1 );
+      db.current_fee_schedule().set_fee( op );
+      return op;
+   };
+
+   // the check of bob finds the shared key marked already by the check of alice, but its cache entry has to
+   // record the key nevertheless
+   signed_transaction tx;
+   tx.operations.push_back( make_transfer( alice_id ) );
+   tx.operations.push_back( make_transfer( bob_id ) );
+   set_expiration( db, tx );
+   sign( tx, alice_private_key );
+   PUSH_TX( db, tx );
+
+   // a hit on the entry of bob marks the shared key as used, so the signature is not rejected as irrelevant
+   auto before = db.authority_checks().get_statistics();
+   signed_transaction bob_tx;
+   bob_tx.operations.push_back( make_transfer( bob_id ) );
+   set_expiration( db, bob_tx );
+   sign( bob_tx, alice_private_key );
+   PUSH_TX( db, bob_tx );
+   BOOST_CHECK_EQUAL( db.authority_checks().get_statistics().hits - before.hits, 1u );
+
+   generate_block();
+   BOOST_CHECK_EQUAL( get_balance( carol_id, asset_id_type() ), 3 );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
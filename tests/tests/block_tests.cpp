@@ -1942,4 +1942,291 @@ BOOST_FIXTURE_TEST_CASE( block_size_test, database_fixture )
    }
 }
 
+
+BOOST_FIXTURE_TEST_CASE( mempool_admission_control, database_fixture )
+{
+   try
+   {
+      ACTORS( (alice)(bob) );
+      fund( alice, asset(1000000) );
+      fund( bob, asset(1000000) );
+      const asset_id_type usd_id = create_user_issued_asset( "USDBIT" ).id;
+      const limit_order_id_type order_id = create_sell_order( alice, asset(1000), asset(1000, usd_id) )->id;
+      generate_block();
+
+      transaction_admission_parameters params;
+      params.max_pending_transactions = 2;
+      params.priority_lane_reserved = 1;
+      db.admission_controller().set_parameters( params );
+
+      auto make_transfer = [&]( account_id_type from, const fc::ecc::private_key& key, share_type fee )
+      {
+         signed_transaction tx;
+         transfer_operation op;
+         op.from = from;
+         op.to = account_id_type();
+         op.amount = asset(1);
+         op.fee = asset(fee);
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         sign( tx, key );
+         return tx;
+      };
+
+      // the normal lane has room for a single transaction
+      PUSH_TX( db, make_transfer( alice_id, alice_private_key, 10 ) );
+      GRAPHENE_REQUIRE_THROW( PUSH_TX( db, make_transfer( bob_id, bob_private_key, 5 ) ), mempool_full );
+
+      // a transaction paying a higher fee per byte evicts the cheapest one, which is only skipped by the next
+      // rebuild of the pending state
+      const signed_transaction cheap_tx = make_transfer( alice_id, alice_private_key, 10 );
+      BOOST_CHECK( db.is_known_transaction( cheap_tx.id() ) );
+      PUSH_TX( db, make_transfer( bob_id, bob_private_key, 100 ) );
+      BOOST_CHECK( db.is_known_transaction( cheap_tx.id() ) );
+
+      // the reserved slot can still be used by an order cancellation
+      limit_order_cancel_operation cancel;
+      cancel.order = order_id;
+      cancel.fee_paying_account = alice_id;
+      signed_transaction cancel_tx;
+      cancel_tx.operations.push_back( cancel );
+      set_expiration( db, cancel_tx );
+      sign( cancel_tx, alice_private_key );
+      PUSH_TX( db, cancel_tx );
+
+      transaction_admission_statistics stats = db.admission_controller().get_statistics();
+      BOOST_CHECK_EQUAL( stats.pending_priority, 1u );
+      BOOST_CHECK_EQUAL( stats.pending_normal, 1u );
+      BOOST_CHECK_EQUAL( stats.accepted, 3u );
+      BOOST_CHECK_EQUAL( stats.evicted, 1u );
+      BOOST_CHECK_EQUAL( stats.rejected_mempool_full, 1u );
+
+      // the priority lane goes first and the evicted transaction is not included
+      signed_block b = generate_block();
+      BOOST_REQUIRE_EQUAL( b.transactions.size(), 2u );
+      BOOST_CHECK( b.transactions[0].operations[0].is_type<limit_order_cancel_operation>() );
+      BOOST_CHECK( b.transactions[1].operations[0].get<transfer_operation>().from == bob_id );
+      BOOST_CHECK( db.find( order_id ) == nullptr );
+      BOOST_CHECK( !db.is_known_transaction( cheap_tx.id() ) );
+
+      // per-account rate limit
+      params = transaction_admission_parameters();
+      params.account_trx_per_second = 1;
+      params.account_trx_burst = 1;
+      db.admission_controller().set_parameters( params );
+
+      // an invalid transaction naming bob as fee payer does not use up the rate of bob
+      signed_transaction forged_tx = make_transfer( bob_id, alice_private_key, 3 );
+      GRAPHENE_REQUIRE_THROW( PUSH_TX( db, forged_tx ), fc::exception );
+      PUSH_TX( db, make_transfer( bob_id, bob_private_key, 4 ) );
+
+      PUSH_TX( db, make_transfer( alice_id, alice_private_key, 1 ) );
+      GRAPHENE_REQUIRE_THROW( PUSH_TX( db, make_transfer( alice_id, alice_private_key, 2 ) ),
+                              transaction_rate_limited );
+      BOOST_CHECK_EQUAL( db.admission_controller().get_statistics().rejected_rate_limited, 1u );
+
+      // the bucket of alice refills after a second, and checking the rate does not take the token
+      transaction_admission_controller& admission = db.admission_controller();
+      const signed_transaction next_tx = make_transfer( alice_id, alice_private_key, 5 );
+      const fc::time_point now = fc::time_point::now();
+      GRAPHENE_REQUIRE_THROW( admission.check_rate( next_tx, now ), transaction_rate_limited );
+      admission.check_rate( next_tx, now + fc::seconds(1) );
+      admission.check_rate( next_tx, now + fc::seconds(1) );
+      admission.charge_rate( next_tx, now + fc::seconds(1) );
+      GRAPHENE_REQUIRE_THROW( admission.check_rate( next_tx, now + fc::seconds(1) ), transaction_rate_limited );
+      admission.check_rate( next_tx, now + fc::seconds(2) );
+      BOOST_CHECK_EQUAL( admission.get_statistics().rejected_rate_limited, 3u );
+   }
+   catch( fc::exception& e )
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+
+BOOST_FIXTURE_TEST_CASE( recent_transaction_cache, database_fixture )
+{
+   try
+   {
+      ACTORS( (alice) );
+      fund( alice, asset(1000000) );
+      generate_block();
+
+      db.recent_transactions().set_capacity( 1 );
+
+      auto make_transfer = [&]( share_type amount )
+      {
+         signed_transaction tx;
+         transfer_operation op;
+         op.from = alice_id;
+         op.to = account_id_type();
+         op.amount = asset(amount);
+         tx.operations.push_back( op );
+         db.current_fee_schedule().set_fee( tx.operations.back() );
+         set_expiration( db, tx );
+         sign( tx, alice_private_key );
+         return tx;
+      };
+
+      const signed_transaction tx1 = make_transfer( 1 );
+      const signed_transaction tx2 = make_transfer( 2 );
+      PUSH_TX( db, tx1 );
+      BOOST_REQUIRE( db.find_recent_transaction( tx1.id() ) != nullptr );
+      BOOST_CHECK( db.get_recent_transaction( tx1.id() ).id() == tx1.id() );
+
+      // the body of the first transaction is dropped, but it is still known as a duplicate
+      PUSH_TX( db, tx2 );
+      BOOST_CHECK( db.find_recent_transaction( tx1.id() ) == nullptr );
+      BOOST_CHECK_THROW( db.get_recent_transaction( tx1.id() ), fc::key_not_found_exception );
+      BOOST_CHECK( db.is_known_transaction( tx1.id() ) );
+      GRAPHENE_REQUIRE_THROW( PUSH_TX( db, tx1 ), duplicate_transaction );
+      BOOST_CHECK( db.find_recent_transaction( tx2.id() ) != nullptr );
+
+      // subscribers are told about the accounts affected by the transactions of the block
+      bool transaction_history_notified = false;
+      flat_set<account_id_type> notified_accounts;
+      auto connection = db.new_objects.connect( [&]( const vector<object_id_type>& ids,
+                                                     const flat_set<account_id_type>& accounts ) {
+         for( const auto& id : ids )
+            transaction_history_notified = transaction_history_notified || id.is<transaction_history_object>();
+         notified_accounts.insert( accounts.begin(), accounts.end() );
+      } );
+      generate_block();
+      connection.disconnect();
+      BOOST_CHECK( transaction_history_notified );
+      BOOST_CHECK( notified_accounts.count( alice_id ) == 1 );
+      BOOST_CHECK( notified_accounts.count( account_id_type() ) == 1 );
+      BOOST_CHECK( db.find_recent_transaction( tx2.id() ) != nullptr );
+
+      // an undone transaction is not reported even if its body is still cached
+      db.pop_block();
+      db.clear_pending();
+      BOOST_CHECK( !db.is_known_transaction( tx2.id() ) );
+      BOOST_CHECK( db.find_recent_transaction( tx2.id() ) == nullptr );
+   }
+   catch( fc::exception& e )
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( block_candidate_assembly, database_fixture )
+{
+   try
+   {
+      // the accumulated merkle root is the same as the one of the whole block, for full and partial trees
+      merkle_accumulator accumulator;
+      vector<processed_transaction> transactions;
+      for( uint16_t i = 0; i <= 17; ++i )
+      {
+         signed_block blk;
+         blk.transactions = transactions;
+         BOOST_CHECK( accumulator.root() == blk.calculate_merkle_root() );
+         processed_transaction trx;
+         trx.ref_block_num = i;
+         accumulator.append( trx.merkle_digest() );
+         transactions.push_back( trx );
+      }
+
+      // a full candidate is outranked by a transaction of a better lane or a higher fee density
+      block_candidate candidate;
+      processed_transaction small_trx;
+      candidate.reset( block_id_type(), fc::raw::pack_size( small_trx ) * 2, 0 );
+      candidate.append( small_trx, transaction_lane::normal, 100 );
+      candidate.append( small_trx, transaction_lane::normal, 50 );
+      BOOST_CHECK( !candidate.is_full() );
+      candidate.append( small_trx, transaction_lane::normal, 200 );
+      BOOST_CHECK( candidate.is_full() );
+      BOOST_CHECK_EQUAL( candidate.size(), 2u );
+      BOOST_CHECK( candidate.is_outranked_by( transaction_lane::normal, 51 ) );
+      BOOST_CHECK( !candidate.is_outranked_by( transaction_lane::normal, 50 ) );
+      BOOST_CHECK( candidate.is_outranked_by( transaction_lane::priority, 0 ) );
+
+      ACTORS( (alice)(bob) );
+      fund( alice, asset(1000000) );
+      generate_block();
+
+      db.enable_block_candidate( true );
+      transfer( alice_id, bob_id, asset(100) );
+      transfer( alice_id, bob_id, asset(200) );
+      signed_block block = generate_block();
+      BOOST_CHECK( db.get_last_block_production_info().from_candidate );
+      BOOST_CHECK_EQUAL( db.get_last_block_production_info().transactions, 2u );
+      BOOST_REQUIRE_EQUAL( block.transactions.size(), 2u );
+      BOOST_CHECK( block.transaction_merkle_root == block.calculate_merkle_root() );
+      BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 300 );
+
+      // evicting a transaction drops the candidate, which may contain it, and block assembly leaves it out
+      transaction_admission_parameters params;
+      params.max_pending_transactions = 1;
+      db.admission_controller().set_parameters( params );
+      auto make_transfer = [&]( share_type amount, share_type fee )
+      {
+         signed_transaction tx;
+         transfer_operation op;
+         op.from = alice_id;
+         op.to = bob_id;
+         op.amount = asset(amount);
+         op.fee = asset(fee);
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         sign( tx, alice_private_key );
+         return tx;
+      };
+      PUSH_TX( db, make_transfer( 100, 1 ) );
+      PUSH_TX( db, make_transfer( 200, 2 ) );
+      block = generate_block();
+      BOOST_CHECK( !db.get_last_block_production_info().from_candidate );
+      BOOST_REQUIRE_EQUAL( block.transactions.size(), 1u );
+      BOOST_CHECK( block.transaction_merkle_root == block.calculate_merkle_root() );
+      BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 500 );
+
+      db.admission_controller().set_parameters( transaction_admission_parameters() );
+      db.enable_block_candidate( false );
+      transfer( alice_id, bob_id, asset(100) );
+      block = generate_block();
+      BOOST_CHECK( !db.get_last_block_production_info().from_candidate );
+      BOOST_CHECK_EQUAL( block.transactions.size(), 1u );
+   }
+   catch( fc::exception& e )
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( block_assembly_time_budget, database_fixture )
+{
+   try
+   {
+      ACTORS( (alice)(bob) );
+      fund( alice, asset(1000000) );
+      generate_block();
+
+      // transactions which do not make it into the block because of the time budget stay pending
+      db.set_block_assembly_time_budget( fc::microseconds(1) );
+      for( int i = 1; i <= 5; ++i )
+         transfer( alice_id, bob_id, asset(i) );
+      signed_block block = db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1),
+                                              init_account_priv_key, ~0 );
+      const auto& info = db.get_last_block_production_info();
+      BOOST_CHECK( !info.from_candidate );
+      BOOST_CHECK_EQUAL( block.transactions.size() + info.deferred_transactions, 5u );
+      const uint32_t deferred = info.deferred_transactions;
+
+      db.set_block_assembly_time_budget( fc::microseconds() );
+      block = generate_block();
+      BOOST_CHECK_EQUAL( db.get_last_block_production_info().deferred_transactions, 0u );
+      BOOST_CHECK_EQUAL( block.transactions.size(), deferred );
+      BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 15 );
+   }
+   catch( fc::exception& e )
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -6230,4 +6230,60 @@ BOOST_AUTO_TEST_CASE(custom_auths) { try {
       FC_LOG_AND_RETHROW()
    }
 
+
+BOOST_AUTO_TEST_CASE(shared_predicate_cache) { try {
+   ACTORS((alice)(bob)(carol));
+
+   const auto transfer_tag = operation::tag<transfer_operation>::value;
+   flat_map<uint16_t, restriction> to_dan;
+   to_dan[0] = restriction(2, restriction::func_eq, account_id_type(12));
+   flat_map<uint16_t, restriction> to_dan_with_other_id;
+   to_dan_with_other_id[7] = to_dan[0];
+   flat_map<uint16_t, restriction> to_edy;
+   to_edy[0] = restriction(2, restriction::func_eq, account_id_type(13));
+
+   auto create_auth = [this, transfer_tag](account_id_type account, const flat_map<uint16_t, restriction>& rs)
+         -> custom_authority_id_type {
+      return db.create<custom_authority_object>([&](custom_authority_object& obj) {
+         obj.account = account;
+         obj.enabled = true;
+         obj.valid_from = db.head_block_time();
+         obj.valid_to = db.head_block_time() + fc::days(1);
+         obj.operation_type = transfer_tag;
+         obj.auth = authority(1, account, 1);
+         obj.restrictions = rs;
+      }).id;
+   };
+   create_auth(alice_id, to_dan);
+   create_auth(bob_id, to_dan_with_other_id);
+   const auto carol_auth = create_auth(carol_id, to_edy);
+
+   const auto before = db.custom_authority_predicates().get_statistics();
+
+   transfer_operation op;
+   op.to = account_id_type(12);
+   op.from = alice_id;
+   BOOST_CHECK_EQUAL(db.get_viable_custom_authorities(alice_id, op).size(), 1u);
+   op.from = bob_id;
+   BOOST_CHECK_EQUAL(db.get_viable_custom_authorities(bob_id, op).size(), 1u);
+   op.from = carol_id;
+   rejected_predicate_map rejects;
+   BOOST_CHECK_EQUAL(db.get_viable_custom_authorities(carol_id, op, &rejects).size(), 0u);
+   BOOST_CHECK_EQUAL(rejects.size(), 1u);
+   BOOST_CHECK(rejects.begin()->first == carol_auth);
+
+   // alice and bob share a predicate, the restriction ids do not matter
+   auto stats = db.custom_authority_predicates().get_statistics();
+   BOOST_CHECK_EQUAL(stats.misses - before.misses, 2u);
+   BOOST_CHECK_EQUAL(stats.hits - before.hits, 1u);
+
+   // a dropped object cache is refilled from the shared cache
+   db.modify(carol_auth(db), [](custom_authority_object& obj) { obj.clear_predicate_cache(); });
+   op.to = account_id_type(13);
+   BOOST_CHECK_EQUAL(db.get_viable_custom_authorities(carol_id, op).size(), 1u);
+   stats = db.custom_authority_predicates().get_statistics();
+   BOOST_CHECK_EQUAL(stats.misses - before.misses, 2u);
+   BOOST_CHECK_EQUAL(stats.hits - before.hits, 2u);
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
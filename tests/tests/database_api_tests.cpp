@@ -24,14 +24,18 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <graphene/app/api_worker_pool.hpp>
 #include <graphene/app/database_api.hpp>
 #include <graphene/chain/hardfork.hpp>
 
+#include <fc/crypto/base64.hpp>
 #include <fc/crypto/digest.hpp>
 #include <fc/crypto/hex.hpp>
+#include <fc/io/json.hpp>
 
 #include "../common/database_fixture.hpp"
 
+#include <atomic>
 #include <random>
 
 using namespace graphene::chain;
@@ -1909,4 +1913,280 @@ BOOST_AUTO_TEST_CASE( get_trade_history )
 } FC_LOG_AND_RETHROW() }
 
 
+BOOST_AUTO_TEST_CASE( get_operation_fees )
+{ try {
+   ACTORS((bob)(alice));
+   const auto& usd = create_user_issued_asset("USD");
+   generate_block();
+
+   graphene::app::database_api db_api( db, &( app.get_options() ));
+
+   transfer_operation top;
+   top.from = bob_id;
+   top.to = alice_id;
+   top.amount = asset( 100 );
+   limit_order_create_operation lop;
+   lop.seller = bob_id;
+   lop.amount_to_sell = asset( 100 );
+   lop.min_to_receive = usd.amount( 100 );
+
+   vector<operation> ops;
+   ops.push_back( top );
+   top.fee = usd.amount( 0 );
+   ops.push_back( top );
+   ops.push_back( lop );
+
+   vector<asset> fees = db_api.get_operation_fees( ops );
+   BOOST_REQUIRE_EQUAL( fees.size(), 3u );
+
+   // each fee is in the asset of the fee field and matches get_required_fees
+   vector<fc::variant> core_fees = db_api.get_required_fees( { ops[0], ops[2] }, "1.3.0" );
+   vector<fc::variant> usd_fees = db_api.get_required_fees( { ops[1] }, "USD" );
+   BOOST_CHECK( fees[0] == core_fees[0].as<asset>( 2 ) );
+   BOOST_CHECK( fees[1] == usd_fees[0].as<asset>( 2 ) );
+   BOOST_CHECK( fees[2] == core_fees[1].as<asset>( 2 ) );
+   BOOST_CHECK( fees[0].asset_id == asset_id_type() );
+   BOOST_CHECK( fees[1].asset_id == usd.id );
+
+   // a fee asset which does not exist is rejected
+   top.fee = asset( 0, asset_id_type( 100 ) );
+   GRAPHENE_REQUIRE_THROW( db_api.get_operation_fees( { top } ), fc::exception );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( scan_objects ) {
+
+   try {
+      ACTORS((alice)(bob)(carol)(feedproducer));
+
+      graphene::app::database_api db_api(db, &(this->app.get_options()));
+
+      const auto &usd = create_bitasset("USD", feedproducer_id);
+      const auto &core = asset_id_type()(db);
+      update_feed_producers(usd, {feedproducer.id});
+      price_feed current_feed;
+      current_feed.maintenance_collateral_ratio = 1750;
+      current_feed.maximum_short_squeeze_ratio = 1100;
+      current_feed.settlement_price = usd.amount(1) / core.amount(5);
+      publish_feed(usd, feedproducer, current_feed);
+
+      transfer(committee_account, alice_id, asset(1000000));
+      transfer(committee_account, bob_id, asset(1000000));
+      transfer(committee_account, carol_id, asset(1000000));
+      borrow(alice, usd.amount(1000), asset(15000));
+      borrow(bob, usd.amount(1000), asset(25000));
+      borrow(carol, usd.amount(1000), asset(20000));
+
+      // All accounts by name, in pages of 4
+      vector<string> names;
+      optional<string> cursor;
+      do
+      {
+         graphene::app::scan_page page = db_api.scan_objects( "accounts", {}, cursor, 4 );
+         BOOST_CHECK_LE( page.objects.size(), 4u );
+         BOOST_CHECK_EQUAL( page.head_block_num, db.head_block_num() );
+         for( const auto& v : page.objects )
+            names.push_back( v.as<account_object>( GRAPHENE_MAX_NESTED_OBJECTS ).name );
+         cursor = page.next_cursor;
+      } while( cursor.valid() );
+      vector<string> expected_names;
+      for( const auto& a : db.get_index_type<account_index>().indices().get<by_name>() )
+         expected_names.push_back( a.name );
+      BOOST_CHECK( names == expected_names );
+
+      // Call orders of USD, one per page, in the order of get_call_orders
+      vector<call_order_id_type> calls;
+      cursor.reset();
+      do
+      {
+         graphene::app::scan_page page = db_api.scan_objects( "call_orders", { "USD" }, cursor, 1 );
+         for( const auto& v : page.objects )
+            calls.push_back( v.as<call_order_object>( GRAPHENE_MAX_NESTED_OBJECTS ).id );
+         cursor = page.next_cursor;
+      } while( cursor.valid() );
+      vector<call_order_id_type> expected_calls;
+      for( const auto& c : db_api.get_call_orders( "USD", 100 ) )
+         expected_calls.push_back( c.id );
+      BOOST_CHECK_EQUAL( calls.size(), 3u );
+      BOOST_CHECK( calls == expected_calls );
+
+      // A cursor can only continue the scan it was returned by
+      graphene::app::scan_page page = db_api.scan_objects( "assets", {}, optional<string>(), 1 );
+      BOOST_REQUIRE( page.next_cursor.valid() );
+      GRAPHENE_CHECK_THROW( db_api.scan_objects( "accounts", {}, page.next_cursor, 1 ), fc::exception );
+      GRAPHENE_CHECK_THROW( db_api.scan_objects( "assets", {}, string("garbage"), 1 ), fc::exception );
+      BOOST_CHECK_EQUAL( db_api.scan_objects( "assets", {}, page.next_cursor, 1 ).objects.size(), 1u );
+
+      // A cursor which was altered by the client, e.g. to extend its lifetime, is rejected
+      const string& signed_cursor = *page.next_cursor;
+      const size_t separator = signed_cursor.rfind( '.' );
+      BOOST_REQUIRE( separator != string::npos );
+      fc::mutable_variant_object payload = fc::json::from_string(
+            fc::base64_decode( signed_cursor.substr( 0, separator ) ) ).get_object();
+      payload["expiration"] = fc::variant( fc::time_point_sec::maximum(), 1 );
+      const string forged_cursor = fc::base64_encode( fc::json::to_string( fc::variant( payload ) ) )
+                                 + signed_cursor.substr( separator );
+      GRAPHENE_CHECK_THROW( db_api.scan_objects( "assets", {}, forged_cursor, 1 ), fc::exception );
+      GRAPHENE_CHECK_THROW( db_api.scan_objects( "assets", {}, signed_cursor.substr( 0, separator ), 1 ),
+                            fc::exception );
+
+      GRAPHENE_CHECK_THROW( db_api.scan_objects( "no_such_collection", {} ), fc::exception );
+      GRAPHENE_CHECK_THROW( db_api.scan_objects( "accounts", {}, optional<string>(), 1001 ), fc::exception );
+      GRAPHENE_CHECK_THROW( db_api.scan_objects( "call_orders", {}, optional<string>(), 1 ), fc::exception );
+
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( scan_objects_trades_and_htlcs ) {
+
+   try {
+      generate_blocks(HARDFORK_CORE_1468_TIME);
+      set_expiration( db, trx );
+      set_htlc_committee_parameters();
+      generate_block();
+      set_expiration( db, trx );
+
+      app.enable_plugin("market_history");
+      graphene::app::application_options opt = app.get_options();
+      opt.has_market_history_plugin = true;
+      graphene::app::database_api db_api( db, &opt );
+
+      ACTORS((alice)(bob));
+
+      const auto& eur = create_user_issued_asset("EUR");
+      const auto& usd = create_user_issued_asset("USD");
+      issue_uia( bob_id, usd.amount(1000000) );
+      issue_uia( alice_id, eur.amount(1000000) );
+      transfer( committee_account, alice_id, asset(100 * GRAPHENE_BLOCKCHAIN_PRECISION) );
+
+      // three matches, each of them is recorded once per side
+      for( int i = 0; i < 3; ++i )
+      {
+         create_sell_order( bob, usd.amount(200), eur.amount(210) );
+         create_sell_order( alice, eur.amount(210), usd.amount(200) );
+      }
+
+      // three HTLCs from alice to bob
+      std::vector<char> pre_image(256);
+      std::independent_bits_engine<std::default_random_engine, sizeof(unsigned), unsigned int> rbe;
+      std::generate(begin(pre_image), end(pre_image), std::ref(rbe));
+      for( int i = 0; i < 3; ++i )
+      {
+         graphene::chain::htlc_create_operation create_operation;
+         create_operation.amount = graphene::chain::asset( GRAPHENE_BLOCKCHAIN_PRECISION );
+         create_operation.to = bob_id;
+         create_operation.claim_period_seconds = 60 + i;
+         create_operation.preimage_hash = hash_it<fc::sha256>( pre_image );
+         create_operation.preimage_size = pre_image.size();
+         create_operation.from = alice_id;
+         create_operation.fee = db.get_global_properties().parameters.current_fees->calculate_fee(create_operation);
+         trx.operations.push_back(create_operation);
+         sign(trx, alice_private_key);
+         PUSH_TX(db, trx, ~0);
+         trx.clear();
+      }
+      generate_block();
+
+      // Trades of the market, one per page, in the order of the market history
+      vector<object_id_type> trades;
+      optional<string> cursor;
+      do
+      {
+         graphene::app::scan_page page = db_api.scan_objects( "trades", { "EUR", "USD" }, cursor, 1 );
+         BOOST_CHECK_LE( page.objects.size(), 1u );
+         for( const auto& v : page.objects )
+            trades.push_back( v.as<graphene::market_history::order_history_object>( GRAPHENE_MAX_NESTED_OBJECTS ).id );
+         cursor = page.next_cursor;
+      } while( cursor.valid() );
+      vector<object_id_type> expected_trades;
+      const auto& history_idx = db.get_index_type<graphene::market_history::history_index>().indices()
+                                  .get<graphene::market_history::by_market_time>();
+      for( const auto& o : history_idx )
+      {
+         if( o.key.base == std::min( eur.get_id(), usd.get_id() )
+               && o.key.quote == std::max( eur.get_id(), usd.get_id() ) )
+            expected_trades.push_back( o.id );
+      }
+      BOOST_CHECK_EQUAL( trades.size(), 6u );
+      BOOST_CHECK( trades == expected_trades );
+
+      // The scope of trades does not depend on the order of the assets
+      BOOST_CHECK_EQUAL( db_api.scan_objects( "trades", { "USD", "EUR" }, optional<string>(), 100 ).objects.size(),
+                         6u );
+      GRAPHENE_CHECK_THROW( db_api.scan_objects( "trades", { "USD" }, optional<string>(), 1 ), fc::exception );
+
+      // All HTLCs by ID, in pages of 2
+      vector<htlc_id_type> htlcs;
+      cursor.reset();
+      do
+      {
+         graphene::app::scan_page page = db_api.scan_objects( "htlcs", {}, cursor, 2 );
+         BOOST_CHECK_LE( page.objects.size(), 2u );
+         for( const auto& v : page.objects )
+            htlcs.push_back( v.as<htlc_object>( GRAPHENE_MAX_NESTED_OBJECTS ).id );
+         cursor = page.next_cursor;
+      } while( cursor.valid() );
+      vector<htlc_id_type> expected_htlcs;
+      for( const auto& h : db.get_index_type<htlc_index>().indices().get<by_id>() )
+         expected_htlcs.push_back( h.id );
+      BOOST_CHECK_EQUAL( htlcs.size(), 3u );
+      BOOST_CHECK( htlcs == expected_htlcs );
+
+      // A cursor of trades does not continue a scan of HTLCs
+      graphene::app::scan_page page = db_api.scan_objects( "trades", { "EUR", "USD" }, optional<string>(), 1 );
+      BOOST_REQUIRE( page.next_cursor.valid() );
+      GRAPHENE_CHECK_THROW( db_api.scan_objects( "htlcs", {}, page.next_cursor, 1 ), fc::exception );
+
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( validate_transaction_waits_for_api_workers )
+{ try {
+   ACTORS( (alice)(bob) );
+   fund( alice, asset(100000) );
+   const int64_t alice_balance = get_balance( alice_id, asset_id_type() );
+
+   graphene::app::api_worker_pool pool;
+   pool.start( 1, 0 );
+   graphene::app::database_api db_api( db, &(app.get_options()), &pool );
+
+   // a read-only call in flight holds off the validation, which applies the transaction to the chain state
+   std::atomic<bool> read_started( false );
+   std::atomic<bool> read_done( false );
+   fc::future<int64_t> read = fc::async( [&]() {
+      return pool.run_read_only( "database_api", "get_account_balances", [&]() {
+         read_started = true;
+         fc::usleep( fc::milliseconds(50) );
+         const int64_t balance = db.get_balance( alice_id, asset_id_type() ).amount.value;
+         read_done = true;
+         return balance;
+      } );
+   } );
+   while( !read_started )
+      fc::usleep( fc::milliseconds(1) );
+
+   transfer_operation op;
+   op.from = alice_id;
+   op.to = bob_id;
+   op.amount = asset(1000);
+   op.fee = db.current_fee_schedule().calculate_fee( op );
+   signed_transaction tx;
+   tx.operations.push_back( op );
+   set_expiration( db, tx );
+   sign( tx, alice_private_key );
+   db_api.validate_transaction( tx );
+
+   BOOST_CHECK( read_done );
+   BOOST_CHECK_EQUAL( read.wait(), alice_balance );
+   // the validation leaves no trace in the chain state
+   BOOST_CHECK_EQUAL( get_balance( alice_id, asset_id_type() ), alice_balance );
+
+   pool.stop();
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
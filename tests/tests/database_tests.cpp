@@ -310,4 +310,47 @@ BOOST_AUTO_TEST_CASE( required_approval_index_test ) // see https://github.com/b
 
 } FC_LOG_AND_RETHROW() }
 
+/**
+ * Check that the incremental state hash follows object changes, is restored by undo and matches a full rehash
+ */
+BOOST_AUTO_TEST_CASE( state_hash_test )
+{ try {
+   db.enable_state_hash( true );
+   const fc::sha256 initial_hash = db.get_state_hash();
+   BOOST_CHECK( !db.get_index_state_hashes().empty() );
+
+   {
+      auto session = db._undo_db.start_undo_session();
+      create_account( "alice" );
+      BOOST_CHECK( db.get_state_hash() != initial_hash );
+      session.undo();
+   }
+   BOOST_CHECK( db.get_state_hash() == initial_hash );
+
+   ACTORS( (alice)(bob) );
+   fund( alice, asset( 1000000 ) );
+   transfer( alice, bob, asset( 1000 ) );
+   generate_block();
+
+   const fc::sha256 incremental_hash = db.get_state_hash();
+   BOOST_CHECK( incremental_hash != initial_hash );
+
+   // a failed modification leaves the object in the state hash
+   BOOST_CHECK_THROW( db.modify( alice, []( account_object& ) { FC_THROW( "failure" ); } ), fc::exception );
+   BOOST_CHECK( db.get_state_hash() == incremental_hash );
+
+   // rehash everything from scratch
+   db.enable_state_hash( false );
+   db.enable_state_hash( true );
+   BOOST_CHECK( db.get_state_hash() == incremental_hash );
+
+   // history objects are not part of the state hash
+   const auto hashes = db.get_index_state_hashes();
+   BOOST_CHECK( hashes.find( std::make_pair( uint8_t(protocol_ids), uint8_t(operation_history_object_type) ) )
+                == hashes.end() );
+   BOOST_CHECK( hashes.find( std::make_pair( uint8_t(protocol_ids), uint8_t(account_object_type) ) )
+                != hashes.end() );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/es_objects/document_pipeline.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <atomic>
+
+using namespace graphene::chain;
+using namespace graphene::es_objects;
+
+namespace {
+
+pending_document make_document( const account_id_type& id, const std::string& name, uint32_t block_number )
+{
+   account_object account;
+   account.id = id;
+   account.name = name;
+   pending_document doc;
+   doc.id = id;
+   doc.index = "account";
+   doc.object = account.clone();
+   doc.block_number = block_number;
+   return doc;
+}
+
+std::string name_of( const pending_document& doc )
+{
+   BOOST_REQUIRE( doc.object );
+   return static_cast<const account_object&>( *doc.object ).name;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(es_objects_pipeline_tests)
+
+BOOST_AUTO_TEST_CASE(only_the_current_version_of_an_object_is_kept)
+{
+   pending_documents pending;
+   pending.add( make_document( account_id_type(5), "alice", 1 ) );
+   pending.add( make_document( account_id_type(6), "bob", 1 ) );
+   pending.add( make_document( account_id_type(5), "carol", 2 ) );
+
+   // the last version replaces the first one at its position
+   BOOST_REQUIRE_EQUAL( pending.size(), 2u );
+   BOOST_CHECK( pending.documents()[0].id == account_id_type(5) );
+   BOOST_CHECK_EQUAL( name_of( pending.documents()[0] ), "carol" );
+   BOOST_CHECK_EQUAL( pending.documents()[0].block_number, 2u );
+   BOOST_CHECK_EQUAL( name_of( pending.documents()[1] ), "bob" );
+
+   // a removed object is deleted instead
+   pending.add_removed( account_id_type(6), "account", 3, fc::time_point_sec() );
+   BOOST_REQUIRE_EQUAL( pending.size(), 2u );
+   BOOST_CHECK( pending.documents()[1].id == account_id_type(6) );
+   BOOST_CHECK( !pending.documents()[1].object );
+
+   // taking the batch starts a new one
+   const auto batch = pending.take();
+   BOOST_CHECK_EQUAL( batch.size(), 2u );
+   BOOST_CHECK( pending.empty() );
+   pending.add( make_document( account_id_type(5), "dave", 4 ) );
+   pending.add( make_document( account_id_type(6), "erin", 4 ) );
+   BOOST_CHECK_EQUAL( pending.size(), 2u );
+   BOOST_CHECK_EQUAL( name_of( pending.documents()[0] ), "dave" );
+}
+
+BOOST_AUTO_TEST_CASE(every_version_is_kept_as_history)
+{
+   pending_documents pending( false );
+   pending.add( make_document( account_id_type(5), "alice", 1 ) );
+   pending.add( make_document( account_id_type(5), "carol", 2 ) );
+   // the documents are the history of the object, so they are not deleted with it
+   pending.add_removed( account_id_type(5), "account", 3, fc::time_point_sec() );
+
+   BOOST_REQUIRE_EQUAL( pending.size(), 2u );
+   BOOST_CHECK_EQUAL( name_of( pending.documents()[0] ), "alice" );
+   BOOST_CHECK_EQUAL( name_of( pending.documents()[1] ), "carol" );
+}
+
+BOOST_AUTO_TEST_CASE(removed_objects_are_deleted_from_the_index)
+{
+   pending_documents pending;
+   pending.add( make_document( account_id_type(5), "alice", 1 ) );
+   pending.add_removed( account_id_type(5), "account", 2, fc::time_point_sec() );
+   const auto removed = pending.take();
+   BOOST_REQUIRE_EQUAL( removed.size(), 1u );
+
+   auto lines = serialize_documents( removed, 0, removed.size(), "objects-", true );
+   BOOST_REQUIRE_EQUAL( lines.size(), 1u );
+   const fc::variant_object deletion = fc::json::from_string( lines[0] ).get_object()["delete"].get_object();
+   BOOST_CHECK_EQUAL( deletion["_id"].as_string(), "1.2.5" );
+   BOOST_CHECK_EQUAL( deletion["_index"].as_string(), "objects-account" );
+
+   // a current version is indexed under the id of the object, so that the next version replaces it
+   const vector<pending_document> current { make_document( account_id_type(6), "bob", 3 ) };
+   lines = serialize_documents( current, 0, current.size(), "objects-", true );
+   BOOST_REQUIRE_EQUAL( lines.size(), 2u );
+   const fc::variant_object header = fc::json::from_string( lines[0] ).get_object()["index"].get_object();
+   BOOST_CHECK_EQUAL( header["_id"].as_string(), "1.2.6" );
+   BOOST_CHECK_EQUAL( header["_index"].as_string(), "objects-account" );
+   const fc::variant_object data = fc::json::from_string( lines[1] ).get_object();
+   BOOST_CHECK_EQUAL( data["object_id"].as_string(), "1.2.6" );
+   BOOST_CHECK_EQUAL( data["name"].as_string(), "bob" );
+   BOOST_CHECK_EQUAL( data["block_number"].as_uint64(), 3u );
+
+   // as history, every version is a new document
+   lines = serialize_documents( current, 0, current.size(), "objects-", false );
+   BOOST_REQUIRE_EQUAL( lines.size(), 2u );
+   BOOST_CHECK( !fc::json::from_string( lines[0] ).get_object()["index"].get_object().contains( "_id" ) );
+}
+
+BOOST_AUTO_TEST_CASE(backlog_is_replayed_in_batch_order)
+{
+   fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+   backlog_directory backlog( dir.path() / "es_objects_backlog" );
+   BOOST_CHECK( fc::exists( backlog.path() ) );
+   BOOST_CHECK( backlog.files().empty() );
+   BOOST_CHECK_EQUAL( backlog.next_sequence(), 0u );
+
+   BOOST_CHECK_EQUAL( backlog.file(7).filename().string(), "00000000000000000007.json" );
+
+   // the file names sort in the order of the batches, also when the number of digits grows
+   backlog_directory::store( backlog.file(10), { "{\"batch\":10}" } );
+   backlog_directory::store( backlog.file(9), { "{\"batch\":9}", "{\"line\":2}" } );
+   backlog_directory::store( backlog.file(100), { "{\"batch\":100}" } );
+   const auto files = backlog.files();
+   BOOST_REQUIRE_EQUAL( files.size(), 3u );
+   BOOST_CHECK_EQUAL( files[0].string(), backlog.file(9).string() );
+   BOOST_CHECK_EQUAL( files[1].string(), backlog.file(10).string() );
+   BOOST_CHECK_EQUAL( files[2].string(), backlog.file(100).string() );
+   BOOST_CHECK_EQUAL( backlog.next_sequence(), 101u );
+
+   // a stored batch is read back line by line
+   const auto lines = backlog_directory::load( files[0] );
+   BOOST_REQUIRE_EQUAL( lines.size(), 2u );
+   BOOST_CHECK_EQUAL( lines[0], "{\"batch\":9}" );
+   BOOST_CHECK_EQUAL( lines[1], "{\"line\":2}" );
+
+   // batches left over from a run are found again by the next one
+   backlog_directory reopened( dir.path() / "es_objects_backlog" );
+   BOOST_CHECK_EQUAL( reopened.files().size(), 3u );
+   BOOST_CHECK_EQUAL( reopened.next_sequence(), 101u );
+}
+
+BOOST_AUTO_TEST_CASE(full_batch_queue_waits_for_the_oldest_batch)
+{
+   fc::thread sender( "es_objects_test_sender" );
+   fc::thread flusher( "es_objects_test_flusher" );
+   std::atomic<bool> release{ false };
+   auto blocked_batch = [&release]() {
+      while( !release )
+         fc::usleep( fc::milliseconds(1) );
+   };
+
+   batch_queue batches( 2 );
+   batches.push( sender.async( blocked_batch ) );
+   batches.push( sender.async( blocked_batch ) );
+
+   std::atomic<bool> made_room{ false };
+   fc::future<void> flushed = flusher.async( [&batches,&made_room]() {
+      batches.make_room();
+      made_room = true;
+   } );
+   fc::usleep( fc::milliseconds(50) );
+   BOOST_CHECK( !made_room );
+
+   release = true;
+   flushed.wait();
+   BOOST_CHECK( made_room );
+   BOOST_CHECK_LT( batches.size(), 2u );
+
+   // batches which are done are dropped without waiting while there is room
+   batches.wait_all();
+   BOOST_CHECK( batches.empty() );
+   batches.push( sender.async( []() {} ) );
+   batches.back().wait();
+   batches.make_room();
+   BOOST_CHECK( batches.empty() );
+
+   flusher.quit();
+   sender.quit();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3890,4 +3890,90 @@ BOOST_AUTO_TEST_CASE( issue_433_indirect_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( fee_parameter_table_test )
+{ try {
+   fee_schedule schedule;
+   transfer_operation::fee_parameters_type transfer_fee;
+   transfer_fee.fee = 1000;
+   transfer_fee.price_per_kbyte = 0;
+   schedule.parameters.insert( transfer_fee );
+   limit_order_create_operation::fee_parameters_type order_fee;
+   order_fee.fee = 200;
+   schedule.parameters.insert( order_fee );
+   account_create_operation::fee_parameters_type account_fee;
+   account_fee.basic_fee = 300;
+   account_fee.premium_fee = 300;
+   account_fee.price_per_kbyte = 0;
+   schedule.parameters.insert( account_fee );
+
+   transfer_operation top;
+   limit_order_create_operation lop;
+   account_create_operation aop;
+   BOOST_CHECK_EQUAL( schedule.calculate_fee( top ).amount.value, 1000 );
+   BOOST_CHECK_EQUAL( schedule.calculate_fee( lop ).amount.value, 200 );
+   BOOST_CHECK_EQUAL( schedule.calculate_fee( aop ).amount.value, 300 );
+
+   // the table is shared until the parameters change
+   auto table = schedule.get_fee_table();
+   BOOST_CHECK( table == schedule.get_fee_table() );
+   BOOST_CHECK_EQUAL( table->parameters.size(), static_cast<size_t>( fee_parameters().count() ) );
+
+   // modifying parameters through the schedule invalidates the table
+   schedule.get<account_create_operation>().basic_fee = 400;
+   schedule.get<account_create_operation>().premium_fee = 400;
+   BOOST_CHECK_EQUAL( schedule.calculate_fee( aop ).amount.value, 400 );
+   BOOST_CHECK( table != schedule.get_fee_table() );
+
+   // so does replacing a parameter, although the set keeps its size and storage
+   transfer_fee.fee = 1500;
+   schedule.parameters.erase( transfer_fee );
+   schedule.parameters.insert( transfer_fee );
+   BOOST_CHECK_EQUAL( schedule.calculate_fee( top ).amount.value, 1500 );
+
+   // a copy shares the table until one of them is modified
+   fee_schedule copy = schedule;
+   BOOST_CHECK( copy.get_fee_table() == schedule.get_fee_table() );
+   copy.parameters.clear();
+   BOOST_CHECK_EQUAL( copy.calculate_fee( top ).amount.value,
+                      transfer_operation::fee_parameters_type().fee );
+   BOOST_CHECK_EQUAL( schedule.calculate_fee( top ).amount.value, 1500 );
+
+   // and deserializing into an existing schedule
+   fee_schedule other = schedule;
+   transfer_fee.fee = 1700;
+   other.parameters.erase( transfer_fee );
+   other.parameters.insert( transfer_fee );
+   const auto packed = fc::raw::pack( other );
+   fc::raw::unpack( packed, copy );
+   BOOST_CHECK_EQUAL( copy.calculate_fee( top ).amount.value, 1700 );
+   copy = schedule;
+   BOOST_CHECK_EQUAL( copy.calculate_fee( top ).amount.value, 1500 );
+   fc::from_variant( fc::variant( other, GRAPHENE_MAX_NESTED_OBJECTS ), copy, GRAPHENE_MAX_NESTED_OBJECTS );
+   BOOST_CHECK_EQUAL( copy.calculate_fee( top ).amount.value, 1700 );
+
+   // the parameters are serialized like a plain set
+   const auto packed_parameters = fc::raw::pack( other.parameters.get() );
+   BOOST_REQUIRE_LT( packed_parameters.size(), packed.size() );
+   BOOST_CHECK( std::equal( packed_parameters.begin(), packed_parameters.end(), packed.begin() ) );
+
+   // and scaling is applied on top of the table
+   schedule.scale = GRAPHENE_100_PERCENT * 2;
+   BOOST_CHECK_EQUAL( schedule.calculate_fee( top ).amount.value, 3000 );
+   schedule.scale = GRAPHENE_100_PERCENT;
+
+   // batch calculation gives the same results as calculating one by one
+   vector<operation> ops{ top, lop, top };
+   vector<operation> single_ops = ops;
+   const price cer( asset( 1, asset_id_type(1) ), asset( 3 ) );
+   vector<asset> fees = schedule.set_fees( ops, cer );
+   BOOST_REQUIRE_EQUAL( fees.size(), ops.size() );
+   for( size_t i = 0; i < ops.size(); ++i )
+      BOOST_CHECK( fees[i] == schedule.set_fee( single_ops[i], cer ) );
+   BOOST_CHECK( ops[0].get<transfer_operation>().fee == fees[0] );
+   BOOST_CHECK( ops[1].get<limit_order_create_operation>().fee == fees[1] );
+   BOOST_CHECK( ops[2].get<transfer_operation>().fee == fees[2] );
+   BOOST_CHECK_EQUAL( fees[0].amount.value, 500 );
+   BOOST_CHECK( fees[0].asset_id == asset_id_type(1) );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
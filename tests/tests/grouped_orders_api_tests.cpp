@@ -58,4 +58,77 @@ BOOST_AUTO_TEST_CASE(api_limit_get_grouped_limit_orders) {
     throw;
    }
 }
+
+BOOST_AUTO_TEST_CASE(grouped_limit_orders_by_groups) {
+   try
+   {
+   ACTORS( (alice) );
+   graphene::app::orders_api orders_api(app);
+   optional<price> start;
+
+   const asset_object& usd = create_user_issued_asset( "MYUSD" );
+   const asset_id_type usd_id = usd.id;
+   transfer( committee_account, alice_id, asset( 10000 ) );
+
+   const std::string core_str = std::string( static_cast<object_id_type>( asset_id_type() ) );
+   const std::string usd_str = std::string( static_cast<object_id_type>( usd_id ) );
+
+   // 0.5% apart: separate groups in the 0.1% group width, one group in the 1% group width
+   create_sell_order( alice_id, asset( 1000 ), asset( 1000, usd_id ) );
+   const limit_order_id_type second_id = create_sell_order( alice_id, asset( 1000 ), asset( 1005, usd_id ) )->id;
+   // 10% apart: separate groups in both group widths
+   create_sell_order( alice_id, asset( 1000 ), asset( 1100, usd_id ) );
+
+   auto check_same_as_single_calls = [&]() {
+      auto by_groups = orders_api.get_grouped_limit_orders_by_groups( core_str, usd_str, { 10, 100 }, start, 101 );
+      BOOST_REQUIRE_EQUAL( by_groups.size(), 2u );
+      for( uint16_t group : { 10, 100 } )
+      {
+         auto single = orders_api.get_grouped_limit_orders( core_str, usd_str, group, start, 101 );
+         BOOST_REQUIRE_EQUAL( by_groups[group].size(), single.size() );
+         for( size_t i = 0; i < single.size(); ++i )
+         {
+            BOOST_CHECK( by_groups[group][i].min_price == single[i].min_price );
+            BOOST_CHECK( by_groups[group][i].max_price == single[i].max_price );
+            BOOST_CHECK_EQUAL( by_groups[group][i].total_for_sale.value, single[i].total_for_sale.value );
+         }
+      }
+      return by_groups;
+   };
+
+   auto groups = check_same_as_single_calls();
+   BOOST_REQUIRE_EQUAL( groups[10].size(), 3u );
+   BOOST_REQUIRE_EQUAL( groups[100].size(), 2u );
+   // the second order has lowered the min_price of the first group in place
+   BOOST_CHECK( groups[100][0].min_price == price( asset( 1000 ), asset( 1005, usd_id ) ) );
+   BOOST_CHECK( groups[100][0].max_price == price( asset( 1000 ), asset( 1000, usd_id ) ) );
+   BOOST_CHECK_EQUAL( groups[100][0].total_for_sale.value, 2000 );
+   BOOST_CHECK_EQUAL( groups[100][1].total_for_sale.value, 1000 );
+
+   cancel_limit_order( second_id( db ) );
+   groups = check_same_as_single_calls();
+   BOOST_REQUIRE_EQUAL( groups[10].size(), 2u );
+   BOOST_REQUIRE_EQUAL( groups[100].size(), 2u );
+   BOOST_CHECK_EQUAL( groups[100][0].total_for_sale.value, 1000 );
+
+   // the limit applies to every group width
+   groups = orders_api.get_grouped_limit_orders_by_groups( core_str, usd_str, { 10, 100 }, start, 1 );
+   BOOST_CHECK_EQUAL( groups[10].size(), 1u );
+   BOOST_CHECK_EQUAL( groups[100].size(), 1u );
+
+   // no orders in the other direction
+   groups = orders_api.get_grouped_limit_orders_by_groups( usd_str, core_str, { 10 }, start, 101 );
+   BOOST_CHECK( groups[10].empty() );
+
+   GRAPHENE_CHECK_THROW( orders_api.get_grouped_limit_orders_by_groups( core_str, usd_str, { 10 }, start, 102 ),
+                         fc::exception );
+   GRAPHENE_CHECK_THROW( orders_api.get_grouped_limit_orders_by_groups( core_str, usd_str, { 10, 20 }, start, 101 ),
+                         fc::exception );
+   }catch (fc::exception &e)
+   {
+    edump((e.to_detail_string()));
+    throw;
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -762,4 +762,93 @@ BOOST_AUTO_TEST_CASE(api_limit_get_account_history_by_operations) {
 }
 
 
+
+BOOST_AUTO_TEST_CASE(get_market_history_aggregated) {
+   try {
+      ACTORS( (seller)(buyer) );
+      graphene::app::history_api hist_api(app);
+
+      const asset_object& usd = create_user_issued_asset( "MYUSD" );
+      const asset_id_type usd_id = usd.id;
+      issue_uia( buyer, asset( 100000, usd_id ) );
+      transfer( committee_account, seller_id, asset( 100000 ) );
+      generate_block();
+
+      // the fixture tracks 15 second buckets
+      for( int i = 0; i < 9; ++i )
+      {
+         create_sell_order( seller_id, asset( 100 ), asset( 100 + i, usd_id ) );
+         create_sell_order( buyer_id, asset( 100 + i, usd_id ), asset( 100 ) );
+         generate_block();
+      }
+
+      const std::string core_str = std::string( static_cast<object_id_type>( asset_id_type() ) );
+      const std::string usd_str = std::string( static_cast<object_id_type>( usd_id ) );
+      const fc::time_point_sec end = db.head_block_time();
+
+      auto fine = hist_api.get_market_history( core_str, usd_str, 15, fc::time_point_sec(), end );
+      BOOST_REQUIRE( !fine.empty() );
+      int64_t total_base = 0;
+      for( const auto& b : fine )
+      {
+         BOOST_CHECK_EQUAL( b.key.seconds, 15u );
+         total_base += b.base_volume.value;
+      }
+      BOOST_CHECK_EQUAL( total_base, 900 );
+
+      // coarser buckets are aggregated from the stored ones, twice to go through the cache
+      for( int round = 0; round < 2; ++round )
+      {
+         auto coarse = hist_api.get_market_history( usd_str, core_str, 45, fc::time_point_sec(), end );
+         BOOST_REQUIRE( !coarse.empty() );
+         BOOST_CHECK_LE( coarse.size(), fine.size() );
+         size_t f = 0;
+         for( const auto& c : coarse )
+         {
+            BOOST_CHECK_EQUAL( c.key.seconds, 45u );
+            BOOST_CHECK_EQUAL( c.key.open.sec_since_epoch() % 45, 0u );
+            const uint32_t c_end = c.key.open.sec_since_epoch() + 45;
+            BOOST_REQUIRE( f < fine.size() );
+            BOOST_CHECK( fine[f].key.open >= c.key.open );
+            BOOST_CHECK_EQUAL( c.open_base.value, fine[f].open_base.value );
+            BOOST_CHECK_EQUAL( c.open_quote.value, fine[f].open_quote.value );
+            int64_t base = 0;
+            int64_t quote = 0;
+            price high = fine[f].high();
+            price low = fine[f].low();
+            size_t last = f;
+            for( ; f < fine.size() && fine[f].key.open.sec_since_epoch() < c_end; ++f )
+            {
+               base += fine[f].base_volume.value;
+               quote += fine[f].quote_volume.value;
+               high = std::max( high, fine[f].high() );
+               low = std::min( low, fine[f].low() );
+               last = f;
+            }
+            BOOST_CHECK_EQUAL( c.base_volume.value, base );
+            BOOST_CHECK_EQUAL( c.quote_volume.value, quote );
+            BOOST_CHECK( c.high() == high );
+            BOOST_CHECK( c.low() == low );
+            BOOST_CHECK_EQUAL( c.close_base.value, fine[last].close_base.value );
+            BOOST_CHECK_EQUAL( c.close_quote.value, fine[last].close_quote.value );
+         }
+         BOOST_CHECK_EQUAL( f, fine.size() );
+      }
+
+      // not a multiple of the stored size
+      BOOST_CHECK( hist_api.get_market_history( core_str, usd_str, 20, fc::time_point_sec(), end ).empty() );
+      // huge buckets
+      auto all = hist_api.get_market_history( core_str, usd_str, 15 * 1000000, fc::time_point_sec(), end );
+      BOOST_REQUIRE( !all.empty() && all.size() <= 2u );
+      int64_t all_base = 0;
+      for( const auto& b : all )
+         all_base += b.base_volume.value;
+      BOOST_CHECK_EQUAL( all_base, 900 );
+
+   } catch (fc::exception &e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
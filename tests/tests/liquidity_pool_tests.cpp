@@ -24,6 +24,7 @@
 
 #include "../common/database_fixture.hpp"
 
+#include <graphene/app/database_api.hpp>
 #include <graphene/chain/hardfork.hpp>
 #include <graphene/chain/liquidity_pool_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
@@ -898,4 +899,122 @@ BOOST_AUTO_TEST_CASE( exchange_test )
    }
 }
 
+
+BOOST_AUTO_TEST_CASE( liquidity_pool_ticker_test )
+{ try {
+
+      generate_blocks( HARDFORK_LIQUIDITY_POOL_TIME );
+      set_expiration( db, trx );
+
+      app.enable_plugin("market_history");
+      graphene::app::application_options opt = app.get_options();
+      opt.has_market_history_plugin = true;
+      graphene::app::database_api db_api( db, &opt );
+
+      ACTORS((sam)(ted));
+
+      int64_t init_amount = 10000000 * GRAPHENE_BLOCKCHAIN_PRECISION;
+      fund( sam, asset(init_amount) );
+      fund( ted, asset(init_amount) );
+
+      const asset_object& eur = create_user_issued_asset( "MYEUR" );
+      const asset_object& usd = create_user_issued_asset( "MYUSD" );
+      const asset_object& lpa = create_user_issued_asset( "LPATEST", sam, charge_market_fee );
+      const asset_object& lpb = create_user_issued_asset( "LPBTEST", sam, charge_market_fee );
+      asset_id_type core_id;
+      asset_id_type eur_id = eur.id;
+      asset_id_type usd_id = usd.id;
+      asset_id_type lpb_id = lpb.id;
+      issue_uia( sam, eur.amount(init_amount) );
+      issue_uia( sam, usd.amount(init_amount) );
+      issue_uia( ted, eur.amount(init_amount) );
+      issue_uia( ted, usd.amount(init_amount) );
+
+      liquidity_pool_id_type lp1_id = create_liquidity_pool( sam_id, eur_id, usd_id, lpa.id, 0, 0 ).id;
+      liquidity_pool_id_type lp2_id = create_liquidity_pool( sam_id, core_id, usd_id, lpb.id, 0, 0 ).id;
+      deposit_to_liquidity_pool( sam_id, lp1_id, asset( 100000, eur_id ), asset( 200000, usd_id ) );
+      deposit_to_liquidity_pool( sam_id, lp2_id, asset( 100000, core_id ), asset( 100000, usd_id ) );
+      generate_block();
+
+      // both pools hold MYUSD as asset B
+      auto tickers = db_api.get_liquidity_pool_tickers_by_volume( "MYUSD" );
+      BOOST_REQUIRE_EQUAL( tickers.size(), 2u );
+      for( const auto& t : tickers )
+      {
+         BOOST_CHECK_EQUAL( t.deposit_count, 1u );
+         BOOST_CHECK_EQUAL( t.exchange_count, 0u );
+         BOOST_CHECK( !t.open.valid() );
+      }
+
+      // exchanges in both directions
+      auto result = exchange_with_liquidity_pool( ted_id, lp1_id, asset( 1000, eur_id ), asset( 1, usd_id ) );
+      int64_t volume_a = 1000;
+      int64_t volume_b = result.received.front().amount.value;
+      result = exchange_with_liquidity_pool( ted_id, lp1_id, asset( 3000, usd_id ), asset( 1, eur_id ) );
+      volume_a += result.received.front().amount.value;
+      volume_b += 3000;
+      exchange_with_liquidity_pool( ted_id, lp2_id, asset( 100, core_id ), asset( 1, usd_id ) );
+      generate_block();
+
+      // ranked by the volume of MYUSD, which is asset B of both pools
+      tickers = db_api.get_liquidity_pool_tickers_by_volume( "MYUSD" );
+      BOOST_REQUIRE_EQUAL( tickers.size(), 2u );
+      BOOST_CHECK( tickers[0].pool == lp1_id );
+      BOOST_CHECK_EQUAL( tickers[0].exchange_count, 2u );
+      BOOST_CHECK( tickers[0].volume_a == fc::uint128_t( volume_a ) );
+      BOOST_CHECK( tickers[0].volume_b == fc::uint128_t( volume_b ) );
+      BOOST_REQUIRE( tickers[0].open.valid() && tickers[0].close.valid() );
+      BOOST_CHECK( *tickers[0].high >= *tickers[0].open );
+      BOOST_CHECK( *tickers[0].low <= *tickers[0].close );
+      BOOST_CHECK_EQUAL( tickers[0].total_exchange_count, 2u );
+      BOOST_CHECK( tickers[1].pool == lp2_id );
+      BOOST_CHECK_EQUAL( tickers[1].exchange_count, 1u );
+
+      // only the pools of the given asset are ranked, whether it is asset A or asset B
+      tickers = db_api.get_liquidity_pool_tickers_by_volume( "MYEUR" );
+      BOOST_REQUIRE_EQUAL( tickers.size(), 1u );
+      BOOST_CHECK( tickers[0].pool == lp1_id );
+      tickers = db_api.get_liquidity_pool_tickers_by_volume( "1.3.0" );
+      BOOST_REQUIRE_EQUAL( tickers.size(), 1u );
+      BOOST_CHECK( tickers[0].pool == lp2_id );
+      tickers = db_api.get_liquidity_pool_tickers_by_volume( "LPATEST" );
+      BOOST_CHECK( tickers.empty() );
+      BOOST_CHECK_THROW( db_api.get_liquidity_pool_tickers_by_volume( "NOSUCHASSET" ), fc::exception );
+
+      // pagination
+      tickers = db_api.get_liquidity_pool_tickers_by_volume( "MYUSD", 1 );
+      BOOST_REQUIRE_EQUAL( tickers.size(), 1u );
+      BOOST_CHECK( tickers[0].pool == lp1_id );
+      tickers = db_api.get_liquidity_pool_tickers_by_volume( "MYUSD", 101, lp2_id );
+      BOOST_REQUIRE_EQUAL( tickers.size(), 1u );
+      BOOST_CHECK( tickers[0].pool == lp2_id );
+      BOOST_CHECK_THROW( db_api.get_liquidity_pool_tickers_by_volume( "MYUSD", 102 ), fc::exception );
+      BOOST_CHECK_THROW( db_api.get_liquidity_pool_tickers_by_volume( "MYEUR", 101, lp2_id ), fc::exception );
+
+      // the activity rolls out after 24 hours
+      generate_blocks( db.head_block_time() + fc::days(1) + fc::hours(1) );
+      tickers = db_api.get_liquidity_pool_tickers_by_volume( "MYUSD" );
+      BOOST_REQUIRE_EQUAL( tickers.size(), 2u );
+      for( const auto& t : tickers )
+      {
+         BOOST_CHECK_EQUAL( t.exchange_count, 0u );
+         BOOST_CHECK_EQUAL( t.deposit_count, 0u );
+         BOOST_CHECK( t.volume_a == fc::uint128_t() );
+         BOOST_CHECK( !t.open.valid() );
+      }
+      BOOST_CHECK_EQUAL( tickers[0].total_exchange_count + tickers[1].total_exchange_count, 3u );
+
+      // the ticker is removed with the pool
+      withdraw_from_liquidity_pool( sam_id, lp2_id, db.get_balance( sam_id, lpb_id ) );
+      delete_liquidity_pool( sam_id, lp2_id );
+      generate_block();
+      tickers = db_api.get_liquidity_pool_tickers_by_volume( "MYUSD" );
+      BOOST_REQUIRE_EQUAL( tickers.size(), 1u );
+      BOOST_CHECK( tickers[0].pool == lp1_id );
+
+} catch (fc::exception& e) {
+   edump((e.to_detail_string()));
+   throw;
+} }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2020 Contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/net/peer_database.hpp>
+#include <graphene/net/config.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/io/json.hpp>
+
+#include <vector>
+
+using namespace graphene::net;
+
+namespace {
+
+   std::vector<fc::ip::endpoint> endpoints_in_iteration_order( const peer_database& db )
+   {
+      std::vector<fc::ip::endpoint> result;
+      for( auto itr = db.begin(); itr != db.end(); ++itr )
+         result.push_back( itr->endpoint );
+      return result;
+   }
+
+}
+
+BOOST_AUTO_TEST_SUITE(peer_database_tests)
+
+BOOST_AUTO_TEST_CASE(peer_score_test)
+{
+   potential_peer_record unknown( fc::ip::endpoint::from_string("10.0.0.1:1776") );
+
+   potential_peer_record fast = unknown;
+   fast.number_of_successful_connection_attempts = 4;
+   fast.record_round_trip_delay( fc::milliseconds(40) );
+   BOOST_CHECK_EQUAL( fast.average_latency_ms, 40u );
+   fast.record_round_trip_delay( fc::milliseconds(80) );
+   BOOST_CHECK_EQUAL( fast.average_latency_ms, 50u );
+
+   potential_peer_record slow = fast;
+   slow.average_latency_ms = 2000;
+
+   potential_peer_record misbehaving = fast;
+   misbehaving.number_of_protocol_errors = 3;
+
+   potential_peer_record synced = fast;
+   synced.number_of_successful_syncs = 2;
+   synced.total_connected_seconds = 3600;
+
+   BOOST_CHECK_GT( fast.score(), unknown.score() );
+   BOOST_CHECK_GT( fast.score(), slow.score() );
+   BOOST_CHECK_GT( fast.score(), misbehaving.score() );
+   BOOST_CHECK_GT( synced.score(), fast.score() );
+
+   potential_peer_record unreliable = fast;
+   unreliable.number_of_failed_connection_attempts = 12;
+   BOOST_CHECK_GT( fast.score(), unreliable.score() );
+}
+
+BOOST_AUTO_TEST_CASE(peer_database_persistence_test)
+{
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   const fc::path db_file = data_dir.path() / "peers.dat";
+
+   const fc::ip::endpoint good = fc::ip::endpoint::from_string("10.0.0.1:1776");
+   const fc::ip::endpoint bad = fc::ip::endpoint::from_string("10.0.0.2:1776");
+   const fc::ip::endpoint stale = fc::ip::endpoint::from_string("10.0.0.3:1776");
+
+   {
+      peer_database db;
+      db.open( db_file );
+      BOOST_CHECK_EQUAL( db.size(), 0u );
+
+      potential_peer_record bad_record( bad, fc::time_point_sec(2000) );
+      bad_record.number_of_protocol_errors = 5;
+      db.update_entry( bad_record );
+
+      potential_peer_record good_record( good, fc::time_point_sec(1000) );
+      good_record.number_of_successful_connection_attempts = 1;
+      good_record.number_of_successful_syncs = 1;
+      good_record.average_latency_ms = 30;
+      db.update_entry( good_record );
+
+      db.update_entry( potential_peer_record( stale, fc::time_point_sec(3000) ) );
+
+      // iteration order is by score, not by last seen time
+      BOOST_CHECK( endpoints_in_iteration_order( db ) == std::vector<fc::ip::endpoint>({ good, stale, bad }) );
+      db.close();
+   }
+
+   {
+      peer_database db;
+      db.open( db_file );
+      BOOST_REQUIRE_EQUAL( db.size(), 3u );
+      fc::optional<potential_peer_record> good_record = db.lookup_entry_for_endpoint( good );
+      BOOST_REQUIRE( good_record.valid() );
+      BOOST_CHECK_EQUAL( good_record->number_of_successful_syncs, 1u );
+      BOOST_CHECK_EQUAL( good_record->average_latency_ms, 30u );
+      BOOST_CHECK( good_record->last_seen_time == fc::time_point_sec(1000) );
+
+      // changes are journaled, they survive even if the database is never closed
+      db.erase( stale );
+      good_record->total_connected_seconds = 600;
+      db.update_entry( *good_record );
+   }
+
+   {
+      peer_database db;
+      db.open( db_file );
+      BOOST_CHECK( endpoints_in_iteration_order( db ) == std::vector<fc::ip::endpoint>({ good, bad }) );
+      BOOST_CHECK_EQUAL( db.lookup_or_create_entry_for_endpoint( good ).total_connected_seconds, 600u );
+      db.close();
+   }
+}
+
+BOOST_AUTO_TEST_CASE(peer_database_journal_batching_test)
+{
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   const fc::path db_file = data_dir.path() / "peers.dat";
+   const fc::ip::endpoint endpoint = fc::ip::endpoint::from_string("10.0.0.1:1776");
+
+   peer_database db;
+   db.open( db_file );
+   const uint64_t empty_size = fc::file_size( db_file );
+
+   // round trip delay samples of a single peer don't each cost a disk write
+   potential_peer_record record( endpoint, fc::time_point_sec(1000) );
+   for( uint32_t i = 1; i <= 20; ++i )
+   {
+      record.record_round_trip_delay( fc::milliseconds(10 * i) );
+      db.update_entry( record );
+   }
+   BOOST_CHECK_EQUAL( fc::file_size( db_file ), empty_size );
+
+   // enough changed peers write the batch, with one entry per peer
+   for( uint32_t i = 2; fc::file_size( db_file ) == empty_size && i < 1000; ++i )
+      db.update_entry( potential_peer_record( fc::ip::endpoint( fc::ip::address(0x0a000000 + i), 1776 ) ) );
+   BOOST_CHECK_GT( fc::file_size( db_file ), empty_size );
+   BOOST_CHECK_LT( db.size(), 1000u );
+
+   db.close();
+   peer_database reopened;
+   reopened.open( db_file );
+   BOOST_CHECK_EQUAL( reopened.lookup_or_create_entry_for_endpoint( endpoint ).average_latency_ms,
+                      record.average_latency_ms );
+   reopened.close();
+}
+
+BOOST_AUTO_TEST_CASE(peer_database_legacy_import_test)
+{
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+   potential_peer_record record( fc::ip::endpoint::from_string("10.0.0.1:1776"), fc::time_point_sec(1000) );
+   record.number_of_successful_connection_attempts = 7;
+   fc::json::save_to_file( std::vector<potential_peer_record>({ record }), data_dir.path() / "peers.json",
+                           GRAPHENE_NET_MAX_NESTED_OBJECTS );
+
+   peer_database db;
+   db.open( data_dir.path() / "peers.dat" );
+   BOOST_REQUIRE_EQUAL( db.size(), 1u );
+   BOOST_CHECK_EQUAL( db.begin()->number_of_successful_connection_attempts, 7u );
+   db.close();
+   BOOST_CHECK( fc::exists( data_dir.path() / "peers.dat" ) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()